@@ -0,0 +1,307 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 terminal emulation throughput benchmark
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QTextStream>
+#include "vtcore.h"
+#include "vt220.h"
+
+namespace {
+
+//! Size in bytes of each generated stream
+static constexpr int stream_size = 8 << 20;
+//! Bytes per write, about what the GUI drains from the RxRing at once
+static constexpr int chunk_size = 4096;
+//! Bytes written between two painted frames
+static constexpr int frame_bytes = 4096;
+//! Maximum number of frames to paint per case
+static constexpr int max_frames = 500;
+//! Number of parse runs per case; the fastest one is reported
+static constexpr int parse_runs = 3;
+//! Number of backlog lines to keep while benchmarking
+static constexpr int backlog_lines = 1000;
+
+/**
+ * @brief A named byte stream to replay
+ */
+struct Case {
+    QString name;
+    QByteArray data;
+};
+
+/**
+ * @brief Simple linear congruential generator for reproducible streams
+ */
+class Random
+{
+public:
+    int next(int n)
+    {
+	m_seed = m_seed * 1103515245u + 12345u;
+	return static_cast<int>((m_seed >> 16) % static_cast<quint32>(n));
+    }
+private:
+    quint32 m_seed = 1;
+};
+
+static const char words[][8] = {
+    "rdlong", "wrlong", "cogid", "coginit", "hubset", "waitx",
+    "pinhigh", "pinlow", "drvnot", "rqpin", "setq", "altd",
+};
+static constexpr int nwords = sizeof(words) / sizeof(words[0]);
+
+/**
+ * @brief Plain printable ASCII lines
+ */
+QByteArray gen_ascii()
+{
+    QByteArray data;
+    data.reserve(stream_size);
+    Random rnd;
+    int line = 0;
+    while (data.size() < stream_size) {
+	QByteArray text = QByteArray::number(line++).rightJustified(6, '0') + ':';
+	while (text.size() < 72) {
+	    text += ' ';
+	    text += words[rnd.next(nwords)];
+	}
+	data += text.left(79);
+	data += "\r\n";
+    }
+    return data;
+}
+
+/**
+ * @brief Lines with an SGR color change for every word
+ */
+QByteArray gen_sgr()
+{
+    QByteArray data;
+    data.reserve(stream_size);
+    Random rnd;
+    while (data.size() < stream_size) {
+	for (int col = 0; col < 72; col += 8) {
+	    switch (rnd.next(4)) {
+	    case 0:
+		data += "\033[" + QByteArray::number(30 + rnd.next(8)) +
+			";" + QByteArray::number(40 + rnd.next(8)) + "m";
+		break;
+	    case 1:
+		data += "\033[1;" + QByteArray::number(90 + rnd.next(8)) + "m";
+		break;
+	    case 2:
+		data += "\033[38;5;" + QByteArray::number(rnd.next(256)) +
+			";48;5;" + QByteArray::number(rnd.next(256)) + "m";
+		break;
+	    default:
+		data += "\033[0;4;7m";
+		break;
+	    }
+	    data += QByteArray(words[rnd.next(nwords)]).leftJustified(8, ' ');
+	}
+	data += "\033[0m\r\n";
+    }
+    return data;
+}
+
+/**
+ * @brief Full screen redraws with cursor addressing for every row
+ */
+QByteArray gen_redraw()
+{
+    QByteArray data;
+    data.reserve(stream_size);
+    Random rnd;
+    int frame = 0;
+    while (data.size() < stream_size) {
+	data += "\033[H";
+	for (int row = 1; row <= 24; row++) {
+	    data += "\033[" + QByteArray::number(row) + ";1H";
+	    data += "\033[3" + QByteArray::number((row + frame) % 8) + "m";
+	    QByteArray text;
+	    while (text.size() < 80)
+		text += QByteArray(words[rnd.next(nwords)]) + ' ';
+	    data += text.left(80);
+	}
+	data += "\033[0m\033[25;1H\033[K" + QByteArray::number(frame++);
+    }
+    return data;
+}
+
+/**
+ * @brief Boxes drawn with UTF-8 box drawing and shade characters
+ */
+QByteArray gen_box()
+{
+    static const char* const shades[] = {"░", "▒", "▓", "█", " "};
+    QByteArray data;
+    data.reserve(stream_size);
+    Random rnd;
+    QByteArray horz;
+    for (int i = 0; i < 78; i++)
+	horz += "─";
+    while (data.size() < stream_size) {
+	data += "┌" + horz + "┐\r\n";
+	for (int row = 0; row < 8; row++) {
+	    data += "│";
+	    for (int col = 0; col < 78; col++)
+		data += shades[rnd.next(5)];
+	    data += "│\r\n";
+	}
+	data += "├" + horz + "┤\r\n";
+	data += "└" + horz + "┘\r\n";
+    }
+    return data;
+}
+
+/**
+ * @brief Scrolling inside changing scroll regions, with inserts and deletes of lines
+ */
+QByteArray gen_scroll()
+{
+    QByteArray data;
+    data.reserve(stream_size);
+    Random rnd;
+    int line = 0;
+    while (data.size() < stream_size) {
+	const int top = 1 + rnd.next(10);
+	const int bottom = top + 2 + rnd.next(24 - top - 1);
+	data += "\033[" + QByteArray::number(top) + ";" + QByteArray::number(bottom) + "r";
+	data += "\033[" + QByteArray::number(bottom) + ";1H";
+	for (int i = 0; i < 16; i++) {
+	    data += QByteArray::number(line++) + ' ' + words[rnd.next(nwords)] + "\n\r";
+	    switch (rnd.next(8)) {
+	    case 0:	// reverse index at the top of the region
+		data += "\033[" + QByteArray::number(top) + ";1H\033M";
+		data += "\033[" + QByteArray::number(bottom) + ";1H";
+		break;
+	    case 1:	// insert lines
+		data += "\033[" + QByteArray::number(1 + rnd.next(3)) + "L";
+		break;
+	    case 2:	// delete lines
+		data += "\033[" + QByteArray::number(1 + rnd.next(3)) + "M";
+		break;
+	    }
+	}
+    }
+    data += "\033[r";
+    return data;
+}
+
+/**
+ * @brief Return the parse throughput of @p data through a headless vtCore
+ * @param data const reference to the QByteArray to replay
+ * @return throughput in MB/s
+ */
+double parse_mbps(const QByteArray& data)
+{
+    qint64 best = 0;
+    for (int run = 0; run < parse_runs; run++) {
+	vtCore core;
+	core.set_backlog_lines(backlog_lines);
+	QElapsedTimer et;
+	et.start();
+	for (int pos = 0; pos < data.size(); pos += chunk_size) {
+	    const int len = qMin(chunk_size, data.size() - pos);
+	    core.write(data.constData() + pos, static_cast<size_t>(len));
+	}
+	const qint64 ns = qMax<qint64>(1, et.nsecsElapsed());
+	if (0 == best || ns < best)
+	    best = ns;
+    }
+    return data.size() / 1e6 / (best / 1e9);
+}
+
+/**
+ * @brief Return the rate of full screen paints of a vt220 view fed with @p data
+ *
+ * Between two frames, frame_bytes of @p data are written to the view and
+ * the damage is flushed. Only the time spent in rendering the screen into
+ * an offscreen QImage is measured.
+ * @param data const reference to the QByteArray to replay
+ * @param p_frames pointer to an int receiving the number of frames painted
+ * @return frames per second
+ */
+double paint_fps(const QByteArray& data, int* p_frames)
+{
+    vt220 view;
+    view.set_backlog_lines(backlog_lines);
+    const QSize size = view.term_geometry();
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    qint64 ns = 0;
+    int frames = 0;
+    for (int pos = 0; pos < data.size() && frames < max_frames; pos += frame_bytes) {
+	const int len = qMin(frame_bytes, data.size() - pos);
+	view.write(data.constData() + pos, static_cast<size_t>(len));
+	view.core()->flush_damage();
+	// the view is screen sized and follows the screen
+	const QRect screen(QPoint(0, 0), size);
+	QElapsedTimer et;
+	et.start();
+	view.render(&image, QPoint(), QRegion(screen));
+	ns += et.nsecsElapsed();
+	frames++;
+    }
+    *p_frames = frames;
+    return frames / (qMax<qint64>(1, ns) / 1e9);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    // no display is needed to paint into a QImage
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+	qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    app.setApplicationName(QLatin1String("vtbench"));
+
+    QList<Case> cases;
+    const QStringList args = app.arguments().mid(1);
+    if (args.isEmpty()) {
+	cases += Case{QLatin1String("ascii"), gen_ascii()};
+	cases += Case{QLatin1String("sgr"), gen_sgr()};
+	cases += Case{QLatin1String("redraw"), gen_redraw()};
+	cases += Case{QLatin1String("utf8-box"), gen_box()};
+	cases += Case{QLatin1String("scroll"), gen_scroll()};
+    }
+    for (const QString& filename : args) {
+	// replay a raw capture of the serial data, e.g. from a P2 session
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) {
+	    qWarning("Could not open '%s': %s", qPrintable(filename), qPrintable(file.errorString()));
+	    return 1;
+	}
+	cases += Case{QFileInfo(filename).fileName(), file.readAll()};
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4\n")
+	   .arg(QLatin1String("case"), -16)
+	   .arg(QLatin1String("MiB"), 8)
+	   .arg(QLatin1String("parse MB/s"), 12)
+	   .arg(QLatin1String("frames/s"), 12);
+    for (const Case& c : cases) {
+	int frames = 0;
+	const double mbps = parse_mbps(c.data);
+	const double fps = paint_fps(c.data, &frames);
+	out << QString("%1 %2 %3 %4 (%5 frames)\n")
+	       .arg(c.name, -16)
+	       .arg(c.data.size() / 1048576.0, 8, 'f', 2)
+	       .arg(mbps, 12, 'f', 1)
+	       .arg(fps, 12, 'f', 1)
+	       .arg(frames);
+	out.flush();
+    }
+    return 0;
+}
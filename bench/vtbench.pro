@@ -0,0 +1,45 @@
+QT      += core gui widgets
+CONFIG  += c++14 console
+CONFIG  -= app_bundle
+TARGET   = vtbench
+
+# Throughput benchmark of the terminal emulation
+# Run with: vtbench [-platform offscreen] [capture files...]
+
+INCLUDEPATH += $$PWD/.. $$PWD/../term
+
+SOURCES += \
+    $$PWD/vtbench.cpp \
+    $$PWD/../trace.cpp \
+    $$PWD/../term/vt220.cpp \
+    $$PWD/../term/vtattr.cpp \
+    $$PWD/../term/vtbacklog.cpp \
+    $$PWD/../term/vtcell.cpp \
+    $$PWD/../term/vtcore.cpp \
+    $$PWD/../term/vtglyphcache.cpp \
+    $$PWD/../term/vtglyphs.cpp \
+    $$PWD/../term/vtline.cpp \
+    $$PWD/../term/vtpage.cpp \
+    $$PWD/../term/vtscrollarea.cpp \
+    $$PWD/../term/vttextindex.cpp
+
+HEADERS += \
+    $$PWD/../trace.h \
+    $$PWD/../term/vt220.h \
+    $$PWD/../term/vtattr.h \
+    $$PWD/../term/vtbacklog.h \
+    $$PWD/../term/vtcell.h \
+    $$PWD/../term/vtchar.h \
+    $$PWD/../term/vtcore.h \
+    $$PWD/../term/vtglyphcache.h \
+    $$PWD/../term/vtglyphs.h \
+    $$PWD/../term/vtline.h \
+    $$PWD/../term/vtpage.h \
+    $$PWD/../term/vtscrollarea.h \
+    $$PWD/../term/vttextindex.h
+
+# Optional OpenGL renderer of the terminal
+qtConfig(opengl) {
+    SOURCES += $$PWD/../term/vtglview.cpp
+    HEADERS += $$PWD/../term/vtglview.h
+}
@@ -0,0 +1,460 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 content-addressed cache of flexspin build results
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include "buildcache.h"
+
+/**
+ * @brief Create a build cache
+ * @param path directory where entries are stored on disk, or empty to keep them in memory only
+ */
+BuildCache::BuildCache(const QString& path)
+    : m_path(path)
+    , m_files()
+    , m_entries()
+    , m_lru()
+{
+    if (!m_path.isEmpty())
+	QDir().mkpath(m_path);
+}
+
+/**
+ * @brief Return the directory where entries are stored on disk
+ */
+QString BuildCache::path() const
+{
+    return m_path;
+}
+
+/**
+ * @brief Return the key for building @p filename
+ * @param executable flexspin executable
+ * @param arguments command line arguments passed to flexspin
+ * @param filename source file name
+ * @param include_paths include paths to search dependencies in
+ * @return hex encoded SHA-256 key
+ */
+QByteArray BuildCache::key(const QString& executable, const QStringList& arguments,
+			   const QString& filename, const QStringList& include_paths)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArrayLiteral("qflexprop build cache 1\n"));
+    hash.addData(tool_identity(executable));
+    hash.addData("\n", 1);
+    foreach(const QString& arg, arguments) {
+	hash.addData(arg.toUtf8());
+	hash.addData("\0", 1);
+    }
+    hash.addData("\n", 1);
+    walk(filename, include_paths, &hash);
+    return hash.result().toHex();
+}
+
+/**
+ * @brief Return the files @p filename transitively depends on
+ * @param filename source file name
+ * @param include_paths include paths to search dependencies in
+ * @return list of absolute paths, starting with @p filename itself
+ */
+QStringList BuildCache::dependencies(const QString& filename, const QStringList& include_paths)
+{
+    return walk(filename, include_paths, nullptr);
+}
+
+/**
+ * @brief Look up the entry for @p key
+ * @param key key as returned by key()
+ * @param p_entry pointer to an Entry to receive the results
+ * @return true if found, false otherwise
+ */
+bool BuildCache::lookup(const QByteArray& key, Entry* p_entry)
+{
+    auto it = m_entries.constFind(key);
+    if (it != m_entries.constEnd()) {
+	*p_entry = it.value();
+	touch(key, *p_entry);
+	return true;
+    }
+
+    if (m_path.isEmpty())
+	return false;
+
+    QFile binfile(entry_filename(key, QStringLiteral(".binary")));
+    if (!binfile.open(QIODevice::ReadOnly))
+	return false;
+    Entry entry;
+    entry.binary = binfile.readAll();
+    binfile.close();
+
+    QFile p2asm(entry_filename(key, QStringLiteral(".p2asm")));
+    if (p2asm.open(QIODevice::ReadOnly)) {
+	entry.p2asm = p2asm.readAll();
+	p2asm.close();
+    }
+
+    QFile lst(entry_filename(key, QStringLiteral(".lst")));
+    if (lst.open(QIODevice::ReadOnly)) {
+	entry.lst = lst.readAll();
+	lst.close();
+    }
+
+    QFile output(entry_filename(key, QStringLiteral(".out")));
+    if (output.open(QIODevice::ReadOnly)) {
+	entry.output = output.readAll();
+	output.close();
+    }
+
+    QFile errors(entry_filename(key, QStringLiteral(".err")));
+    if (errors.open(QIODevice::ReadOnly)) {
+	entry.errors = errors.readAll();
+	errors.close();
+    }
+
+    touch(key, entry);
+    *p_entry = entry;
+    return true;
+}
+
+/**
+ * @brief Insert the results of a successful build as @p key
+ * @param key key as returned by key()
+ * @param entry const reference to the results
+ */
+void BuildCache::insert(const QByteArray& key, const Entry& entry)
+{
+    touch(key, entry);
+
+    if (m_path.isEmpty())
+	return;
+
+    // the binary is written last, since its presence marks a complete entry
+    if (!entry.p2asm.isNull()) {
+	QSaveFile p2asm(entry_filename(key, QStringLiteral(".p2asm")));
+	if (p2asm.open(QIODevice::WriteOnly)) {
+	    p2asm.write(entry.p2asm);
+	    p2asm.commit();
+	}
+    }
+    if (!entry.lst.isNull()) {
+	QSaveFile lst(entry_filename(key, QStringLiteral(".lst")));
+	if (lst.open(QIODevice::WriteOnly)) {
+	    lst.write(entry.lst);
+	    lst.commit();
+	}
+    }
+    if (!entry.output.isEmpty()) {
+	QSaveFile output(entry_filename(key, QStringLiteral(".out")));
+	if (output.open(QIODevice::WriteOnly)) {
+	    output.write(entry.output);
+	    output.commit();
+	}
+    }
+    if (!entry.errors.isEmpty()) {
+	QSaveFile errors(entry_filename(key, QStringLiteral(".err")));
+	if (errors.open(QIODevice::WriteOnly)) {
+	    errors.write(entry.errors);
+	    errors.commit();
+	}
+    }
+    QSaveFile binfile(entry_filename(key, QStringLiteral(".binary")));
+    if (binfile.open(QIODevice::WriteOnly)) {
+	binfile.write(entry.binary);
+	binfile.commit();
+    }
+    prune_disk();
+}
+
+/**
+ * @brief Remove all entries from memory and disk
+ */
+void BuildCache::clear()
+{
+    m_files.clear();
+    m_entries.clear();
+    m_lru.clear();
+    if (m_path.isEmpty())
+	return;
+    QDir dir(m_path);
+    const QStringList names = dir.entryList(QStringList()
+					    << QStringLiteral("*.binary")
+					    << QStringLiteral("*.p2asm")
+					    << QStringLiteral("*.lst")
+					    << QStringLiteral("*.out")
+					    << QStringLiteral("*.err"),
+					    QDir::Files);
+    foreach(const QString& name, names)
+	dir.remove(name);
+}
+
+/**
+ * @brief Walk the dependencies of @p filename
+ *
+ * If @p hash is not nullptr, the path, contents hash, and resolved
+ * references of every file are added to it. References which cannot
+ * be resolved are hashed, too, so that the key changes once they appear.
+ * @param filename source file name
+ * @param include_paths include paths to search dependencies in
+ * @param hash pointer to a QCryptographicHash to update, or nullptr
+ * @return list of absolute paths, starting with @p filename itself
+ */
+QStringList BuildCache::walk(const QString& filename, const QStringList& include_paths,
+			     QCryptographicHash* hash)
+{
+    QStringList files;
+    QSet<QString> seen;
+    const QString source = QFileInfo(filename).absoluteFilePath();
+    files += source;
+    seen.insert(source);
+
+    for (int i = 0; i < files.count(); i++) {
+	const QString path = files[i];
+	const FileInfo* info = scan(path);
+	if (hash) {
+	    hash->addData(path.toUtf8());
+	    hash->addData("\0", 1);
+	    hash->addData(info ? info->sha256 : QByteArrayLiteral("missing"));
+	    hash->addData("\n", 1);
+	}
+	if (!info)
+	    continue;
+	// copy, since scan() may rehash m_files
+	const QStringList refs = info->refs;
+	foreach(const QString& ref, refs) {
+	    const QString dep = resolve(ref, path, include_paths);
+	    if (hash) {
+		hash->addData(ref.toUtf8());
+		hash->addData("\0", 1);
+		hash->addData(dep.toUtf8());
+		hash->addData("\n", 1);
+	    }
+	    if (dep.isEmpty() || seen.contains(dep))
+		continue;
+	    seen.insert(dep);
+	    files += dep;
+	}
+    }
+    return files;
+}
+
+/**
+ * @brief Return the hash and references of @p filename
+ *
+ * A file is read and scanned again only when its size or
+ * modification time changed since it was last scanned.
+ * @param filename absolute path of the file
+ * @return pointer to the FileInfo, or nullptr if the file does not exist
+ */
+const BuildCache::FileInfo* BuildCache::scan(const QString& filename)
+{
+    QFileInfo fi(filename);
+    if (!fi.isFile()) {
+	m_files.remove(filename);
+	return nullptr;
+    }
+
+    auto it = m_files.find(filename);
+    if (it != m_files.end() &&
+	it.value().size == fi.size() &&
+	it.value().mtime == fi.lastModified())
+	return &it.value();
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+	m_files.remove(filename);
+	return nullptr;
+    }
+    const QByteArray source = file.readAll();
+    file.close();
+
+    const QString suffix = fi.suffix().toLower();
+    FileInfo info;
+    info.size = fi.size();
+    info.mtime = fi.lastModified();
+    info.sha256 = QCryptographicHash::hash(source, QCryptographicHash::Sha256);
+    info.refs = references(source, suffix == QLatin1String("spin") ||
+				    suffix == QLatin1String("spin2"));
+    it = m_files.insert(filename, info);
+    return &it.value();
+}
+
+/**
+ * @brief Return the file names referenced by @p source
+ *
+ * This recognizes #include "file" in all languages, the objects in a
+ * Spin OBJ section, BASIC's class using "file", and C's struct __using("file").
+ * Being a little too generous is harmless, since a reference which does
+ * not exist only becomes part of the key.
+ * @param source const reference to the source code
+ * @param spin true if the source is Spin or Spin2
+ * @return list of referenced names as written in the source
+ */
+QStringList BuildCache::references(const QByteArray& source, bool spin)
+{
+    static const QRegularExpression re_include(
+		QStringLiteral("^\\s*#\\s*include\\s+\"([^\"]+)\""));
+    static const QRegularExpression re_section(
+		QStringLiteral("^(con|var|obj|pub|pri|dat)\\b"),
+		QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression re_obj(
+		QStringLiteral("^\\s*\\w+\\s*(\\[[^\\]]*\\])?\\s*:\\s*\"([^\"]+)\""));
+    static const QRegularExpression re_using(
+		QStringLiteral("\\bclass\\s+using\\s+\"([^\"]+)\""),
+		QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression re_struct_using(
+		QStringLiteral("\\b__using\\s*\\(\\s*\"([^\"]+)\""));
+
+    QStringList refs;
+    bool in_obj = false;
+    const QStringList lines = QString::fromUtf8(source).split(QChar('\n'));
+    foreach(const QString& line, lines) {
+	QRegularExpressionMatch match = re_include.match(line);
+	if (match.hasMatch()) {
+	    refs += match.captured(1);
+	    continue;
+	}
+	if (spin) {
+	    match = re_section.match(line);
+	    if (match.hasMatch())
+		in_obj = match.captured(1).toLower() == QLatin1String("obj");
+	    // objects may follow the OBJ keyword on the same line
+	    const QString rest = match.hasMatch() ? line.mid(match.capturedEnd()) : line;
+	    if (in_obj) {
+		match = re_obj.match(rest);
+		if (match.hasMatch())
+		    refs += match.captured(2);
+	    }
+	    continue;
+	}
+	match = re_using.match(line);
+	if (match.hasMatch())
+	    refs += match.captured(1);
+	match = re_struct_using.match(line);
+	if (match.hasMatch())
+	    refs += match.captured(1);
+    }
+    return refs;
+}
+
+/**
+ * @brief Resolve the referenced @p name like flexspin does
+ *
+ * The name is searched relative to the directory of the @p parent
+ * and then in the @p include_paths. A name without extension gets
+ * the extension of the @p parent, or any of the source extensions.
+ * @param name referenced file name
+ * @param parent absolute path of the referencing file
+ * @param include_paths include paths to search
+ * @return absolute path of the file, or an empty string if not found
+ */
+QString BuildCache::resolve(const QString& name, const QString& parent,
+			    const QStringList& include_paths)
+{
+    const QFileInfo pi(parent);
+    QStringList candidates;
+    if (QFileInfo(name).suffix().isEmpty()) {
+	QStringList suffixes;
+	suffixes << pi.suffix()
+		 << QStringLiteral("spin2")
+		 << QStringLiteral("spin")
+		 << QStringLiteral("bas")
+		 << QStringLiteral("c");
+	suffixes.removeDuplicates();
+	foreach(const QString& suffix, suffixes)
+	    candidates += QString("%1.%2").arg(name).arg(suffix);
+    } else {
+	candidates += name;
+    }
+
+    QStringList dirs;
+    dirs += pi.absolutePath();
+    dirs += include_paths;
+    foreach(const QString& dir, dirs) {
+	foreach(const QString& candidate, candidates) {
+	    const QFileInfo fi(QDir(dir).filePath(candidate));
+	    if (fi.isFile())
+		return fi.absoluteFilePath();
+	}
+    }
+    return QString();
+}
+
+/**
+ * @brief Return a string identifying the flexspin @p executable
+ *
+ * Asking flexspin for its version would mean starting a process before
+ * every build, so the executable's path, size, and modification time
+ * stand in for the version. Installing another flexspin changes them.
+ * @param executable path or name of the executable
+ * @return QByteArray identifying the executable
+ */
+QByteArray BuildCache::tool_identity(const QString& executable)
+{
+    QFileInfo fi(executable);
+    if (!fi.isFile()) {
+	const QString found = QStandardPaths::findExecutable(executable);
+	if (found.isEmpty())
+	    return QString("missing %1").arg(executable).toUtf8();
+	fi.setFile(found);
+    }
+    return QString("%1 %2 %3")
+	    .arg(fi.canonicalFilePath())
+	    .arg(fi.size())
+	    .arg(fi.lastModified().toMSecsSinceEpoch())
+	    .toUtf8();
+}
+
+/**
+ * @brief Return the file name for an entry's part on disk
+ * @param key key of the entry
+ * @param suffix suffix of the part (.binary, .p2asm, .lst, .out, or .err)
+ * @return QString with the absolute path
+ */
+QString BuildCache::entry_filename(const QByteArray& key, const QString& suffix) const
+{
+    return QDir(m_path).filePath(QString::fromLatin1(key) + suffix);
+}
+
+/**
+ * @brief Make @p key the most recently used entry in memory
+ * @param key key of the entry
+ * @param entry const reference to the results
+ */
+void BuildCache::touch(const QByteArray& key, const Entry& entry)
+{
+    m_lru.removeOne(key);
+    m_lru.append(key);
+    m_entries.insert(key, entry);
+    while (m_lru.count() > max_entries)
+	m_entries.remove(m_lru.takeFirst());
+}
+
+/**
+ * @brief Remove the oldest entries on disk beyond max_disk_entries
+ */
+void BuildCache::prune_disk()
+{
+    QDir dir(m_path);
+    const QFileInfoList binaries = dir.entryInfoList(QStringList() << QStringLiteral("*.binary"),
+						     QDir::Files, QDir::Time);
+    for (int i = max_disk_entries; i < binaries.count(); i++) {
+	const QString base = binaries[i].completeBaseName();
+	dir.remove(base + QStringLiteral(".binary"));
+	dir.remove(base + QStringLiteral(".p2asm"));
+	dir.remove(base + QStringLiteral(".lst"));
+	dir.remove(base + QStringLiteral(".out"));
+	dir.remove(base + QStringLiteral(".err"));
+    }
+}
@@ -0,0 +1,81 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 content-addressed cache of flexspin build results
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QCryptographicHash;
+
+/**
+ * @brief Cache of flexspin results keyed by the hash of everything a build depends on
+ *
+ * The key is a SHA-256 over the flexspin executable's identity, the
+ * command line arguments, and the contents of the source file and all
+ * the files it transitively includes (#include, OBJ, class using, and
+ * struct __using). Entries are kept in memory and, if a directory is
+ * given, also on disk so they survive a restart.
+ */
+class BuildCache
+{
+public:
+    struct Entry {
+	QByteArray binary;		//!< resulting binary
+	QByteArray p2asm;		//!< intermediate p2asm output (UTF-8)
+	QByteArray lst;			//!< listing (UTF-8)
+	QByteArray output;		//!< compiler's standard output (UTF-8)
+	QByteArray errors;		//!< compiler's standard error (UTF-8)
+    };
+
+    explicit BuildCache(const QString& path = QString());
+
+    QString path() const;
+    QByteArray key(const QString& executable, const QStringList& arguments,
+		   const QString& filename, const QStringList& include_paths);
+    QStringList dependencies(const QString& filename, const QStringList& include_paths);
+    bool lookup(const QByteArray& key, Entry* p_entry);
+    void insert(const QByteArray& key, const Entry& entry);
+    void clear();
+
+private:
+    //! Maximum number of entries kept in memory
+    static constexpr int max_entries = 32;
+    //! Maximum number of entries kept on disk
+    static constexpr int max_disk_entries = 256;
+
+    /**
+     * @brief Hash and references of a file, valid while its size and mtime are unchanged
+     */
+    struct FileInfo {
+	qint64 size = -1;		//!< file size when it was scanned
+	QDateTime mtime;		//!< modification time when it was scanned
+	QByteArray sha256;		//!< SHA-256 of the file contents
+	QStringList refs;		//!< file names referenced by the source
+    };
+
+    QString m_path;				//!< directory for entries on disk, or empty
+    QHash<QString,FileInfo> m_files;		//!< scanned files by absolute path
+    QHash<QByteArray,Entry> m_entries;		//!< entries in memory by key
+    QList<QByteArray> m_lru;			//!< keys in m_entries, most recently used last
+
+    QStringList walk(const QString& filename, const QStringList& include_paths,
+		     QCryptographicHash* hash);
+    const FileInfo* scan(const QString& filename);
+    static QStringList references(const QByteArray& source, bool spin);
+    static QString resolve(const QString& name, const QString& parent,
+			   const QStringList& include_paths);
+    static QByteArray tool_identity(const QString& executable);
+    QString entry_filename(const QByteArray& key, const QString& suffix) const;
+    void touch(const QByteArray& key, const Entry& entry);
+    void prune_disk();
+};
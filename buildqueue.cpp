@@ -0,0 +1,176 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 queue of flexspin builds of independent programs
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QThread>
+#include "buildqueue.h"
+
+BuildQueue::BuildQueue(const Flexspin::Options& options, BuildCache* cache, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_cache(cache)
+    , m_jobs(qMax(1, QThread::idealThreadCount()))
+    , m_pending()
+    , m_running()
+    , m_built(0)
+    , m_failed(0)
+    , m_canceled(false)
+    , m_starting(false)
+{
+}
+
+BuildQueue::~BuildQueue()
+{
+    // the Flexspin destructor kills a still running process
+    foreach(Flexspin* job, m_running)
+	job->disconnect(this);
+}
+
+/**
+ * @brief Return the maximum number of jobs running at the same time
+ */
+int BuildQueue::jobs() const
+{
+    return m_jobs;
+}
+
+/**
+ * @brief Set the maximum number of jobs running at the same time
+ * @param jobs number of jobs; values less than 1 mean one per core
+ */
+void BuildQueue::set_jobs(int jobs)
+{
+    m_jobs = jobs > 0 ? jobs : qMax(1, QThread::idealThreadCount());
+}
+
+/**
+ * @brief Return true, if builds are pending or running
+ */
+bool BuildQueue::is_running() const
+{
+    return !m_pending.isEmpty() || !m_running.isEmpty();
+}
+
+/**
+ * @brief Return the @p files which are not an object of another file in @p files
+ *
+ * flexspin compiles a whole program from its top level file, so building
+ * a file which another listed file pulls in via OBJ, #include etc. would
+ * only duplicate work. Files depending on each other are all kept.
+ * @param files list of source file names
+ * @return list of the top level files, in the order of @p files
+ */
+QStringList BuildQueue::top_level(const QStringList& files) const
+{
+    if (!m_cache)
+	return files;
+
+    QHash<QString,QSet<QString>> deps;
+    foreach(const QString& file, files) {
+	const QStringList list = m_cache->dependencies(file, m_options.include_paths);
+	deps.insert(QFileInfo(file).absoluteFilePath(), list.mid(1).toSet());
+    }
+
+    QStringList result;
+    foreach(const QString& file, files) {
+	const QString path = QFileInfo(file).absoluteFilePath();
+	bool child = false;
+	for (auto it = deps.constBegin(); it != deps.constEnd() && !child; ++it) {
+	    if (it.key() == path)
+		continue;
+	    // a file is a child unless it is part of a cycle with its parent
+	    child = it.value().contains(path) && !deps.value(path).contains(it.key());
+	}
+	if (!child)
+	    result += file;
+    }
+    return result;
+}
+
+/**
+ * @brief Start building @p files
+ *
+ * The Started() signal is emitted for each job right before its build
+ * starts, so that receivers can connect to its Error() and Message()
+ * signals. Built() is emitted for each job and Finished() at the end.
+ * @param files list of source file names
+ */
+void BuildQueue::start(const QStringList& files)
+{
+    m_pending += files;
+    m_pending.removeDuplicates();
+    if (m_running.isEmpty()) {
+	m_built = 0;
+	m_failed = 0;
+	m_canceled = false;
+    }
+    start_jobs();
+}
+
+/**
+ * @brief Cancel the pending and running builds
+ */
+void BuildQueue::cancel()
+{
+    m_canceled = true;
+    m_failed += m_pending.count();
+    m_pending.clear();
+    foreach(Flexspin* job, m_running)
+	job->cancel();
+}
+
+/**
+ * @brief Collect the result of a job and start the next one
+ * @param ok true if the build succeeded
+ */
+void BuildQueue::job_finished(bool ok)
+{
+    Flexspin* job = qobject_cast<Flexspin*>(sender());
+    if (!job || !m_running.removeOne(job))
+	return;
+    if (ok) {
+	m_built++;
+    } else {
+	m_failed++;
+    }
+    emit Built(job, ok);
+    job->deleteLater();
+    start_jobs();
+}
+
+/**
+ * @brief Start pending jobs until m_jobs are running, and emit Finished() when done
+ */
+void BuildQueue::start_jobs()
+{
+    // a job failing to start finishes from within Flexspin::start()
+    if (m_starting)
+	return;
+    m_starting = true;
+
+    while (!m_canceled && !m_pending.isEmpty() && m_running.count() < m_jobs) {
+	const QString filename = m_pending.takeFirst();
+
+	Flexspin* job = new Flexspin(m_options, this);
+	job->set_cache(m_cache);
+	bool ok;
+	ok = connect(job, &Flexspin::Finished,
+		     this, &BuildQueue::job_finished);
+	Q_ASSERT(ok);
+	m_running += job;
+	emit Started(job, filename);
+	job->start(filename);
+    }
+
+    m_starting = false;
+    if (m_running.isEmpty() && m_pending.isEmpty())
+	emit Finished(m_built, m_failed);
+}
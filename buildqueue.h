@@ -0,0 +1,65 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 queue of flexspin builds of independent programs
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include "buildcache.h"
+#include "flexspin.h"
+
+/**
+ * @brief Builds several independent programs, one flexspin process each
+ *
+ * Up to jobs() Flexspin instances run at the same time, by default one
+ * per core. flexspin compiles a program together with all of its
+ * objects in one process, so a single program is never split into
+ * jobs; files which are objects of other queued files are built as
+ * part of their parents, see top_level(). With a BuildCache set, files
+ * whose sources did not change are not compiled again.
+ */
+class BuildQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BuildQueue(const Flexspin::Options& options, BuildCache* cache = nullptr,
+			QObject* parent = nullptr);
+    ~BuildQueue();
+
+    int jobs() const;
+    void set_jobs(int jobs);
+    bool is_running() const;
+    QStringList top_level(const QStringList& files) const;
+
+    void start(const QStringList& files);
+
+public slots:
+    void cancel();
+
+signals:
+    void Started(Flexspin* job, const QString& filename);
+    void Built(Flexspin* job, bool ok);
+    void Finished(int built, int failed);
+
+private slots:
+    void job_finished(bool ok);
+
+private:
+    Flexspin::Options m_options;	//!< compiler options for all jobs
+    BuildCache* m_cache;		//!< cache of build results, or nullptr
+    int m_jobs;				//!< maximum number of jobs running at the same time
+    QStringList m_pending;		//!< files waiting to be built
+    QList<Flexspin*> m_running;		//!< jobs currently running
+    int m_built;			//!< number of files built successfully
+    int m_failed;			//!< number of files which failed to build
+    bool m_canceled;			//!< true if cancel() was called
+    bool m_starting;			//!< true while start_jobs() is starting jobs
+
+    void start_jobs();
+};
@@ -0,0 +1,368 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 headless build and upload from the command line
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <cstdio>
+#include "clirunner.h"
+#include "proptypes.h"
+
+CliRunner::CliRunner(QObject* parent)
+    : QObject(parent)
+    , m_flexspin_options(Flexspin::saved_options())
+    , m_upload_options()
+    , m_filename()
+    , m_ports()
+    , m_capture_file()
+    , m_compile(true)
+    , m_stage2(false)
+    , m_quiet(false)
+    , m_flexspin(nullptr)
+    , m_workers()
+    , m_failed(0)
+    , m_exit_code(Exit_Success)
+{
+    m_upload_options.baud_rate = Serial_Baud230400;
+    m_upload_options.data_bits = QSerialPort::Data8;
+    m_upload_options.parity = QSerialPort::NoParity;
+    m_upload_options.stop_bits = QSerialPort::OneStop;
+    m_upload_options.flow_control = QSerialPort::NoFlowControl;
+    m_upload_options.upload_baud_rate = 0;
+    m_upload_options.clock_freq = 180000000;
+    m_upload_options.clock_mode = 0;
+    m_upload_options.mode = PropLoad::Prop_Hex;
+}
+
+/**
+ * @brief Return true, if the command line selects the headless mode
+ *
+ * This is checked before the application object is created, so that
+ * no QApplication is needed.
+ * @param argc number of arguments
+ * @param argv array of argument strings
+ * @return true if --cli is given
+ */
+bool CliRunner::requested(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+	if (0 == qstrcmp(argv[i], "--cli"))
+	    return true;
+    return false;
+}
+
+/**
+ * @brief Parse the command line @p arguments
+ * @param arguments QStringList with the program name and its arguments
+ * @return true if start() should be called, or false to exit with exit_code()
+ */
+bool CliRunner::parse(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("Build a Propeller 2 program and upload it without a window."));
+    const QCommandLineOption opt_help = parser.addHelpOption();
+    const QCommandLineOption opt_version = parser.addVersionOption();
+    const QCommandLineOption opt_cli(QStringList() << "cli",
+				     tr("Run without a window."));
+    const QCommandLineOption opt_port(QStringList() << "p" << "port",
+				      tr("Upload to serial port <port>; may be repeated."),
+				      tr("port"));
+    const QCommandLineOption opt_baud(QStringList() << "b" << "baud",
+				      tr("Terminal baud rate <rate> (default %1).").arg(m_upload_options.baud_rate),
+				      tr("rate"));
+    const QCommandLineOption opt_upload_baud(QStringList() << "u" << "upload-baud",
+					     tr("Upload at baud rate <rate> (default: the terminal baud rate)."),
+					     tr("rate"));
+    const QCommandLineOption opt_binary_upload(QStringList() << "binary-upload",
+					       tr("Upload through the second stage loader."));
+    const QCommandLineOption opt_capture(QStringList() << "c" << "capture",
+					 tr("Capture the output for <seconds> after the upload."),
+					 tr("seconds"));
+    const QCommandLineOption opt_output(QStringList() << "o" << "output",
+					tr("Write the captured output to <file> (default: standard output)."),
+					tr("file"));
+    const QCommandLineOption opt_flexspin(QStringList() << "flexspin",
+					  tr("Use the flexspin executable <path>."),
+					  tr("path"));
+    const QCommandLineOption opt_include(QStringList() << "I" << "include",
+					 tr("Add <path> to the include paths; may be repeated."),
+					 tr("path"));
+    const QCommandLineOption opt_quiet(QStringList() << "q" << "quiet",
+				       tr("Print errors only."));
+    parser.addOption(opt_cli);
+    parser.addOption(opt_port);
+    parser.addOption(opt_baud);
+    parser.addOption(opt_upload_baud);
+    parser.addOption(opt_binary_upload);
+    parser.addOption(opt_capture);
+    parser.addOption(opt_output);
+    parser.addOption(opt_flexspin);
+    parser.addOption(opt_include);
+    parser.addOption(opt_quiet);
+    parser.addPositionalArgument(QLatin1String("file"),
+				 tr("Source file to compile, or a .binary file to upload as is."));
+
+    m_exit_code = Exit_Usage;
+    if (!parser.parse(arguments)) {
+	print(parser.errorText());
+	return false;
+    }
+    if (parser.isSet(opt_help)) {
+	print(parser.helpText());
+	m_exit_code = Exit_Success;
+	return false;
+    }
+    if (parser.isSet(opt_version)) {
+	print(QString("%1 %2")
+	      .arg(QCoreApplication::applicationName())
+	      .arg(QCoreApplication::applicationVersion()));
+	m_exit_code = Exit_Success;
+	return false;
+    }
+
+    const QStringList files = parser.positionalArguments();
+    if (files.count() != 1) {
+	print(tr("Exactly one file must be given."));
+	return false;
+    }
+    m_filename = files.first();
+    if (!QFileInfo(m_filename).isFile()) {
+	print(tr("No such file: %1").arg(m_filename));
+	return false;
+    }
+    const QString suffix = QFileInfo(m_filename).suffix().toLower();
+    m_compile = suffix != QLatin1String("binary") && suffix != QLatin1String("bin");
+
+    m_ports = parser.values(opt_port);
+    m_quiet = parser.isSet(opt_quiet);
+    m_stage2 = parser.isSet(opt_binary_upload);
+
+    bool ok = true;
+    if (parser.isSet(opt_baud))
+	m_upload_options.baud_rate = parser.value(opt_baud).toInt(&ok);
+    if (!ok || m_upload_options.baud_rate <= 0) {
+	print(tr("Invalid baud rate: %1").arg(parser.value(opt_baud)));
+	return false;
+    }
+    m_upload_options.upload_baud_rate = static_cast<quint32>(m_upload_options.baud_rate);
+    if (parser.isSet(opt_upload_baud))
+	m_upload_options.upload_baud_rate = parser.value(opt_upload_baud).toUInt(&ok);
+    if (!ok || 0 == m_upload_options.upload_baud_rate) {
+	print(tr("Invalid upload baud rate: %1").arg(parser.value(opt_upload_baud)));
+	return false;
+    }
+    if (parser.isSet(opt_capture)) {
+	const double seconds = parser.value(opt_capture).toDouble(&ok);
+	if (!ok || seconds <= 0.0) {
+	    print(tr("Invalid capture time: %1").arg(parser.value(opt_capture)));
+	    return false;
+	}
+	m_upload_options.capture_msecs = qRound(seconds * 1000.0);
+    }
+    m_capture_file = parser.value(opt_output);
+
+    if (parser.isSet(opt_flexspin))
+	m_flexspin_options.executable = parser.value(opt_flexspin);
+    m_flexspin_options.include_paths += parser.values(opt_include);
+    m_flexspin_options.baud_rate = m_upload_options.baud_rate;
+
+    m_exit_code = Exit_Success;
+    return true;
+}
+
+/**
+ * @brief Return the exit code for the process
+ */
+int CliRunner::exit_code() const
+{
+    return m_exit_code;
+}
+
+/**
+ * @brief Compile the source, or read the binary, and start the uploads
+ *
+ * Finished() is emitted when everything is done.
+ */
+void CliRunner::start()
+{
+    if (!m_compile) {
+	QFile file(m_filename);
+	if (!file.open(QIODevice::ReadOnly)) {
+	    print(tr("Could not open %1: %2").arg(m_filename).arg(file.errorString()));
+	    finish(Exit_Usage);
+	    return;
+	}
+	upload(file.readAll());
+	return;
+    }
+
+    m_flexspin = new Flexspin(m_flexspin_options, this);
+    bool ok;
+    ok = connect(m_flexspin, &Flexspin::Error,
+		 this, &CliRunner::flexspin_error);
+    Q_ASSERT(ok);
+    ok = connect(m_flexspin, &Flexspin::Message,
+		 this, &CliRunner::flexspin_message);
+    Q_ASSERT(ok);
+    ok = connect(m_flexspin, &Flexspin::Finished,
+		 this, &CliRunner::flexspin_finished);
+    Q_ASSERT(ok);
+    if (!m_quiet)
+	print(m_flexspin->command_line(m_filename));
+    m_flexspin->start(m_filename);
+}
+
+void CliRunner::flexspin_error(const QString& text)
+{
+    print(text);
+}
+
+void CliRunner::flexspin_message(const QString& text)
+{
+    if (!m_quiet)
+	print(text);
+}
+
+/**
+ * @brief The build is done: upload the binary, if it succeeded
+ * @param ok true if the build succeeded
+ */
+void CliRunner::flexspin_finished(bool ok)
+{
+    const QByteArray binary = m_flexspin->binary();
+    m_flexspin->deleteLater();
+    m_flexspin = nullptr;
+    if (!ok || binary.isEmpty()) {
+	finish(Exit_Build);
+	return;
+    }
+    upload(binary);
+}
+
+void CliRunner::worker_error(int row, const QString& text)
+{
+    print(QString("%1: %2").arg(m_ports.value(row)).arg(text));
+}
+
+void CliRunner::worker_message(int row, const QString& text)
+{
+    if (!m_quiet)
+	print(QString("%1: %2").arg(m_ports.value(row)).arg(text));
+}
+
+/**
+ * @brief The upload to the port in @p row is done
+ * @param row index of the port in m_ports
+ * @param ok true if the upload succeeded
+ * @param checksum checksum of the upload
+ */
+void CliRunner::worker_finished(int row, bool ok, quint32 checksum)
+{
+    UploadWorker* worker = qobject_cast<UploadWorker*>(sender());
+    m_workers.removeAll(worker);
+    if (worker)
+	worker->deleteLater();
+    if (ok) {
+	if (!m_quiet)
+	    print(tr("%1: Uploaded, checksum %2.")
+		  .arg(m_ports.value(row))
+		  .arg(checksum, 8, 16, QChar('0')));
+    } else {
+	m_failed++;
+    }
+    if (m_workers.isEmpty())
+	finish(m_failed > 0 ? Exit_Upload : Exit_Success);
+}
+
+/**
+ * @brief Start an UploadWorker for @p binary on each port
+ * @param binary const reference to the image
+ */
+void CliRunner::upload(const QByteArray& binary)
+{
+    if (m_ports.isEmpty()) {
+	finish(Exit_Success);
+	return;
+    }
+
+    UploadWorker::Options options = m_upload_options;
+    if (m_stage2) {
+	QString error;
+	options.stage2 = Flexspin::stage2_loader(m_flexspin_options.executable,
+						 options.clock_freq, options.upload_baud_rate, &error);
+	if (options.stage2.isEmpty()) {
+	    print(error);
+	    finish(Exit_Build);
+	    return;
+	}
+	options.mode = PropLoad::Prop_Bin;
+    }
+
+    for (int row = 0; row < m_ports.count(); row++) {
+	options.capture_file = capture_filename(m_ports[row]);
+	UploadWorker* worker = new UploadWorker(row, m_ports[row], options, binary, this);
+	bool ok;
+	ok = connect(worker, &UploadWorker::Error,
+		     this, &CliRunner::worker_error);
+	Q_ASSERT(ok);
+	ok = connect(worker, &UploadWorker::Message,
+		     this, &CliRunner::worker_message);
+	Q_ASSERT(ok);
+	ok = connect(worker, &UploadWorker::Finished,
+		     this, &CliRunner::worker_finished);
+	Q_ASSERT(ok);
+	m_workers += worker;
+    }
+    // start the workers once all are listed, so that m_workers runs empty with the last one
+    foreach(UploadWorker* worker, m_workers)
+	QMetaObject::invokeMethod(worker, "start", Qt::QueuedConnection);
+}
+
+/**
+ * @brief Return the capture file for @p port_name
+ *
+ * With more than one port, the port's name is appended to the base
+ * name of the file, e.g. out-ttyUSB0.txt.
+ * @param port_name serial port name
+ * @return file name, or an empty string for standard output
+ */
+QString CliRunner::capture_filename(const QString& port_name) const
+{
+    if (m_capture_file.isEmpty() || m_ports.count() < 2)
+	return m_capture_file;
+    const QFileInfo fi(m_capture_file);
+    QString name = QString("%1-%2").arg(fi.completeBaseName()).arg(QFileInfo(port_name).fileName());
+    if (!fi.suffix().isEmpty())
+	name += QString(".%1").arg(fi.suffix());
+    return fi.dir().filePath(name);
+}
+
+/**
+ * @brief Print @p text to standard error
+ *
+ * Standard output is left to the captured output.
+ * @param text message to print
+ */
+void CliRunner::print(const QString& text) const
+{
+    fprintf(stderr, "%s\n", qPrintable(text));
+    fflush(stderr);
+}
+
+/**
+ * @brief Record @p exit_code and emit Finished()
+ * @param exit_code ExitCode of the run
+ */
+void CliRunner::finish(int exit_code)
+{
+    m_exit_code = exit_code;
+    emit Finished(exit_code);
+}
@@ -0,0 +1,80 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 headless build and upload from the command line
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+#include "flexspin.h"
+#include "uploadworker.h"
+
+/**
+ * @brief Compiles and uploads without a window, for scripts and test farms
+ *
+ * The runner is used when QFlexProp is started with --cli. It compiles
+ * the source with the saved flexspin settings, exactly as the Build
+ * action does, uploads the binary to each given port with an UploadWorker,
+ * optionally captures the output for some seconds, and emits Finished()
+ * with the process exit code. Only a QCoreApplication is needed.
+ *
+ * The uploads run concurrently on the caller's thread; they are event
+ * driven, so one thread keeps many ports busy.
+ */
+class CliRunner : public QObject
+{
+    Q_OBJECT
+public:
+    /** @brief Exit codes of the process */
+    typedef enum {
+	Exit_Success = 0,	//!< built and uploaded to all ports
+	Exit_Usage = 1,		//!< invalid command line or input file
+	Exit_Build = 2,		//!< the compiler failed
+	Exit_Upload = 3		//!< the upload to at least one port failed
+    }   ExitCode;
+
+    explicit CliRunner(QObject* parent = nullptr);
+
+    static bool requested(int argc, char* argv[]);
+    bool parse(const QStringList& arguments);
+    int exit_code() const;
+
+public slots:
+    void start();
+
+signals:
+    void Finished(int exit_code);
+
+private slots:
+    void flexspin_error(const QString& text);
+    void flexspin_message(const QString& text);
+    void flexspin_finished(bool ok);
+    void worker_error(int row, const QString& text);
+    void worker_message(int row, const QString& text);
+    void worker_finished(int row, bool ok, quint32 checksum);
+
+private:
+    Flexspin::Options m_flexspin_options;	//!< compiler options
+    UploadWorker::Options m_upload_options;	//!< serial port and upload options
+    QString m_filename;				//!< source or binary file
+    QStringList m_ports;			//!< serial ports to upload to
+    QString m_capture_file;			//!< file for the captured output, or empty
+    bool m_compile;				//!< if true, compile m_filename first
+    bool m_stage2;				//!< if true, upload through the second stage loader
+    bool m_quiet;				//!< if true, print errors only
+    Flexspin* m_flexspin;			//!< running build, if any
+    QList<UploadWorker*> m_workers;		//!< running uploads
+    int m_failed;				//!< number of failed uploads
+    int m_exit_code;				//!< ExitCode after parse() or finish()
+
+    void upload(const QByteArray& binary);
+    QString capture_filename(const QString& port_name) const;
+    void print(const QString& text) const;
+    void finish(int exit_code);
+};
@@ -0,0 +1,261 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 multi-board upload dialog
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#include <QPushButton>
+#include <QProgressBar>
+#include <QSerialPortInfo>
+#include <QSettings>
+#include <QTableWidgetItem>
+#include "idstrings.h"
+#include "multiloaddlg.h"
+#include "ui_multiloaddlg.h"
+
+MultiLoadDlg::MultiLoadDlg(QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::MultiLoadDlg)
+    , m_start(nullptr)
+    , m_select_all(nullptr)
+    , m_binary()
+    , m_options()
+    , m_threads()
+    , m_workers()
+    , m_running(0)
+    , m_succeeded(0)
+{
+    ui->setupUi(this);
+    m_select_all = ui->buttonBox->addButton(tr("Select all"), QDialogButtonBox::ActionRole);
+    m_start = ui->buttonBox->addButton(tr("Start"), QDialogButtonBox::ActionRole);
+    bool ok = connect(ui->buttonBox, &QDialogButtonBox::clicked,
+		      this, &MultiLoadDlg::button_clicked);
+    Q_ASSERT(ok);
+    fill_ports();
+
+    QSettings s;
+    s.beginGroup(objectName());
+    restoreGeometry(s.value(id_window_geometry).toByteArray());
+    s.endGroup();
+}
+
+MultiLoadDlg::~MultiLoadDlg()
+{
+    stop_threads();
+    QSettings s;
+    s.beginGroup(objectName());
+    s.setValue(id_window_geometry, saveGeometry());
+    s.endGroup();
+    delete ui;
+}
+
+/**
+ * @brief Set the image to upload to all selected ports
+ * @param binary const reference to the binary image
+ */
+void MultiLoadDlg::set_binary(const QByteArray& binary)
+{
+    m_binary = binary;
+    ui->lbl_summary->setText(tr("%1 bytes to upload.").arg(binary.size()));
+}
+
+/**
+ * @brief Set the serial port and upload options for all ports
+ * @param options const reference to the options
+ */
+void MultiLoadDlg::set_options(const UploadWorker::Options& options)
+{
+    m_options = options;
+}
+
+void MultiLoadDlg::button_clicked(QAbstractButton* button)
+{
+    if (button == m_start) {
+	start();
+    } else if (button == m_select_all) {
+	select_all();
+    } else if (ui->buttonBox->standardButton(button) == QDialogButtonBox::Close) {
+	if (m_running == 0)
+	    reject();
+    }
+}
+
+/**
+ * @brief Fill the table with all available serial ports
+ */
+void MultiLoadDlg::fill_ports()
+{
+    const auto infos = QSerialPortInfo::availablePorts();
+    ui->tw_ports->setRowCount(infos.count());
+    int row = 0;
+    for (const QSerialPortInfo &info : infos) {
+	QTableWidgetItem* item = new QTableWidgetItem(info.portName());
+	item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+	item->setCheckState(Qt::Unchecked);
+	item->setData(Qt::UserRole, info.systemLocation());
+	ui->tw_ports->setItem(row, col_port, item);
+	item = new QTableWidgetItem(info.description());
+	item->setFlags(Qt::ItemIsEnabled);
+	ui->tw_ports->setItem(row, col_description, item);
+	QProgressBar* pb = new QProgressBar;
+	pb->setRange(0, 100);
+	pb->setValue(0);
+	ui->tw_ports->setCellWidget(row, col_progress, pb);
+	item = new QTableWidgetItem();
+	item->setFlags(Qt::ItemIsEnabled);
+	ui->tw_ports->setItem(row, col_result, item);
+	row++;
+    }
+    ui->tw_ports->resizeColumnsToContents();
+}
+
+void MultiLoadDlg::select_all()
+{
+    for (int row = 0; row < ui->tw_ports->rowCount(); row++)
+	ui->tw_ports->item(row, col_port)->setCheckState(Qt::Checked);
+}
+
+/**
+ * @brief Start one upload per selected port on the thread pool
+ *
+ * Uploads are I/O bound, so the pool has at most one thread per core
+ * and each thread runs the event driven uploads of several ports.
+ */
+void MultiLoadDlg::start()
+{
+    if (m_running > 0 || m_binary.isEmpty())
+	return;
+    stop_threads();
+
+    QList<int> rows;
+    for (int row = 0; row < ui->tw_ports->rowCount(); row++) {
+	if (Qt::Checked == ui->tw_ports->item(row, col_port)->checkState())
+	    rows += row;
+    }
+    if (rows.isEmpty())
+	return;
+
+    const int nthreads = qBound(1, QThread::idealThreadCount(), rows.count());
+    for (int i = 0; i < nthreads; i++) {
+	QThread* thread = new QThread(this);
+	thread->setObjectName(QString("upload%1").arg(i));
+	m_threads += thread;
+    }
+
+    m_running = rows.count();
+    m_succeeded = 0;
+    int i = 0;
+    foreach(const int row, rows) {
+	const QString port_name = ui->tw_ports->item(row, col_port)->data(Qt::UserRole).toString();
+	qobject_cast<QProgressBar*>(ui->tw_ports->cellWidget(row, col_progress))->setValue(0);
+	ui->tw_ports->item(row, col_result)->setText(tr("Starting"));
+
+	UploadWorker* worker = new UploadWorker(row, port_name, m_options, m_binary);
+	QThread* thread = m_threads[i++ % nthreads];
+	worker->moveToThread(thread);
+	bool ok;
+	ok = connect(thread, &QThread::finished,
+		     worker, &QObject::deleteLater);
+	Q_ASSERT(ok);
+	ok = connect(worker, &UploadWorker::Progress,
+		     this, &MultiLoadDlg::worker_progress);
+	Q_ASSERT(ok);
+	ok = connect(worker, &UploadWorker::Error,
+		     this, &MultiLoadDlg::worker_error);
+	Q_ASSERT(ok);
+	ok = connect(worker, &UploadWorker::Message,
+		     this, &MultiLoadDlg::worker_message);
+	Q_ASSERT(ok);
+	ok = connect(worker, &UploadWorker::Finished,
+		     this, &MultiLoadDlg::worker_finished);
+	Q_ASSERT(ok);
+	m_workers += worker;
+    }
+
+    foreach(QThread* thread, m_threads)
+	thread->start();
+    foreach(UploadWorker* worker, m_workers)
+	QMetaObject::invokeMethod(worker, "start", Qt::QueuedConnection);
+
+    m_start->setEnabled(false);
+    ui->lbl_summary->setText(tr("Uploading to %1 boards on %2 threads.")
+			     .arg(rows.count())
+			     .arg(nthreads));
+}
+
+void MultiLoadDlg::worker_progress(int row, qint64 value, qint64 total)
+{
+    QProgressBar* pb = qobject_cast<QProgressBar*>(ui->tw_ports->cellWidget(row, col_progress));
+    if (!pb || total <= 0)
+	return;
+    pb->setValue(static_cast<int>(100 * value / total));
+}
+
+void MultiLoadDlg::worker_error(int row, const QString& text)
+{
+    QTableWidgetItem* item = ui->tw_ports->item(row, col_result);
+    item->setForeground(Qt::red);
+    item->setText(text.section(QChar::LineFeed, 0, 0));
+    item->setToolTip(text);
+}
+
+void MultiLoadDlg::worker_message(int row, const QString& text)
+{
+    ui->tw_ports->item(row, col_result)->setToolTip(text);
+}
+
+/**
+ * @brief An upload finished: show its result and the summary
+ * @param row row of the port in the table
+ * @param ok true on success
+ * @param checksum checksum of the upload
+ */
+void MultiLoadDlg::worker_finished(int row, bool ok, quint32 checksum)
+{
+    QTableWidgetItem* item = ui->tw_ports->item(row, col_result);
+    if (ok) {
+	m_succeeded++;
+	item->setForeground(Qt::darkGreen);
+	item->setText(tr("OK, checksum 0x%1")
+		      .arg(checksum, 8, 16, QChar('0')));
+    }
+    ui->tw_ports->resizeColumnToContents(col_result);
+
+    if (--m_running > 0)
+	return;
+
+    const int total = m_workers.count();
+    stop_threads();
+    m_start->setEnabled(true);
+    ui->lbl_summary->setText(tr("%1 of %2 boards uploaded successfully.")
+			     .arg(m_succeeded)
+			     .arg(total));
+}
+
+/**
+ * @brief Abort running uploads and tear down the thread pool
+ *
+ * The workers are aborted with a blocking call, so that every abort()
+ * has run in its thread before the thread's event loop is told to quit
+ * and would drop it. Their signals to this dialog are disconnected
+ * first, so the worker threads never wait for the GUI thread here.
+ */
+void MultiLoadDlg::stop_threads()
+{
+    foreach(UploadWorker* worker, m_workers) {
+	disconnect(worker, nullptr, this, nullptr);
+	if (m_running > 0 && worker->thread()->isRunning())
+	    QMetaObject::invokeMethod(worker, "abort", Qt::BlockingQueuedConnection);
+    }
+    m_running = 0;
+    foreach(QThread* thread, m_threads) {
+	thread->quit();
+	thread->wait();
+	delete thread;
+    }
+    m_threads.clear();
+    m_workers.clear();
+}
@@ -0,0 +1,62 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 multi-board upload dialog
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#pragma once
+#include <QDialog>
+#include <QList>
+#include <QThread>
+#include "uploadworker.h"
+
+namespace Ui {
+class MultiLoadDlg;
+}
+class QAbstractButton;
+class QPushButton;
+
+class MultiLoadDlg : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit MultiLoadDlg(QWidget *parent = nullptr);
+    ~MultiLoadDlg();
+
+    void set_binary(const QByteArray& binary);
+    void set_options(const UploadWorker::Options& options);
+
+private slots:
+    void button_clicked(QAbstractButton* button);
+    void select_all();
+    void start();
+    void worker_progress(int row, qint64 value, qint64 total);
+    void worker_error(int row, const QString& text);
+    void worker_message(int row, const QString& text);
+    void worker_finished(int row, bool ok, quint32 checksum);
+
+private:
+    enum {
+	col_port,
+	col_description,
+	col_progress,
+	col_result,
+    };
+
+    Ui::MultiLoadDlg *ui;
+    QPushButton* m_start;		//!< start button
+    QPushButton* m_select_all;		//!< select all button
+    QByteArray m_binary;		//!< image to upload
+    UploadWorker::Options m_options;	//!< port and upload options
+    QList<QThread*> m_threads;		//!< upload thread pool
+    QList<UploadWorker*> m_workers;	//!< one worker per selected port
+    int m_running;			//!< number of uploads still running
+    int m_succeeded;			//!< number of successful uploads
+
+    void fill_ports();
+    void stop_threads();
+};
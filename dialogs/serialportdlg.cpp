@@ -71,6 +71,7 @@ void SerialPortDlg::set_settings(const SerialPortDlg::Settings& s)
     m_settings.parity = s.parity;
     m_settings.flow_control = s.flow_control;
     m_settings.local_echo = s.local_echo;
+    m_settings.upload_baud_rate = s.upload_baud_rate;
     setup_dialog();
 }
 
@@ -162,6 +163,13 @@ void SerialPortDlg::fill_ports_parameters()
     ui->cb_baud_rate->addItem(locale.toString(Serial_Baud2000000), Serial_Baud2000000);
     ui->cb_baud_rate->addItem(tr("Custom"));
 
+    // the upload baud rate defaults to the terminal baud rate
+    ui->cb_upload_baud_rate->addItem(tr("Same as terminal"), 0);
+    ui->cb_upload_baud_rate->addItem(locale.toString(Serial_Baud230400), Serial_Baud230400);
+    ui->cb_upload_baud_rate->addItem(locale.toString(Serial_Baud921600), Serial_Baud921600);
+    ui->cb_upload_baud_rate->addItem(locale.toString(Serial_Baud2000000), Serial_Baud2000000);
+    ui->cb_upload_baud_rate->addItem(locale.toString(Serial_Baud3000000), Serial_Baud3000000);
+
     foreach(const QSerialPort::DataBits key, data_bits_str.keys()) {
 	if (QSerialPort::UnknownDataBits != key)
 	    ui->cb_data_bits->addItem(data_bits_str.value(key), key);
@@ -232,6 +240,7 @@ void SerialPortDlg::setup_dialog(bool load_settings)
 	settings.stop_bits = static_cast<QSerialPort::StopBits>(s.value(id_stop_bits, QSerialPort::OneStop).toInt());
 	settings.flow_control = static_cast<QSerialPort::FlowControl>(s.value(id_flow_control, QSerialPort::NoFlowControl).toInt());
 	settings.local_echo = s.value(id_local_echo, false).toBool();
+	settings.upload_baud_rate = static_cast<Serial_BaudRate>(s.value(id_upload_baud_rate, 0).toInt());
 	s.endGroup();
 	s.endGroup();
     } else {
@@ -268,6 +277,9 @@ void SerialPortDlg::setup_dialog(bool load_settings)
 
     ui->cb_local_echo->setChecked(settings.local_echo);
 
+    idx = ui->cb_upload_baud_rate->findData(settings.upload_baud_rate);
+    ui->cb_upload_baud_rate->setCurrentIndex(idx >= 0 ? idx : 0);
+
     // Create human readable strings from the settings
     settings.str.baud_rate = locale.toString(settings.baud_rate);
     settings.str.data_bits = data_bits_str.value(settings.data_bits);
@@ -298,6 +310,7 @@ void SerialPortDlg::save_settings()
     s.setValue(id_stop_bits, m_settings.stop_bits);
     s.setValue(id_flow_control, m_settings.flow_control);
     s.setValue(id_local_echo, m_settings.local_echo);
+    s.setValue(id_upload_baud_rate, m_settings.upload_baud_rate);
     s.endGroup();
     s.endGroup();
 }
@@ -331,4 +344,7 @@ void SerialPortDlg::read_settings()
     m_settings.str.flow_control = flow_control_str.value(m_settings.flow_control);
 
     m_settings.local_echo = ui->cb_local_echo->isChecked();
+
+    idx = ui->cb_upload_baud_rate->currentIndex();
+    m_settings.upload_baud_rate = static_cast<Serial_BaudRate>(ui->cb_upload_baud_rate->itemData(idx).toInt());
 }
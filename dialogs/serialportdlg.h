@@ -30,6 +30,7 @@ public:
 	QSerialPort::StopBits stop_bits;
 	QSerialPort::FlowControl flow_control;
 	bool local_echo;
+	Serial_BaudRate upload_baud_rate;
 	struct {
 	    QString baud_rate;
 	    QString data_bits;
@@ -0,0 +1,142 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 serial statistics dialog
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#include <QDateTime>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QPushButton>
+#include <QSettings>
+#include <QStandardPaths>
+#include "idstrings.h"
+#include "statsdlg.h"
+#include "ui_statsdlg.h"
+
+StatsDlg::StatsDlg(SerialStats* stats, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::StatsDlg)
+    , m_stats(stats)
+    , m_reset(nullptr)
+    , m_csv(nullptr)
+{
+    Q_ASSERT(m_stats);
+    ui->setupUi(this);
+    m_reset = ui->buttonBox->addButton(tr("Reset"), QDialogButtonBox::ResetRole);
+    m_csv = ui->buttonBox->addButton(tr("Write CSV…"), QDialogButtonBox::ActionRole);
+    m_csv->setCheckable(true);
+    m_csv->setChecked(m_stats->is_csv_active());
+    bool ok;
+    ok = connect(ui->buttonBox, &QDialogButtonBox::clicked,
+		 this, &StatsDlg::button_clicked);
+    Q_ASSERT(ok);
+    ok = connect(m_stats, &SerialStats::Sampled,
+		 this, &StatsDlg::sampled);
+    Q_ASSERT(ok);
+    sampled(m_stats->sample());
+
+    QSettings s;
+    s.beginGroup(objectName());
+    restoreGeometry(s.value(id_window_geometry).toByteArray());
+    s.endGroup();
+}
+
+StatsDlg::~StatsDlg()
+{
+    QSettings s;
+    s.beginGroup(objectName());
+    s.setValue(id_window_geometry, saveGeometry());
+    s.endGroup();
+    delete ui;
+}
+
+void StatsDlg::button_clicked(QAbstractButton* button)
+{
+    if (button == m_reset) {
+	m_stats->reset();
+	sampled(m_stats->sample());
+    } else if (button == m_csv) {
+	toggle_csv();
+    }
+}
+
+/**
+ * @brief Show the values of the @p sample
+ * @param sample const reference to the most recent SerialStats::Sample
+ */
+void StatsDlg::sampled(const SerialStats::Sample& sample)
+{
+    ui->lbl_rx->setText(tr("%1 (%2 bytes total)")
+			.arg(rate(sample.rx_rate))
+			.arg(sample.rx_total));
+    ui->lbl_tx->setText(tr("%1 (%2 bytes total)")
+			.arg(rate(sample.tx_rate))
+			.arg(sample.tx_total));
+    ui->lbl_stalls->setText(QString::number(sample.rx_stalls));
+    ui->lbl_errors->setText(QString::number(sample.errors));
+    ui->lbl_dropped->setText(tr("%1 bytes").arg(sample.dropped));
+    ui->lbl_latency->setText(tr("%1 ms average, %2 ms maximum")
+			     .arg(sample.latency_avg, 0, 'f', 2)
+			     .arg(sample.latency_max, 0, 'f', 2));
+    ui->lbl_parse->setText(tr("%1 MB/s").arg(sample.parse_rate, 0, 'f', 1));
+    if (sample.upload_baud > 0) {
+	ui->lbl_upload->setText(tr("%1 bit/s effective at %2 baud (%3%)")
+				.arg(sample.upload_rate, 0, 'f', 0)
+				.arg(sample.upload_baud)
+				.arg(sample.upload_rate * 100.0 / sample.upload_baud, 0, 'f', 1));
+    } else {
+	ui->lbl_upload->setText(QLatin1String("-"));
+    }
+    m_csv->setChecked(m_stats->is_csv_active());
+}
+
+/**
+ * @brief Start or stop writing the samples to a CSV file
+ */
+void StatsDlg::toggle_csv()
+{
+    if (!m_csv->isChecked()) {
+	m_stats->stop_csv();
+	return;
+    }
+
+    QSettings s;
+    s.beginGroup(objectName());
+    QStringList documents = QStandardPaths::standardLocations(QStandardPaths::DocumentsLocation);
+    QString csvdflt = documents.isEmpty()
+		      ? QDir::homePath()
+		      : documents.first();
+    QString csvdir = s.value(id_sourcedir, csvdflt).toString();
+    s.endGroup();
+
+    const QString name = QString("%1/serial-%2.csv")
+			 .arg(csvdir)
+			 .arg(QDateTime::currentDateTime().toString(QLatin1String("yyyyMMdd-hhmmss")));
+    const QString filename = QFileDialog::getSaveFileName(this, tr("Write statistics to CSV file"),
+							  name, tr("CSV (*.csv)"), nullptr,
+							  QFileDialog::DontUseNativeDialog);
+    if (filename.isEmpty() || !m_stats->start_csv(filename)) {
+	m_csv->setChecked(false);
+	return;
+    }
+    s.beginGroup(objectName());
+    s.setValue(id_sourcedir, QFileInfo(filename).dir().absolutePath());
+    s.endGroup();
+}
+
+/**
+ * @brief Format @p bytes_per_sec as a human readable rate
+ */
+QString StatsDlg::rate(double bytes_per_sec)
+{
+    if (bytes_per_sec >= 1024.0 * 1024.0)
+	return tr("%1 MiB/s").arg(bytes_per_sec / 1024.0 / 1024.0, 0, 'f', 2);
+    if (bytes_per_sec >= 1024.0)
+	return tr("%1 KiB/s").arg(bytes_per_sec / 1024.0, 0, 'f', 1);
+    return tr("%1 B/s").arg(bytes_per_sec, 0, 'f', 0);
+}
@@ -0,0 +1,40 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 serial statistics dialog
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#pragma once
+#include <QDialog>
+#include "serialstats.h"
+
+namespace Ui {
+class StatsDlg;
+}
+class QAbstractButton;
+class QPushButton;
+
+class StatsDlg : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit StatsDlg(SerialStats* stats, QWidget *parent = nullptr);
+    ~StatsDlg();
+
+private slots:
+    void button_clicked(QAbstractButton* button);
+    void sampled(const SerialStats::Sample& sample);
+
+private:
+    Ui::StatsDlg *ui;
+    SerialStats* m_stats;		//!< statistics shown in the dialog
+    QPushButton* m_reset;		//!< reset button
+    QPushButton* m_csv;			//!< button to toggle writing the CSV file
+
+    void toggle_csv();
+    static QString rate(double bytes_per_sec);
+};
@@ -7,14 +7,28 @@
  * See the file LICENSE for the details of the BSD-3-Clause terms.
  *
  ***************************************************************************************/
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
+#include <algorithm>
 #include "textbrowserdlg.h"
 #include "ui_textbrowserdlg.h"
+#include "hexdumpmodel.h"
+#include "textlinesmodel.h"
 
 TextBrowserDlg::TextBrowserDlg(QWidget *parent) :
     QDialog(parent),
     ui(new Ui::TextBrowserDlg)
 {
     ui->setupUi(this);
+    QAction* act_copy = new QAction(tr("Copy"), ui->listView);
+    act_copy->setShortcut(QKeySequence::Copy);
+    act_copy->setShortcutContext(Qt::WidgetShortcut);
+    bool ok;
+    ok = connect(act_copy, &QAction::triggered,
+		 this, &TextBrowserDlg::copy_triggered);
+    Q_ASSERT(ok);
+    ui->listView->addAction(act_copy);
 }
 
 TextBrowserDlg::~TextBrowserDlg()
@@ -22,7 +36,40 @@ TextBrowserDlg::~TextBrowserDlg()
     delete ui;
 }
 
-void TextBrowserDlg::set_text(const QString& text)
+/**
+ * @brief Show the UTF-8 @p text line by line
+ * @param text const reference to the text, e.g. a listing
+ */
+void TextBrowserDlg::set_text(const QByteArray& text)
 {
-    ui->textBrowser->setPlainText(text);
+    TextLinesModel* model = new TextLinesModel(text, this);
+    model->set_font(ui->listView->font());
+    ui->listView->setModel(model);
+}
+
+/**
+ * @brief Show a hex dump of @p data
+ * @param data const reference to the binary data
+ */
+void TextBrowserDlg::set_binary(const QByteArray& data)
+{
+    HexDumpModel* model = new HexDumpModel(data, this);
+    model->set_font(ui->listView->font());
+    ui->listView->setModel(model);
+}
+
+/**
+ * @brief Copy the selected rows to the clipboard
+ */
+void TextBrowserDlg::copy_triggered(bool checked)
+{
+    Q_UNUSED(checked)
+    QModelIndexList rows = ui->listView->selectionModel()
+			   ? ui->listView->selectionModel()->selectedRows()
+			   : QModelIndexList();
+    std::sort(rows.begin(), rows.end());
+    QStringList lines;
+    foreach(const QModelIndex& index, rows)
+	lines += index.data().toString();
+    QApplication::clipboard()->setText(lines.join(QChar::LineFeed));
 }
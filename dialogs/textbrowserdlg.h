@@ -8,12 +8,20 @@
  *
  ***************************************************************************************/
 #pragma once
+#include <QByteArray>
 #include <QDialog>
 
 namespace Ui {
 class TextBrowserDlg;
 }
 
+/**
+ * @brief The TextBrowserDlg class shows a build artifact
+ *
+ * The artifact is shown in a list view with uniform rows through a model
+ * which formats only the visible rows, so the dialog opens instantly
+ * regardless of the size of the listing or binary.
+ */
 class TextBrowserDlg : public QDialog
 {
     Q_OBJECT
@@ -22,7 +30,12 @@ public:
     explicit TextBrowserDlg(QWidget *parent = nullptr);
     ~TextBrowserDlg();
 
-    void set_text(const QString& text);
+    void set_text(const QByteArray& text);
+    void set_binary(const QByteArray& data);
+
+private slots:
+    void copy_triggered(bool checked = false);
+
 private:
     Ui::TextBrowserDlg *ui;
 };
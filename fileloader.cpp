@@ -0,0 +1,133 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 loading of source files in the background
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextCodec>
+#include <cstring>
+#include "fileloader.h"
+
+FileLoaderWorker::FileLoaderWorker(QObject* parent)
+    : QObject(parent)
+{
+}
+
+/**
+ * @brief Read @p filename and emit Loaded() or Failed()
+ * @param filename absolute path of the file
+ */
+void FileLoaderWorker::load(const QString& filename)
+{
+    QString text;
+    QByteArray sha256;
+    QString error;
+    if (FileLoader::read(filename, &text, &sha256, &error)) {
+	emit Loaded(filename, text, sha256);
+    } else {
+	emit Failed(filename, error);
+    }
+}
+
+FileLoader::FileLoader(QObject* parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_worker(new FileLoaderWorker)
+{
+    m_thread->setObjectName(QLatin1String("FileLoader"));
+    m_worker->moveToThread(m_thread);
+    bool ok;
+    ok = connect(m_thread, &QThread::finished,
+		 m_worker, &QObject::deleteLater);
+    Q_ASSERT(ok);
+    ok = connect(m_worker, &FileLoaderWorker::Loaded,
+		 this, &FileLoader::Loaded);
+    Q_ASSERT(ok);
+    ok = connect(m_worker, &FileLoaderWorker::Failed,
+		 this, &FileLoader::Failed);
+    Q_ASSERT(ok);
+    m_thread->start();
+}
+
+FileLoader::~FileLoader()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+/**
+ * @brief Read @p filename on the worker thread
+ * @param filename name of the file
+ */
+void FileLoader::load(const QString& filename)
+{
+    const QString path = QFileInfo(filename).absoluteFilePath();
+    QMetaObject::invokeMethod(m_worker, "load", Qt::QueuedConnection,
+			      Q_ARG(QString, path));
+}
+
+/**
+ * @brief Read the UTF-8 text of @p filename and its SHA-256 hash
+ *
+ * The file is memory mapped if possible, so that it is decoded straight
+ * from the page cache. A leading byte order mark is skipped. If the file
+ * is valid UTF-8, the hash is that of the file's bytes, which is the same
+ * as that of the decoded text encoded again; otherwise the decoded text
+ * is encoded again for the hash. This can be called from any thread.
+ * @param filename name of the file
+ * @param p_text pointer to a QString to receive the text
+ * @param p_sha256 pointer to a QByteArray to receive the hash
+ * @param p_error optional pointer to a QString to receive an error message
+ * @return true on success, false on error
+ */
+bool FileLoader::read(const QString& filename, QString* p_text, QByteArray* p_sha256, QString* p_error)
+{
+    static const char bom[3] = {'\xef', '\xbb', '\xbf'};
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+	if (p_error)
+	    *p_error = file.errorString();
+	return false;
+    }
+
+    QByteArray contents;
+    const char* data = nullptr;
+    qint64 size = file.size();
+    if (size > 0) {
+	data = reinterpret_cast<const char*>(file.map(0, size));
+	if (!data) {
+	    // not mappable, e.g. a pipe or a special file
+	    contents = file.readAll();
+	    data = contents.constData();
+	    size = contents.size();
+	}
+    }
+    if (size >= 3 && 0 == memcmp(data, bom, sizeof(bom))) {
+	data += sizeof(bom);
+	size -= sizeof(bom);
+    }
+
+    QTextCodec* codec = QTextCodec::codecForName("UTF-8");
+    QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+    const QString text = codec->toUnicode(data, static_cast<int>(size), &state);
+
+    QCryptographicHash sha256(QCryptographicHash::Sha256);
+    if (0 == state.invalidChars && 0 == state.remainingChars) {
+	sha256.addData(data, static_cast<int>(size));
+    } else {
+	sha256.addData(text.toUtf8());
+    }
+    file.close();
+
+    if (p_text)
+	*p_text = text;
+    if (p_sha256)
+	*p_sha256 = sha256.result();
+    return true;
+}
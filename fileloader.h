@@ -0,0 +1,61 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 loading of source files in the background
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+/**
+ * @brief The FileLoaderWorker class reads files for its FileLoader
+ *
+ * It lives on the thread of its FileLoader.
+ */
+class FileLoaderWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileLoaderWorker(QObject* parent = nullptr);
+
+signals:
+    void Loaded(const QString& filename, const QString& text, const QByteArray& sha256);
+    void Failed(const QString& filename, const QString& error);
+
+public slots:
+    void load(const QString& filename);
+};
+
+/**
+ * @brief The FileLoader class reads source files on a thread of its own
+ *
+ * The file is memory mapped, decoded from UTF-8 and hashed with SHA-256
+ * off the GUI thread, so that opening large files does not block the
+ * window. The result is reported with Loaded(), or Failed() if the file
+ * could not be read. One loader serves all editor tabs; requests are
+ * handled in the order they were made.
+ */
+class FileLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileLoader(QObject* parent = nullptr);
+    ~FileLoader() override;
+
+    void load(const QString& filename);
+    static bool read(const QString& filename, QString* p_text, QByteArray* p_sha256, QString* p_error = nullptr);
+
+signals:
+    void Loaded(const QString& filename, const QString& text, const QByteArray& sha256);
+    void Failed(const QString& filename, const QString& error);
+
+private:
+    QThread* m_thread;			//!< thread of the worker
+    FileLoaderWorker* m_worker;		//!< reads files on m_thread
+};
@@ -0,0 +1,280 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 streaming, flow controlled file transfer to the terminal
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QFileInfo>
+#include "filesender.h"
+#include "serialworker.h"
+
+FileSender::FileSender(SerialWorker* worker, const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_worker(worker)
+    , m_options(options)
+    , m_file()
+    , m_elapsed()
+    , m_prompt_timer()
+    , m_progress_timer()
+    , m_rx_tail()
+    , m_in_flight(0)
+    , m_written(0)
+    , m_running(false)
+    , m_paused(false)
+    , m_waiting(false)
+    , m_line_end(true)
+{
+    Q_ASSERT(m_worker);
+    m_options.chunk_size = qMax(1, m_options.chunk_size);
+    m_options.window = qMax(m_options.chunk_size, m_options.window);
+
+    m_prompt_timer.setSingleShot(true);
+    m_prompt_timer.setInterval(m_options.prompt_timeout);
+    m_progress_timer.setInterval(progress_interval);
+
+    bool ok;
+    ok = connect(m_worker, &SerialWorker::BytesWritten,
+		 this, &FileSender::bytes_written);
+    Q_ASSERT(ok);
+    ok = connect(&m_prompt_timer, &QTimer::timeout,
+		 this, &FileSender::prompt_timeout);
+    Q_ASSERT(ok);
+    ok = connect(&m_progress_timer, &QTimer::timeout,
+		 this, &FileSender::tick);
+    Q_ASSERT(ok);
+}
+
+/**
+ * @brief Return true, if a transfer is running
+ */
+bool FileSender::is_running() const
+{
+    return m_running;
+}
+
+/**
+ * @brief Return the number of bytes of the file which were sent so far
+ */
+qint64 FileSender::value() const
+{
+    return m_file.isOpen() ? m_file.pos() : total();
+}
+
+/**
+ * @brief Return the size of the file in bytes
+ */
+qint64 FileSender::total() const
+{
+    return m_file.size();
+}
+
+/**
+ * @brief Return the average number of bytes per second written by the device
+ */
+qint64 FileSender::rate() const
+{
+    const qint64 msecs = m_elapsed.isValid() ? m_elapsed.elapsed() : 0;
+    return msecs > 0 ? m_written * 1000 / msecs : 0;
+}
+
+/**
+ * @brief Start sending the file @p filename
+ *
+ * The transfer starts when the event loop is entered again, so that
+ * the signals can be connected after this returns.
+ * @param filename name of the file to send
+ * @return true if the file was opened, false otherwise
+ */
+bool FileSender::start(const QString& filename)
+{
+    if (m_running)
+	return false;
+    if (!m_worker->is_attached()) {
+	emit Error(tr("The serial port is not open."));
+	return false;
+    }
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+	emit Error(tr("Could not open file '%1' for reading: %2")
+		   .arg(QFileInfo(filename).fileName())
+		   .arg(m_file.errorString()));
+	return false;
+    }
+    m_rx_tail.clear();
+    m_in_flight = 0;
+    m_written = 0;
+    m_running = true;
+    m_paused = false;
+    m_waiting = false;
+    m_line_end = true;
+    m_elapsed.start();
+    m_progress_timer.start();
+    QTimer::singleShot(0, this, &FileSender::pump);
+    return true;
+}
+
+/**
+ * @brief Look for flow control characters and the prompt in received data
+ *
+ * This is to be called with everything the terminal receives while
+ * the transfer is running.
+ * @param data pointer to the received bytes
+ * @param len number of bytes
+ */
+void FileSender::received(const char* data, size_t len)
+{
+    if (!m_running || !data || !len)
+	return;
+
+    if (m_options.xon_xoff) {
+	// the last flow control character in the data decides
+	for (size_t i = len; i-- > 0; ) {
+	    if (data[i] == XOFF) {
+		m_paused = true;
+		break;
+	    }
+	    if (data[i] == XON) {
+		m_paused = false;
+		break;
+	    }
+	}
+    }
+
+    if (m_waiting) {
+	m_rx_tail.append(data, static_cast<int>(len));
+	if (m_rx_tail.contains(m_options.prompt)) {
+	    m_prompt_timer.stop();
+	    m_rx_tail.clear();
+	    m_waiting = false;
+	} else {
+	    // keep what could be the start of a prompt split across reads
+	    m_rx_tail = m_rx_tail.right(m_options.prompt.size() - 1);
+	}
+    }
+
+    pump();
+}
+
+/**
+ * @brief Cancel a running transfer
+ */
+void FileSender::cancel()
+{
+    if (m_running)
+	finish(false);
+}
+
+/**
+ * @brief Account for @p bytes written by the device and send more data
+ *
+ * Data typed while the file is sent is counted, too, which only
+ * makes the window a little smaller for a moment.
+ * @param bytes number of bytes written
+ */
+void FileSender::bytes_written(qint64 bytes)
+{
+    if (!m_running)
+	return;
+    m_in_flight = qMax(Q_INT64_C(0), m_in_flight - bytes);
+    m_written += bytes;
+    pump();
+}
+
+/**
+ * @brief Send data until the window is full, or the transfer has to wait
+ */
+void FileSender::pump()
+{
+    while (m_running && !m_paused && !m_waiting && m_in_flight < m_options.window) {
+	if (m_file.atEnd()) {
+	    if (!m_line_end) {
+		send(QByteArray(1, '\n'));
+		continue;
+	    }
+	    if (m_in_flight == 0)
+		finish(true);
+	    return;
+	}
+
+	QByteArray data;
+	if (m_options.prompt.isEmpty()) {
+	    data = m_file.read(qMin(static_cast<qint64>(m_options.chunk_size),
+				    m_options.window - m_in_flight));
+	} else {
+	    data = m_file.readLine();
+	    if (!data.isEmpty() && !data.endsWith('\n'))
+		data += '\n';
+	}
+	if (data.isEmpty()) {
+	    emit Error(tr("Reading file '%1' failed: %2")
+		       .arg(QFileInfo(m_file.fileName()).fileName())
+		       .arg(m_file.errorString()));
+	    finish(false);
+	    return;
+	}
+
+	if (!m_options.prompt.isEmpty()) {
+	    m_rx_tail.clear();
+	    m_waiting = true;
+	    m_prompt_timer.start();
+	}
+	send(data);
+    }
+}
+
+/**
+ * @brief Continue with the next line, if the prompt did not arrive in time
+ */
+void FileSender::prompt_timeout()
+{
+    if (!m_waiting)
+	return;
+    m_rx_tail.clear();
+    m_waiting = false;
+    pump();
+}
+
+/**
+ * @brief Report the progress and stop if the device went away
+ */
+void FileSender::tick()
+{
+    if (!m_running)
+	return;
+    if (!m_worker->is_attached()) {
+	emit Error(tr("The serial port was closed while sending the file."));
+	finish(false);
+	return;
+    }
+    emit Progress(value(), total());
+}
+
+/**
+ * @brief Hand @p data to the worker and account for it in the window
+ * @param data bytes to write
+ */
+void FileSender::send(const QByteArray& data)
+{
+    m_in_flight += data.size();
+    m_line_end = data.endsWith('\n');
+    m_worker->write(data);
+    emit Sent(data);
+}
+
+/**
+ * @brief Stop the transfer and emit Finished()
+ * @param ok true if the whole file was sent
+ */
+void FileSender::finish(bool ok)
+{
+    m_running = false;
+    m_waiting = false;
+    m_prompt_timer.stop();
+    m_progress_timer.stop();
+    emit Progress(value(), total());
+    m_file.close();
+    emit Finished(ok);
+}
@@ -0,0 +1,93 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 streaming, flow controlled file transfer to the terminal
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTimer>
+
+class SerialWorker;
+
+/**
+ * @brief Sends a text file to the serial worker in chunks, paced by the device
+ *
+ * At most Options::window bytes are handed to the worker which the device
+ * did not report as written yet, so RTS/CTS or XON/XOFF flow control done
+ * by the serial driver stops the transfer without piling up data. If
+ * Options::xon_xoff is set, XOFF and XON received from the Prop pause and
+ * resume the transfer, too. With a non-empty Options::prompt the file is
+ * sent line by line, and each line waits for the prompt to be received,
+ * or for Options::prompt_timeout milliseconds.
+ *
+ * Line ends are sent as LF, like typing the file would do.
+ */
+class FileSender : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options {
+	int chunk_size = 1024;		//!< bytes per write without prompt pacing
+	int window = 4096;		//!< maximum bytes not yet written by the device
+	QByteArray prompt;		//!< prompt to wait for after each line, or empty
+	int prompt_timeout = 2000;	//!< milliseconds to wait for the prompt
+	bool xon_xoff = false;		//!< pause on received XOFF, resume on XON
+    };
+
+    explicit FileSender(SerialWorker* worker, const Options& options, QObject* parent = nullptr);
+
+    bool is_running() const;
+    qint64 value() const;
+    qint64 total() const;
+    qint64 rate() const;
+
+    bool start(const QString& filename);
+    void received(const char* data, size_t len);
+
+public slots:
+    void cancel();
+
+signals:
+    void Sent(const QByteArray& data);
+    void Error(const QString& message);
+    void Progress(qint64 value, qint64 total);
+    void Finished(bool ok);
+
+private slots:
+    void bytes_written(qint64 bytes);
+    void pump();
+    void prompt_timeout();
+    void tick();
+
+private:
+    //! Milliseconds between Progress() signals
+    static constexpr int progress_interval = 100;
+    //! XON (DC1) control character
+    static constexpr char XON = '\021';
+    //! XOFF (DC3) control character
+    static constexpr char XOFF = '\023';
+
+    SerialWorker* m_worker;		//!< worker owning the serial device
+    Options m_options;			//!< transfer options
+    QFile m_file;			//!< file being sent
+    QElapsedTimer m_elapsed;		//!< time since the start of the transfer
+    QTimer m_prompt_timer;		//!< timeout while waiting for the prompt
+    QTimer m_progress_timer;		//!< timer to report the progress
+    QByteArray m_rx_tail;		//!< received data which may start a prompt
+    qint64 m_in_flight;			//!< bytes handed to the worker but not yet written
+    qint64 m_written;			//!< bytes reported as written by the device
+    bool m_running;			//!< true while a transfer is running
+    bool m_paused;			//!< true after XOFF was received
+    bool m_waiting;			//!< true while waiting for the prompt
+    bool m_line_end;			//!< true if the last byte sent was a LF
+
+    void send(const QByteArray& data);
+    void finish(bool ok);
+};
@@ -0,0 +1,643 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 asynchronous flexspin compiler run
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+#include "flexspin.h"
+#include "idstrings.h"
+#include "trace.h"
+
+Flexspin::Flexspin(const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_filename()
+    , m_process(nullptr)
+    , m_output_timer()
+    , m_stdout()
+    , m_stderr()
+    , m_canceled(false)
+    , m_cache(nullptr)
+    , m_cache_key()
+    , m_cached(false)
+    , m_binary()
+    , m_p2asm()
+    , m_lst()
+    , m_output_dir()
+    , m_trace_start(0)
+{
+    m_output_timer.setSingleShot(true);
+    m_output_timer.setInterval(output_interval);
+    bool ok;
+    ok = connect(&m_output_timer, &QTimer::timeout,
+		 this, &Flexspin::flush_output);
+    Q_ASSERT(ok);
+}
+
+Flexspin::~Flexspin()
+{
+    if (m_process) {
+	m_process->disconnect(this);
+	m_process->kill();
+	m_process->waitForFinished(1000);
+    }
+}
+
+/**
+ * @brief Return the options saved in the flexspin settings
+ *
+ * The baud rate is not part of these settings and is left at 0.
+ * @return Flexspin::Options
+ */
+Flexspin::Options Flexspin::saved_options()
+{
+    QSettings s;
+    bool ok;
+    Options options;
+
+    s.beginGroup(id_grp_flexspin);
+    const QString binary_dflt = QString("%1/bin/flexspin").arg(p2tools_path);
+    options.executable = s.value(id_flexspin_executable, binary_dflt).toString();
+    QStringList include_paths_default;
+    include_paths_default += QString("%1/include").arg(p2tools_path);
+    options.include_paths = s.value(id_flexspin_include_paths, include_paths_default).toStringList();
+    options.quiet = s.value(id_flexspin_quiet, true).toBool();
+    options.listing = s.value(id_flexspin_listing, false).toBool();
+    options.warnings = s.value(id_flexspin_warnings, true).toBool();
+    options.errors = s.value(id_flexspin_errors, false).toBool();
+    options.hub_address = s.value(id_flexspin_hub_address, 0).toUInt(&ok);
+    if (!ok) {
+	options.hub_address = 0;
+    }
+    options.skip_coginit = s.value(id_flexspin_skip_coginit, false).toBool();
+    s.endGroup();
+    return options;
+}
+
+/**
+ * @brief Build the second stage loader for a clock frequency and baud rate
+ *
+ * The loader source is copied from the resources and compiled with
+ * @p executable in a temporary directory. This blocks until flexspin
+ * is done, so it is meant for the command line only; the GUI starts
+ * a Flexspin on stage2_defines() instead.
+ * @param executable path of the flexspin executable
+ * @param clock_freq clock frequency the loader runs at
+ * @param baud baud rate the loader talks at
+ * @param p_error optional pointer to a QString to receive an error message
+ * @return binary image of the loader, or an empty array on error
+ */
+QByteArray Flexspin::stage2_loader(const QString& executable, quint32 clock_freq,
+				   quint32 baud, QString* p_error)
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+	if (p_error)
+	    *p_error = tr("Could not create a temporary directory for the second stage loader.");
+	return QByteArray();
+    }
+
+    const QString source = dir.filePath(QStringLiteral("stage2.spin2"));
+    if (!QFile::copy(QStringLiteral(":/loader/stage2.spin2"), source)) {
+	if (p_error)
+	    *p_error = tr("Could not copy the second stage loader source.");
+	return QByteArray();
+    }
+
+    QStringList args;
+    args += QStringLiteral("-2");
+    args += QStringLiteral("-q");
+    foreach(const QString& define, stage2_defines(clock_freq, baud))
+	args += QStringLiteral("-D") + define;
+    args += source;
+
+    QProcess process;
+    process.setProgram(executable);
+    process.setWorkingDirectory(dir.path());
+#if defined(Q_OS_WIN)
+    process.setNativeArguments(args.join(QChar::Space));
+#else
+    process.setArguments(args);
+#endif
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start();
+    if (!process.waitForFinished() || process.exitCode() != 0) {
+	if (p_error)
+	    *p_error = tr("Building the second stage loader failed: %1")
+		       .arg(QString::fromUtf8(process.readAll()));
+	return QByteArray();
+    }
+
+    QFile binfile(dir.filePath(QStringLiteral("stage2.binary")));
+    if (!binfile.open(QIODevice::ReadOnly)) {
+	if (p_error)
+	    *p_error = tr("The second stage loader binary is missing.");
+	return QByteArray();
+    }
+    return binfile.readAll();
+}
+
+/**
+ * @brief Return the defines to build the second stage loader with
+ * @param clock_freq clock frequency the loader runs at
+ * @param baud baud rate the loader talks at
+ * @return QStringList with the NAME=VALUE defines
+ */
+QStringList Flexspin::stage2_defines(quint32 clock_freq, quint32 baud)
+{
+    QStringList defines;
+    defines += QString("STAGE2_CLKFREQ=%1").arg(clock_freq);
+    defines += QString("STAGE2_BAUD=%1").arg(baud);
+    return defines;
+}
+
+/**
+ * @brief Return a quoted string if it contains spaces
+ * @param src const reference to the source string
+ * @param quote character to use for quoting
+ * @return quoted or original string
+ */
+QString Flexspin::quoted(const QString& src, const QChar quote)
+{
+    if (src.contains(QChar::Space))
+	return QString("%1%2%3").arg(quote).arg(src).arg(quote);
+    return src;
+}
+
+/**
+ * @brief Return the list of arguments to compile @p filename
+ * @param filename source file name
+ * @return QStringList with the arguments
+ */
+QStringList Flexspin::arguments(const QString& filename) const
+{
+    QStringList args;
+
+    // compile for Prop2
+    args += QStringLiteral("-2");
+
+    // quiet mode if enabled
+    if (m_options.quiet)
+	args += QStringLiteral("-q");
+
+    // append include paths
+    foreach(const QString& include_path, m_options.include_paths) {
+	// We need to quote paths with embedded spaces (e.g. Windows)
+	args += QString("-I %1").arg(quoted(include_path));
+    }
+
+    // define the current terminal baud rate
+    args += QString("-D _BAUD=%1").arg(m_options.baud_rate);
+    foreach(const QString& define, m_options.defines)
+	args += QString("-D %1").arg(define);
+
+    // generate a listing if enabled
+    if (m_options.listing)
+	args += QStringLiteral("-l");
+
+    // add option for warnings if enabled
+    if (m_options.warnings)
+	args += QStringLiteral("-Wall");
+
+    // add option for errors if enabled
+    if (m_options.errors)
+	args += QStringLiteral("-Werror");
+
+    // append a HUB address if configured
+    if (m_options.hub_address > 0) {
+	args += QString("-H %1").arg(m_options.hub_address, 4, 16, QChar('0'));
+	// Add flag for skip coginit
+	if (m_options.skip_coginit)
+	    args += QStringLiteral("-E");
+    }
+
+    // add source filename
+    args += filename;
+    return args;
+}
+
+/**
+ * @brief Return the command line to compile @p filename for display
+ * @param filename source file name
+ * @return QString with the executable and its arguments
+ */
+QString Flexspin::command_line(const QString& filename) const
+{
+    return QString("%1 %2")
+	    .arg(m_options.executable)
+	    .arg(arguments(filename).join(QStringLiteral(" \\\n\t")));
+}
+
+/**
+ * @brief Return true, if the compiler is running
+ */
+bool Flexspin::is_running() const
+{
+    return m_process != nullptr;
+}
+
+/**
+ * @brief Return true, if the most recent build was canceled
+ */
+bool Flexspin::was_canceled() const
+{
+    return m_canceled;
+}
+
+/**
+ * @brief Return true, if the most recent build's results came from the cache
+ */
+bool Flexspin::was_cached() const
+{
+    return m_cached;
+}
+
+/**
+ * @brief Return the source file name of the most recent build
+ */
+QString Flexspin::filename() const
+{
+    return m_filename;
+}
+
+/**
+ * @brief Return the binary of the most recent build
+ */
+QByteArray Flexspin::binary() const
+{
+    return m_binary;
+}
+
+/**
+ * @brief Return the intermediate p2asm output of the most recent build as UTF-8
+ */
+QByteArray Flexspin::p2asm() const
+{
+    return m_p2asm;
+}
+
+/**
+ * @brief Return the listing of the most recent build as UTF-8
+ */
+QByteArray Flexspin::lst() const
+{
+    return m_lst;
+}
+
+/**
+ * @brief Set the cache to look up and store build results in
+ * @param cache pointer to the BuildCache, or nullptr to always compile
+ */
+void Flexspin::set_cache(BuildCache* cache)
+{
+    m_cache = cache;
+}
+
+/**
+ * @brief Start compiling @p filename
+ *
+ * The result is delivered through the Finished() signal. If the cache
+ * holds the results for the same sources, arguments, and executable,
+ * they are delivered instead, without running flexspin.
+ * @param filename source file name
+ * @return true if started, or false if a build is already running
+ */
+bool Flexspin::start(const QString& filename)
+{
+    if (m_process)
+	return false;
+
+    m_filename = filename;
+    m_canceled = false;
+    m_trace_start = Trace::enabled() ? Trace::now_ns() : 0;
+    m_stdout.clear();
+    m_stderr.clear();
+    m_output.clear();
+    m_errors.clear();
+    m_binary.clear();
+    m_p2asm.clear();
+    m_lst.clear();
+    m_cached = false;
+    m_cache_key.clear();
+
+    if (m_cache) {
+	m_cache_key = m_cache->key(m_options.executable, arguments(filename),
+				   filename, m_options.include_paths);
+	BuildCache::Entry entry;
+	if (m_cache->lookup(m_cache_key, &entry)) {
+	    m_binary = entry.binary;
+	    m_p2asm = entry.p2asm;
+	    m_lst = entry.lst;
+	    m_output = entry.output;
+	    m_errors = entry.errors;
+	    m_cached = true;
+	    // deliver the results after the caller connected and returned
+	    QTimer::singleShot(0, this, &Flexspin::cached_finish);
+	    return true;
+	}
+    }
+
+    // let flexspin write its results into a private directory instead of next to the source
+    m_output_dir.reset(new QTemporaryDir(QDir(output_location()).filePath(QLatin1String("qflexprop-XXXXXX"))));
+    QStringList args = arguments(filename);
+    if (m_output_dir->isValid()) {
+#if defined(Q_OS_WIN)
+	args.insert(args.count() - 1, QString("-o %1").arg(quoted(output_filename(QLatin1String(".binary")))));
+#else
+	args.insert(args.count() - 1, QStringLiteral("-o"));
+	args.insert(args.count() - 1, output_filename(QLatin1String(".binary")));
+#endif
+    }
+
+    m_process = new QProcess(this);
+    m_process->setProgram(m_options.executable);
+#if defined(Q_OS_WIN)
+    // Windows really sucks: not even argument passing to a process works as elsewhere
+    m_process->setNativeArguments(args.join(QChar::Space));
+#else
+    m_process->setArguments(args);
+#endif
+    bool ok;
+    ok = connect(m_process, &QProcess::channelReadyRead,
+		 this, &Flexspin::process_ready_read);
+    Q_ASSERT(ok);
+    ok = connect(m_process, &QProcess::errorOccurred,
+		 this, &Flexspin::process_error);
+    Q_ASSERT(ok);
+    ok = connect(m_process, QOverload<int,QProcess::ExitStatus>::of(&QProcess::finished),
+		 this, &Flexspin::process_finished);
+    Q_ASSERT(ok);
+
+    m_process->start();
+    return true;
+}
+
+/**
+ * @brief Cancel the running build
+ */
+void Flexspin::cancel()
+{
+    if (!m_process)
+	return;
+    m_canceled = true;
+    m_process->kill();
+}
+
+/**
+ * @brief Collect the output of the process' @p channel
+ * @param channel which channel (stdout or stderr)
+ */
+void Flexspin::process_ready_read(int channel)
+{
+    if (!m_process)
+	return;
+    m_process->setReadChannel(static_cast<QProcess::ProcessChannel>(channel));
+    switch (channel) {
+    case QProcess::StandardOutput:
+	{
+	    const QByteArray data = m_process->readAll();
+	    m_stdout += data;
+	    m_output += data;
+	}
+	break;
+    case QProcess::StandardError:
+	{
+	    const QByteArray data = m_process->readAll();
+	    m_stderr += data;
+	    m_errors += data;
+	}
+	break;
+    default:
+	m_process->readAll();
+	break;
+    }
+    if (!m_output_timer.isActive())
+	m_output_timer.start();
+}
+
+/**
+ * @brief Report an error starting or running the process
+ * @param error QProcess::ProcessError code
+ */
+void Flexspin::process_error(QProcess::ProcessError error)
+{
+    if (!m_process)
+	return;
+    if (QProcess::FailedToStart != error)
+	return;	// process_finished() follows
+    emit Error(tr("Could not start %1: %2")
+	       .arg(m_options.executable)
+	       .arg(m_process->errorString()));
+    finish(false);
+}
+
+/**
+ * @brief Collect the results after the process exited
+ * @param exit_code exit code of the process
+ * @param status normal or crash exit
+ */
+void Flexspin::process_finished(int exit_code, QProcess::ExitStatus status)
+{
+    if (!m_process)
+	return;
+    m_process->setReadChannel(QProcess::StandardOutput);
+    const QByteArray out = m_process->readAll();
+    m_stdout += out;
+    m_output += out;
+    m_process->setReadChannel(QProcess::StandardError);
+    const QByteArray err = m_process->readAll();
+    m_stderr += err;
+    m_errors += err;
+    flush_output();
+
+    if (m_canceled) {
+	emit Error(tr("Build canceled."));
+	collect_results();
+	m_binary.clear();
+	finish(false);
+	return;
+    }
+
+    if (QProcess::NormalExit != status) {
+	emit Error(tr("%1 crashed.").arg(m_options.executable));
+	collect_results();
+	finish(false);
+	return;
+    }
+
+    if (0 == exit_code)
+	emit Compiled();
+    collect_results();
+    if (exit_code != 0) {
+	emit Error(tr("Result code %1.").arg(exit_code));
+    } else if (m_cache && !m_cache_key.isEmpty() && !m_binary.isEmpty()) {
+	BuildCache::Entry entry;
+	entry.binary = m_binary;
+	entry.p2asm = m_p2asm;
+	entry.lst = m_lst;
+	entry.output = m_output;
+	entry.errors = m_errors;
+	m_cache->insert(m_cache_key, entry);
+    }
+    finish(0 == exit_code);
+}
+
+/**
+ * @brief Deliver the results found in the cache by start()
+ *
+ * The compiler's output of the cached build is emitted again, so that
+ * its warnings are shown as for a real build.
+ */
+void Flexspin::cached_finish()
+{
+    emit Message(tr("Sources unchanged: using the cached build results."));
+    emit_lines(m_output, false, true);
+    emit_lines(m_errors, true, true);
+    emit Compiled();
+    trace_finish();
+    emit Finished(true);
+}
+
+/**
+ * @brief Emit the complete lines of the collected output
+ */
+void Flexspin::flush_output()
+{
+    const bool all = !m_process || QProcess::NotRunning == m_process->state();
+    emit_lines(m_stdout, false, all);
+    emit_lines(m_stderr, true, all);
+}
+
+/**
+ * @brief Emit the lines in @p buffer as Message() or Error() and remove them
+ * @param buffer reference to the QByteArray with the collected output
+ * @param error if true, emit Error(), otherwise Message()
+ * @param all if true, emit an incomplete last line, too
+ */
+void Flexspin::emit_lines(QByteArray& buffer, bool error, bool all)
+{
+    int len = all ? buffer.size() : buffer.lastIndexOf('\n') + 1;
+    if (len <= 0)
+	return;
+    QByteArray lines = buffer.left(len);
+    buffer.remove(0, len);
+    if (lines.endsWith('\n'))
+	lines.chop(1);
+    const QString text = QString::fromUtf8(lines);
+    if (error) {
+	emit Error(text);
+    } else {
+	emit Message(text);
+    }
+}
+
+/**
+ * @brief Return the directory to create the private output directories in
+ *
+ * The runtime directory is usually a tmpfs, so the results never touch
+ * a disk or a network share. Otherwise the system's temporary directory
+ * is used.
+ */
+QString Flexspin::output_location()
+{
+    const QString runtime = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (!runtime.isEmpty() && QFileInfo(runtime).isWritable())
+	return runtime;
+    return QDir::tempPath();
+}
+
+/**
+ * @brief Return the name of the result file with @p suffix in the private directory
+ * @param suffix file name suffix (.binary, .lst, or .p2asm)
+ * @return absolute path of the file
+ */
+QString Flexspin::output_filename(const QString& suffix) const
+{
+    return QDir(m_output_dir->path()).filePath(QFileInfo(m_filename).completeBaseName() + suffix);
+}
+
+/**
+ * @brief Map, copy, and remove the file @p filename
+ * @param filename name of the file
+ * @return QByteArray with its contents, or a null QByteArray if it does not exist
+ */
+QByteArray Flexspin::take_file(const QString& filename)
+{
+    QFile file(filename);
+    if (!file.exists())
+	return QByteArray();
+    QByteArray data;
+    if (file.open(QIODevice::ReadOnly)) {
+	const qint64 size = file.size();
+	uchar* ptr = size > 0 ? file.map(0, size) : nullptr;
+	if (ptr) {
+	    // copy, since the file is removed right away
+	    data = QByteArray(reinterpret_cast<const char*>(ptr), static_cast<int>(size));
+	    file.unmap(ptr);
+	} else {
+	    data = file.readAll();
+	}
+	file.close();
+    }
+    file.remove();
+    return data;
+}
+
+/**
+ * @brief Collect the listing, intermediate, and binary files
+ *
+ * The results are taken from the private directory only; a file
+ * missing there, e.g. the listing of a build without -l, stays empty.
+ * Only if the private directory could not be created, flexspin wrote
+ * its results next to the source and they are collected from there.
+ */
+void Flexspin::collect_results()
+{
+    if (m_output_dir && m_output_dir->isValid()) {
+	m_lst = take_file(output_filename(QLatin1String(".lst")));
+	m_p2asm = take_file(output_filename(QLatin1String(".p2asm")));
+	m_binary = take_file(output_filename(QLatin1String(".binary")));
+	return;
+    }
+
+    QFileInfo info(m_filename);
+    const QString base = QDir(info.absolutePath()).filePath(info.completeBaseName());
+    m_lst = take_file(base + QLatin1String(".lst"));
+    m_p2asm = take_file(base + QLatin1String(".p2asm"));
+    m_binary = take_file(base + QLatin1String(".binary"));
+}
+
+/**
+ * @brief Release the process and emit Finished()
+ * @param ok true on success
+ */
+void Flexspin::finish(bool ok)
+{
+    m_output_timer.stop();
+    m_process->disconnect(this);
+    m_process->deleteLater();
+    m_process = nullptr;
+    m_output_dir.reset();
+    trace_finish();
+    emit Finished(ok);
+}
+
+/**
+ * @brief Record the build from start() to now, if it was traced
+ */
+void Flexspin::trace_finish()
+{
+    if (!m_trace_start)
+	return;
+    Trace::complete(m_cached ? "Flexspin::build (cached)" : "Flexspin::build",
+		    m_trace_start, Trace::now_ns());
+    m_trace_start = 0;
+}
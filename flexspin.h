@@ -0,0 +1,123 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 asynchronous flexspin compiler run
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QProcess>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTimer>
+#include "buildcache.h"
+
+/**
+ * @brief Runs flexspin on a source file without blocking the caller
+ *
+ * The compiler's output is collected and emitted line-wise in batches
+ * with the Message() and Error() signals. flexspin writes its results
+ * into a private temporary directory, preferably in RAM. When the
+ * process exits, the resulting binary, intermediate p2asm and listing
+ * are mapped and copied, and the Finished() signal is emitted. The
+ * listings are kept as UTF-8 and decoded only when they are shown.
+ * A running build can be canceled.
+ *
+ * If a BuildCache is set and it holds the results for an identical
+ * build, no process is started and the cached results are delivered,
+ * including the compiler's output, which is emitted again.
+ *
+ * Compiled() is emitted as soon as the compiler exited successfully,
+ * before the results are collected, so that a caller can prepare the
+ * board for the upload while Finished() is still pending.
+ */
+class Flexspin : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options {
+	QString executable;		//!< path of the flexspin executable
+	QStringList include_paths;	//!< include paths (-I)
+	qint32 baud_rate = 0;		//!< terminal baud rate to define as _BAUD
+	QStringList defines;		//!< additional NAME=VALUE defines (-D)
+	bool quiet = false;		//!< quiet mode (-q)
+	bool listing = false;		//!< generate a listing (-l)
+	bool warnings = false;		//!< enable all warnings (-Wall)
+	bool errors = false;		//!< treat warnings as errors (-Werror)
+	quint32 hub_address = 0;	//!< HUB address (-H), if non-zero
+	bool skip_coginit = false;	//!< skip the coginit (-E)
+    };
+
+    explicit Flexspin(const Options& options, QObject* parent = nullptr);
+    ~Flexspin();
+
+    static Options saved_options();
+    static QByteArray stage2_loader(const QString& executable, quint32 clock_freq,
+				    quint32 baud, QString* p_error = nullptr);
+    static QStringList stage2_defines(quint32 clock_freq, quint32 baud);
+
+    QStringList arguments(const QString& filename) const;
+    QString command_line(const QString& filename) const;
+    bool is_running() const;
+    bool was_canceled() const;
+    bool was_cached() const;
+    QString filename() const;
+    QByteArray binary() const;
+    QByteArray p2asm() const;
+    QByteArray lst() const;
+
+    void set_cache(BuildCache* cache);
+    bool start(const QString& filename);
+
+public slots:
+    void cancel();
+
+signals:
+    void Error(const QString& text);
+    void Message(const QString& text);
+    void Compiled();
+    void Finished(bool ok);
+
+private slots:
+    void process_ready_read(int channel);
+    void process_error(QProcess::ProcessError error);
+    void process_finished(int exit_code, QProcess::ExitStatus status);
+    void flush_output();
+    void cached_finish();
+
+private:
+    //! Milliseconds between batches of output lines
+    static constexpr int output_interval = 50;
+
+    Options m_options;		//!< compiler options
+    QString m_filename;		//!< source file being compiled
+    QProcess* m_process;	//!< running flexspin process, if any
+    QTimer m_output_timer;	//!< timer to emit batches of output
+    QByteArray m_stdout;	//!< standard output not yet emitted
+    QByteArray m_stderr;	//!< standard error not yet emitted
+    QByteArray m_output;	//!< all of the standard output, for the cache
+    QByteArray m_errors;	//!< all of the standard error, for the cache
+    bool m_canceled;		//!< true if cancel() was called
+    BuildCache* m_cache;	//!< cache of build results, or nullptr
+    QByteArray m_cache_key;	//!< cache key of the running build
+    bool m_cached;		//!< true if the results came from the cache
+    QByteArray m_binary;	//!< resulting binary
+    QByteArray m_p2asm;		//!< resulting intermediate p2asm output (UTF-8)
+    QByteArray m_lst;		//!< resulting listing (UTF-8)
+    QScopedPointer<QTemporaryDir> m_output_dir; //!< private directory for the results
+    qint64 m_trace_start;	//!< Trace::now_ns() when the build started, or 0
+
+    static QString quoted(const QString& src, const QChar quote = QChar('"'));
+    void emit_lines(QByteArray& buffer, bool error, bool all);
+    static QString output_location();
+    static QByteArray take_file(const QString& filename);
+    QString output_filename(const QString& suffix) const;
+    void collect_results();
+    void finish(bool ok);
+    void trace_finish();
+};
@@ -22,6 +22,11 @@ const QLatin1String id_window_geometry("window_geomtry");
 const QLatin1String id_fixedfont_family("fixedfont_family");
 const QLatin1String id_fixedfont_weight("fixedfont_weight");
 const QLatin1String id_fixedfont_size("fixedfont_size");
+const QLatin1String id_capture_dir("capture_dir");
+const QLatin1String id_trace_dir("trace_dir");
+const QLatin1String id_elf_dir("elf_dir");
+const QLatin1String id_flash_dir("flash_dir");
+const QLatin1String id_capture_timestamps("capture_timestamps");
 
 const QLatin1String id_grp_preferences("preferences");
 const QLatin1String id_grp_serialport("serialport");
@@ -41,6 +46,7 @@ const QLatin1String id_parity("parity");
 const QLatin1String id_stop_bits("stop_bits");
 const QLatin1String id_flow_control("flow_control");
 const QLatin1String id_local_echo("local_echo");
+const QLatin1String id_upload_baud_rate("upload_baud_rate");
 const QLatin1String id_parity_data_stop("data_parity_stop");
 
 const QLatin1String id_port_name("port_name");
@@ -57,8 +63,16 @@ const QLatin1String id_status("status");
 const QLatin1String id_terminal("terminal");
 const QLatin1String id_zoom("zoom");
 const QLatin1String id_font_family("font_family");
+const QLatin1String id_backlog_lines("backlog_lines");
+const QLatin1String id_backlog_memory("backlog_memory");
+const QLatin1String id_opengl("opengl");
 
 const QLatin1String id_grp_serterm("serterm");
+const QLatin1String id_send_prompt("send_prompt");
+const QLatin1String id_send_prompt_timeout("send_prompt_timeout");
+const QLatin1String id_send_xon_xoff("send_xon_xoff");
+const QLatin1String id_find_regex("find_regex");
+const QLatin1String id_find_case("find_case");
 
 const QLatin1String id_dcd("dcd");
 const QLatin1String id_dsr("dsr");
@@ -98,6 +112,7 @@ const QLatin1String p2tools_path("");
 const QLatin1String id_grp_flexspin("flexspin");
 const QLatin1String id_compile_verbose_upload("quiet_mode");
 const QLatin1String id_compile_switch_to_term("switch_to_term)");
+const QLatin1String id_compile_binary_upload("binary_upload");
 const QLatin1String id_flexspin_executable("executable");
 const QLatin1String id_flexspin_quiet("quiet");
 const QLatin1String id_flexspin_include_paths("include_paths");
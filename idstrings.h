@@ -10,13 +10,14 @@
 #pragma once
 #include <QLatin1String>
 #include <QSerialPort>
+#include "trace.h"
 
 #define	DEBUG_DATA	0
 
 #if defined(DEBUG_DATA) && (DEBUG_DATA != 0)
 #define	DBG_DATA(X,...)	qDebug(X, __VA_ARGS__)
 #else
-#define	DBG_DATA(X,...) /* X */
+#define	DBG_DATA(X,...)	TRACE_MARK(X)
 #endif
 
 extern const QLatin1String id_sourcedir;
@@ -28,6 +29,11 @@ extern const QLatin1String id_grp_application;
 extern const QLatin1String id_window_geometry;
 extern const QLatin1String id_fixedfont_family;
 extern const QLatin1String id_fixedfont_weight;
+extern const QLatin1String id_capture_dir;
+extern const QLatin1String id_trace_dir;
+extern const QLatin1String id_elf_dir;
+extern const QLatin1String id_flash_dir;
+extern const QLatin1String id_capture_timestamps;
 extern const QLatin1String id_fixedfont_size;
 
 extern const QLatin1String id_grp_preferences;
@@ -41,6 +47,7 @@ extern const QLatin1String id_parity;
 extern const QLatin1String id_stop_bits;
 extern const QLatin1String id_flow_control;
 extern const QLatin1String id_local_echo;
+extern const QLatin1String id_upload_baud_rate;
 extern const QLatin1String id_parity_data_stop;
 
 extern const QLatin1String id_port_name;
@@ -57,8 +64,16 @@ extern const QLatin1String id_status;
 extern const QLatin1String id_terminal;
 extern const QLatin1String id_zoom;
 extern const QLatin1String id_font_family;
+extern const QLatin1String id_backlog_lines;
+extern const QLatin1String id_backlog_memory;
+extern const QLatin1String id_opengl;
 
 extern const QLatin1String id_grp_serterm;
+extern const QLatin1String id_send_prompt;
+extern const QLatin1String id_send_prompt_timeout;
+extern const QLatin1String id_send_xon_xoff;
+extern const QLatin1String id_find_regex;
+extern const QLatin1String id_find_case;
 
 extern const QLatin1String id_dcd;
 extern const QLatin1String id_dsr;
@@ -101,6 +116,7 @@ extern const QLatin1String p2tools_path;
 extern const QLatin1String id_grp_flexspin;
 extern const QLatin1String id_compile_verbose_upload;
 extern const QLatin1String id_compile_switch_to_term;
+extern const QLatin1String id_compile_binary_upload;
 extern const QLatin1String id_flexspin_executable;
 extern const QLatin1String id_flexspin_include_paths;
 extern const QLatin1String id_flexspin_quiet;
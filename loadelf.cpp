@@ -1,3 +1,5 @@
+#include <QFileDevice>
+#include <cstring>
 #include "loadelf.h"
 
 #define	IDENT_SIGNIFICANT_BYTES	16
@@ -18,10 +20,13 @@ LoadElf::LoadElf(QObject *parent)
     : QObject(parent)
     , m_file(nullptr)
     , m_hdr()
-    , m_string_offs(0)
-    , m_symbol_offs(0)
-    , m_symbol_string_offs(0)
-    , m_symbol_cnt(0)
+    , m_sections()
+    , m_section_names()
+    , m_section_index()
+    , m_programs()
+    , m_symbols()
+    , m_symbol_names()
+    , m_symbol_index()
 {
 }
 
@@ -59,34 +64,167 @@ bool LoadElf::is_elf()
     return 0 == memcmp(ident, m_hdr.ident, IDENT_SIGNIFICANT_BYTES);
 }
 
+/**
+ * @brief Open the ELF file on the device @p fp and index its tables
+ *
+ * The file is mapped, or read if the device can not be mapped, once.
+ * The section, program, and symbol tables are copied into in-memory
+ * indices, so that the lookups afterwards do not touch the device.
+ * @param fp pointer to the opened device
+ * @return true on success, or false if it is not a valid ELF file
+ */
 bool LoadElf::open(QIODevice *fp)
 {
-    ElfSectionHdr section;
-
     m_file = fp;
-    if (!is_elf())
+    clear_index();
+    if (!m_file)
 	return false;
 
-    // get the string section offset
-    if (!load_section_table_entry(m_hdr.shstrndx, section))
+    QFileDevice* file = qobject_cast<QFileDevice*>(m_file);
+    const qint64 size = m_file->size();
+    uchar* ptr = (file && size > 0) ? file->map(0, size) : nullptr;
+    bool ok;
+    if (ptr) {
+	ok = build_index(ptr, size);
+	file->unmap(ptr);
+    } else {
+	if (!m_file->isSequential())
+	    m_file->seek(0);
+	const QByteArray data = m_file->readAll();
+	ok = build_index(reinterpret_cast<const uchar*>(data.constData()), data.size());
+    }
+    if (!ok)
+	clear_index();
+    return ok;
+}
+
+/**
+ * @brief Forget the indices of the previously opened file
+ */
+void LoadElf::clear_index()
+{
+    memset(&m_hdr, 0, sizeof(m_hdr));
+    m_sections.clear();
+    m_section_names.clear();
+    m_section_index.clear();
+    m_programs.clear();
+    m_symbols.clear();
+    m_symbol_names.clear();
+    m_symbol_index.clear();
+}
+
+/**
+ * @brief Return the NUL terminated string at @p offs in @p data
+ * @param data pointer to the file's contents
+ * @param size size of the file's contents
+ * @param offs offset of the string
+ * @return QByteArray with at most ELFNAMEMAX characters, or empty if @p offs is outside
+ */
+QByteArray LoadElf::string_at(const uchar* data, qint64 size, quint64 offs)
+{
+    if (offs >= static_cast<quint64>(size))
+	return QByteArray();
+    const char* str = reinterpret_cast<const char*>(data + offs);
+    const size_t max = static_cast<size_t>(qMin<quint64>(ELFNAMEMAX, static_cast<quint64>(size) - offs));
+    const void* nul = memchr(str, 0, max);
+    return QByteArray(str, static_cast<int>(nul ? static_cast<const char*>(nul) - str : max));
+}
+
+/**
+ * @brief Parse the header and the tables from the file's contents
+ * @param data pointer to the file's contents
+ * @param size size of the file's contents
+ * @return true on success, or false if the header or a table is invalid
+ */
+bool LoadElf::build_index(const uchar* data, qint64 size)
+{
+    const quint64 fsize = static_cast<quint64>(size);
+    if (fsize < sizeof(m_hdr))
+	return false;
+    memcpy(&m_hdr, data, sizeof(m_hdr));
+    if (0 != memcmp(ident, m_hdr.ident, IDENT_SIGNIFICANT_BYTES))
 	return false;
 
-    m_string_offs = section.offset;
+    // the section table
+    if (m_hdr.shnum > 0) {
+	const quint64 entsize = m_hdr.shentsize;
+	if (entsize == 0 || m_hdr.shoff + entsize * m_hdr.shnum > fsize) {
+	    emit Message(tr("ELF section table is outside the file."));
+	    return false;
+	}
+	m_sections.resize(m_hdr.shnum);
+	for (quint16 i = 0; i < m_hdr.shnum; ++i) {
+	    ElfSectionHdr& section = m_sections[i];
+	    memset(&section, 0, sizeof(section));
+	    memcpy(&section, data + m_hdr.shoff + i * entsize,
+		   static_cast<size_t>(qMin<quint64>(sizeof(section), entsize)));
+	}
+    }
 
-    // get the symbol table section offset
-    if (find_section_table_entry(dot_symtab, section)) {
-	m_symbol_offs = section.offset;
-	m_symbol_cnt = section.size / sizeof(ElfSymbol);
-	if (find_section_table_entry(dot_strtab, section)) {
-	    m_symbol_string_offs = section.offset;
-	} else {
-	    m_symbol_offs = 0;
-	    m_symbol_cnt = 0;
+    // the program table
+    if (m_hdr.phnum > 0) {
+	const quint64 entsize = m_hdr.phentsize;
+	if (entsize == 0 || m_hdr.phoff + entsize * m_hdr.phnum > fsize) {
+	    emit Message(tr("ELF program table is outside the file."));
+	    return false;
+	}
+	m_programs.resize(m_hdr.phnum);
+	for (quint16 i = 0; i < m_hdr.phnum; ++i) {
+	    ElfProgramHdr& program = m_programs[i];
+	    memset(&program, 0, sizeof(program));
+	    memcpy(&program, data + m_hdr.phoff + i * entsize,
+		   static_cast<size_t>(qMin<quint64>(sizeof(program), entsize)));
+	}
+    }
+
+    // the section names
+    if (m_hdr.shstrndx >= m_sections.size()) {
+	emit Message(tr("Can't read ELF section header %1").arg(m_hdr.shstrndx));
+	return false;
+    }
+    const quint64 string_offs = m_sections[m_hdr.shstrndx].offset;
+    m_section_names.resize(m_sections.size());
+    for (int i = 0; i < m_sections.size(); ++i) {
+	m_section_names[i] = string_at(data, size, string_offs + m_sections[i].name);
+	if (!m_section_index.contains(m_section_names[i]))
+	    m_section_index.insert(m_section_names[i], i);
+    }
+
+    // the symbol table and its names
+    const int symtab = m_section_index.value(QByteArray(dot_symtab.data(), dot_symtab.size()), -1);
+    const int strtab = m_section_index.value(QByteArray(dot_strtab.data(), dot_strtab.size()), -1);
+    if (symtab >= 0 && strtab >= 0) {
+	const ElfSectionHdr& section = m_sections[symtab];
+	const quint64 count = section.size / sizeof(ElfSymbol);
+	if (section.offset + count * sizeof(ElfSymbol) > fsize) {
+	    emit Message(tr("ELF symbol table is outside the file."));
+	    return false;
+	}
+	const quint64 symbol_string_offs = m_sections[strtab].offset;
+	m_symbols.resize(static_cast<int>(count));
+	m_symbol_names.resize(static_cast<int>(count));
+	if (count > 0)
+	    memcpy(m_symbols.data(), data + section.offset, static_cast<size_t>(count * sizeof(ElfSymbol)));
+	// symbol 0 is the undefined symbol
+	for (int i = 1; i < m_symbols.size(); ++i) {
+	    if (!m_symbols[i].name)
+		continue;
+	    m_symbol_names[i] = string_at(data, size, symbol_string_offs + m_symbols[i].name);
+	    if (!m_symbol_index.contains(m_symbol_names[i]))
+		m_symbol_index.insert(m_symbol_names[i], i);
 	}
     }
     return true;
 }
 
+/**
+ * @brief Return the number of entries in the program table
+ */
+int LoadElf::program_count() const
+{
+    return m_programs.size();
+}
+
 bool LoadElf::program_size(quint32& start, quint32& size, quint32& cog_images_size)
 {
     start = 0xffffffffUL;
@@ -144,84 +282,59 @@ QByteArray LoadElf::load_program_segment(const ElfProgramHdr& program)
 
 int LoadElf::find_section_table_entry(const QString& name, ElfSectionHdr& section)
 {
-    for (quint16 i = 0; i < m_hdr.shnum; ++i) {
-	if (!load_section_table_entry(i, section)) {
-	    emit Message(tr("Can't read ELF section header %1").arg(i));
-	    return 1;
-	}
-	qint64 pos = m_file->seek(m_string_offs + section.name);
-	if (static_cast<size_t>(pos) != m_string_offs + section.name)
-	    return false;
-	QByteArray ascii_name = m_file->read(ELFNAMEMAX);
-	QString this_name = QString::fromLatin1(ascii_name);
-	if (name == this_name)
-	    return true;
-    }
-    return false;
+    const int i = m_section_index.value(name.toLatin1(), -1);
+    if (i < 0)
+	return false;
+    section = m_sections[i];
+    return true;
 }
 
 bool LoadElf::load_section_table_entry(quint16 i, ElfSectionHdr& section)
 {
-    memset(&section, 0, sizeof(section));
-    qint64 pos = m_file->seek(m_hdr.shoff + i * m_hdr.shentsize);
-    if (pos != m_hdr.shoff + i * m_hdr.shentsize)
-	return false;
-    qint64 done = m_file->read(reinterpret_cast<char*>(&section), sizeof(section));
-    if (done != sizeof(section))
+    if (i >= m_sections.size()) {
+	memset(&section, 0, sizeof(section));
 	return false;
+    }
+    section = m_sections[i];
     return true;
 }
 
 int LoadElf::find_program_table_entry(ElfSectionHdr& section, ElfProgramHdr& program)
 {
-    for (quint16 i = 0; i < m_hdr.shnum; ++i) {
-	if (!load_program_table_entry(i, program)) {
-	    emit Message(tr("Can't read ELF program header %1").arg(i));
-	    return -1;
-	}
-	if (section_in_program_segment(section, program))
+    for (int i = 0; i < m_programs.size(); ++i) {
+	if (section_in_program_segment(section, m_programs[i])) {
+	    program = m_programs[i];
 	    return i;
+	}
     }
     return -1;
 }
 
 int LoadElf::load_program_table_entry(quint16 i, ElfProgramHdr& program)
 {
-    memset(&program, 0, sizeof(program));
-    qint64 pos = m_file->seek(m_hdr.phoff + i * m_hdr.phentsize);
-    if (pos != m_hdr.phoff + i * m_hdr.phentsize)
-	return -1;
-    qint64 done = m_file->read(reinterpret_cast<char*>(&program), sizeof(program));
-    if (done != sizeof(program))
+    if (i >= m_programs.size()) {
+	memset(&program, 0, sizeof(program));
 	return -1;
-    return done;
+    }
+    program = m_programs[i];
+    return sizeof(program);
 }
 
 bool LoadElf::find_elf_symbol(const QString& find_name, ElfSymbol& symbol)
 {
-    for (quint32 i = 1; i < m_symbol_cnt; ++i) {
-	QString name;
-	if (load_elf_symbol(i, name, symbol) && name == find_name)
-	    return true;
-    }
-    return false;
+    const int i = m_symbol_index.value(find_name.toLatin1(), -1);
+    if (i < 0)
+	return false;
+    symbol = m_symbols[i];
+    return true;
 }
 
 bool LoadElf::load_elf_symbol(size_t i, QString& name, ElfSymbol& symbol)
 {
-    qint64 pos = m_file->seek(m_symbol_offs + i * sizeof(ElfSymbol));
-    if (static_cast<size_t>(pos) != m_symbol_offs + i * sizeof(ElfSymbol))
-	return false;
-    qint64 done = m_file->read(reinterpret_cast<char *>(&symbol), sizeof(symbol));
-    if (static_cast<size_t>(done) < sizeof(symbol))
+    if (i >= static_cast<size_t>(m_symbols.size()))
 	return false;
-    if (symbol.name) {
-	pos = m_file->seek(m_symbol_offs + symbol.name);
-	if (static_cast<size_t>(pos) != m_symbol_offs + symbol.name)
-	    return -1;
-	QByteArray ascii_name = m_file->read(ELFNAMEMAX);
-	name = QString::fromLatin1(ascii_name);
-    }
+    symbol = m_symbols[static_cast<int>(i)];
+    name = QString::fromLatin1(m_symbol_names[static_cast<int>(i)]);
     return true;
 }
 
@@ -258,11 +371,7 @@ QStringList LoadElf::elf_file_info()
 	    list += QString("error: can't read section header %1").arg(i);
 	    return list;
 	}
-	qint64 pos = m_file->seek(m_string_offs + section.name);
-	if (static_cast<size_t>(pos) != m_string_offs + section.name)
-	    continue;
-	QByteArray ascii_name = m_file->read(ELFNAMEMAX);
-	name = QString::fromLatin1(ascii_name);
+	name = QString::fromLatin1(m_section_names[i]);
 	list += QString("SectionHdr %1:").arg(i);
 	list += QString("  name:      %1 %2")
 	       .arg(section.name, 8, 16, QChar(0))
@@ -281,7 +390,7 @@ QStringList LoadElf::elf_file_info()
     }
 
     // show the symbol table
-    for (size_t i = 1; i < m_symbol_cnt; ++i) {
+    for (size_t i = 1; i < static_cast<size_t>(m_symbols.size()); ++i) {
 	QString name;
 	ElfSymbol symbol;
 	if (load_elf_symbol(i, name, symbol) && symbol.name > 0 && STB_GLOBAL == info_bind(symbol.info))
@@ -22,7 +22,10 @@
 */
 #pragma once
 #include <QObject>
+#include <QByteArray>
+#include <QHash>
 #include <QIODevice>
+#include <QVector>
 
 typedef struct  {
     quint8  ident[16];
@@ -88,10 +91,17 @@ class LoadElf : public QObject
     Q_OBJECT
 
 public:
+    //! base address of cog driver overlays to be loaded into eeprom
+    static constexpr ulong COG_DRIVER_IMAGE_BASE = 0xc0000000;
+
+    static constexpr uchar PT_NULL     = 0;
+    static constexpr uchar PT_LOAD     = 1;
+
     explicit LoadElf(QObject *parent = nullptr);
 
     bool is_elf();
     bool open(QIODevice *fp);
+    int program_count() const;
     bool program_size(quint32& start, quint32& size, quint32& pCogImagesSize);
     int find_section_table_entry(const QString& name, ElfSectionHdr& section);
     int find_program_segment(const QString& name, ElfProgramHdr& program);
@@ -107,9 +117,6 @@ signals:
 
 private:
 
-    //! base address of cog driver overlays to be loaded into eeprom
-    static constexpr ulong COG_DRIVER_IMAGE_BASE = 0xc0000000;
-
     static constexpr uchar ST_NULL     = 0;
     static constexpr uchar ST_PROGBITS = 1;
     static constexpr uchar ST_SYMTAB   = 2;
@@ -127,9 +134,6 @@ private:
     static constexpr uchar SF_ALLOC    = 2;
     static constexpr uchar SF_EXECUTE  = 4;
 
-    static constexpr uchar PT_NULL     = 0;
-    static constexpr uchar PT_LOAD     = 1;
-
     static constexpr int ELFNAMEMAX  = 128;
 
     static uchar info_bind(const uchar i);
@@ -141,10 +145,17 @@ private:
 
     QIODevice *m_file;
     ElfHdr m_hdr;
-    size_t m_string_offs;
-    size_t m_symbol_offs;
-    size_t m_symbol_string_offs;
-    size_t m_symbol_cnt;
+    QVector<ElfSectionHdr> m_sections;		//!< section table
+    QVector<QByteArray> m_section_names;	//!< section names by index
+    QHash<QByteArray,int> m_section_index;	//!< first section index by name
+    QVector<ElfProgramHdr> m_programs;		//!< program table
+    QVector<ElfSymbol> m_symbols;		//!< symbol table
+    QVector<QByteArray> m_symbol_names;		//!< symbol names by index
+    QHash<QByteArray,int> m_symbol_index;	//!< first symbol index by name
+
+    void clear_index();
+    bool build_index(const uchar* data, qint64 size);
+    static QByteArray string_at(const uchar* data, qint64 size, quint64 offs);
 
     void CloseElfFile(ElfContext* c);
     int find_program_table_entry(ElfSectionHdr& section, ElfProgramHdr& program);
@@ -8,13 +8,18 @@
  *
  *****************************************************************************/
 #include "qflexprop.h"
+#include "clirunner.h"
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QTimer>
 
-int main(int argc, char *argv[])
+/**
+ * @brief Set the names which select the settings of the application
+ * @param a reference to the application object
+ */
+static void set_names(QCoreApplication& a)
 {
-    QApplication a(argc, argv);
-
     a.setApplicationName(QLatin1String("QFlexProp"));
     a.setApplicationVersion(QString("%1.%2.%3")
 			    .arg(VERSION_MAJOR)
@@ -22,6 +27,27 @@ int main(int argc, char *argv[])
 			    .arg(VERSION_PATCH));
     a.setOrganizationName(QLatin1String("pullmoll"));
     a.setOrganizationDomain(QLatin1String("pullmoll.github.io"));
+}
+
+int main(int argc, char *argv[])
+{
+    if (CliRunner::requested(argc, argv)) {
+	// headless: no QApplication, no widgets
+	QCoreApplication a(argc, argv);
+	set_names(a);
+	CliRunner cli;
+	if (!cli.parse(a.arguments()))
+	    return cli.exit_code();
+	bool ok;
+	ok = QObject::connect(&cli, &CliRunner::Finished,
+			      &a, &QCoreApplication::exit, Qt::QueuedConnection);
+	Q_ASSERT(ok);
+	QTimer::singleShot(0, &cli, &CliRunner::start);
+	return a.exec();
+    }
+
+    QApplication a(argc, argv);
+    set_names(a);
 
     QFlexProp w;
     w.show();
@@ -15,6 +15,10 @@
  * This lists (a subset of) token strings used with Propeller 2
  * editor's supported languages.
  *
+ * The table of tokens and the perfect hash over their names are
+ * built at compile time, so looking up a name neither allocates
+ * nor needs any initialization at startup.
+ *
  * TODO:
  *
  * Classify tokens per language so that syntax highlighting
@@ -25,624 +29,861 @@
  * keyword for some time.
  */
 
-CPropToken::CPropToken(const PropToken t, const QString& name, const QString& desc)
-    : m_token(t)
-    , m_name(name)
-    , m_desc(desc)
+namespace {
+
+/**
+ * @brief Name and description of a token
+ */
+struct TokenEntry {
+    PropToken tok;
+    const char* name;
+    const char* desc;
+};
+
+/**
+ * @brief Table of all tokens, indexed by PropToken
+ */
+constexpr TokenEntry token_table[TOK_] = {
+    {TOK_0, nullptr, nullptr},
+    {TOK_CPP_IF, "#if", "Preprocessor condition"},
+    {TOK_CPP_ELSE, "#else", "Preprocessor condition"},
+    {TOK_CPP_ENDIF, "#endif", "Preprocessor condition"},
+    {TOK_CPP_IFDEF, "#ifdef", "Preprocessor condition"},
+    {TOK_CPP_IFNDEF, "#ifndef", "Preprocessor condition"},
+    {TOK_CPP_ELIF, "#elif", "Preprocessor condition"},
+    {TOK_CPP_ELIFDEF, "#elifdef", "Preprocessor condition"},
+    {TOK_CPP_ELIFNDEF, "#elifndef", "Preprocessor condition"},
+    {TOK_CPP_DEFINE, "#define", "Preprocessor definition"},
+    {TOK_CPP_UNDEF, "#undef", "Preprocessor definition remove"},
+
+    {TOK_CON, "CON", "CON"},
+    {TOK_VAR, "VAR", "VAR"},
+    {TOK_DAT, "DAT", "DAT"},
+    {TOK_PUB, "PUB", "PUB"},
+    {TOK_PRI, "PRI", "PRI"},
+    {TOK_OBJ, "OBJ", "OBJ"},
+    {TOK_ASM, "ASM", "ASM"},
+    {TOK_ENDASM, "ENDASM", "ENDASM"},
+    {TOK_END, "END", "END"},
+    {TOK_INLINECCODE, "CCODE", "CCODE"},
+
+    {TOK_BYTE, "BYTE", "BYTE"},
+    {TOK_WORD, "WORD", "WORD"},
+    {TOK_LONG, "LONG", "LONG"},
+    {TOK_FVAR, "FVAR", "FVAR"},
+    {TOK_FVARS, "FVARS", "FVARS"},
+    {TOK_ASMCLK, "ASMCLK", "ASMCLK"},
+
+    {TOK_INSTR, nullptr, "instruction"},
+    {TOK_INSTRMODIFIER, nullptr, "instruction modifier"},
+    {TOK_HWREG, nullptr, "hardware register"},
+    {TOK_ORG, "ORG", "ORG"},
+    {TOK_ORGH, "ORGH", "ORGH"},
+    {TOK_ORGF, "ORGF", "ORGF"},
+    {TOK_RES, "RES", "RES"},
+    {TOK_FIT, "FIT", "FIT"},
+    {TOK_ALIGNL, "ALIGNL", "ALIGNL"},
+    {TOK_ALIGNW, "ALIGNW", "ALIGNW"},
+
+    {TOK_REPEAT, "REPEAT", "REPEAT"},
+    {TOK_FROM, "FROM", "FROM"},
+    {TOK_TO, "TO", "TO"},
+    {TOK_STEP, "STEP", "STEP"},
+    {TOK_WHILE, "WHILE", "WHILE"},
+    {TOK_UNTIL, "UNTIL", "UNTIL"},
+    {TOK_IF, "IF", "IF"},
+    {TOK_IFNOT, "IFNOT", "IFNOT"},
+    {TOK_ELSE, "ELSE", "ELSE"},
+    {TOK_ELSEIF, "ELSEIF", "ELSEIF"},
+    {TOK_ELSEIFNOT, "ELSEIFNOT", "ELSEIFNOT"},
+    {TOK_THEN, "THEN", "THEN"},
+    {TOK_ENDIF, "ENDIF", "ENDIF"},
+
+    {TOK_LOOKDOWN, "LOOKDOWN", "LOOKDOWN"},
+    {TOK_LOOKDOWNZ, "LOOKDOWNZ", "LOOKDOWNZ"},
+    {TOK_LOOKUP, "LOOKUP", "LOOKUP"},
+    {TOK_LOOKUPZ, "LOOKUPZ", "LOOKUPZ"},
+    {TOK_COGINIT2, "COGINIT", "COGINIT"},
+    {TOK_COGNEW, "COGNEW", "COGNEW"},
+
+    {TOK_CASE, "CASE", "CASE"},
+    {TOK_CASE_FAST, "CASE_FAST", "CASE_FAST"},
+    {TOK_OTHER, "OTHER", "OTHER"},
+
+    {TOK_QUIT, "QUIT", "QUIT"},
+    {TOK_NEXT, "NEXT", "NEXT"},
+
+    {TOK_ALLOCA, "__BUILTIN_ALLOCA", "__BUILTIN_ALLOCA"},
+
+    {TOK_ABORT, "ABORT", "ABORT"},
+    {TOK_RESULT, "RESULT", "RESULT"},
+    {TOK_RETURN, "RETURN", "RETURN"},
+    {TOK_INDENT, nullptr, "indentation"},
+    {TOK_OUTDENT, nullptr, "lack of indentation"},
+    {TOK_EOLN, nullptr, "end of line"},
+    {TOK_EOF, nullptr, "end of file"},
+    {TOK_DOTS, "..", ".."},
+    {TOK_HERE, "$", "$"},
+    {TOK_STRINGPTR, nullptr, "STRING"},
+    {TOK_FILE, nullptr, "FILE"},
+
+    {TOK_NOP, "NOP", "No operation"},
+    {TOK_ROR, "ROR", "ROR"},
+    {TOK_ROL, "ROL", "ROL"},
+    {TOK_SHR, "SHR", "SHR"},
+    {TOK_SHL, "SHL", "SHL"},
+    {TOK_RCR, "RCR", "RCR"},
+    {TOK_RCL, "RCL", "RCL"},
+    {TOK_SAR, "SAR", "SAR"},
+    {TOK_SAL, "SAL", "SAL"},
+    {TOK_ADD, "ADD", "ADD"},
+    {TOK_ADDX, "ADDX", "ADDX"},
+    {TOK_ADDS, "ADDS", "ADDS"},
+    {TOK_ADDSX, "ADDSX", "ADDSX"},
+    {TOK_SUB, "SUB", "SUB"},
+    {TOK_SUBX, "SUBX", "SUBX"},
+    {TOK_SUBS, "SUBS", "SUBS"},
+    {TOK_SUBSX, "SUBSX", "SUBSX"},
+    {TOK_CMP, "CMP", "CMP"},
+    {TOK_CMPX, "CMPX", "CMPX"},
+    {TOK_CMPS, "CMPS", "CMPS"},
+    {TOK_CMPSX, "CMPSX", "CMPSX"},
+    {TOK_CMPR, "CMPR", "CMPR"},
+    {TOK_CMPM, "CMPM", "CMPM"},
+    {TOK_SUBR, "SUBR", "SUBR"},
+    {TOK_CMPSUB, "CMPSUB", "CMPSUB"},
+    {TOK_FGE, "FGE", "FGE"},
+    {TOK_FLE, "FLE", "FLE"},
+    {TOK_FGES, "FGES", "FGES"},
+    {TOK_FLES, "FLES", "FLES"},
+    {TOK_SUMC, "SUMC", "SUMC"},
+    {TOK_SUMNC, "SUMNC", "SUMNC"},
+    {TOK_SUMZ, "SUMZ", "SUMZ"},
+    {TOK_SUMNZ, "SUMNZ", "SUMNZ"},
+    {TOK_TESTB, "TESTB", "TESTB"},
+    {TOK_TESTBN, "TESTBN", "TESTBN"},
+    {TOK_BITL, "BITL", "BITL"},
+    {TOK_BITH, "BITH", "BITH"},
+    {TOK_BITC, "BITC", "BITC"},
+    {TOK_BITNC, "BITNC", "BITNC"},
+    {TOK_BITZ, "BITZ", "BITZ"},
+    {TOK_BITNZ, "BITNZ", "BITNZ"},
+    {TOK_BITRND, "BITRND", "BITRND"},
+    {TOK_BITNOT, "BITNOT", "BITNOT"},
+    {TOK_AND, "AND", "AND"},
+    {TOK_ANDN, "ANDN", "ANDN"},
+    {TOK_OR, "OR", "OR"},
+    {TOK_XOR, "XOR", "XOR"},
+    {TOK_MUXC, "MUXC", "MUXC"},
+    {TOK_MUXNC, "MUXNC", "MUXNC"},
+    {TOK_MUXZ, "MUXZ", "MUXZ"},
+    {TOK_MUXNZ, "MUXNZ", "MUXNZ"},
+    {TOK_MOV, "MOV", "MOV"},
+    {TOK_NOT, "NOT", "NOT"},
+    {TOK_ABS, "ABS", "ABS"},
+    {TOK_NEG, "NEG", "NEG"},
+    {TOK_NEGC, "NEGC", "NEGC"},
+    {TOK_NEGNC, "NEGNC", "NEGNC"},
+    {TOK_NEGZ, "NEGZ", "NEGZ"},
+    {TOK_NEGNZ, "NEGNZ", "NEGNZ"},
+    {TOK_INCMOD, "INCMOD", "INCMOD"},
+    {TOK_DECMOD, "DECMOD", "DECMOD"},
+    {TOK_ZEROX, "ZEROX", "ZEROX"},
+    {TOK_SIGNX, "SIGNX", "SIGNX"},
+    {TOK_ENCOD, "ENCOD", "ENCOD"},
+    {TOK_ONES, "ONES", "ONES"},
+    {TOK_TEST, "TEST", "TEST"},
+    {TOK_TESTN, "TESTN", "TESTN"},
+    {TOK_SETNIB, "SETNIB", "SETNIB"},
+    {TOK_GETNIB, "GETNIB", "GETNIB"},
+    {TOK_ROLNIB, "ROLNIB", "ROLNIB"},
+    {TOK_SETBYTE, "SETBYTE", "SETBYTE"},
+    {TOK_GETBYTE, "GETBYTE", "GETBYTE"},
+    {TOK_ROLBYTE, "ROLBYTE", "ROLBYTE"},
+    {TOK_SETWORD, "SETWORD", "SETWORD"},
+    {TOK_GETWORD, "GETWORD", "GETWORD"},
+    {TOK_ROLWORD, "ROLWORD", "ROLWORD"},
+    {TOK_ALTSN, "ALTSN", "ALTSN"},
+    {TOK_ALTGN, "ALTGN", "ALTGN"},
+    {TOK_ALTSB, "ALTSB", "ALTSB"},
+    {TOK_ALTGB, "ALTGB", "ALTGB"},
+    {TOK_ALTSW, "ALTSW", "ALTSW"},
+    {TOK_ALTGW, "ALTGW", "ALTGW"},
+    {TOK_ALTR, "ALTR", "ALTR"},
+    {TOK_ALTD, "ALTD", "ALTD"},
+    {TOK_ALTS, "ALTS", "ALTS"},
+    {TOK_ALTB, "ALTB", "ALTB"},
+    {TOK_ALTI, "ALTI", "ALTI"},
+    {TOK_SETR, "SETR", "SETR"},
+    {TOK_SETD, "SETD", "SETD"},
+    {TOK_SETS, "SETS", "SETS"},
+    {TOK_DECOD, "DECOD", "DECOD"},
+    {TOK_BMASK, "BMASK", "BMASK"},
+    {TOK_CRCBIT, "CRCBIT", "CRCBIT"},
+    {TOK_CRCNIB, "CRCNIB", "CRCNIB"},
+    {TOK_MUXNITS, "MUXNITS", "MUXNITS"},
+    {TOK_MUXNIBS, "MUXNIBS", "MUXNIBS"},
+    {TOK_MUXQ, "MUXQ", "MUXQ"},
+    {TOK_MOVBYTS, "MOVBYTS", "MOVBYTS"},
+    {TOK_MUL, "MUL", "MUL"},
+    {TOK_MULS, "MULS", "MULS"},
+    {TOK_SCA, "SCA", "SCA"},
+    {TOK_SCAS, "SCAS", "SCAS"},
+    {TOK_ADDPIX, "ADDPIX", "ADDPIX"},
+    {TOK_MULPIX, "MULPIX", "MULPIX"},
+    {TOK_BLNPIX, "BLNPIX", "BLNPIX"},
+    {TOK_MIXPIX, "MIXPIX", "MIXPIX"},
+    {TOK_ADDCT1, "ADDCT1", "ADDCT1"},
+    {TOK_ADDCT2, "ADDCT2", "ADDCT2"},
+    {TOK_ADDCT3, "ADDCT3", "ADDCT3"},
+    {TOK_WMLONG, "WMLONG", "WMLONG"},
+    {TOK_RQPIN, "RQPIN", "RQPIN"},
+    {TOK_RDPIN, "RDPIN", "RDPIN"},
+    {TOK_RDLUT, "RDLUT", "RDLUT"},
+    {TOK_RDBYTE, "RDBYTE", "RDBYTE"},
+    {TOK_RDWORD, "RDWORD", "RDWORD"},
+    {TOK_RDLONG, "RDLONG", "RDLONG"},
+    {TOK_POPA, "POPA", "POPA"},
+    {TOK_POPB, "POPB", "POPB"},
+    {TOK_CALLD, "CALLD", "CALLD"},
+    {TOK_RESI3, "RESI3", "RESI3"},
+    {TOK_RESI2, "RESI2", "RESI2"},
+    {TOK_RESI1, "RESI1", "RESI1"},
+    {TOK_RESI0, "RESI0", "RESI0"},
+    {TOK_RETI3, "RETI3", "RETI3"},
+    {TOK_RETI2, "RETI2", "RETI2"},
+    {TOK_RETI1, "RETI1", "RETI1"},
+    {TOK_RETI0, "RETI0", "RETI0"},
+    {TOK_CALLPA, "CALLPA", "CALLPA"},
+    {TOK_CALLPB, "CALLPB", "CALLPB"},
+    {TOK_DJZ, "DJZ", "DJZ"},
+    {TOK_DJNZ, "DJNZ", "DJNZ"},
+    {TOK_DJF, "DJF", "DJF"},
+    {TOK_DJNF, "DJNF", "DJNF"},
+    {TOK_IJZ, "IJZ", "IJZ"},
+    {TOK_IJNZ, "IJNZ", "IJNZ"},
+    {TOK_TJZ, "TJZ", "TJZ"},
+    {TOK_TJNZ, "TJNZ", "TJNZ"},
+    {TOK_TJF, "TJF", "TJF"},
+    {TOK_TJNF, "TJNF", "TJNF"},
+    {TOK_TJS, "TJS", "TJS"},
+    {TOK_TJNS, "TJNS", "TJNS"},
+    {TOK_TJV, "TJV", "TJV"},
+    {TOK_JINT, "JINT", "JINT"},
+    {TOK_JCT1, "JCT1", "JCT1"},
+    {TOK_JCT2, "JCT2", "JCT2"},
+    {TOK_JCT3, "JCT3", "JCT3"},
+    {TOK_JSE1, "JSE1", "JSE1"},
+    {TOK_JSE2, "JSE2", "JSE2"},
+    {TOK_JSE3, "JSE3", "JSE3"},
+    {TOK_JSE4, "JSE4", "JSE4"},
+    {TOK_JPAT, "JPAT", "JPAT"},
+    {TOK_JFBW, "JFBW", "JFBW"},
+    {TOK_JXMT, "JXMT", "JXMT"},
+    {TOK_JXFI, "JXFI", "JXFI"},
+    {TOK_JXRO, "JXRO", "JXRO"},
+    {TOK_JXRL, "JXRL", "JXRL"},
+    {TOK_JATN, "JATN", "JATN"},
+    {TOK_JQMT, "JQMT", "JQMT"},
+    {TOK_JNINT, "JNINT", "JNINT"},
+    {TOK_JNCT1, "JNCT1", "JNCT1"},
+    {TOK_JNCT2, "JNCT2", "JNCT2"},
+    {TOK_JNCT3, "JNCT3", "JNCT3"},
+    {TOK_JNSE1, "JNSE1", "JNSE1"},
+    {TOK_JNSE2, "JNSE2", "JNSE2"},
+    {TOK_JNSE3, "JNSE3", "JNSE3"},
+    {TOK_JNSE4, "JNSE4", "JNSE4"},
+    {TOK_JNPAT, "JNPAT", "JNPAT"},
+    {TOK_JNFBW, "JNFBW", "JNFBW"},
+    {TOK_JNXMT, "JNXMT", "JNXMT"},
+    {TOK_JNXFI, "JNXFI", "JNXFI"},
+    {TOK_JNXRO, "JNXRO", "JNXRO"},
+    {TOK_JNXRL, "JNXRL", "JNXRL"},
+    {TOK_JNATN, "JNATN", "JNATN"},
+    {TOK_JNQMT, "JNQMT", "JNQMT"},
+    {TOK_SETPAT, "SETPAT", "SETPAT"},
+    {TOK_AKPIN, "AKPIN", "AKPIN"},
+    {TOK_WRPIN, "WRPIN", "WRPIN"},
+    {TOK_WXPIN, "WXPIN", "WXPIN"},
+    {TOK_WYPIN, "WYPIN", "WYPIN"},
+    {TOK_WRLUT, "WRLUT", "WRLUT"},
+    {TOK_WRBYTE, "WRBYTE", "WRBYTE"},
+    {TOK_WRWORD, "WRWORD", "WRWORD"},
+    {TOK_WRLONG, "WRLONG", "WRLONG"},
+    {TOK_PUSHA, "PUSHA", "PUSHA"},
+    {TOK_PUSHB, "PUSHB", "PUSHB"},
+    {TOK_RDFAST, "RDFAST", "RDFAST"},
+    {TOK_WRFAST, "WRFAST", "WRFAST"},
+    {TOK_FBLOCK, "FBLOCK", "FBLOCK"},
+    {TOK_XINIT, "XINIT", "XINIT"},
+    {TOK_XSTOP, "XSTOP", "XSTOP"},
+    {TOK_XZERO, "XZERO", "XZERO"},
+    {TOK_XCONT, "XCONT", "XCONT"},
+    {TOK_REP, "REP", "REP"},
+    {TOK_COGINIT, "COGINIT", "COGINIT"},
+    {TOK_QMUL, "QMUL", "QMUL"},
+    {TOK_QDIV, "QDIV", "QDIV"},
+    {TOK_QFRAC, "QFRAC", "QFRAC"},
+    {TOK_QSQRT, "QSQRT", "QSQRT"},
+    {TOK_QROTATE, "QROTATE", "QROTATE"},
+    {TOK_QVECTOR, "QVECTOR", "QVECTOR"},
+    {TOK_HUBSET, "HUBSET", "HUBSET"},
+    {TOK_COGID, "COGID", "COGID"},
+    {TOK_COGSTOP, "COGSTOP", "COGSTOP"},
+    {TOK_LOCKNEW, "LOCKNEW", "LOCKNEW"},
+    {TOK_LOCKRET, "LOCKRET", "LOCKRET"},
+    {TOK_LOCKTRY, "LOCKTRY", "LOCKTRY"},
+    {TOK_LOCKREL, "LOCKREL", "LOCKREL"},
+    {TOK_QLOG, "QLOG", "QLOG"},
+    {TOK_QEXP, "QEXP", "QEXP"},
+    {TOK_RFBYTE, "RFBYTE", "RFBYTE"},
+    {TOK_RFWORD, "RFWORD", "RFWORD"},
+    {TOK_RFLONG, "RFLONG", "RFLONG"},
+    {TOK_RFVAR, "RFVAR", "RFVAR"},
+    {TOK_RFVARS, "RFVARS", "RFVARS"},
+    {TOK_WFBYTE, "WFBYTE", "WFBYTE"},
+    {TOK_WFWORD, "WFWORD", "WFWORD"},
+    {TOK_WFLONG, "WFLONG", "WFLONG"},
+    {TOK_GETQX, "GETQX", "GETQX"},
+    {TOK_GETQY, "GETQY", "GETQY"},
+    {TOK_GETCT, "GETCT", "GETCT"},
+    {TOK_GETRND, "GETRND", "GETRND"},
+    {TOK_SETDACS, "SETDACS", "SETDACS"},
+    {TOK_SETXFRQ, "SETXFRQ", "SETXFRQ"},
+    {TOK_FETXACC, "FETXACC", "FETXACC"},
+    {TOK_WAITX, "WAITX", "WAITX"},
+    {TOK_SETSE1, "SETSE1", "SETSE1"},
+    {TOK_SETSE2, "SETSE2", "SETSE2"},
+    {TOK_SETSE3, "SETSE3", "SETSE3"},
+    {TOK_SETSE4, "SETSE4", "SETSE4"},
+    {TOK_POLLINT, "POLLINT", "POLLINT"},
+    {TOK_POLLCT1, "POLLCT1", "POLLCT1"},
+    {TOK_POLLCT2, "POLLCT2", "POLLCT2"},
+    {TOK_POLLCT3, "POLLCT3", "POLLCT3"},
+    {TOK_POLLSE1, "POLLSE1", "POLLSE1"},
+    {TOK_POLLSE2, "POLLSE2", "POLLSE2"},
+    {TOK_POLLSE3, "POLLSE3", "POLLSE3"},
+    {TOK_POLLSE4, "POLLSE4", "POLLSE4"},
+    {TOK_POLLPAT, "POLLPAT", "POLLPAT"},
+    {TOK_POLLFBW, "POLLFBW", "POLLFBW"},
+    {TOK_POLLXMT, "POLLXMT", "POLLXMT"},
+    {TOK_POLLXFI, "POLLXFI", "POLLXFI"},
+    {TOK_POLLXRO, "POLLXRO", "POLLXRO"},
+    {TOK_POLLXRL, "POLLXRL", "POLLXRL"},
+    {TOK_POLLATN, "POLLATN", "POLLATN"},
+    {TOK_POLLQMT, "POLLQMT", "POLLQMT"},
+    {TOK_WAITINT, "WAITINT", "WAITINT"},
+    {TOK_WAITCT1, "WAITCT1", "WAITCT1"},
+    {TOK_WAITCT2, "WAITCT2", "WAITCT2"},
+    {TOK_WAITCT3, "WAITCT3", "WAITCT3"},
+    {TOK_WAITSE1, "WAITSE1", "WAITSE1"},
+    {TOK_WAITSE2, "WAITSE2", "WAITSE2"},
+    {TOK_WAITSE3, "WAITSE3", "WAITSE3"},
+    {TOK_WAITSE4, "WAITSE4", "WAITSE4"},
+    {TOK_WAITPAT, "WAITPAT", "WAITPAT"},
+    {TOK_WAITFBW, "WAITFBW", "WAITFBW"},
+    {TOK_WAITXMT, "WAITXMT", "WAITXMT"},
+    {TOK_WAITXFI, "WAITXFI", "WAITXFI"},
+    {TOK_WAITXRO, "WAITXRO", "WAITXRO"},
+    {TOK_WAITXRL, "WAITXRL", "WAITXRL"},
+    {TOK_WAITATN, "WAITATN", "WAITATN"},
+    {TOK_ALLOWI, "ALLOWI", "ALLOWI"},
+    {TOK_STALLI, "STALLI", "STALLI"},
+    {TOK_TRGINT1, "TRGINT1", "TRGINT1"},
+    {TOK_TRGINT2, "TRGINT2", "TRGINT2"},
+    {TOK_TRGINT3, "TRGINT3", "TRGINT3"},
+    {TOK_NIXINT1, "NIXINT1", "NIXINT1"},
+    {TOK_NIXINT2, "NIXINT2", "NIXINT2"},
+    {TOK_NIXINT3, "NIXINT3", "NIXINT3"},
+    {TOK_SETINT1, "SETINT1", "SETINT1"},
+    {TOK_SETINT2, "SETINT2", "SETINT2"},
+    {TOK_SETINT3, "SETINT3", "SETINT3"},
+    {TOK_SETQ, "SETQ", "SETQ"},
+    {TOK_SETQ2, "SETQ2", "SETQ2"},
+    {TOK_PUSH, "PUSH", "PUSH"},
+    {TOK_POP, "POP", "POP"},
+    {TOK_JMP, "JMP", "JMP"},
+    {TOK_CALL, "CALL", "CALL"},
+    {TOK_RET, "RET", "RET"},
+    {TOK_CALLA, "CALLA", "CALLA"},
+    {TOK_RETA, "RETA", "RETA"},
+    {TOK_CALLB, "CALLB", "CALLB"},
+    {TOK_RETB, "RETB", "RETB"},
+    {TOK_JMPREL, "JMPREL", "JMPREL"},
+    {TOK_SKIP, "SKIP", "SKIP"},
+    {TOK_SKIPF, "SKIPF", "SKIPF"},
+    {TOK_EXECF, "EXECF", "EXECF"},
+    {TOK_GETPTR, "GETPTR", "GETPTR"},
+    {TOK_GETBRK, "GETBRK", "GETBRK"},
+    {TOK_COGBRK, "COGBRK", "COGBRK"},
+    {TOK_BRK, "BRK", "BRK"},
+    {TOK_SETLUTS, "SETLUTS", "SETLUTS"},
+    {TOK_SETCY, "SETCY", "SETCY"},
+    {TOK_SETCI, "SETCI", "SETCI"},
+    {TOK_SETCQ, "SETCQ", "SETCQ"},
+    {TOK_SETCFRQ, "SETCFRQ", "SETCFRQ"},
+    {TOK_SETCMOD, "SETCMOD", "SETCMOD"},
+    {TOK_SETPIV, "SETPIV", "SETPIV"},
+    {TOK_SETPIX, "SETPIX", "SETPIX"},
+    {TOK_COGATN, "COGATN", "COGATN"},
+    {TOK_TESTP, "TESTP", "TESTP"},
+    {TOK_TESTPN, "TESTPN", "TESTPN"},
+    {TOK_DIRL, "DIRL", "DIRL"},
+    {TOK_DIRH, "DIRH", "DIRH"},
+    {TOK_DIRC, "DIRC", "DIRC"},
+    {TOK_DIRNC, "DIRNC", "DIRNC"},
+    {TOK_DIRZ, "DIRZ", "DIRZ"},
+    {TOK_DIRNZ, "DIRNZ", "DIRNZ"},
+    {TOK_DIRRND, "DIRRND", "DIRRND"},
+    {TOK_DIRNOT, "DIRNOT", "DIRNOT"},
+    {TOK_OUTL, "OUTL", "OUTL"},
+    {TOK_OUTH, "OUTH", "OUTH"},
+    {TOK_OUTC, "OUTC", "OUTC"},
+    {TOK_OUTNC, "OUTNC", "OUTNC"},
+    {TOK_OUTZ, "OUTZ", "OUTZ"},
+    {TOK_OUTNZ, "OUTNZ", "OUTNZ"},
+    {TOK_OUTRND, "OUTRND", "OUTRND"},
+    {TOK_OUTNOT, "OUTNOT", "OUTNOT"},
+    {TOK_FLTL, "FLTL", "FLTL"},
+    {TOK_FLTH, "FLTH", "FLTH"},
+    {TOK_FLTC, "FLTC", "FLTC"},
+    {TOK_FLTNC, "FLTNC", "FLTNC"},
+    {TOK_FLTZ, "FLTZ", "FLTZ"},
+    {TOK_FLTNZ, "FLTNZ", "FLTNZ"},
+    {TOK_FLTRND, "FLTRND", "FLTRND"},
+    {TOK_FLTNOT, "FLTNOT", "FLTNOT"},
+    {TOK_DRVL, "DRVL", "DRVL"},
+    {TOK_DRVH, "DRVH", "DRVH"},
+    {TOK_DRVC, "DRVC", "DRVC"},
+    {TOK_DRVNC, "DRVNC", "DRVNC"},
+    {TOK_DRVZ, "DRVZ", "DRVZ"},
+    {TOK_DRVNZ, "DRVNZ", "DRVNZ"},
+    {TOK_DRVRND, "DRVRND", "DRVRND"},
+    {TOK_DRVNOT, "DRVNOT", "DRVNOT"},
+    {TOK_SPLITB, "SPLITB", "SPLITB"},
+    {TOK_MERGEB, "MERGEB", "MERGEB"},
+    {TOK_SPLITW, "SPLITW", "SPLITW"},
+    {TOK_MERGEW, "MERGEW", "MERGEW"},
+    {TOK_SEUSSR, "SEUSSR", "SEUSSR"},
+    {TOK_RGBSQZ, "RGBSQZ", "RGBSQZ"},
+    {TOK_RGBEXP, "RGBEXP", "RGBEXP"},
+    {TOK_XORO32, "XORO32", "XORO32"},
+    {TOK_REV, "REV", "REV"},
+    {TOK_RCZR, "RCZR", "RCZR"},
+    {TOK_RCZL, "RCZL", "RCZL"},
+    {TOK_WRC, "WRC", "WRC"},
+    {TOK_RCNC, "RCNC", "RCNC"},
+    {TOK_WRZ, "WRZ", "WRZ"},
+    {TOK_RCNZ, "RCNZ", "RCNZ"},
+    {TOK_MODCZ, "MODCZ", "MODCZ"},
+    {TOK_MODC, "MODC", "MODC"},
+    {TOK_MODZ, "MODZ", "MODZ"},
+    {TOK_SETSCP, "SETSCP", "SETSCP"},
+    {TOK_GETSCP, "GETSCP", "GETSCP"},
+    {TOK_LOC, "LOC", "LOC"},
+    {TOK_AUGS, "AUGS", "AUGS"},
+    {TOK_AUGD, "AUGD", "AUGD"},
+    {TOK__RET_, "_RET_", "_RET_"},
+
+    {TOK_IF_NZ_AND_NC, "IF_NZ_AND_NC", "IF_NZ_AND_NC"},
+    {TOK_IF_NC_AND_NZ, "IF_NC_AND_NZ", "IF_NC_AND_NZ"},
+    {TOK_IF_A, "IF_A", "IF_A"},
+    {TOK_IF_GT, "IF_GT", "IF_GT"},
+    {TOK_IF_00, "IF_00", "IF_00"},
+    {TOK_IF_Z_AND_NC, "IF_Z_AND_NC", "IF_Z_AND_NC"},
+    {TOK_IF_NC_AND_Z, "IF_NC_AND_Z", "IF_NC_AND_Z"},
+    {TOK_IF_01, "IF_01", "IF_01"},
+    {TOK_IF_NC, "IF_NC", "IF_NC"},
+    {TOK_IF_AE, "IF_AE", "IF_AE"},
+    {TOK_IF_GE, "IF_GE", "IF_GE"},
+    {TOK_IF_0X, "IF_0X", "IF_0X"},
+    {TOK_IF_NZ_AND_C, "IF_NZ_AND_C", "IF_NZ_AND_C"},
+    {TOK_IF_C_AND_NZ, "IF_C_AND_NZ", "IF_C_AND_NZ"},
+    {TOK_IF_10, "IF_10", "IF_10"},
+    {TOK_IF_NZ, "IF_NZ", "IF_NZ"},
+    {TOK_IF_NE, "IF_NE", "IF_NE"},
+    {TOK_IF_X0, "IF_X0", "IF_X0"},
+    {TOK_IF_Z_NE_C, "IF_Z_NE_C", "IF_Z_NE_C"},
+    {TOK_IF_C_NE_Z, "IF_C_NE_Z", "IF_C_NE_Z"},
+    {TOK_IF_DIFF, "IF_DIFF", "IF_DIFF"},
+    {TOK_IF_NZ_OR_NC, "IF_NZ_OR_NC", "IF_NZ_OR_NC"},
+    {TOK_IF_NC_OR_NZ, "IF_NC_OR_NZ", "IF_NC_OR_NZ"},
+    {TOK_IF_NOT_11, "IF_NOT_11", "IF_NOT_11"},
+    {TOK_IF_Z_AND_C, "IF_Z_AND_C", "IF_Z_AND_C"},
+    {TOK_IF_C_AND_Z, "IF_C_AND_Z", "IF_C_AND_Z"},
+    {TOK_IF_11, "IF_11", "IF_11"},
+    {TOK_IF_Z_EQ_C, "IF_Z_EQ_C", "IF_Z_EQ_C"},
+    {TOK_IF_C_EQ_Z, "IF_C_EQ_Z", "IF_C_EQ_Z"},
+    {TOK_IF_SAME, "IF_SAME", "IF_SAME"},
+    {TOK_IF_Z, "IF_Z", "IF_Z"},
+    {TOK_IF_E, "IF_E", "IF_E"},
+    {TOK_IF_X1, "IF_X1", "IF_X1"},
+    {TOK_IF_Z_OR_NC, "IF_Z_OR_NC", "IF_Z_OR_NC"},
+    {TOK_IF_NC_OR_Z, "IF_NC_OR_Z", "IF_NC_OR_Z"},
+    {TOK_IF_NOT_10, "IF_NOT_10", "IF_NOT_10"},
+    {TOK_IF_C, "IF_C", "IF_C"},
+    {TOK_IF_B, "IF_B", "IF_B"},
+    {TOK_IF_LT, "IF_LT", "IF_LT"},
+    {TOK_IF_1X, "IF_1X", "IF_1X"},
+    {TOK_IF_NZ_OR_C, "IF_NZ_OR_C", "IF_NZ_OR_C"},
+    {TOK_IF_C_OR_NZ, "IF_C_OR_NZ", "IF_C_OR_NZ"},
+    {TOK_IF_NOT_01, "IF_NOT_01", "IF_NOT_01"},
+    {TOK_IF_Z_OR_C, "IF_Z_OR_C", "IF_Z_OR_C"},
+    {TOK_IF_C_OR_Z, "IF_C_OR_Z", "IF_C_OR_Z"},
+    {TOK_IF_BE, "IF_BE", "IF_BE"},
+    {TOK_IF_LE, "IF_LE", "IF_LE"},
+    {TOK_IF_NOT_00, "IF_NOT_00", "IF_NOT_00"},
+    {TOK_IF_ALWAYS, "IF_ALWAYS", "IF_ALWAYS"},
+
+    {TOK_ASSIGN, ":=", ":="},
+    {TOK_OP_XOR, "^^", "XOR (^^)"},
+    {TOK_OP_OR, "||", "OR (||)"},
+    {TOK_OP_AND, "&&", "AND (&&)"},
+    {TOK_OP_ORELSE, "__ORELSE__", "__ORELSE__"},
+    {TOK_OP_ANDTHEN, "__ANDTHEN__", "__ANDTHEN__"},
+    {TOK_OP_GE, "=>", "=>"},
+    {TOK_OP_LE, "=<", "=<"},
+    {TOK_OP_GEU, "+=>", "+=>"},
+    {TOK_OP_LEU, "+=<", "+=<"},
+    {TOK_OP_GTU, "+>", "+>"},
+    {TOK_OP_LTU, "+<", "+<"},
+    {TOK_OP_NE, "<>", "<>"},
+    {TOK_OP_EQ, "==", "=="},
+    {TOK_OP_SGNCOMP, "<=>", "<=>"},
+    {TOK_OP_LIMITMIN, "#>", "#>"},
+    {TOK_OP_LIMITMAX, "<#", "<#"},
+    {TOK_OP_REMAINDER, "//", "//"},
+    {TOK_OP_UNSDIV, "+/", "+/"},
+    {TOK_OP_UNSMOD, "+//", "+//"},
+    {TOK_OP_FRAC, "FRAC", "FRAC"},
+    {TOK_OP_HIGHMULT, "**", "**"},
+    {TOK_OP_SCAS, "SCAS", "SCAS"},
+    {TOK_OP_UNSHIGHMULT, "+**", "SCA (+**)"},
+    {TOK_OP_ROTR, "->", "ROR (->)"},
+    {TOK_OP_ROTL, "<-", "ROL (<-)"},
+    {TOK_OP_SHL, "<<", "<<"},
+    {TOK_OP_SHR, ">>", ">>"},
+    {TOK_OP_SAR, "~>", "SAR (~>)"},
+    {TOK_OP_REV, "><", "><"},
+    {TOK_OP_REV2, "REV", "REV"},
+    {TOK_OP_ADDBITS, "ADDBITS", "ADDBITS"},
+    {TOK_OP_ADDPINS, "ADDPINS", "ADDPINS"},
+    {TOK_OP_NEGATE, "-", "-"},
+    {TOK_OP_BIT_NOT, "!", "!"},
+    {TOK_OP_SQRT, "^^", "SQRT (^^)"},
+    {TOK_OP_ABS, "||", "ABS (||)"},
+    {TOK_OP_DECODE, "|<", "DECOD (|<)"},
+    {TOK_OP_ENCODE, ">|", ">|"},
+    {TOK_OP_ENCODE2, "ENCOD", "ENCOD"},
+    {TOK_OP_NOT, "!!", "NOT (!!)"},
+    {TOK_OP_DOUBLETILDE, "~~", "~~"},
+    {TOK_OP_INCREMENT, "++", "++"},
+    {TOK_OP_DECREMENT, "--", "--"},
+    {TOK_OP_DOUBLEAT, "@@", "@@"},
+    {TOK_OP_TRIPLEAT, "@@@", "@@@"},
+    {TOK_OP_FLOAT, nullptr, "floating point number"},
+    {TOK_OP_TRUNC, "TRUNC", "TRUNC"},
+    {TOK_OP_ROUND, "ROUND", "ROUND"},
+    {TOK_CONSTANT, nullptr, "constant"},
+    {TOK_RANDOM, "??", "??"},
+    {TOK_EMPTY, nullptr, "empty assignment marker _"},
+    {TOK_OP_SIGNX, "SIGNX", "SIGNX"},
+    {TOK_OP_ZEROX, "ZEROX", "ZEROX"},
+    {TOK_OP_ONES, "ONES", "ONES"},
+    {TOK_OP_BMASK, "BMASK", "BMASK"},
+    {TOK_OP_QLOG, "QLOG", "QLOG"},
+    {TOK_OP_QEXP, "QEXP", "QEXP"},
+    {TOK_OP_DEBUG, "DEBUG", "DEBUG"},
+    {TOK_LOOK_SEP, ":", ":"},
+};
+
+constexpr bool table_in_order()
 {
+    for (int i = 0; i < TOK_; i++)
+	if (token_table[i].tok != i)
+	    return false;
+    return true;
+}
+static_assert(table_in_order(), "token_table[] must list all tokens in PropToken order");
 
+constexpr int string_length(const char* str)
+{
+    int len = 0;
+    while (str && str[len])
+	len++;
+    return len;
 }
 
-PropToken CPropToken::tok() const
+constexpr int max_name_length()
 {
-    return m_token;
+    int max = 0;
+    for (int i = 0; i < TOK_; i++)
+	if (string_length(token_table[i].name) > max)
+	    max = string_length(token_table[i].name);
+    return max;
 }
 
-const QString& CPropToken::name() const
+//! Length of the longest token name
+constexpr int max_name_len = max_name_length();
+
+constexpr char upper(char ch)
 {
-    return m_name;
+    return (ch >= 'a' && ch <= 'z') ? static_cast<char>(ch - 'a' + 'A') : ch;
 }
 
-const QString& CPropToken::desc() const
+/**
+ * @brief The three hash values of a name, computed in one pass
+ *
+ * Names are hashed case-insensitively. @p bucket selects the bucket,
+ * @p base and @p step give the slot for the bucket's displacement d
+ * as (base + d * step) modulo hash_slots.
+ */
+struct NameHash {
+    quint32 bucket;
+    quint32 base;
+    quint32 step;
+};
+
+constexpr NameHash hash_add(NameHash h, char ch)
 {
-    return m_desc;
+    const quint32 c = static_cast<uchar>(upper(ch));
+    return NameHash{
+	(h.bucket ^ c) * 16777619u,
+	(h.base ^ c) * 0x01000193u * 31u + c,
+	(h.step ^ c) * 2654435761u
+    };
 }
 
-CPropTokens::CPropTokens()
-    : m_tokens()
+constexpr NameHash hash_init()
 {
-    add(TOK_CPP_IF, "#if", "Preprocessor condition");
-    add(TOK_CPP_ELSE, "#else", "Preprocessor condition");
-    add(TOK_CPP_ENDIF, "#endif", "Preprocessor condition");
-    add(TOK_CPP_IFDEF, "#ifdef", "Preprocessor condition");
-    add(TOK_CPP_IFNDEF, "#ifndef", "Preprocessor condition");
-    add(TOK_CPP_ELIF, "#elif", "Preprocessor condition");
-    add(TOK_CPP_ELIFDEF, "#elifdef", "Preprocessor condition");
-    add(TOK_CPP_ELIFNDEF, "#elifndef", "Preprocessor condition");
-    add(TOK_CPP_DEFINE, "#define", "Preprocessor definition");
-    add(TOK_CPP_UNDEF, "#undef", "Preprocessor definition remove");
+    return NameHash{2166136261u, 0x9e3779b9u, 0x7f4a7c15u};
+}
 
-    add(TOK_CON, "CON", "CON");
-    add(TOK_VAR, "VAR", "VAR");
-    add(TOK_DAT, "DAT", "DAT");
-    add(TOK_PUB, "PUB", "PUB");
-    add(TOK_PRI, "PRI", "PRI");
-    add(TOK_OBJ, "OBJ", "OBJ");
-    add(TOK_ASM, "ASM", "ASM");
-    add(TOK_ENDASM, "ENDASM", "ENDASM");
-    add(TOK_END, "END", "END");
-    add(TOK_INLINECCODE, "CCODE", "CCODE");
+constexpr NameHash hash_name(const char* name)
+{
+    NameHash h = hash_init();
+    for (int i = 0; name[i]; i++)
+	h = hash_add(h, name[i]);
+    return h;
+}
+
+constexpr bool same_name(const char* a, const char* b)
+{
+    for (int i = 0; ; i++) {
+	if (upper(a[i]) != upper(b[i]))
+	    return false;
+	if (!a[i])
+	    return true;
+    }
+}
+
+//! Number of buckets of the perfect hash
+constexpr int hash_buckets = 256;
+//! Number of slots of the perfect hash (a power of two)
+constexpr int hash_slots = 1024;
+//! Maximum number of names per bucket
+constexpr int hash_bucket_max = 16;
+
+/**
+ * @brief Perfect hash over the token names
+ *
+ * Each bucket has a displacement chosen such that all names map to
+ * distinct slots. A slot holds the token of its name, or -1. Of names
+ * shared by several tokens only the first token is stored.
+ */
+struct PerfectHash {
+    quint16 disp[hash_buckets];
+    qint16 slot[hash_slots];
+};
 
-    add(TOK_BYTE, "BYTE", "BYTE");
-    add(TOK_WORD, "WORD", "WORD");
-    add(TOK_LONG, "LONG", "LONG");
-    add(TOK_FVAR, "FVAR", "FVAR");
-    add(TOK_FVARS, "FVARS", "FVARS");
-    add(TOK_ASMCLK, "ASMCLK", "ASMCLK");
+// not constexpr: calling it makes the compiler reject a table which cannot be built
+void perfect_hash_failed()
+{
+}
 
-    add(TOK_INSTR, nullptr, "instruction");
-    add(TOK_INSTRMODIFIER, nullptr, "instruction modifier");
-    add(TOK_HWREG, nullptr, "hardware register");
-    add(TOK_ORG, "ORG", "ORG");
-    add(TOK_ORGH, "ORGH", "ORGH");
-    add(TOK_ORGF, "ORGF", "ORGF");
-    add(TOK_RES, "RES", "RES");
-    add(TOK_FIT, "FIT", "FIT");
-    add(TOK_ALIGNL, "ALIGNL", "ALIGNL");
-    add(TOK_ALIGNW, "ALIGNW", "ALIGNW");
+constexpr PerfectHash build_perfect_hash()
+{
+    PerfectHash ph{};
+    NameHash hash[TOK_] {};
+    int next[TOK_] {};
+    int head[hash_buckets] {};
+    int size[hash_buckets] {};
 
-    add(TOK_REPEAT, "REPEAT", "REPEAT");
-    add(TOK_FROM, "FROM", "FROM");
-    add(TOK_TO, "TO", "TO");
-    add(TOK_STEP, "STEP", "STEP");
-    add(TOK_WHILE, "WHILE", "WHILE");
-    add(TOK_UNTIL, "UNTIL", "UNTIL");
-    add(TOK_IF, "IF", "IF");
-    add(TOK_IFNOT, "IFNOT", "IFNOT");
-    add(TOK_ELSE, "ELSE", "ELSE");
-    add(TOK_ELSEIF, "ELSEIF", "ELSEIF");
-    add(TOK_ELSEIFNOT, "ELSEIFNOT", "ELSEIFNOT");
-    add(TOK_THEN, "THEN", "THEN");
-    add(TOK_ENDIF, "ENDIF", "ENDIF");
+    for (int s = 0; s < hash_slots; s++)
+	ph.slot[s] = -1;
+    for (int b = 0; b < hash_buckets; b++)
+	head[b] = -1;
 
-    add(TOK_LOOKDOWN, "LOOKDOWN", "LOOKDOWN");
-    add(TOK_LOOKDOWNZ, "LOOKDOWNZ", "LOOKDOWNZ");
-    add(TOK_LOOKUP, "LOOKUP", "LOOKUP");
-    add(TOK_LOOKUPZ, "LOOKUPZ", "LOOKUPZ");
-    add(TOK_COGINIT2, "COGINIT", "COGINIT");
-    add(TOK_COGNEW, "COGNEW", "COGNEW");
+    // hash the names and chain them by bucket, dropping duplicate names
+    for (int t = 0; t < TOK_; t++) {
+	if (!token_table[t].name || !token_table[t].name[0])
+	    continue;
+	hash[t] = hash_name(token_table[t].name);
+	const int b = static_cast<int>(hash[t].bucket % hash_buckets);
+	bool dup = false;
+	for (int k = head[b]; k >= 0 && !dup; k = next[k])
+	    dup = same_name(token_table[k].name, token_table[t].name);
+	if (dup)
+	    continue;
+	next[t] = head[b];
+	head[b] = t;
+	size[b]++;
+    }
 
-    add(TOK_CASE, "CASE", "CASE");
-    add(TOK_CASE_FAST, "CASE_FAST", "CASE_FAST");
-    add(TOK_OTHER, "OTHER", "OTHER");
+    // place the largest buckets first
+    for (int n = hash_bucket_max; n > 0; n--) {
+	for (int b = 0; b < hash_buckets; b++) {
+	    if (size[b] > hash_bucket_max)
+		perfect_hash_failed();
+	    if (size[b] != n)
+		continue;
+	    bool placed = false;
+	    for (int d = 0; d < hash_slots && !placed; d++) {
+		int used[hash_bucket_max] {};
+		int count = 0;
+		placed = true;
+		for (int k = head[b]; k >= 0 && placed; k = next[k]) {
+		    const int s = static_cast<int>((hash[k].base + d * (hash[k].step | 1u)) % hash_slots);
+		    if (ph.slot[s] >= 0)
+			placed = false;
+		    for (int u = 0; u < count && placed; u++)
+			if (used[u] == s)
+			    placed = false;
+		    used[count++] = s;
+		}
+		if (!placed)
+		    continue;
+		count = 0;
+		for (int k = head[b]; k >= 0; k = next[k])
+		    ph.slot[used[count++]] = static_cast<qint16>(k);
+		ph.disp[b] = static_cast<quint16>(d);
+	    }
+	    if (!placed)
+		perfect_hash_failed();
+	}
+    }
+    return ph;
+}
 
-    add(TOK_QUIT, "QUIT", "QUIT");
-    add(TOK_NEXT, "NEXT", "NEXT");
+//! Perfect hash built by the compiler
+constexpr PerfectHash perfect_hash = build_perfect_hash();
 
-    add(TOK_ALLOCA, "__BUILTIN_ALLOCA", "__BUILTIN_ALLOCA");
+}
 
-    add(TOK_ABORT, "ABORT", "ABORT");
-    add(TOK_RESULT, "RESULT", "RESULT");
-    add(TOK_RETURN, "RETURN", "RETURN");
-    add(TOK_INDENT, nullptr, "indentation");
-    add(TOK_OUTDENT, nullptr, "lack of indentation");
-    add(TOK_EOLN, nullptr, "end of line");
-    add(TOK_EOF, nullptr, "end of file");
-    add(TOK_DOTS, "..", "..");
-    add(TOK_HERE, "$", "$");
-    add(TOK_STRINGPTR, nullptr, "STRING");
-    add(TOK_FILE, nullptr, "FILE");
+CPropTokens::CPropTokens()
+    : m_lists()
+    , m_esc_lists()
+{
+}
 
-    add(TOK_NOP, "NOP", "No operation");
-    add(TOK_ROR, "ROR", "ROR");
-    add(TOK_ROL, "ROL", "ROL");
-    add(TOK_SHR, "SHR", "SHR");
-    add(TOK_SHL, "SHL", "SHL");
-    add(TOK_RCR, "RCR", "RCR");
-    add(TOK_RCL, "RCL", "RCL");
-    add(TOK_SAR, "SAR", "SAR");
-    add(TOK_SAL, "SAL", "SAL");
-    add(TOK_ADD, "ADD", "ADD");
-    add(TOK_ADDX, "ADDX", "ADDX");
-    add(TOK_ADDS, "ADDS", "ADDS");
-    add(TOK_ADDSX, "ADDSX", "ADDSX");
-    add(TOK_SUB, "SUB", "SUB");
-    add(TOK_SUBX, "SUBX", "SUBX");
-    add(TOK_SUBS, "SUBS", "SUBS");
-    add(TOK_SUBSX, "SUBSX", "SUBSX");
-    add(TOK_CMP, "CMP", "CMP");
-    add(TOK_CMPX, "CMPX", "CMPX");
-    add(TOK_CMPS, "CMPS", "CMPS");
-    add(TOK_CMPSX, "CMPSX", "CMPSX");
-    add(TOK_CMPR, "CMPR", "CMPR");
-    add(TOK_CMPM, "CMPM", "CMPM");
-    add(TOK_SUBR, "SUBR", "SUBR");
-    add(TOK_CMPSUB, "CMPSUB", "CMPSUB");
-    add(TOK_FGE, "FGE", "FGE");
-    add(TOK_FLE, "FLE", "FLE");
-    add(TOK_FGES, "FGES", "FGES");
-    add(TOK_FLES, "FLES", "FLES");
-    add(TOK_SUMC, "SUMC", "SUMC");
-    add(TOK_SUMNC, "SUMNC", "SUMNC");
-    add(TOK_SUMZ, "SUMZ", "SUMZ");
-    add(TOK_SUMNZ, "SUMNZ", "SUMNZ");
-    add(TOK_TESTB, "TESTB", "TESTB");
-    add(TOK_TESTBN, "TESTBN", "TESTBN");
-    add(TOK_BITL, "BITL", "BITL");
-    add(TOK_BITH, "BITH", "BITH");
-    add(TOK_BITC, "BITC", "BITC");
-    add(TOK_BITNC, "BITNC", "BITNC");
-    add(TOK_BITZ, "BITZ", "BITZ");
-    add(TOK_BITNZ, "BITNZ", "BITNZ");
-    add(TOK_BITRND, "BITRND", "BITRND");
-    add(TOK_BITNOT, "BITNOT", "BITNOT");
-    add(TOK_AND, "AND", "AND");
-    add(TOK_ANDN, "ANDN", "ANDN");
-    add(TOK_OR, "OR", "OR");
-    add(TOK_XOR, "XOR", "XOR");
-    add(TOK_MUXC, "MUXC", "MUXC");
-    add(TOK_MUXNC, "MUXNC", "MUXNC");
-    add(TOK_MUXZ, "MUXZ", "MUXZ");
-    add(TOK_MUXNZ, "MUXNZ", "MUXNZ");
-    add(TOK_MOV, "MOV", "MOV");
-    add(TOK_NOT, "NOT", "NOT");
-    add(TOK_ABS, "ABS", "ABS");
-    add(TOK_NEG, "NEG", "NEG");
-    add(TOK_NEGC, "NEGC", "NEGC");
-    add(TOK_NEGNC, "NEGNC", "NEGNC");
-    add(TOK_NEGZ, "NEGZ", "NEGZ");
-    add(TOK_NEGNZ, "NEGNZ", "NEGNZ");
-    add(TOK_INCMOD, "INCMOD", "INCMOD");
-    add(TOK_DECMOD, "DECMOD", "DECMOD");
-    add(TOK_ZEROX, "ZEROX", "ZEROX");
-    add(TOK_SIGNX, "SIGNX", "SIGNX");
-    add(TOK_ENCOD, "ENCOD", "ENCOD");
-    add(TOK_ONES, "ONES", "ONES");
-    add(TOK_TEST, "TEST", "TEST");
-    add(TOK_TESTN, "TESTN", "TESTN");
-    add(TOK_SETNIB, "SETNIB", "SETNIB");
-    add(TOK_GETNIB, "GETNIB", "GETNIB");
-    add(TOK_ROLNIB, "ROLNIB", "ROLNIB");
-    add(TOK_SETBYTE, "SETBYTE", "SETBYTE");
-    add(TOK_GETBYTE, "GETBYTE", "GETBYTE");
-    add(TOK_ROLBYTE, "ROLBYTE", "ROLBYTE");
-    add(TOK_SETWORD, "SETWORD", "SETWORD");
-    add(TOK_GETWORD, "GETWORD", "GETWORD");
-    add(TOK_ROLWORD, "ROLWORD", "ROLWORD");
-    add(TOK_ALTSN, "ALTSN", "ALTSN");
-    add(TOK_ALTGN, "ALTGN", "ALTGN");
-    add(TOK_ALTSB, "ALTSB", "ALTSB");
-    add(TOK_ALTGB, "ALTGB", "ALTGB");
-    add(TOK_ALTSW, "ALTSW", "ALTSW");
-    add(TOK_ALTGW, "ALTGW", "ALTGW");
-    add(TOK_ALTR, "ALTR", "ALTR");
-    add(TOK_ALTD, "ALTD", "ALTD");
-    add(TOK_ALTS, "ALTS", "ALTS");
-    add(TOK_ALTB, "ALTB", "ALTB");
-    add(TOK_ALTI, "ALTI", "ALTI");
-    add(TOK_SETR, "SETR", "SETR");
-    add(TOK_SETD, "SETD", "SETD");
-    add(TOK_SETS, "SETS", "SETS");
-    add(TOK_DECOD, "DECOD", "DECOD");
-    add(TOK_BMASK, "BMASK", "BMASK");
-    add(TOK_CRCBIT, "CRCBIT", "CRCBIT");
-    add(TOK_CRCNIB, "CRCNIB", "CRCNIB");
-    add(TOK_MUXNITS, "MUXNITS", "MUXNITS");
-    add(TOK_MUXNIBS, "MUXNIBS", "MUXNIBS");
-    add(TOK_MUXQ, "MUXQ", "MUXQ");
-    add(TOK_MOVBYTS, "MOVBYTS", "MOVBYTS");
-    add(TOK_MUL, "MUL", "MUL");
-    add(TOK_MULS, "MULS", "MULS");
-    add(TOK_SCA, "SCA", "SCA");
-    add(TOK_SCAS, "SCAS", "SCAS");
-    add(TOK_ADDPIX, "ADDPIX", "ADDPIX");
-    add(TOK_MULPIX, "MULPIX", "MULPIX");
-    add(TOK_BLNPIX, "BLNPIX", "BLNPIX");
-    add(TOK_MIXPIX, "MIXPIX", "MIXPIX");
-    add(TOK_ADDCT1, "ADDCT1", "ADDCT1");
-    add(TOK_ADDCT2, "ADDCT2", "ADDCT2");
-    add(TOK_ADDCT3, "ADDCT3", "ADDCT3");
-    add(TOK_WMLONG, "WMLONG", "WMLONG");
-    add(TOK_RQPIN, "RQPIN", "RQPIN");
-    add(TOK_RDPIN, "RDPIN", "RDPIN");
-    add(TOK_RDLUT, "RDLUT", "RDLUT");
-    add(TOK_RDBYTE, "RDBYTE", "RDBYTE");
-    add(TOK_RDWORD, "RDWORD", "RDWORD");
-    add(TOK_RDLONG, "RDLONG", "RDLONG");
-    add(TOK_POPA, "POPA", "POPA");
-    add(TOK_POPB, "POPB", "POPB");
-    add(TOK_CALLD, "CALLD", "CALLD");
-    add(TOK_RESI3, "RESI3", "RESI3");
-    add(TOK_RESI2, "RESI2", "RESI2");
-    add(TOK_RESI1, "RESI1", "RESI1");
-    add(TOK_RESI0, "RESI0", "RESI0");
-    add(TOK_RETI3, "RETI3", "RETI3");
-    add(TOK_RETI2, "RETI2", "RETI2");
-    add(TOK_RETI1, "RETI1", "RETI1");
-    add(TOK_RETI0, "RETI0", "RETI0");
-    add(TOK_CALLPA, "CALLPA", "CALLPA");
-    add(TOK_CALLPB, "CALLPB", "CALLPB");
-    add(TOK_DJZ, "DJZ", "DJZ");
-    add(TOK_DJNZ, "DJNZ", "DJNZ");
-    add(TOK_DJF, "DJF", "DJF");
-    add(TOK_DJNF, "DJNF", "DJNF");
-    add(TOK_IJZ, "IJZ", "IJZ");
-    add(TOK_IJNZ, "IJNZ", "IJNZ");
-    add(TOK_TJZ, "TJZ", "TJZ");
-    add(TOK_TJNZ, "TJNZ", "TJNZ");
-    add(TOK_TJF, "TJF", "TJF");
-    add(TOK_TJNF, "TJNF", "TJNF");
-    add(TOK_TJS, "TJS", "TJS");
-    add(TOK_TJNS, "TJNS", "TJNS");
-    add(TOK_TJV, "TJV", "TJV");
-    add(TOK_JINT, "JINT", "JINT");
-    add(TOK_JCT1, "JCT1", "JCT1");
-    add(TOK_JCT2, "JCT2", "JCT2");
-    add(TOK_JCT3, "JCT3", "JCT3");
-    add(TOK_JSE1, "JSE1", "JSE1");
-    add(TOK_JSE2, "JSE2", "JSE2");
-    add(TOK_JSE3, "JSE3", "JSE3");
-    add(TOK_JSE4, "JSE4", "JSE4");
-    add(TOK_JPAT, "JPAT", "JPAT");
-    add(TOK_JFBW, "JFBW", "JFBW");
-    add(TOK_JXMT, "JXMT", "JXMT");
-    add(TOK_JXFI, "JXFI", "JXFI");
-    add(TOK_JXRO, "JXRO", "JXRO");
-    add(TOK_JXRL, "JXRL", "JXRL");
-    add(TOK_JATN, "JATN", "JATN");
-    add(TOK_JQMT, "JQMT", "JQMT");
-    add(TOK_JNINT, "JNINT", "JNINT");
-    add(TOK_JNCT1, "JNCT1", "JNCT1");
-    add(TOK_JNCT2, "JNCT2", "JNCT2");
-    add(TOK_JNCT3, "JNCT3", "JNCT3");
-    add(TOK_JNSE1, "JNSE1", "JNSE1");
-    add(TOK_JNSE2, "JNSE2", "JNSE2");
-    add(TOK_JNSE3, "JNSE3", "JNSE3");
-    add(TOK_JNSE4, "JNSE4", "JNSE4");
-    add(TOK_JNPAT, "JNPAT", "JNPAT");
-    add(TOK_JNFBW, "JNFBW", "JNFBW");
-    add(TOK_JNXMT, "JNXMT", "JNXMT");
-    add(TOK_JNXFI, "JNXFI", "JNXFI");
-    add(TOK_JNXRO, "JNXRO", "JNXRO");
-    add(TOK_JNXRL, "JNXRL", "JNXRL");
-    add(TOK_JNATN, "JNATN", "JNATN");
-    add(TOK_JNQMT, "JNQMT", "JNQMT");
-    add(TOK_SETPAT, "SETPAT", "SETPAT");
-    add(TOK_AKPIN, "AKPIN", "AKPIN");
-    add(TOK_WRPIN, "WRPIN", "WRPIN");
-    add(TOK_WXPIN, "WXPIN", "WXPIN");
-    add(TOK_WYPIN, "WYPIN", "WYPIN");
-    add(TOK_WRLUT, "WRLUT", "WRLUT");
-    add(TOK_WRBYTE, "WRBYTE", "WRBYTE");
-    add(TOK_WRWORD, "WRWORD", "WRWORD");
-    add(TOK_WRLONG, "WRLONG", "WRLONG");
-    add(TOK_PUSHA, "PUSHA", "PUSHA");
-    add(TOK_PUSHB, "PUSHB", "PUSHB");
-    add(TOK_RDFAST, "RDFAST", "RDFAST");
-    add(TOK_WRFAST, "WRFAST", "WRFAST");
-    add(TOK_FBLOCK, "FBLOCK", "FBLOCK");
-    add(TOK_XINIT, "XINIT", "XINIT");
-    add(TOK_XSTOP, "XSTOP", "XSTOP");
-    add(TOK_XZERO, "XZERO", "XZERO");
-    add(TOK_XCONT, "XCONT", "XCONT");
-    add(TOK_REP, "REP", "REP");
-    add(TOK_COGINIT, "COGINIT", "COGINIT");
-    add(TOK_QMUL, "QMUL", "QMUL");
-    add(TOK_QDIV, "QDIV", "QDIV");
-    add(TOK_QFRAC, "QFRAC", "QFRAC");
-    add(TOK_QSQRT, "QSQRT", "QSQRT");
-    add(TOK_QROTATE, "QROTATE", "QROTATE");
-    add(TOK_QVECTOR, "QVECTOR", "QVECTOR");
-    add(TOK_HUBSET, "HUBSET", "HUBSET");
-    add(TOK_COGID, "COGID", "COGID");
-    add(TOK_COGSTOP, "COGSTOP", "COGSTOP");
-    add(TOK_LOCKNEW, "LOCKNEW", "LOCKNEW");
-    add(TOK_LOCKRET, "LOCKRET", "LOCKRET");
-    add(TOK_LOCKTRY, "LOCKTRY", "LOCKTRY");
-    add(TOK_LOCKREL, "LOCKREL", "LOCKREL");
-    add(TOK_QLOG, "QLOG", "QLOG");
-    add(TOK_QEXP, "QEXP", "QEXP");
-    add(TOK_RFBYTE, "RFBYTE", "RFBYTE");
-    add(TOK_RFWORD, "RFWORD", "RFWORD");
-    add(TOK_RFLONG, "RFLONG", "RFLONG");
-    add(TOK_RFVAR, "RFVAR", "RFVAR");
-    add(TOK_RFVARS, "RFVARS", "RFVARS");
-    add(TOK_WFBYTE, "WFBYTE", "WFBYTE");
-    add(TOK_WFWORD, "WFWORD", "WFWORD");
-    add(TOK_WFLONG, "WFLONG", "WFLONG");
-    add(TOK_GETQX, "GETQX", "GETQX");
-    add(TOK_GETQY, "GETQY", "GETQY");
-    add(TOK_GETCT, "GETCT", "GETCT");
-    add(TOK_GETRND, "GETRND", "GETRND");
-    add(TOK_SETDACS, "SETDACS", "SETDACS");
-    add(TOK_SETXFRQ, "SETXFRQ", "SETXFRQ");
-    add(TOK_FETXACC, "FETXACC", "FETXACC");
-    add(TOK_WAITX, "WAITX", "WAITX");
-    add(TOK_SETSE1, "SETSE1", "SETSE1");
-    add(TOK_SETSE2, "SETSE2", "SETSE2");
-    add(TOK_SETSE3, "SETSE3", "SETSE3");
-    add(TOK_SETSE4, "SETSE4", "SETSE4");
-    add(TOK_POLLINT, "POLLINT", "POLLINT");
-    add(TOK_POLLCT1, "POLLCT1", "POLLCT1");
-    add(TOK_POLLCT2, "POLLCT2", "POLLCT2");
-    add(TOK_POLLCT3, "POLLCT3", "POLLCT3");
-    add(TOK_POLLSE1, "POLLSE1", "POLLSE1");
-    add(TOK_POLLSE2, "POLLSE2", "POLLSE2");
-    add(TOK_POLLSE3, "POLLSE3", "POLLSE3");
-    add(TOK_POLLSE4, "POLLSE4", "POLLSE4");
-    add(TOK_POLLPAT, "POLLPAT", "POLLPAT");
-    add(TOK_POLLFBW, "POLLFBW", "POLLFBW");
-    add(TOK_POLLXMT, "POLLXMT", "POLLXMT");
-    add(TOK_POLLXFI, "POLLXFI", "POLLXFI");
-    add(TOK_POLLXRO, "POLLXRO", "POLLXRO");
-    add(TOK_POLLXRL, "POLLXRL", "POLLXRL");
-    add(TOK_POLLATN, "POLLATN", "POLLATN");
-    add(TOK_POLLQMT, "POLLQMT", "POLLQMT");
-    add(TOK_WAITINT, "WAITINT", "WAITINT");
-    add(TOK_WAITCT1, "WAITCT1", "WAITCT1");
-    add(TOK_WAITCT2, "WAITCT2", "WAITCT2");
-    add(TOK_WAITCT3, "WAITCT3", "WAITCT3");
-    add(TOK_WAITSE1, "WAITSE1", "WAITSE1");
-    add(TOK_WAITSE2, "WAITSE2", "WAITSE2");
-    add(TOK_WAITSE3, "WAITSE3", "WAITSE3");
-    add(TOK_WAITSE4, "WAITSE4", "WAITSE4");
-    add(TOK_WAITPAT, "WAITPAT", "WAITPAT");
-    add(TOK_WAITFBW, "WAITFBW", "WAITFBW");
-    add(TOK_WAITXMT, "WAITXMT", "WAITXMT");
-    add(TOK_WAITXFI, "WAITXFI", "WAITXFI");
-    add(TOK_WAITXRO, "WAITXRO", "WAITXRO");
-    add(TOK_WAITXRL, "WAITXRL", "WAITXRL");
-    add(TOK_WAITATN, "WAITATN", "WAITATN");
-    add(TOK_ALLOWI, "ALLOWI", "ALLOWI");
-    add(TOK_STALLI, "STALLI", "STALLI");
-    add(TOK_TRGINT1, "TRGINT1", "TRGINT1");
-    add(TOK_TRGINT2, "TRGINT2", "TRGINT2");
-    add(TOK_TRGINT3, "TRGINT3", "TRGINT3");
-    add(TOK_NIXINT1, "NIXINT1", "NIXINT1");
-    add(TOK_NIXINT2, "NIXINT2", "NIXINT2");
-    add(TOK_NIXINT3, "NIXINT3", "NIXINT3");
-    add(TOK_SETINT1, "SETINT1", "SETINT1");
-    add(TOK_SETINT2, "SETINT2", "SETINT2");
-    add(TOK_SETINT3, "SETINT3", "SETINT3");
-    add(TOK_SETQ, "SETQ", "SETQ");
-    add(TOK_SETQ2, "SETQ2", "SETQ2");
-    add(TOK_PUSH, "PUSH", "PUSH");
-    add(TOK_POP, "POP", "POP");
-    add(TOK_JMP, "JMP", "JMP");
-    add(TOK_CALL, "CALL", "CALL");
-    add(TOK_RET, "RET", "RET");
-    add(TOK_CALLA, "CALLA", "CALLA");
-    add(TOK_RETA, "RETA", "RETA");
-    add(TOK_CALLB, "CALLB", "CALLB");
-    add(TOK_RETB, "RETB", "RETB");
-    add(TOK_JMPREL, "JMPREL", "JMPREL");
-    add(TOK_SKIP, "SKIP", "SKIP");
-    add(TOK_SKIPF, "SKIPF", "SKIPF");
-    add(TOK_EXECF, "EXECF", "EXECF");
-    add(TOK_GETPTR, "GETPTR", "GETPTR");
-    add(TOK_GETBRK, "GETBRK", "GETBRK");
-    add(TOK_COGBRK, "COGBRK", "COGBRK");
-    add(TOK_BRK, "BRK", "BRK");
-    add(TOK_SETLUTS, "SETLUTS", "SETLUTS");
-    add(TOK_SETCY, "SETCY", "SETCY");
-    add(TOK_SETCI, "SETCI", "SETCI");
-    add(TOK_SETCQ, "SETCQ", "SETCQ");
-    add(TOK_SETCFRQ, "SETCFRQ", "SETCFRQ");
-    add(TOK_SETCMOD, "SETCMOD", "SETCMOD");
-    add(TOK_SETPIV, "SETPIV", "SETPIV");
-    add(TOK_SETPIX, "SETPIX", "SETPIX");
-    add(TOK_COGATN, "COGATN", "COGATN");
-    add(TOK_TESTP, "TESTP", "TESTP");
-    add(TOK_TESTPN, "TESTPN", "TESTPN");
-    add(TOK_DIRL, "DIRL", "DIRL");
-    add(TOK_DIRH, "DIRH", "DIRH");
-    add(TOK_DIRC, "DIRC", "DIRC");
-    add(TOK_DIRNC, "DIRNC", "DIRNC");
-    add(TOK_DIRZ, "DIRZ", "DIRZ");
-    add(TOK_DIRNZ, "DIRNZ", "DIRNZ");
-    add(TOK_DIRRND, "DIRRND", "DIRRND");
-    add(TOK_DIRNOT, "DIRNOT", "DIRNOT");
-    add(TOK_OUTL, "OUTL", "OUTL");
-    add(TOK_OUTH, "OUTH", "OUTH");
-    add(TOK_OUTC, "OUTC", "OUTC");
-    add(TOK_OUTNC, "OUTNC", "OUTNC");
-    add(TOK_OUTZ, "OUTZ", "OUTZ");
-    add(TOK_OUTNZ, "OUTNZ", "OUTNZ");
-    add(TOK_OUTRND, "OUTRND", "OUTRND");
-    add(TOK_OUTNOT, "OUTNOT", "OUTNOT");
-    add(TOK_FLTL, "FLTL", "FLTL");
-    add(TOK_FLTH, "FLTH", "FLTH");
-    add(TOK_FLTC, "FLTC", "FLTC");
-    add(TOK_FLTNC, "FLTNC", "FLTNC");
-    add(TOK_FLTZ, "FLTZ", "FLTZ");
-    add(TOK_FLTNZ, "FLTNZ", "FLTNZ");
-    add(TOK_FLTRND, "FLTRND", "FLTRND");
-    add(TOK_FLTNOT, "FLTNOT", "FLTNOT");
-    add(TOK_DRVL, "DRVL", "DRVL");
-    add(TOK_DRVH, "DRVH", "DRVH");
-    add(TOK_DRVC, "DRVC", "DRVC");
-    add(TOK_DRVNC, "DRVNC", "DRVNC");
-    add(TOK_DRVZ, "DRVZ", "DRVZ");
-    add(TOK_DRVNZ, "DRVNZ", "DRVNZ");
-    add(TOK_DRVRND, "DRVRND", "DRVRND");
-    add(TOK_DRVNOT, "DRVNOT", "DRVNOT");
-    add(TOK_SPLITB, "SPLITB", "SPLITB");
-    add(TOK_MERGEB, "MERGEB", "MERGEB");
-    add(TOK_SPLITW, "SPLITW", "SPLITW");
-    add(TOK_MERGEW, "MERGEW", "MERGEW");
-    add(TOK_SEUSSR, "SEUSSR", "SEUSSR");
-    add(TOK_RGBSQZ, "RGBSQZ", "RGBSQZ");
-    add(TOK_RGBEXP, "RGBEXP", "RGBEXP");
-    add(TOK_XORO32, "XORO32", "XORO32");
-    add(TOK_REV, "REV", "REV");
-    add(TOK_RCZR, "RCZR", "RCZR");
-    add(TOK_RCZL, "RCZL", "RCZL");
-    add(TOK_WRC, "WRC", "WRC");
-    add(TOK_RCNC, "RCNC", "RCNC");
-    add(TOK_WRZ, "WRZ", "WRZ");
-    add(TOK_RCNZ, "RCNZ", "RCNZ");
-    add(TOK_MODCZ, "MODCZ", "MODCZ");
-    add(TOK_MODC, "MODC", "MODC");
-    add(TOK_MODZ, "MODZ", "MODZ");
-    add(TOK_SETSCP, "SETSCP", "SETSCP");
-    add(TOK_GETSCP, "GETSCP", "GETSCP");
-    add(TOK_LOC, "LOC", "LOC");
-    add(TOK_AUGS, "AUGS", "AUGS");
-    add(TOK_AUGD, "AUGD", "AUGD");
-    add(TOK__RET_, "_RET_", "_RET_");
+/**
+ * @brief Return the token named @p len characters at @p str
+ *
+ * Names are compared case-insensitively. Of names shared by
+ * several tokens, the first token is returned.
+ * @param str pointer to the characters of the name
+ * @param len number of characters
+ * @return PropToken, or TOK_0 if there is no such token
+ */
+PropToken CPropTokens::token(const QChar* str, int len) const
+{
+    if (len <= 0 || len > max_name_len)
+	return TOK_0;
+    NameHash h = hash_init();
+    for (int i = 0; i < len; i++) {
+	const ushort uc = str[i].unicode();
+	if (uc >= 0x80)
+	    return TOK_0;
+	h = hash_add(h, static_cast<char>(uc));
+    }
+    const quint32 d = perfect_hash.disp[h.bucket % hash_buckets];
+    const int t = perfect_hash.slot[(h.base + d * (h.step | 1u)) % hash_slots];
+    if (t < 0)
+	return TOK_0;
+    const char* name = token_table[t].name;
+    for (int i = 0; i < len; i++)
+	if (upper(name[i]) != upper(static_cast<char>(str[i].unicode())))
+	    return TOK_0;
+    return name[len] ? TOK_0 : static_cast<PropToken>(t);
+}
 
-    add(TOK_IF_NZ_AND_NC, "IF_NZ_AND_NC", "IF_NZ_AND_NC");
-    add(TOK_IF_NC_AND_NZ, "IF_NC_AND_NZ", "IF_NC_AND_NZ");
-    add(TOK_IF_A, "IF_A", "IF_A");
-    add(TOK_IF_GT, "IF_GT", "IF_GT");
-    add(TOK_IF_00, "IF_00", "IF_00");
-    add(TOK_IF_Z_AND_NC, "IF_Z_AND_NC", "IF_Z_AND_NC");
-    add(TOK_IF_NC_AND_Z, "IF_NC_AND_Z", "IF_NC_AND_Z");
-    add(TOK_IF_01, "IF_01", "IF_01");
-    add(TOK_IF_NC, "IF_NC", "IF_NC");
-    add(TOK_IF_AE, "IF_AE", "IF_AE");
-    add(TOK_IF_GE, "IF_GE", "IF_GE");
-    add(TOK_IF_0X, "IF_0X", "IF_0X");
-    add(TOK_IF_NZ_AND_C, "IF_NZ_AND_C", "IF_NZ_AND_C");
-    add(TOK_IF_C_AND_NZ, "IF_C_AND_NZ", "IF_C_AND_NZ");
-    add(TOK_IF_10, "IF_10", "IF_10");
-    add(TOK_IF_NZ, "IF_NZ", "IF_NZ");
-    add(TOK_IF_NE, "IF_NE", "IF_NE");
-    add(TOK_IF_X0, "IF_X0", "IF_X0");
-    add(TOK_IF_Z_NE_C, "IF_Z_NE_C", "IF_Z_NE_C");
-    add(TOK_IF_C_NE_Z, "IF_C_NE_Z", "IF_C_NE_Z");
-    add(TOK_IF_DIFF, "IF_DIFF", "IF_DIFF");
-    add(TOK_IF_NZ_OR_NC, "IF_NZ_OR_NC", "IF_NZ_OR_NC");
-    add(TOK_IF_NC_OR_NZ, "IF_NC_OR_NZ", "IF_NC_OR_NZ");
-    add(TOK_IF_NOT_11, "IF_NOT_11", "IF_NOT_11");
-    add(TOK_IF_Z_AND_C, "IF_Z_AND_C", "IF_Z_AND_C");
-    add(TOK_IF_C_AND_Z, "IF_C_AND_Z", "IF_C_AND_Z");
-    add(TOK_IF_11, "IF_11", "IF_11");
-    add(TOK_IF_Z_EQ_C, "IF_Z_EQ_C", "IF_Z_EQ_C");
-    add(TOK_IF_C_EQ_Z, "IF_C_EQ_Z", "IF_C_EQ_Z");
-    add(TOK_IF_SAME, "IF_SAME", "IF_SAME");
-    add(TOK_IF_Z, "IF_Z", "IF_Z");
-    add(TOK_IF_E, "IF_E", "IF_E");
-    add(TOK_IF_X1, "IF_X1", "IF_X1");
-    add(TOK_IF_Z_OR_NC, "IF_Z_OR_NC", "IF_Z_OR_NC");
-    add(TOK_IF_NC_OR_Z, "IF_NC_OR_Z", "IF_NC_OR_Z");
-    add(TOK_IF_NOT_10, "IF_NOT_10", "IF_NOT_10");
-    add(TOK_IF_C, "IF_C", "IF_C");
-    add(TOK_IF_B, "IF_B", "IF_B");
-    add(TOK_IF_LT, "IF_LT", "IF_LT");
-    add(TOK_IF_1X, "IF_1X", "IF_1X");
-    add(TOK_IF_NZ_OR_C, "IF_NZ_OR_C", "IF_NZ_OR_C");
-    add(TOK_IF_C_OR_NZ, "IF_C_OR_NZ", "IF_C_OR_NZ");
-    add(TOK_IF_NOT_01, "IF_NOT_01", "IF_NOT_01");
-    add(TOK_IF_Z_OR_C, "IF_Z_OR_C", "IF_Z_OR_C");
-    add(TOK_IF_C_OR_Z, "IF_C_OR_Z", "IF_C_OR_Z");
-    add(TOK_IF_BE, "IF_BE", "IF_BE");
-    add(TOK_IF_LE, "IF_LE", "IF_LE");
-    add(TOK_IF_NOT_00, "IF_NOT_00", "IF_NOT_00");
-    add(TOK_IF_ALWAYS, "IF_ALWAYS", "IF_ALWAYS");
+/**
+ * @brief Return the token named @p name
+ * @param name const reference to the name
+ * @return PropToken, or TOK_0 if there is no such token
+ */
+PropToken CPropTokens::token(const QString& name) const
+{
+    return token(name.constData(), name.length());
+}
 
-    add(TOK_ASSIGN, ":=", ":=");
-    add(TOK_OP_XOR, "^^", "XOR (^^)");
-    add(TOK_OP_OR, "||", "OR (||)");
-    add(TOK_OP_AND, "&&", "AND (&&)");
-    add(TOK_OP_ORELSE, "__ORELSE__", "__ORELSE__");
-    add(TOK_OP_ANDTHEN, "__ANDTHEN__", "__ANDTHEN__");
-    add(TOK_OP_GE, "=>", "=>");
-    add(TOK_OP_LE, "=<", "=<");
-    add(TOK_OP_GEU, "+=>", "+=>");
-    add(TOK_OP_LEU, "+=<", "+=<");
-    add(TOK_OP_GTU, "+>", "+>");
-    add(TOK_OP_LTU, "+<", "+<");
-    add(TOK_OP_NE, "<>", "<>");
-    add(TOK_OP_EQ, "==", "==");
-    add(TOK_OP_SGNCOMP, "<=>", "<=>");
-    add(TOK_OP_LIMITMIN, "#>", "#>");
-    add(TOK_OP_LIMITMAX, "<#", "<#");
-    add(TOK_OP_REMAINDER, "//", "//");
-    add(TOK_OP_UNSDIV, "+/", "+/");
-    add(TOK_OP_UNSMOD, "+//", "+//");
-    add(TOK_OP_FRAC, "FRAC", "FRAC");
-    add(TOK_OP_HIGHMULT, "**", "**");
-    add(TOK_OP_SCAS, "SCAS", "SCAS");
-    add(TOK_OP_UNSHIGHMULT, "+**", "SCA (+**)");
-    add(TOK_OP_ROTR, "->", "ROR (->)");
-    add(TOK_OP_ROTL, "<-", "ROL (<-)");
-    add(TOK_OP_SHL, "<<", "<<");
-    add(TOK_OP_SHR, ">>", ">>");
-    add(TOK_OP_SAR, "~>", "SAR (~>)");
-    add(TOK_OP_REV, "><", "><");
-    add(TOK_OP_REV2, "REV", "REV");
-    add(TOK_OP_ADDBITS, "ADDBITS", "ADDBITS");
-    add(TOK_OP_ADDPINS, "ADDPINS", "ADDPINS");
-    add(TOK_OP_NEGATE, "-", "-");
-    add(TOK_OP_BIT_NOT, "!", "!");
-    add(TOK_OP_SQRT, "^^", "SQRT (^^)");
-    add(TOK_OP_ABS, "||", "ABS (||)");
-    add(TOK_OP_DECODE, "|<", "DECOD (|<)");
-    add(TOK_OP_ENCODE, ">|", ">|");
-    add(TOK_OP_ENCODE2, "ENCOD", "ENCOD");
-    add(TOK_OP_NOT, "!!", "NOT (!!)");
-    add(TOK_OP_DOUBLETILDE, "~~", "~~");
-    add(TOK_OP_INCREMENT, "++", "++");
-    add(TOK_OP_DECREMENT, "--", "--");
-    add(TOK_OP_DOUBLEAT, "@@", "@@");
-    add(TOK_OP_TRIPLEAT, "@@@", "@@@");
-    add(TOK_OP_FLOAT, nullptr, "floating point number");
-    add(TOK_OP_TRUNC, "TRUNC", "TRUNC");
-    add(TOK_OP_ROUND, "ROUND", "ROUND");
-    add(TOK_CONSTANT, nullptr, "constant");
-    add(TOK_RANDOM, "??", "??");
-    add(TOK_EMPTY, nullptr, "empty assignment marker _");
-    add(TOK_OP_SIGNX, "SIGNX", "SIGNX");
-    add(TOK_OP_ZEROX, "ZEROX", "ZEROX");
-    add(TOK_OP_ONES, "ONES", "ONES");
-    add(TOK_OP_BMASK, "BMASK", "BMASK");
-    add(TOK_OP_QLOG, "QLOG", "QLOG");
-    add(TOK_OP_QEXP, "QEXP", "QEXP");
-    add(TOK_OP_DEBUG, "DEBUG", "DEBUG");
-    add(TOK_LOOK_SEP, ":", ":");
+/**
+ * @brief Return the name of token @p t
+ * @return QLatin1String with the name, which is null for tokens without name
+ */
+QLatin1String CPropTokens::name(PropToken t) const
+{
+    if (t < TOK_0 || t >= TOK_)
+	return QLatin1String();
+    return QLatin1String(token_table[t].name);
 }
 
-void CPropTokens::add(const PropToken t, const QString& name, const QString& desc)
+/**
+ * @brief Return the description of token @p t
+ * @return QLatin1String with the description
+ */
+QLatin1String CPropTokens::desc(PropToken t) const
 {
-    m_tokens.insert(t, CPropToken(t, name, desc));
+    if (t < TOK_0 || t >= TOK_)
+	return QLatin1String();
+    return QLatin1String(token_table[t].desc);
 }
 
+/**
+ * @brief Return the names of the tokens in @p filter, or of all tokens
+ *
+ * The lists are built once per filter and then shared.
+ * @param filter list of tokens, or an empty list for all tokens
+ * @return QStringList with the names
+ */
 QStringList CPropTokens::list(const QList<PropToken>& filter) const
 {
+    auto it = m_lists.constFind(filter);
+    if (it != m_lists.constEnd())
+	return it.value();
+
     QStringList list;
     if (filter.isEmpty()) {
 	list.reserve(TOK_);
-	foreach(const CPropToken& tok, m_tokens.values())
-	    if (!tok.name().isNull())
-		list += tok.name();
+	for (int t = 0; t < TOK_; t++)
+	    if (token_table[t].name)
+		list += QLatin1String(token_table[t].name);
     } else {
 	list.reserve(filter.count());
 	foreach(const PropToken t, filter) {
-	    const CPropToken& tok = m_tokens.value(t);
-	    if (!tok.name().isNull())
-		list += tok.name();
+	    if (t > TOK_0 && t < TOK_ && token_table[t].name)
+		list += QLatin1String(token_table[t].name);
 	}
     }
+    m_lists.insert(filter, list);
     return list;
 }
 
+/**
+ * @brief Return the names of list() escaped for use in a QRegExp
+ * @param filter list of tokens, or an empty list for all tokens
+ * @return QStringList with the escaped names
+ */
 QStringList CPropTokens::list_esc(const QList<PropToken>& filter) const
 {
+    auto it = m_esc_lists.constFind(filter);
+    if (it != m_esc_lists.constEnd())
+	return it.value();
+
     QStringList list;
-    if (filter.isEmpty()) {
-	list.reserve(TOK_);
-	foreach(const CPropToken& tok, m_tokens.values())
-	    if (!tok.name().isNull())
-		list += QRegExp::escape(tok.name());
-    } else {
-	list.reserve(filter.count());
-	foreach(const PropToken t, filter) {
-	    const CPropToken& tok = m_tokens.value(t);
-	    if (!tok.name().isNull())
-		list += QRegExp::escape(tok.name());
-	}
-    }
+    foreach(const QString& name, CPropTokens::list(filter))
+	list += QRegExp::escape(name);
+    m_esc_lists.insert(filter, list);
     return list;
 }
 
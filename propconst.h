@@ -10,7 +10,8 @@
 #pragma once
 
 #include <QString>
-#include <QMap>
+#include <QStringList>
+#include <QHash>
 #include <QList>
 
 typedef enum {
@@ -573,32 +574,28 @@ typedef enum {
     TOK_
 }   PropToken;
 
-class CPropToken
-{
-public:
-    CPropToken(const PropToken t = TOK_0, const QString& name = QString(), const QString& desc = QString());
-
-    PropToken tok() const;
-    const QString& name() const;
-    const QString& desc() const;
-
-private:
-    PropToken m_token;
-    QString m_name;
-    QString m_desc;
-};
-
+/**
+ * @brief Access to the table of tokens
+ *
+ * The table and a perfect hash over the token names are built at
+ * compile time. Looking up a name does not allocate, and the lists
+ * for the highlighter's regular expressions are built once per filter.
+ */
 class CPropTokens
 {
 public:
     CPropTokens();
 
-    void add(const PropToken t, const QString& name = QString(), const QString& desc = QString());
+    PropToken token(const QChar* str, int len) const;
+    PropToken token(const QString& name) const;
+    QLatin1String name(PropToken t) const;
+    QLatin1String desc(PropToken t) const;
     QStringList list(const QList<PropToken>& filter = QList<PropToken>()) const;
     QStringList list_esc(const QList<PropToken>& filter = QList<PropToken>()) const;
 
 private:
-    QMap<PropToken,CPropToken> m_tokens;
+    mutable QHash<QList<PropToken>,QStringList> m_lists;	//!< cache of list() results
+    mutable QHash<QList<PropToken>,QStringList> m_esc_lists;	//!< cache of list_esc() results
 };
 
 extern const CPropTokens g_tokens;
@@ -1,9 +1,14 @@
 #include <QDateTime>
+#include <QFile>
+#include <QSerialPort>
+#include <QtEndian>
+#include <cstring>
+#include <algorithm>
+#include "loadelf.h"
 #include "propload.h"
+#include "trace.h"
 #include "util.h"
 
-#define	WAIT_FOR_BYTES_WRITTEN	0
-
 PropLoad::PropLoad(QIODevice* dev, QObject* parent)
     : QObject(parent)
     , m_dev(dev)
@@ -13,7 +18,42 @@ PropLoad::PropLoad(QIODevice* dev, QObject* parent)
     , m_clock_mode(0)
     , m_user_baud(Serial_Baud230400)
     , m_use_checksum(true)
+    , m_inflight(default_inflight)
+    , m_reply_timeout(1000)
+    , m_state(St_Idle)
+    , m_upload_mode(Prop_Hex)
+    , m_buffer()
+    , m_data_size(0)
+    , m_total(0)
+    , m_written(0)
+    , m_sent(0)
+    , m_checksum(0)
+    , m_reply_timer(this)
+    , m_pump_pending(false)
+    , m_stage2()
+    , m_stage2_pending(false)
+    , m_segments()
+    , m_fills_done(0)
+    , m_flash_image()
+    , m_flash_sectors()
+    , m_flash_done(0)
+    , m_flash_boot(false)
+    , m_reply()
+    , m_fast_baud(0)
+    , m_saved_baud(0)
+    , m_ping_timer(this)
+    , m_header_size(0)
+    , m_trace_start(0)
+    , m_trace_name(nullptr)
 {
+    m_reply_timer.setSingleShot(true);
+    bool ok = connect(&m_reply_timer, &QTimer::timeout,
+		      this, &PropLoad::reply_timeout_expired);
+    Q_ASSERT(ok);
+    m_ping_timer.setInterval(stage2_ping_interval);
+    ok = connect(&m_ping_timer, &QTimer::timeout,
+		 this, &PropLoad::ping_stage2);
+    Q_ASSERT(ok);
 }
 
 /**
@@ -62,16 +102,109 @@ bool PropLoad::use_checksum() const
 }
 
 /**
- * @brief Load a
- * @return bool true if checksum is to be used
+ * @brief Return the checksum of the most recent upload
+ * @return checksum value sent to (Prop_Hex, Prop_Txt) or verified by (Prop_Bin) the Prop
+ */
+quint32 PropLoad::checksum() const
+{
+    return m_checksum;
+}
+
+/**
+ * @brief Return the second stage loader binary
+ * @return binary image of the loader
+ */
+QByteArray PropLoad::stage2_loader() const
+{
+    return m_stage2;
+}
+
+/**
+ * @brief Return the baud rate to switch to for uploads
+ * @return baud rate, or 0 to keep the current one
+ */
+quint32 PropLoad::fast_baud() const
+{
+    return m_fast_baud;
+}
+
+/**
+ * @brief Return the maximum number of bytes in flight
+ * @return number of bytes
+ */
+qint64 PropLoad::inflight() const
+{
+    return m_inflight;
+}
+
+/**
+ * @brief Return the checksum reply timeout
+ * @return timeout in milliseconds
+ */
+int PropLoad::reply_timeout() const
+{
+    return m_reply_timeout;
+}
+
+/**
+ * @brief Return true while an upload is in progress
+ * @return bool true if busy
+ */
+bool PropLoad::is_busy() const
+{
+    return m_state != St_Idle;
+}
+
+/**
+ * @brief Start loading a block of data
+ *
+ * The upload runs asynchronously and its result is reported
+ * through the Finished() signal.
+ *
+ * @param data const reference to the data block to send
+ * @param patch_mode if true, patch in the clock frequence, mode, and user baud
+ * @return true if the upload was started, or false on error
  */
 bool PropLoad::load_data(const QByteArray& data, bool patch_mode)
 {
+    TRACE_SCOPE("PropLoad::load_data");
+    if (St_Idle != m_state) {
+	emit Error(tr("An upload is already in progress."));
+	return false;
+    }
+    m_trace_start = Trace::enabled() ? Trace::now_ns() : 0;
+    m_trace_name = "PropLoad::upload (data)";
+    m_upload_mode = m_mode;
     switch (m_mode) {
     case Prop_Hex:
-	return load_single_data_hex(data, patch_mode);
     case Prop_Txt:
-	return load_single_data_txt(data, patch_mode);
+	if (m_verbose)
+	    emit Message(tr("Loading %1 bytes.")
+			 .arg(data.size()));
+	encode_image(data, m_mode, patch_mode);
+	return start_upload(data);
+
+    case Prop_Bin:
+	if (m_stage2.isEmpty() && !m_stage2_pending) {
+	    emit Error(tr("No second stage loader for binary upload."));
+	    return false;
+	}
+	{
+	    Segment segment;
+	    segment.addr = 0;
+	    segment.data = data;
+	    segment.zero = 0;
+	    if (patch_mode) {
+		if (segment.data.size() < 0x20)
+		    segment.data.append(0x20 - segment.data.size(), 0);
+		util.put_le32(segment.data, 0x14, m_clock_freq);
+		util.put_le32(segment.data, 0x18, m_clock_mode);
+		util.put_le32(segment.data, 0x1c, m_user_baud);
+	    }
+	    m_segments.clear();
+	    m_segments.append(segment);
+	}
+	return load_stage2();
     }
     emit Error(tr("Invalid PropMode (%2).")
 	       .arg(m_mode));
@@ -83,6 +216,182 @@ bool PropLoad::load_file(const QString& filename, bool patch_mode)
     return load_single_file(filename, patch_mode);
 }
 
+/**
+ * @brief Upload the PT_LOAD segments of the ELF file @p filename
+ *
+ * Only the populated address ranges are sent to the second stage
+ * loader, which fills the gaps between them and their uninitialized
+ * parts with zeroes, so the upload time depends on the size of the
+ * contents rather than on the address span. Cog driver images above
+ * LoadElf::COG_DRIVER_IMAGE_BASE are placed in hub memory behind the
+ * program, in the order of their addresses.
+ *
+ * @param filename const reference to a fully qualified filename to upload
+ * @param patch_mode if true, patch in the clock frequence, mode, and user baud
+ * @return true if the upload was started, or false on error
+ */
+bool PropLoad::load_elf(const QString& filename, bool patch_mode)
+{
+    TRACE_SCOPE("PropLoad::load_elf");
+    if (St_Idle != m_state) {
+	emit Error(tr("An upload is already in progress."));
+	return false;
+    }
+    if (m_stage2.isEmpty() && !m_stage2_pending) {
+	emit Error(tr("No second stage loader for ELF upload."));
+	return false;
+    }
+    m_trace_start = Trace::enabled() ? Trace::now_ns() : 0;
+    m_trace_name = "PropLoad::upload (ELF)";
+    if (!load_elf_segments(filename, patch_mode))
+	return false;
+    // ELF images always go through the second stage loader
+    m_upload_mode = Prop_Bin;
+    return load_stage2();
+}
+
+/**
+ * @brief Write @p image to the SPI flash, programming only the sectors which differ
+ *
+ * The second stage loader is uploaded first. It hashes the flash
+ * sectors covered by the image, and only the sectors whose hash does
+ * not match the image's are erased, programmed, and verified. Then
+ * the chip is reset to boot from the flash.
+ *
+ * With @p boot, @p image is a hub image as flexspin builds it. The
+ * second stage loader's flash boot stub is then written in front of it,
+ * which loads the image to hub memory and starts it after the reset.
+ * Without it, @p image is a complete flash image with its own boot code.
+ *
+ * @param image const reference to the image
+ * @param boot true to put the flash boot stub in front of @p image
+ * @return true if the upload was started, or false on error
+ */
+bool PropLoad::flash_data(const QByteArray& image, bool boot)
+{
+    TRACE_SCOPE("PropLoad::flash_data");
+    if (St_Idle != m_state) {
+	emit Error(tr("An upload is already in progress."));
+	return false;
+    }
+    if (m_stage2.isEmpty() && !m_stage2_pending) {
+	emit Error(tr("No second stage loader for flash programming."));
+	return false;
+    }
+    if (image.isEmpty()) {
+	emit Error(tr("The flash image is empty."));
+	return false;
+    }
+    m_trace_start = Trace::enabled() ? Trace::now_ns() : 0;
+    m_trace_name = "PropLoad::upload (flash)";
+    m_flash_image = image;
+    m_flash_boot = boot;
+    if (!m_flash_boot && m_flash_image.size() % flash_sector)
+	m_flash_image.append(flash_sector - m_flash_image.size() % flash_sector, '\xff');
+    m_segments.clear();
+    // the flash is programmed by the second stage loader
+    m_upload_mode = Prop_Bin;
+    return load_stage2();
+}
+
+/**
+ * @brief Read the segments of the ELF file @p filename into m_segments
+ * @param filename const reference to a fully qualified filename
+ * @param patch_mode if true, patch in the clock frequence, mode, and user baud
+ * @return true on success, or false on error
+ */
+bool PropLoad::load_elf_segments(const QString& filename, bool patch_mode)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+	emit Error(tr("Could not open '%1' for reading.")
+		   .arg(filename));
+	return false;
+    }
+    LoadElf elf;
+    bool ok;
+    ok = connect(&elf, &LoadElf::Message,
+		 this, &PropLoad::Error);
+    Q_ASSERT(ok);
+    if (!elf.open(&file)) {
+	emit Error(tr("File '%1' is not a valid ELF file.")
+		   .arg(filename));
+	return false;
+    }
+    quint32 start = 0, size = 0, cog_images_size = 0;
+    if (!elf.program_size(start, size, cog_images_size))
+	return false;
+
+    QVector<ElfProgramHdr> programs;
+    quint32 cog_images_start = 0xffffffffUL;
+    for (int i = 0; i < elf.program_count(); ++i) {
+	ElfProgramHdr program;
+	if (elf.load_program_table_entry(static_cast<quint16>(i), program) < 0)
+	    continue;
+	if (LoadElf::PT_LOAD != program.type || 0 == program.memsz)
+	    continue;
+	if (program.paddr >= LoadElf::COG_DRIVER_IMAGE_BASE)
+	    cog_images_start = qMin(cog_images_start, program.paddr);
+	programs.append(program);
+    }
+    std::sort(programs.begin(), programs.end(),
+	      [](const ElfProgramHdr& a, const ElfProgramHdr& b) { return a.paddr < b.paddr; });
+
+    // the cog images follow the program, long aligned
+    const quint32 cog_images_base = (start + size + 3) & ~3u;
+    m_segments.clear();
+    qint64 contents = 0;
+    for (const ElfProgramHdr& program : programs) {
+	Segment segment;
+	segment.addr = program.paddr < LoadElf::COG_DRIVER_IMAGE_BASE
+		       ? program.paddr
+		       : cog_images_base + (program.paddr - cog_images_start);
+	segment.data = elf.load_program_segment(program);
+	if (static_cast<quint32>(segment.data.size()) != program.filesz) {
+	    emit Error(tr("Can't read the ELF segment at 0x%1.")
+		       .arg(program.paddr, 8, 16, QChar('0')));
+	    return false;
+	}
+	segment.zero = program.memsz > program.filesz ? program.memsz - program.filesz : 0;
+	if (!m_segments.isEmpty()) {
+	    // zero fill the gap behind the previous segment
+	    Segment& prev = m_segments.last();
+	    const quint32 end = prev.addr + static_cast<quint32>(prev.data.size()) + prev.zero;
+	    if (segment.addr < end) {
+		emit Error(tr("ELF segments overlap at 0x%1.")
+			   .arg(segment.addr, 8, 16, QChar('0')));
+		return false;
+	    }
+	    prev.zero += segment.addr - end;
+	}
+	contents += segment.data.size();
+	m_segments.append(segment);
+    }
+    if (m_segments.isEmpty()) {
+	emit Error(tr("File '%1' has no loadable segments.")
+		   .arg(filename));
+	return false;
+    }
+
+    if (patch_mode) {
+	Segment& first = m_segments.first();
+	if (first.addr == 0 && first.data.size() >= 0x20) {
+	    util.put_le32(first.data, 0x14, m_clock_freq);
+	    util.put_le32(first.data, 0x18, m_clock_mode);
+	    util.put_le32(first.data, 0x1c, m_user_baud);
+	}
+    }
+
+    if (m_verbose)
+	emit Message(tr("Loaded '%1' %2 segments with %3 bytes spanning %4 bytes, %5 bytes of cog images.")
+		     .arg(filename)
+		     .arg(m_segments.size())
+		     .arg(contents)
+		     .arg(size)
+		     .arg(cog_images_size));
+    return true;
+}
+
 void PropLoad::set_verbose(bool on)
 {
     m_verbose = on;
@@ -113,6 +422,81 @@ void PropLoad::set_use_checksum(bool use_checksum)
     m_use_checksum = use_checksum;
 }
 
+/**
+ * @brief Set the maximum number of bytes written but not yet sent
+ *
+ * This keeps the device's output buffer filled so that the line stays
+ * saturated without queueing the whole image in the driver.
+ *
+ * @param inflight number of bytes (at least one block)
+ */
+void PropLoad::set_inflight(qint64 inflight)
+{
+    m_inflight = qMax<qint64>(chunksize, inflight);
+}
+
+/**
+ * @brief Set the second stage loader binary for Prop_Bin mode
+ *
+ * The loader must be built from loader/stage2.spin2 for the
+ * clock frequency and the baud rate set with set_fast_baud().
+ * An upload waiting for it in St_Loader is continued, or fails if
+ * @p binary is empty.
+ *
+ * @param binary binary image of the loader
+ */
+void PropLoad::set_stage2_loader(const QByteArray& binary)
+{
+    m_stage2 = binary;
+    m_stage2_pending = false;
+    if (St_Loader != m_state)
+	return;
+    m_reply_timer.stop();
+    if (m_stage2.isEmpty()) {
+	emit Error(tr("The second stage loader could not be built."));
+	finish(false);
+	return;
+    }
+    if (!load_stage2())
+	finish(false);
+}
+
+/**
+ * @brief Mark the second stage loader as being built
+ *
+ * While it is pending, an upload which needs it waits in St_Loader
+ * until set_stage2_loader() delivers it, instead of failing.
+ *
+ * @param on true if the loader will be set with set_stage2_loader()
+ */
+void PropLoad::set_stage2_pending(bool on)
+{
+    m_stage2_pending = on;
+}
+
+/**
+ * @brief Set the baud rate to switch to for uploads
+ *
+ * A serial port is switched to this baud rate after the loader header
+ * has been sent, and the second stage loader also talks at this rate.
+ * The previous baud rate is restored before Finished() is emitted.
+ *
+ * @param baud baud rate, or 0 to keep the current one
+ */
+void PropLoad::set_fast_baud(quint32 baud)
+{
+    m_fast_baud = baud;
+}
+
+/**
+ * @brief Set the time to wait for the checksum reply
+ * @param msecs timeout in milliseconds
+ */
+void PropLoad::set_reply_timeout(int msecs)
+{
+    m_reply_timeout = msecs;
+}
+
 /**
  * @brief Compute a checksum of unsigned 32 bit little endian values in @p data
  * @param data const reference to the byte array to checksum
@@ -120,284 +504,969 @@ void PropLoad::set_use_checksum(bool use_checksum)
  */
 quint32 PropLoad::compute_checksum(const QByteArray& data)
 {
-    quint32 checksum = 0;
-    for (int offs = 0; offs < data.size(); offs += sizeof(quint32))
-	checksum += util.get_le32(data, offs);
-    return checksum;
+    return Util::sum_le32(data);
+}
+
+/**
+ * @brief Return the number of characters needed to encode @p size bytes
+ * @param mode Prop_Hex or Prop_Txt
+ * @param size number of bytes
+ * @return number of characters
+ */
+static int encoded_size(PropLoad::PropLoadMode mode, int size)
+{
+    switch (mode) {
+    case PropLoad::Prop_Hex:
+	return Util::hex_size(size);
+    case PropLoad::Prop_Txt:
+	return Util::base64_size(size);
+    case PropLoad::Prop_Bin:
+	break;
+    }
+    return 0;
 }
 
 /**
- * @brief Upload a single file using base64 encoding
+ * @brief Encode the image into the upload buffer in a single pass
+ *
+ * The buffer is allocated once with its exact final size. Each block is
+ * copied to a padded scratch block, patched (first block only), added to
+ * the checksum, and encoded straight into the buffer.
+ *
  * @param data const reference to the data block to send
+ * @param mode encoding to use: Prop_Hex or Prop_Txt
  * @param patch_mode if true, patch in the clock frequence, mode, and user baud
- * @return true on success, or false on error
  */
-bool PropLoad::load_single_data_txt(const QByteArray& data, bool patch_mode)
+void PropLoad::encode_image(const QByteArray& data, PropLoadMode mode, bool patch_mode)
 {
-    static const QByteArray::Base64Options opts = QByteArray::OmitTrailingEquals;
-    int totnum = 0;
-    quint32 checksum = 0;
+    static const QByteArray prop_hex("> Prop_Hex 0 0 0 0");
+    static const QByteArray prop_txt("> Prop_Txt 0 0 0 0");
+    static const QByteArray prefix("> ");
+    const QByteArray& header = Prop_Txt == mode ? prop_txt : prop_hex;
+    const int size = data.size();
+    const int nblocks = size / chunksize;
+    const int tail = ((size % chunksize) + 3) & ~3;
 
-    if (m_verbose)
-	emit Message(tr("Loading %1 bytes.").arg(data.size()));
+    // compute the exact size of the encoded image
+    int total = header.size();
+    total += nblocks * (prefix.size() + encoded_size(mode, chunksize));
+    if (tail > 0)
+	total += prefix.size() + encoded_size(mode, tail);
+    total += m_use_checksum ? 1 + encoded_size(mode, 4) + 1 : 1;
 
-    emit Progress(0, data.size());
-    QByteArray prop_txt("> Prop_Txt 0 0 0 0");
-    if (m_verbose)
-	emit Message(tr("Sending Prop_Txt header '%1'.")
-		     .arg(QString::fromLatin1(prop_txt)));
+    m_buffer = QByteArray(total, Qt::Uninitialized);
+    char* const base = m_buffer.data();
+    char* dst = base;
 
-    if (m_dev->write(prop_txt) != prop_txt.size()) {
-	emit Error(tr("Failed to send prop_txt '%1' %2 bytes")
-		   .arg(QString::fromLatin1(prop_txt))
-		   .arg(prop_txt.size()));
-	return false;
-    }
+    memcpy(dst, header.constData(), static_cast<size_t>(header.size()));
+    dst += header.size();
+    m_header_size = header.size();
+    if (m_verbose)
+	emit Message(tr("Sending %1 header '%2'.")
+		     .arg(Prop_Txt == mode ? QLatin1String("Prop_Txt") : QLatin1String("Prop_Hex"))
+		     .arg(QString::fromLatin1(header)));
 
-    for (int offs = 0; offs < data.size(); offs += chunksize) {
-	QByteArray block = data.mid(offs, chunksize);
-	if (block.size() & 3) {
-	    // pad block to multiples of 32 bit with zeroes
-	    block.append(4 - (block.size() & 3), 0);
-	}
+    quint32 checksum = 0;
+    uchar block[chunksize];
+    const uchar* src = reinterpret_cast<const uchar*>(data.constData());
+    for (int offs = 0; offs < size; offs += chunksize) {
+	const int len = qMin(chunksize, size - offs);
+	const int padded = (len + 3) & ~3;
+	memcpy(block, src + offs, static_cast<size_t>(len));
+	// pad block to multiples of 32 bit with zeroes
+	memset(block + len, 0, static_cast<size_t>(padded - len));
 
 	// If patch_mode is enabled, patch the first block
 	if (patch_mode) {
 	    patch_mode = false;
-	    util.put_le32(block, 0x14, m_clock_freq);
-	    util.put_le32(block, 0x18, m_clock_mode);
-	    util.put_le32(block, 0x1c, m_user_baud);
+	    qToLittleEndian<quint32>(m_clock_freq, block + 0x14);
+	    qToLittleEndian<quint32>(m_clock_mode, block + 0x18);
+	    qToLittleEndian<quint32>(m_user_baud, block + 0x1c);
 	}
 
 	// If checksumming is enabled, add the block to the checksum
 	if (m_use_checksum)
-	    checksum += compute_checksum(block);
+	    checksum += Util::sum_le32(block, padded);
 
-	// Send the block as hex bytes
-	QByteArray buffer = QByteArray("> ") + block.toBase64(opts);
+	char* line = dst;
+	memcpy(dst, prefix.constData(), static_cast<size_t>(prefix.size()));
+	dst += prefix.size();
+	dst += Prop_Txt == mode ? Util::encode_base64(dst, block, padded)
+				  : Util::encode_hex(dst, block, padded);
 	if (m_verbose)
 	    emit Message(tr("Send %1 bytes block @0x%2 '%3'")
-			 .arg(block.size())
+			 .arg(padded)
 			 .arg(offs, 4, 16, QChar('0'))
-			 .arg(QString::fromLatin1(buffer)));
-
-	if (m_dev->write(buffer) != buffer.length()) {
-	    emit Error(tr("Failed to send data block at offset 0x%1, %2 bytes")
-		       .arg(offs, 4, 16, QChar('0'))
-		       .arg(block.size()));
-	    return false;
-	}
-
-	// Wait for the block to be written
-#if WAIT_FOR_BYTES_WRITTEN > 0
-	// FIXME: do we need this?
-	if (!m_dev->waitForBytesWritten(30000)) {
-	    emit Error(tr("Failed to transfer %1 bytes block.")
-		       .arg(buffer.size()));
-	    return false;
-	}
-#endif
-	emit Progress(offs, data.size());
-	totnum += block.size();
+			 .arg(QString::fromLatin1(line, static_cast<int>(dst - line))));
     }
 
     if (m_use_checksum) {
-	checksum = Prop - checksum;
-	QByteArray checksum_data(4, 0);
-	util.put_le32(checksum_data, 0, checksum);
-	QByteArray buffer = QByteArray(" ") + checksum_data.toBase64(opts) + QByteArray("?");
-
+	m_checksum = Prop - checksum;
+	uchar checksum_data[4];
+	qToLittleEndian<quint32>(m_checksum, checksum_data);
+	char* line = dst;
+	*dst++ = ' ';
+	dst += Prop_Txt == mode ? Util::encode_base64(dst, checksum_data, 4)
+				  : Util::encode_hex(dst, checksum_data, 4);
+	*dst++ = '?';
 	if (m_verbose)
 	    emit Message(tr("Send checksum '%1'.")
-			 .arg(QString::fromLatin1(buffer)));
-
-	if (m_dev->write(buffer) != buffer.length()) {
-	    emit Error(tr("Failed to send checksum at 0x%1 (%2) bytes")
-		       .arg(checksum, 8, 16, QChar('0'))
-		       .arg(checksum_data.size()));
-	    return false;
-	}
-
-	// Wait until the checksum is written
-#if WAIT_FOR_BYTES_WRITTEN > 0
-	// FIXME: do we need this?
-	if (!m_dev->waitForBytesWritten(30000)) {
-	    emit Error(tr("Failed to transfer %1 bytes block.")
-		       .arg(buffer.size()));
-	    return false;
-	}
-#endif
-
-	buffer.clear();
-	// Now wait for a reply from the Prop
-	if (m_dev->waitForReadyRead(1000)) {
-	    // and read 1 byte
-	    buffer = m_dev->read(1);
-	}
-
-	if (buffer.length() != 1 || buffer[0] != '.') {
-	    QString message = tr("Failed to transfer %1 bytes of data.")
-			      .arg(data.size());
-	    message += QChar::LineFeed + tr("Error response was '%1'")
-		       .arg(QString::fromLatin1(buffer));
-	    emit Error(message);
-	    return false;
-	}
-	if (m_verbose)
-	    emit Message(tr("Checksum 0x%1 validated.")
-			 .arg(checksum, 8, 16, QChar('0')));
-
+			 .arg(QString::fromLatin1(line, static_cast<int>(dst - line))));
     } else {
 	// No checksum mode: write a tilde (~)
+	*dst++ = '~';
+    }
+    Q_ASSERT(dst - base == total);
+}
 
-	QByteArray buffer("~");
-	if (m_dev->write(buffer) != buffer.length()) {
-	    emit Error(tr("Failed to send skip '%1' (%2) bytes")
-		       .arg(QString::fromLatin1(buffer))
-		       .arg(buffer.size()));
-	    return false;
-	}
+/**
+ * @brief Upload the second stage loader through the ROM, which then loads m_segments
+ *
+ * If the loader is still being built, the engine waits for it in
+ * St_Loader and set_stage2_loader() continues from there.
+ * @return true if the upload was started
+ */
+bool PropLoad::load_stage2()
+{
+    if (m_stage2.isEmpty()) {
+	// continued by set_stage2_loader()
+	if (m_verbose)
+	    emit Message(tr("Waiting for the second stage loader to be built."));
+	m_state = St_Loader;
+	m_reply_timer.start(stage2_build_timeout);
+	return true;
     }
-    emit Progress(data.size(), data.size());
+    if (m_verbose)
+	emit Message(tr("Loading %1 bytes second stage loader.")
+		     .arg(m_stage2.size()));
+    // the loader itself goes through the ROM with Prop_Hex
+    encode_image(m_stage2, Prop_Hex, false);
+    return start_upload(m_stage2);
+}
+
+/**
+ * @brief Start the asynchronous upload of the encoded buffer
+ *
+ * The result is reported by the Finished() signal, which may
+ * already be emitted before this function returns.
+ *
+ * @param data const reference to the data being uploaded
+ * @return true if the upload was started
+ */
+bool PropLoad::start_upload(const QByteArray& data)
+{
+    m_data_size = data.size();
 
-    emit Message(tr("%1 bytes of data loaded.")
-		 .arg(data.size()));
+    m_dev->readAll();	// discard stale input
+    bool ok;
+    ok = connect(m_dev, &QIODevice::bytesWritten,
+		 this, &PropLoad::dev_bytes_written,
+		 Qt::UniqueConnection);
+    Q_ASSERT(ok);
+    ok = connect(m_dev, &QIODevice::readyRead,
+		 this, &PropLoad::dev_ready_read,
+		 Qt::UniqueConnection);
+    Q_ASSERT(ok);
 
+    emit Progress(0, m_data_size);
+    QSerialPort* port = qobject_cast<QSerialPort*>(m_dev);
+    if (port && m_fast_baud > 0 && port->baudRate() != static_cast<qint32>(m_fast_baud)) {
+	// send the header at the current baud rate, the rest after switching
+	send_buffer(St_Header);
+	return true;
+    }
+    send_buffer(St_Sending);
     return true;
 }
 
 /**
- * @brief Upload a single file using hexadecimal encoding
- * @param data const reference to the data block to send
- * @param patch_mode if true, patch in the clock frequence, mode, and user baud
- * @return true on success, or false on error
+ * @brief The header has left the UART: switch to the upload baud rate
+ *
+ * The ROM loader measures the baud rate on every '>' character,
+ * so the blocks following the header can be sent at any rate.
  */
-bool PropLoad::load_single_data_hex(const QByteArray& data, bool patch_mode)
+void PropLoad::header_sent()
 {
-    int totnum = 0;
-    quint32 checksum = 0;
+    if (St_Header != m_state)
+	return;
+    if (!switch_baud()) {
+	finish(false);
+	return;
+    }
+    m_total = m_buffer.size();
+    m_state = St_Sending;
+    pump();
+}
 
+/**
+ * @brief Switch the serial port to the upload baud rate
+ *
+ * The previous baud rate is restored when the upload is finished.
+ *
+ * @return true on success, or false on error
+ */
+bool PropLoad::switch_baud()
+{
+    QSerialPort* port = qobject_cast<QSerialPort*>(m_dev);
+    if (!port || 0 == m_fast_baud || port->baudRate() == static_cast<qint32>(m_fast_baud))
+	return true;
+    const qint32 baud = port->baudRate();
+    if (!port->setBaudRate(static_cast<qint32>(m_fast_baud))) {
+	emit Error(tr("Could not switch to %1 baud.")
+		   .arg(m_fast_baud));
+	return false;
+    }
+    if (0 == m_saved_baud)
+	m_saved_baud = baud;
     if (m_verbose)
-	emit Message(tr("Loading %1 bytes.")
-		     .arg(data.size()));
+	emit Message(tr("Switched to %1 baud.")
+		     .arg(m_fast_baud));
+    return true;
+}
 
-    emit Progress(0, data.size());
-    QByteArray prop_hex("> Prop_Hex 0 0 0 0");
-    if (m_verbose)
-	emit Message(tr("Sending Prop_Hex header '%1'.").arg(QString::fromLatin1(prop_hex)));
+/**
+ * @brief Start writing m_buffer and enter @p state
+ * @param state one of the sending states
+ */
+void PropLoad::send_buffer(UploadState state)
+{
+    m_total = St_Header == state ? m_header_size : m_buffer.size();
+    m_written = 0;
+    m_sent = 0;
+    m_state = state;
+    pump();
+}
 
-    if (m_dev->write(prop_hex) != prop_hex.size()) {
-	emit Error(tr("Failed to send prop_hex '%1' %2 bytes")
-		   .arg(QString::fromLatin1(prop_hex))
-		   .arg(prop_hex.size()));
+/**
+ * @brief Return true if the engine is in one of the sending states
+ * @return true if sending
+ */
+bool PropLoad::is_sending() const
+{
+    switch (m_state) {
+    case St_Header:
+    case St_Sending:
+    case St_Binary:
+    case St_Fill:
+    case St_Boot:
+    case St_Query:
+    case St_Program:
+    case St_Reboot:
+    case St_Go:
+	return true;
+    default:
 	return false;
     }
+}
+
+/**
+ * @brief Defer a call to pump() to the event loop
+ */
+void PropLoad::schedule_pump()
+{
+    if (m_pump_pending)
+	return;
+    m_pump_pending = true;
+    QTimer::singleShot(0, this, &PropLoad::pump);
+}
+
+/**
+ * @brief Write queued buffers until the in-flight limit is reached
+ *
+ * Devices which write synchronously (e.g. a pty opened as QFile) never
+ * emit bytesWritten(), so for them everything the device accepted is
+ * counted as sent right away and the next round is deferred to the
+ * event loop to keep the GUI responsive.
+ */
+void PropLoad::pump()
+{
+    m_pump_pending = false;
+    if (!is_sending())
+	return;
 
-    for (int offs = 0; offs < data.size(); offs += chunksize) {
-	QByteArray block = data.mid(offs, chunksize);
-	if (block.size() & 3) {
-	    // pad block to multiples of 32 bit with zeroes
-	    block.append(4 - (block.size() & 3), 0);
+    const qint64 room = m_inflight - (m_written - m_sent);
+    const qint64 size = qMin(room, m_total - m_written);
+    if (size > 0) {
+	// write a slice of the encoded buffer, no temporaries involved
+	const qint64 written = m_dev->write(m_buffer.constData() + m_written, size);
+	if (written < 0) {
+	    emit Error(tr("Failed to send %1 bytes at offset %2 of %3.")
+		       .arg(size)
+		       .arg(m_written)
+		       .arg(m_total));
+	    finish(false);
+	    return;
 	}
+	m_written += written;
+    }
 
-	// If patch_mode is enabled, patch the first block
-	if (patch_mode) {
-	    patch_mode = false;
-	    util.put_le32(block, 0x14, m_clock_freq);
-	    util.put_le32(block, 0x18, m_clock_mode);
-	    util.put_le32(block, 0x1c, m_user_baud);
+    if (m_dev->bytesToWrite() == 0 && m_sent < m_written) {
+	// synchronous device: everything is already gone
+	m_sent = m_written;
+	report_progress();
+	if (m_written < m_total) {
+	    schedule_pump();
+	} else {
+	    all_sent();
 	}
+    }
+}
 
-	// If checksumming is enabled, add the block to the checksum
-	if (m_use_checksum)
-	    checksum += compute_checksum(block);
+/**
+ * @brief Account for bytes going out and refill the device buffer
+ * @param bytes number of bytes written to the device
+ */
+void PropLoad::dev_bytes_written(qint64 bytes)
+{
+    if (!is_sending())
+	return;
 
-	// Send the block as hex bytes
-	QByteArray buffer = QByteArray("> ") + block.toHex(' ');
-	if (m_verbose)
-	    emit Message(tr("Send %1 bytes block @0x%2 '%3'")
-			 .arg(block.size())
-			 .arg(offs, 4, 16, QChar('0'))
-			 .arg(QString::fromLatin1(buffer)));
+    m_sent = qMin(m_sent + bytes, m_written);
+    report_progress();
 
-	if (m_dev->write(buffer) != buffer.length()) {
-	    emit Error(tr("Failed to send data block at offset 0x%1, %2 bytes")
-		       .arg(offs, 4, 16, QChar('0'))
-		       .arg(block.size()));
-	    return false;
+    if (m_written < m_total) {
+	pump();
+	return;
+    }
+
+    if (m_sent < m_written)
+	return;
+
+    all_sent();
+}
+
+/**
+ * @brief Return the reply timeout allowing for bytes still in the FIFO
+ * @param msecs base timeout in milliseconds
+ * @return timeout in milliseconds
+ */
+int PropLoad::line_timeout(int msecs) const
+{
+    QSerialPort* port = qobject_cast<QSerialPort*>(m_dev);
+    if (port && port->baudRate() > 0)
+	msecs += static_cast<int>(m_inflight * 10 * 1000 / port->baudRate());
+    return msecs;
+}
+
+/**
+ * @brief All bytes of the buffer are written: go to the next phase
+ */
+void PropLoad::all_sent()
+{
+    switch (m_state) {
+    case St_Header:
+	{
+	    // give the UART time to shift out the header
+	    QSerialPort* port = qobject_cast<QSerialPort*>(m_dev);
+	    const int baud = port && port->baudRate() > 0 ? port->baudRate() : Serial_Baud115200;
+	    QTimer::singleShot(1 + static_cast<int>(m_header_size * 10 * 1000 / baud + 1),
+			       this, &PropLoad::header_sent);
 	}
+	return;
 
-	// Wait for the block to be written
-	if (!m_dev->waitForBytesWritten(30000)) {
-	    emit Error(tr("Failed to transfer %1 bytes block.")
-		       .arg(buffer.size()));
-	    return false;
+    case St_Sending:
+	if (!m_use_checksum) {
+	    if (Prop_Bin == m_upload_mode) {
+		start_stage2();
+		return;
+	    }
+	    finish(true);
+	    return;
 	}
-	emit Progress(offs, data.size());
-	totnum += block.size();
-    }
+	// Now wait for a reply from the Prop
+	m_state = St_Reply;
+	m_reply_timer.start(line_timeout(m_reply_timeout));
+	break;
 
-    if (m_use_checksum) {
-	checksum = Prop - checksum;
-	QByteArray checksum_data(4, 0);
-	util.put_le32(checksum_data, 0, checksum);
-	QByteArray buffer = QByteArray(" ") + checksum_data.toHex(' ') + QByteArray("?");
+    case St_Binary:
+	// wait for the second stage's sum of the loaded bytes
+	m_state = St_Sum;
+	m_reply_timer.start(line_timeout(m_reply_timeout));
+	break;
+
+    case St_Fill:
+	// wait for the second stage to acknowledge the zero fill
+	m_state = St_Filled;
+	m_reply_timer.start(line_timeout(m_reply_timeout));
+	break;
+
+    case St_Boot:
+	// wait for the flash boot stub
+	m_state = St_Stub;
+	m_reply_timer.start(line_timeout(m_reply_timeout));
+	break;
+
+    case St_Query:
+	// wait for the hashes of the flash sectors
+	m_state = St_Hashes;
+	m_reply_timer.start(line_timeout(m_reply_timeout) +
+			    m_flash_image.size() / flash_sector * flash_hash_msecs);
+	break;
 
+    case St_Program:
+	// wait for the hash of the programmed sector
+	m_state = St_Verify;
+	m_reply_timer.start(line_timeout(m_reply_timeout) + flash_program_msecs);
+	break;
+
+    case St_Reboot:
 	if (m_verbose)
-	    emit Message(tr("Send checksum '%1'.")
-			 .arg(QString::fromLatin1(buffer)));
+	    emit Message(tr("Booting from the flash."));
+	finish(true);
+	return;
 
-	if (m_dev->write(buffer) != buffer.length()) {
-	    emit Error(tr("Failed to send checksum at 0x%1 (%2) bytes")
-		       .arg(checksum, 8, 16, QChar('0'))
-		       .arg(checksum_data.size()));
-	    return false;
-	}
+    case St_Go:
+	if (m_verbose)
+	    emit Message(tr("Started the image."));
+	finish(true);
+	return;
 
-	// Wait until the checksum is written
-	if (!m_dev->waitForBytesWritten(30000)) {
-	    emit Error(tr("Failed to transfer %1 bytes block.")
-		       .arg(buffer.size()));
-	    return false;
+    default:
+	return;
+    }
+    if (m_dev->bytesAvailable() > 0)
+	dev_ready_read();
+}
+
+/**
+ * @brief Read the replies from the Prop
+ */
+void PropLoad::dev_ready_read()
+{
+    switch (m_state) {
+    case St_Reply:
+	{
+	    const QByteArray buffer = m_dev->read(1);
+	    if (buffer.isEmpty())
+		return;
+	    m_reply_timer.stop();
+
+	    if (buffer[0] != '.') {
+		QString message = tr("Failed to transfer %1 bytes of data.")
+				  .arg(m_data_size);
+		message += QChar::LineFeed + tr("Error response was '%1'")
+			   .arg(QString::fromLatin1(buffer));
+		emit Error(message);
+		finish(false);
+		return;
+	    }
+
+	    if (m_verbose)
+		emit Message(tr("Checksum 0x%1 validated.")
+			     .arg(m_checksum, 8, 16, QChar('0')));
+	    if (Prop_Bin == m_upload_mode) {
+		start_stage2();
+		return;
+	    }
+	    finish(true);
 	}
+	break;
 
-	// Now wait for a reply from the Prop
-	buffer.clear();
-	if (m_dev->waitForReadyRead(1000)) {
-	    // and read 1 byte
-	    buffer = m_dev->read(1);
+    case St_Sync:
+	// noise while the clock and baud rate change is ignored
+	if (m_dev->readAll().contains('@'))
+	    sync_stage2();
+	break;
+
+    case St_Synced:
+	// answers to the pings still in flight are skipped
+	if (m_dev->readAll().contains('S'))
+	    send_binary();
+	break;
+
+    case St_Sum:
+	if (m_dev->bytesAvailable() < 4)
+	    return;
+	{
+	    m_reply_timer.stop();
+	    const QByteArray reply = m_dev->read(4);
+	    const quint32 sum = qFromLittleEndian<quint32>(reply.constData());
+	    if (sum != m_checksum) {
+		emit Error(tr("Second stage checksum mismatch: expected 0x%1, got 0x%2.")
+			   .arg(m_checksum, 8, 16, QChar('0'))
+			   .arg(sum, 8, 16, QChar('0')));
+		finish(false);
+		return;
+	    }
+	    if (m_verbose)
+		emit Message(tr("Checksum 0x%1 validated.")
+			     .arg(m_checksum, 8, 16, QChar('0')));
+	    m_buffer = QByteArray(1, 'G');
+	    send_buffer(St_Go);
 	}
+	break;
 
-	if (buffer.length() != 1 || buffer[0] != '.') {
-	    QString message = tr("Failed to transfer %1 bytes of data.")
-			      .arg(data.size());
-	    message += QChar::LineFeed + tr("Error response was '%1'")
-		       .arg(QString::fromLatin1(buffer));
-	    emit Error(message);
-	    return false;
+    case St_Filled:
+	{
+	    const QByteArray reply = m_dev->read(1);
+	    if (reply.isEmpty())
+		return;
+	    m_reply_timer.stop();
+	    if (reply[0] != 'Z') {
+		emit Error(tr("Second stage zero fill failed: got '%1'.")
+			   .arg(QString::fromLatin1(reply.toHex())));
+		finish(false);
+		return;
+	    }
+	    send_zero_fill();
 	}
-	if (m_verbose)
-	    emit Message(tr("Checksum 0x%1 validated.")
-			 .arg(checksum, 8, 16, QChar('0')));
+	break;
 
-    } else {
-	// No checksum mode: write a tilde (~)
+    case St_Stub:
+	m_reply += m_dev->readAll();
+	if (m_reply.size() < flash_boot_size)
+	    return;
+	m_reply_timer.stop();
+	add_flash_boot();
+	send_flash_query();
+	break;
 
-	QByteArray buffer("~");
-	if (m_dev->write(buffer) != buffer.length()) {
-	    emit Error(tr("Failed to send skip '%1' (%2) bytes")
-		       .arg(QString::fromLatin1(buffer))
-		       .arg(buffer.size()));
-	    return false;
+    case St_Hashes:
+	m_reply += m_dev->readAll();
+	if (m_reply.size() < m_flash_image.size() / flash_sector * 4)
+	    return;
+	m_reply_timer.stop();
+	compare_flash_hashes();
+	break;
+
+    case St_Verify:
+	m_reply += m_dev->readAll();
+	if (m_reply.size() < 4)
+	    return;
+	m_reply_timer.stop();
+	verify_flash_sector();
+	break;
+
+    case St_Fill:
+    case St_Boot:
+    case St_Query:
+    case St_Program:
+	// a quick reply is read once all_sent() is reached
+	break;
+
+    case St_Header:
+    case St_Sending:
+    case St_Binary:
+	// nothing is expected while sending
+	m_dev->readAll();
+	break;
+
+    case St_Reboot:
+    case St_Go:
+	// the started program's first output stays in the device for the terminal
+	break;
+
+    case St_Idle:
+    case St_Loader:
+	break;
+    }
+}
+
+/**
+ * @brief The image was received by the second stage loader: switch baud and sync
+ */
+void PropLoad::start_stage2()
+{
+    if (!switch_baud()) {
+	finish(false);
+	return;
+    }
+    m_state = St_Sync;
+    m_reply_timer.start(stage2_sync_timeout);
+    m_ping_timer.start();
+    ping_stage2();
+}
+
+/**
+ * @brief Ping the second stage loader until it answers
+ */
+void PropLoad::ping_stage2()
+{
+    if (St_Sync != m_state) {
+	m_ping_timer.stop();
+	return;
+    }
+    m_dev->write("@", 1);
+}
+
+/**
+ * @brief The second stage loader answered a ping: stop pinging and sync
+ *
+ * More pings may have been sent before the first answer arrived, and
+ * their answers would be taken for the replies to the next commands.
+ * The loader answers the "S" after all of them, so everything up to
+ * its answer is dropped.
+ */
+void PropLoad::sync_stage2()
+{
+    m_ping_timer.stop();
+    m_state = St_Synced;
+    m_reply_timer.start(line_timeout(m_reply_timeout));
+    m_dev->write("S", 1);
+}
+
+/**
+ * @brief The second stage loader is in sync: send the zero fills and the compressed image
+ */
+void PropLoad::send_binary()
+{
+    m_reply_timer.stop();
+    if (m_verbose)
+	emit Message(tr("Second stage loader is running."));
+    if (!m_flash_image.isEmpty()) {
+	if (m_flash_boot) {
+	    m_buffer = QByteArray(1, 'B');
+	    m_reply.clear();
+	    send_buffer(St_Boot);
+	    return;
 	}
+	send_flash_query();
+	return;
+    }
+    m_fills_done = 0;
+    send_zero_fill();
+}
+
+/**
+ * @brief Return the 32 bit FNV-1a hash of @p size bytes at @p data
+ *
+ * This is the hash the second stage loader computes of flash sectors.
+ */
+quint32 PropLoad::flash_hash(const char* data, int size)
+{
+    quint32 hash = 0x811c9dc5u;
+    for (int i = 0; i < size; i++) {
+	hash ^= static_cast<uchar>(data[i]);
+	hash *= 16777619u;
     }
-    emit Progress(data.size(), data.size());
+    return hash;
+}
+
+/**
+ * @brief Put the flash boot stub received in m_reply in front of m_flash_image
+ *
+ * The stub gets the size of the hub image, and its last long is set so
+ * that its longs sum up to the value the ROM expects before it runs it.
+ */
+void PropLoad::add_flash_boot()
+{
+    QByteArray stub = m_reply.left(flash_boot_size);
+    uchar* data = reinterpret_cast<uchar*>(stub.data());
+    qToLittleEndian<quint32>(static_cast<quint32>(m_flash_image.size()), data + 4);
+    quint32 sum = 0;
+    for (int i = 0; i < flash_boot_size - 4; i += 4)
+	sum += qFromLittleEndian<quint32>(data + i);
+    qToLittleEndian<quint32>(flash_boot_sum - sum, data + flash_boot_size - 4);
+    m_flash_image.prepend(stub);
+    if (m_flash_image.size() % flash_sector)
+	m_flash_image.append(flash_sector - m_flash_image.size() % flash_sector, '\xff');
+    m_flash_boot = false;
+}
 
+/**
+ * @brief Ask the second stage loader for the hashes of the sectors covered by the image
+ */
+void PropLoad::send_flash_query()
+{
+    const int sectors = m_flash_image.size() / flash_sector;
+    uchar record[9];
+    record[0] = 'H';
+    qToLittleEndian<quint32>(0, record + 1);
+    qToLittleEndian<quint32>(static_cast<quint32>(sectors), record + 5);
+    m_buffer = QByteArray(reinterpret_cast<const char*>(record), sizeof(record));
+    m_reply.clear();
     if (m_verbose)
-	emit Message(tr("%1 bytes of data loaded.")
-		     .arg(data.size()));
+	emit Message(tr("Comparing %1 flash sectors.")
+		     .arg(sectors));
+    send_buffer(St_Query);
+}
 
-    return true;
+/**
+ * @brief Compare the sector hashes in m_reply and program the sectors which differ
+ */
+void PropLoad::compare_flash_hashes()
+{
+    const int sectors = m_flash_image.size() / flash_sector;
+    const uchar* hashes = reinterpret_cast<const uchar*>(m_reply.constData());
+    m_flash_sectors.clear();
+    for (int i = 0; i < sectors; i++) {
+	const quint32 hash = flash_hash(m_flash_image.constData() + i * flash_sector, flash_sector);
+	if (qFromLittleEndian<quint32>(hashes + 4 * i) != hash)
+	    m_flash_sectors.append(i);
+    }
+    if (m_verbose)
+	emit Message(tr("%1 of %2 flash sectors differ.")
+		     .arg(m_flash_sectors.size())
+		     .arg(sectors));
+    m_flash_done = 0;
+    m_data_size = static_cast<qint64>(m_flash_sectors.size()) * flash_sector;
+    emit Progress(0, m_data_size);
+    send_flash_sector();
+}
+
+/**
+ * @brief Send the next differing sector to program, or reboot when all are done
+ *
+ * The sector goes to the second stage loader's buffer with an "L"
+ * record, followed by the "P" command to erase and program it.
+ */
+void PropLoad::send_flash_sector()
+{
+    if (m_flash_done >= m_flash_sectors.size()) {
+	m_buffer = QByteArray(1, 'R');
+	send_buffer(St_Reboot);
+	return;
+    }
+
+    const int sector = m_flash_sectors[m_flash_done];
+    const uchar* data = reinterpret_cast<const uchar*>(m_flash_image.constData()) + sector * flash_sector;
+    uchar record[9];
+    m_buffer.clear();
+    record[0] = 'L';
+    qToLittleEndian<quint32>(stage2_buffer, record + 1);
+    qToLittleEndian<quint32>(flash_sector, record + 5);
+    m_buffer.append(reinterpret_cast<const char*>(record), sizeof(record));
+    encode_rle(m_buffer, data, flash_sector);
+    record[0] = 'P';
+    qToLittleEndian<quint32>(static_cast<quint32>(sector), record + 1);
+    m_buffer.append(reinterpret_cast<const char*>(record), 5);
+    m_reply.clear();
+    send_buffer(St_Program);
+}
+
+/**
+ * @brief Check the hash of the programmed sector in m_reply and continue
+ */
+void PropLoad::verify_flash_sector()
+{
+    const int sector = m_flash_sectors[m_flash_done];
+    const quint32 expected = flash_hash(m_flash_image.constData() + sector * flash_sector, flash_sector);
+    const quint32 hash = qFromLittleEndian<quint32>(m_reply.constData());
+    if (hash != expected) {
+	emit Error(tr("Verifying flash sector %1 failed: expected hash 0x%2, got 0x%3.")
+		   .arg(sector)
+		   .arg(expected, 8, 16, QChar('0'))
+		   .arg(hash, 8, 16, QChar('0')));
+	finish(false);
+	return;
+    }
+    m_flash_done++;
+    emit Progress(static_cast<qint64>(m_flash_done) * flash_sector, m_data_size);
+    send_flash_sector();
+}
+
+/**
+ * @brief Send the next zero fill, or the compressed segments when all are done
+ *
+ * The second stage loader can not receive while it fills, so each
+ * zero fill is sent on its own and acknowledged with a "Z".
+ */
+void PropLoad::send_zero_fill()
+{
+    while (m_fills_done < m_segments.size()) {
+	const Segment& segment = m_segments[m_fills_done++];
+	if (0 == segment.zero)
+	    continue;
+	uchar record[9];
+	record[0] = 'Z';
+	qToLittleEndian<quint32>(segment.addr + static_cast<quint32>(segment.data.size()), record + 1);
+	qToLittleEndian<quint32>(segment.zero, record + 5);
+	m_buffer = QByteArray(reinterpret_cast<const char*>(record), sizeof(record));
+	send_buffer(St_Fill);
+	return;
+    }
+
+    qint64 size = 0;
+    for (const Segment& segment : m_segments)
+	size += segment.data.size();
+    m_buffer.clear();
+    m_buffer.reserve(static_cast<int>(9 * m_segments.size() + size + size / 128 + 2));
+    // the second stage sums bytes, not words
+    m_checksum = 0;
+    for (const Segment& segment : m_segments) {
+	if (segment.data.isEmpty())
+	    continue;
+	uchar record[9];
+	record[0] = 'L';
+	qToLittleEndian<quint32>(segment.addr, record + 1);
+	qToLittleEndian<quint32>(static_cast<quint32>(segment.data.size()), record + 5);
+	m_buffer.append(reinterpret_cast<const char*>(record), sizeof(record));
+	encode_rle(m_buffer, reinterpret_cast<const uchar*>(segment.data.constData()), segment.data.size());
+	for (const char ch : segment.data)
+	    m_checksum += static_cast<uchar>(ch);
+    }
+    m_buffer.append('C');
+
+    if (m_verbose)
+	emit Message(tr("Sending %1 bytes compressed to %2 bytes (%3%).")
+		     .arg(size)
+		     .arg(m_buffer.size())
+		     .arg(100.0 * m_buffer.size() / qMax<qint64>(1, size), 0, 'f', 1));
+    m_data_size = size;
+    emit Progress(0, m_data_size);
+    send_buffer(St_Binary);
+}
+
+/**
+ * @brief Emit Progress() for the part of the buffer sent so far
+ */
+void PropLoad::report_progress()
+{
+    switch (m_state) {
+    case St_Fill:
+    case St_Boot:
+    case St_Query:
+    case St_Reboot:
+	// the zero fills and flash commands are not part of the image's progress
+	return;
+    case St_Program:
+	emit Progress(static_cast<qint64>(m_flash_done) * flash_sector +
+		      flash_sector * m_sent / qMax<qint64>(1, m_total), m_data_size);
+	return;
+    default:
+	break;
+    }
+    emit Progress(m_data_size * m_sent / qMax<qint64>(1, m_total), m_data_size);
+}
+
+/**
+ * @brief Run length encode @p size bytes from @p src and append them to @p dst
+ *
+ * Control bytes below 0x80 are followed by 1 to 128 literal bytes.
+ * Control bytes 0x80 and above repeat the next byte 3 to max_run times.
+ * Runs are capped so that the second stage can store a run before its
+ * receiver overflows at 3 Mbaud.
+ *
+ * @param dst reference to the buffer to append to
+ * @param src pointer to the bytes
+ * @param size number of bytes
+ */
+void PropLoad::encode_rle(QByteArray& dst, const uchar* src, int size)
+{
+    int lit = 0;	// start of pending literals
+    int i = 0;
+    auto flush_literals = [&](int end) {
+	while (lit < end) {
+	    const int n = qMin(128, end - lit);
+	    dst.append(static_cast<char>(n - 1));
+	    dst.append(reinterpret_cast<const char*>(src + lit), n);
+	    lit += n;
+	}
+    };
+    while (i < size) {
+	int run = 1;
+	while (i + run < size && run < max_run && src[i + run] == src[i])
+	    run++;
+	if (run >= 3) {
+	    flush_literals(i);
+	    dst.append(static_cast<char>(0x80 + run - 3));
+	    dst.append(static_cast<char>(src[i]));
+	    i += run;
+	    lit = i;
+	} else {
+	    i += run;
+	}
+    }
+    flush_literals(size);
+}
+
+/**
+ * @brief The Prop did not reply in time
+ */
+void PropLoad::reply_timeout_expired()
+{
+    QString message;
+    switch (m_state) {
+    case St_Loader:
+	message = tr("The second stage loader was not built within %1ms.")
+		  .arg(stage2_build_timeout);
+	break;
+    case St_Reply:
+	message = tr("Failed to transfer %1 bytes of data.")
+		  .arg(m_data_size);
+	message += QChar::LineFeed + tr("No response within %1ms.")
+		   .arg(m_reply_timeout);
+	break;
+    case St_Sync:
+	message = tr("The second stage loader did not answer at %1 baud.")
+		  .arg(m_fast_baud);
+	break;
+    case St_Synced:
+	message = tr("The second stage loader did not answer the sync.");
+	break;
+    case St_Sum:
+	message = tr("The second stage loader did not send a checksum.");
+	break;
+    case St_Filled:
+	message = tr("The second stage loader did not finish a zero fill.");
+	break;
+    case St_Stub:
+	message = tr("The second stage loader did not send the flash boot stub.");
+	break;
+    case St_Hashes:
+	message = tr("The second stage loader did not send the flash sector hashes.");
+	break;
+    case St_Verify:
+	message = tr("The second stage loader did not program flash sector %1.")
+		  .arg(m_flash_sectors.value(m_flash_done));
+	break;
+    default:
+	return;
+    }
+    emit Error(message);
+    finish(false);
+}
+
+/**
+ * @brief Abort a running upload
+ */
+void PropLoad::abort()
+{
+    if (St_Idle == m_state)
+	return;
+    emit Error(tr("Upload aborted."));
+    finish(false);
+}
+
+/**
+ * @brief Tear down the upload state and emit Finished()
+ * @param ok true on success
+ */
+void PropLoad::finish(bool ok)
+{
+    m_reply_timer.stop();
+    m_ping_timer.stop();
+    disconnect(m_dev, &QIODevice::bytesWritten,
+	       this, &PropLoad::dev_bytes_written);
+    disconnect(m_dev, &QIODevice::readyRead,
+	       this, &PropLoad::dev_ready_read);
+    m_state = St_Idle;
+    m_buffer.clear();
+    m_segments.clear();
+    m_flash_image.clear();
+    m_flash_boot = false;
+    m_flash_sectors.clear();
+    m_reply.clear();
+
+    if (m_saved_baud > 0) {
+	// return to the terminal's baud rate
+	QSerialPort* port = qobject_cast<QSerialPort*>(m_dev);
+	if (port)
+	    port->setBaudRate(m_saved_baud);
+	m_saved_baud = 0;
+    }
+
+    if (ok) {
+	emit Progress(m_data_size, m_data_size);
+	if (m_verbose)
+	    emit Message(tr("%1 bytes of data loaded.")
+			 .arg(m_data_size));
+    }
+    if (m_trace_start) {
+	Trace::complete(m_trace_name, m_trace_start, Trace::now_ns());
+	m_trace_start = 0;
+    }
+    emit Finished(ok);
 }
 
 /**
@@ -408,6 +1477,7 @@ bool PropLoad::load_single_data_hex(const QByteArray& data, bool patch_mode)
  */
 bool PropLoad::load_single_file(const QString& filename, bool patch_mode)
 {
+    TRACE_SCOPE("PropLoad::load_single_file");
     QFile file(filename);
     if (!file.exists()) {
 	emit Error(tr("File '%1' does not exist.")
@@ -416,21 +1486,17 @@ bool PropLoad::load_single_file(const QString& filename, bool patch_mode)
     }
 
     if (file.open(QIODevice::ReadOnly)) {
+	if (file.peek(4) == QByteArray("\x7f" "ELF", 4)) {
+	    file.close();
+	    return load_elf(filename, patch_mode);
+	}
 	QByteArray data = file.readAll();
 	if (m_verbose)
 	    emit Message(tr("Loaded '%1' %2 bytes.")
 			 .arg(filename)
 			 .arg(data.size()));
 	file.close();
-	switch (m_mode) {
-	case Prop_Hex:
-	    return load_single_data_hex(data, patch_mode);
-	case Prop_Txt:
-	    return load_single_data_txt(data, patch_mode);
-	}
-	emit Error(tr("Invalid PropMode (%2).")
-		   .arg(m_mode));
-	return false;
+	return load_data(data, patch_mode);
     }
 
     emit Error(tr("Could not open '%1' for reading.")
@@ -11,6 +11,8 @@
 #include <QObject>
 #include <QByteArray>
 #include <QIODevice>
+#include <QTimer>
+#include <QVector>
 
 class PropLoad : public QObject
 {
@@ -18,7 +20,8 @@ class PropLoad : public QObject
 public:
     typedef enum {
 	Prop_Hex,
-	Prop_Txt
+	Prop_Txt,
+	Prop_Bin
     } PropLoadMode;
 
     PropLoad(QIODevice* dev, QObject* parent = nullptr);
@@ -29,9 +32,17 @@ public:
     quint32 clock_mode() const;
     quint32 user_baud() const;
     bool use_checksum() const;
+    quint32 checksum() const;
+    QByteArray stage2_loader() const;
+    quint32 fast_baud() const;
+    qint64 inflight() const;
+    int reply_timeout() const;
+    bool is_busy() const;
 
     bool load_data(const QByteArray& data, bool patch_mode = false);
     bool load_file(const QString& filename, bool patch_mode = false);
+    bool load_elf(const QString& filename, bool patch_mode = false);
+    bool flash_data(const QByteArray& image, bool boot = false);
 
 public slots:
     void set_verbose(bool on = true);
@@ -40,11 +51,26 @@ public slots:
     void set_clock_mode(quint32 clock_mode);
     void set_user_baud(quint32 user_baud);
     void set_use_checksum(bool use_checksum = true);
+    void set_stage2_loader(const QByteArray& binary);
+    void set_stage2_pending(bool on = true);
+    void set_fast_baud(quint32 baud);
+    void set_inflight(qint64 inflight);
+    void set_reply_timeout(int msecs);
+    void abort();
 
 signals:
     void Error(const QString& text);
     void Message(const QString& text);
     void Progress(qint64 value, qint64 total);
+    void Finished(bool ok);
+
+private slots:
+    void dev_bytes_written(qint64 bytes);
+    void dev_ready_read();
+    void reply_timeout_expired();
+    void ping_stage2();
+    void header_sent();
+    void pump();
 
 private:
     //! The magic constant for checksums to be subtracted from:
@@ -53,6 +79,51 @@ private:
     static constexpr quint32 Prop = ('P' << 0) | ('r' << 8) | ('o' << 16) | ('p' << 24);
     //! The number of bytes per chunk to upload
     static constexpr int chunksize = 128;
+    //! The default number of bytes to keep in flight
+    static constexpr qint64 default_inflight = 4096;
+    //! The longest run the second stage loader is sent
+    static constexpr int max_run = 66;
+    //! Milliseconds between pings to the second stage loader
+    static constexpr int stage2_ping_interval = 50;
+    //! Milliseconds to wait for the second stage loader to answer
+    static constexpr int stage2_sync_timeout = 2000;
+    //! Milliseconds to wait for a pending second stage loader to be built
+    static constexpr int stage2_build_timeout = 30000;
+    //! Size of a flash sector, which is compared and erased as a whole
+    static constexpr int flash_sector = 4096;
+    //! Size of the flash boot stub the ROM loads from the start of the flash
+    static constexpr int flash_boot_size = 1024;
+    //! Sum of the flash boot stub's longs the ROM expects ("Prop")
+    static constexpr quint32 flash_boot_sum = 0x706f7250;
+    //! Hub address where the second stage loader buffers a flash sector
+    static constexpr quint32 stage2_buffer = 0x40000;
+    //! Milliseconds the second stage loader may take to hash a flash sector
+    static constexpr int flash_hash_msecs = 20;
+    //! Milliseconds the second stage loader may take to erase and program a flash sector
+    static constexpr int flash_program_msecs = 2000;
+
+    //! State of the upload engine
+    typedef enum {
+	St_Idle,	//!< not uploading
+	St_Loader,	//!< waiting for the second stage loader to be built
+	St_Header,	//!< sending the header before switching the baud rate
+	St_Sending,	//!< sending the encoded blocks
+	St_Reply,	//!< waiting for the checksum reply
+	St_Sync,	//!< waiting for the second stage loader to answer
+	St_Synced,	//!< waiting for the answer to the sync after the pings
+	St_Binary,	//!< sending the compressed image to the second stage
+	St_Sum,		//!< waiting for the second stage's checksum
+	St_Fill,	//!< sending a zero fill command to the second stage
+	St_Filled,	//!< waiting for the second stage to finish the zero fill
+	St_Boot,	//!< sending the flash boot stub request
+	St_Stub,	//!< waiting for the flash boot stub
+	St_Query,	//!< sending the flash sector hash request
+	St_Hashes,	//!< waiting for the flash sector hashes
+	St_Program,	//!< sending a flash sector to program
+	St_Verify,	//!< waiting for the hash of the programmed sector
+	St_Reboot,	//!< sending the command to boot from the flash
+	St_Go,		//!< sending the start command
+    } UploadState;
 
     QIODevice* m_dev;	    //!< Serial i/o device to talk to
     bool m_verbose;	    //!< if true, be verbose during transfer
@@ -62,9 +133,64 @@ private:
     quint32 m_user_baud;    //!< user baud rate to patch in
 
     bool m_use_checksum;    //!< if true, calculate and verify the checksum
+    qint64 m_inflight;	    //!< maximum number of bytes written but not yet sent
+    int m_reply_timeout;    //!< milliseconds to wait for the checksum reply
+
+    UploadState m_state;    //!< current state of the upload engine
+    PropLoadMode m_upload_mode; //!< load mode of the current upload
+    QByteArray m_buffer;    //!< encoded header, blocks, and trailer
+    qint64 m_data_size;	    //!< size of the image being uploaded
+    qint64 m_total;	    //!< total number of encoded bytes
+    qint64 m_written;	    //!< number of encoded bytes handed to the device
+    qint64 m_sent;	    //!< number of encoded bytes confirmed by the device
+    quint32 m_checksum;	    //!< checksum value to be validated
+    QTimer m_reply_timer;   //!< timer for the checksum reply
+    bool m_pump_pending;    //!< true if a deferred pump() is scheduled
+    QByteArray m_stage2;    //!< second stage loader binary
+    bool m_stage2_pending;  //!< true if m_stage2 is still being built
+    //! A block of hub memory to be loaded by the second stage loader
+    struct Segment {
+	quint32 addr;	    //!< hub address
+	QByteArray data;    //!< bytes to load at addr
+	quint32 zero;	    //!< number of zero bytes to fill in after data
+    };
+    QVector<Segment> m_segments; //!< segments to send to the second stage loader
+    int m_fills_done;	    //!< number of the segments' zero fills sent
+    QByteArray m_flash_image; //!< image to write to the flash, padded to sectors, or empty
+    QVector<int> m_flash_sectors; //!< sectors of the flash which differ from the image
+    int m_flash_done;	    //!< number of the m_flash_sectors programmed
+    bool m_flash_boot;	    //!< true if the flash boot stub is to be put in front of m_flash_image
+    QByteArray m_reply;	    //!< reply of the second stage loader collected so far
+    quint32 m_fast_baud;    //!< baud rate for uploads after the header
+    qint32 m_saved_baud;    //!< baud rate to restore after the upload
+    QTimer m_ping_timer;    //!< timer to ping the second stage loader
+    int m_header_size;	    //!< size of the header in m_buffer
+    qint64 m_trace_start;   //!< Trace::now_ns() when the upload started, or 0
+    const char* m_trace_name; //!< name of the upload's trace event
 
     quint32 compute_checksum(const QByteArray& data);
-    bool load_single_data_txt(const QByteArray& data, bool patch_mode = false);
-    bool load_single_data_hex(const QByteArray& data, bool patch_mode = false);
+    void encode_image(const QByteArray& data, PropLoadMode mode, bool patch_mode = false);
+    static void encode_rle(QByteArray& dst, const uchar* src, int size);
     bool load_single_file(const QString& filename, bool patch_mode = false);
+    bool load_stage2();
+    bool load_elf_segments(const QString& filename, bool patch_mode);
+    bool start_upload(const QByteArray& data);
+    void send_buffer(UploadState state);
+    bool is_sending() const;
+    int line_timeout(int msecs) const;
+    void schedule_pump();
+    void all_sent();
+    bool switch_baud();
+    void start_stage2();
+    void sync_stage2();
+    void send_binary();
+    void send_zero_fill();
+    void add_flash_boot();
+    void send_flash_query();
+    void compare_flash_hashes();
+    void send_flash_sector();
+    void verify_flash_sector();
+    static quint32 flash_hash(const char* data, int size);
+    void report_progress();
+    void finish(bool ok);
 };
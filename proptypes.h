@@ -23,5 +23,6 @@ typedef enum {
     Serial_Baud115200 = QSerialPort::Baud115200,
     Serial_Baud230400 = 2*QSerialPort::Baud115200,
     Serial_Baud921600 = 8*QSerialPort::Baud115200,
-    Serial_Baud2000000 = 2000000
+    Serial_Baud2000000 = 2000000,
+    Serial_Baud3000000 = 3000000
 }   Serial_BaudRate;
@@ -8,6 +8,9 @@
  *
  *****************************************************************************/
 #include <QFile>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QTemporaryFile>
 #include <QMessageBox>
@@ -15,7 +18,9 @@
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QSettings>
+#include <QStandardPaths>
 #include <QCryptographicHash>
+#include <QRegularExpression>
 #include <QScrollArea>
 #include <QSplitter>
 #include <QFrame>
@@ -32,18 +37,39 @@
 #include "propedit.h"
 #include "qflexprop.h"
 #include "propload.h"
+#include "buildqueue.h"
+#include "flexspin.h"
+#include "serialworker.h"
 #include "aboutdlg.h"
 #include "ui_qflexprop.h"
 #include "serterm.h"
 #include "flexspindlg.h"
+#include "multiloaddlg.h"
 #include "serialportdlg.h"
 #include "settingsdlg.h"
+#include "statsdlg.h"
 #include "textbrowserdlg.h"
+#include "trace.h"
 
 QFlexProp::QFlexProp(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::QFlexProp)
     , m_dev(nullptr)
+    , m_rx_ring()
+    , m_rx_capture(new RxCapture())
+    , m_serial(new SerialWorker(&m_rx_ring, m_rx_capture))
+    , m_stats(new SerialStats(m_serial, m_rx_capture, this))
+    , m_stats_dlg()
+    , m_rx_timer()
+    , m_status(0)
+    , m_propload(nullptr)
+    , m_flexspin(nullptr)
+    , m_build_action(Build_Only)
+    , m_build_queue(nullptr)
+    , m_build_propedit()
+    , m_run_stage(Run_Idle)
+    , m_run_binary()
+    , m_run_tb()
     , m_fixedfont()
     , m_leds({
 	id_pwr,
@@ -77,6 +103,8 @@ QFlexProp::QFlexProp(QWidget *parent)
 	{id_pe,  false },
     })
     , m_labels()
+    , m_led_state()
+    , m_led_cache()
     , m_stty_operation()
     , m_port_name()
     , m_baud_rate(Serial_Baud230400)
@@ -85,6 +113,7 @@ QFlexProp::QFlexProp(QWidget *parent)
     , m_stop_bits(QSerialPort::OneStop)
     , m_flow_control(QSerialPort::NoFlowControl)
     , m_local_echo(false)
+    , m_upload_baud_rate(static_cast<Serial_BaudRate>(0))
     , m_flexspin_executable()
     , m_flexspin_include_paths()
     , m_flexspin_quiet(true)
@@ -96,6 +125,16 @@ QFlexProp::QFlexProp(QWidget *parent)
     , m_flexspin_skip_coginit(false)
     , m_compile_verbose_upload(false)
     , m_compile_switch_to_term(true)
+    , m_compile_binary_upload(false)
+    , m_capture_timestamps(false)
+    , m_stage2_cache()
+    , m_stage2_builds()
+    , m_stage2_wait()
+    , m_multi_wait()
+    , m_multi_binary()
+    , m_build_cache(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+		    .filePath(QLatin1String("build")))
+    , m_file_loader(new FileLoader(this))
 {
     ui->setupUi(this);
 
@@ -106,12 +145,39 @@ QFlexProp::QFlexProp(QWidget *parent)
     setup_signals();
     tab_changed(0);
 
+    m_rx_timer.setInterval(rx_frame_interval);
+    bool ok = connect(&m_rx_timer, &QTimer::timeout,
+		      this, &QFlexProp::rx_drain);
+    Q_ASSERT(ok);
+    m_rx_timer.start();
+    ok = connect(m_serial, &SerialWorker::StatusChanged,
+		 this, &QFlexProp::status_changed);
+    Q_ASSERT(ok);
+    ok = connect(m_serial, &SerialWorker::DtrPulsed,
+		 this, &QFlexProp::dtr_pulsed);
+    Q_ASSERT(ok);
+    ok = connect(m_rx_capture, &RxCapture::Error,
+		 this, &QFlexProp::capture_error);
+    Q_ASSERT(ok);
+    ok = connect(m_stats, &SerialStats::Error,
+		 this, &QFlexProp::stats_error);
+    Q_ASSERT(ok);
+    ok = connect(m_file_loader, &FileLoader::Loaded,
+		 this, &QFlexProp::file_loaded);
+    Q_ASSERT(ok);
+    ok = connect(m_file_loader, &FileLoader::Failed,
+		 this, &QFlexProp::file_load_failed);
+    Q_ASSERT(ok);
+
     QTimer::singleShot(100, this, &QFlexProp::configure_port);
 }
 
 QFlexProp::~QFlexProp()
 {
     save_settings();
+    m_rx_timer.stop();
+    delete m_serial;
+    delete m_rx_capture;
     delete ui;
 }
 
@@ -163,6 +229,23 @@ QTextBrowser* QFlexProp::current_textbrowser(int index) const
     return tb;
 }
 
+/**
+ * @brief Return the index of the tab editing @p filename
+ * @param filename source file name
+ * @return tab index, or -1 if the file is not open
+ */
+int QFlexProp::find_tab(const QString& filename) const
+{
+    const QString path = QFileInfo(filename).absoluteFilePath();
+    // the last tab is the terminal
+    for (int index = 0; index < ui->tabWidget->count() - 1; index++) {
+	const PropEdit* pe = current_propedit(index);
+	if (pe && QFileInfo(pe->filename()).absoluteFilePath() == path)
+	    return index;
+    }
+    return -1;
+}
+
 /**
  * @brief Preset a QFileDialog for loading an existing source file
  * @param title window title
@@ -298,6 +381,10 @@ void QFlexProp::setup_signals()
     connect(st, &SerTerm::update_pinout,
 	    this, &QFlexProp::update_pinout,
 	    Qt::UniqueConnection);
+    connect(st, &SerTerm::painted,
+	    m_stats, &SerialStats::painted,
+	    Qt::UniqueConnection);
+    st->set_worker(m_serial);
     connect(ui->tabWidget, &QTabWidget::currentChanged,
 	    this, &QFlexProp::tab_changed);
     connect(ui->tabWidget, &QTabWidget::tabCloseRequested,
@@ -305,19 +392,45 @@ void QFlexProp::setup_signals()
 }
 
 /**
- * @brief Slot called when the serial device has data to be read
+ * @brief Slot called on the frame timer to drain the receive ring
+ *
+ * The serial worker thread fills m_rx_ring at whatever rate the device
+ * delivers. Here the terminal gets the data in large batches, and at most
+ * rx_frame_bytes per frame, so that a flood of data can not starve the GUI.
  */
-void QFlexProp::dev_ready_read()
-{
-
-    qint64 available = m_dev->bytesAvailable();
-    if (available > 0) {
-	QByteArray data = m_dev->read(available);
-	DBG_DATA("%s: recv %d bytes\n%s", __func__, data.length(),
-		 qPrintable(util.dump(__func__, data)));
-	ui->terminal->write(data);
-	update_pinout(true);
+void QFlexProp::rx_drain()
+{
+    const qint64 stamp = m_serial->take_rx_stamp();
+    QElapsedTimer parse;
+    parse.start();
+    qint64 drained = 0;
+    while (drained < rx_frame_bytes) {
+	qint64 len = 0;
+	const char* src = m_rx_ring.read_span(&len);
+	if (!src)
+	    break;
+	len = qMin(len, rx_frame_bytes - drained);
+	DBG_DATA("%s: recv %lld bytes\n%s", __func__, len,
+		 qPrintable(util.dump(__func__, QByteArray::fromRawData(src, static_cast<int>(len)))));
+	ui->terminal->write(src, static_cast<size_t>(len));
+	m_rx_ring.consume(len);
+	drained += len;
     }
+    if (drained > 0) {
+	m_stats->add_parse(drained, parse.nsecsElapsed());
+	if (ui->terminal->isVisible())
+	    m_stats->delivered(stamp);
+    }
+}
+
+/**
+ * @brief Hand the open serial device over to the serial worker thread
+ */
+void QFlexProp::attach_port()
+{
+    if (m_propload || !m_dev || !m_dev->isOpen())
+	return;
+    m_serial->attach(m_dev);
 }
 
 /**
@@ -325,14 +438,12 @@ void QFlexProp::dev_ready_read()
  */
 void QFlexProp::dev_close()
 {
-    SerTerm* st = ui->tabWidget->findChild<SerTerm*>(id_terminal);
-    Q_ASSERT(st != nullptr);
     if (m_dev) {
 	qDebug("%s: deleting m_dev", __func__);
+	m_serial->detach();
 	m_dev->close();
 	m_dev->deleteLater();
 	m_dev = nullptr;
-	st->set_device(m_dev);
     }
 }
 
@@ -344,7 +455,11 @@ void QFlexProp::dev_write_data(const QByteArray& data)
 {
     Q_ASSERT(m_dev);
     DBG_DATA("%s: xmit %d bytes\n%s", __func__, data.length(), qPrintable(util.dump(__func__, data)));
-    m_dev->write(data);
+    if (m_serial->is_attached()) {
+	m_serial->write(data);
+    } else {
+	m_dev->write(data);
+    }
 }
 
 /**
@@ -355,6 +470,11 @@ void QFlexProp::dev_write_data(const QByteArray& data)
  */
 QPixmap QFlexProp::led(const QString& type, int state)
 {
+    const QPair<QString,int> key(type, state);
+    auto it = m_led_cache.constFind(key);
+    if (it != m_led_cache.constEnd())
+	return it.value();
+
     // This is how the led_*.png resource images are laid out
     static const QHash<QString,int> leds_xpos = {
 	{id_dcd,  0},
@@ -373,7 +493,25 @@ QPixmap QFlexProp::led(const QString& type, int state)
     QString name = QString("led_%1.png").arg(state);
     QPixmap pix = QPixmap(QString(":/images/%1").arg(name));
     QPixmap led = pix.copy(leds_xpos.value(type) * 64, 0, 64, 64);
-    return led.scaled(16, 16, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    led = led.scaled(16, 16, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    m_led_cache.insert(key, led);
+    return led;
+}
+
+/**
+ * @brief Set the LED label for @p type to @p state, if it changed
+ * @param type string constant with type name (dcd, dsr, dtr, ...)
+ * @param state LED state (off, red, green, yellow)
+ */
+void QFlexProp::set_led(const QString& type, int state)
+{
+    QLabel* label = m_labels.value(type);
+    if (!label)
+	return;
+    if (m_led_state.value(type, -1) == state)
+	return;
+    m_led_state.insert(type, state);
+    label->setPixmap(led(type, state));
 }
 
 /**
@@ -399,8 +537,10 @@ void QFlexProp::load_settings()
     const QString family = s.value(id_fixedfont_family, font_default).toString();
     const int size = s.value(id_fixedfont_size, 12).toInt();
     const int weight = s.value(id_fixedfont_weight, QFont::Normal).toInt();
+    m_capture_timestamps = s.value(id_capture_timestamps, false).toBool();
     s.endGroup();
     m_fixedfont = QFont(family, size, weight);
+    ui->action_Capture_timestamps->setChecked(m_capture_timestamps);
 
     s.beginGroup(id_grp_serialport);
     m_port_name = s.value(id_port_name, QLatin1String("ttyUSB0")).toString();
@@ -411,6 +551,7 @@ void QFlexProp::load_settings()
     m_stop_bits = static_cast<QSerialPort::StopBits>(s.value(id_stop_bits, m_stop_bits).toInt());
     m_flow_control = static_cast<QSerialPort::FlowControl>(s.value(id_flow_control, m_flow_control).toInt());
     m_local_echo = s.value(id_local_echo, false).toBool();
+    m_upload_baud_rate = static_cast<Serial_BaudRate>(s.value(id_upload_baud_rate, 0).toInt());
     s.endGroup();
 
     s.beginGroup(id_grp_enabled);
@@ -423,31 +564,30 @@ void QFlexProp::load_settings()
     s.endGroup();
     s.endGroup();
 
+    // the headless mode reads the same compiler settings
+    const Flexspin::Options fo = Flexspin::saved_options();
+    m_flexspin_executable = fo.executable;
+    m_flexspin_include_paths = fo.include_paths;
+    m_flexspin_quiet = fo.quiet;
+    m_flexspin_listing = fo.listing;
+    m_flexspin_warnings = fo.warnings;
+    m_flexspin_errors = fo.errors;
+    m_flexspin_hub_address = fo.hub_address;
+    m_flexspin_skip_coginit = fo.skip_coginit;
+
     s.beginGroup(id_grp_flexspin);
-    QString binary_dflt = QString("%1/bin/flexspin").arg(p2tools_path);
-    m_flexspin_executable = s.value(id_flexspin_executable, binary_dflt).toString();
-    QStringList include_paths_default;
-    include_paths_default += QString("%1/include").arg(p2tools_path);
-    m_flexspin_include_paths = s.value(id_flexspin_include_paths, include_paths_default).toStringList();
-    m_flexspin_quiet = s.value(id_flexspin_quiet, true).toBool();
     m_flexspin_optimize = s.value(id_flexspin_optimize, 1).toInt(&ok);
     if (!ok) {
 	m_flexspin_optimize = 1;
     }
-    m_flexspin_listing = s.value(id_flexspin_listing, false).toBool();
-    m_flexspin_warnings = s.value(id_flexspin_warnings, true).toBool();
-    m_flexspin_errors = s.value(id_flexspin_errors, false).toBool();
-    m_flexspin_hub_address = s.value(id_flexspin_hub_address, 0).toUInt(&ok);
-    if (!ok) {
-	m_flexspin_hub_address = 0;
-    }
-    m_flexspin_skip_coginit = s.value(id_flexspin_skip_coginit, false).toBool();
     m_compile_verbose_upload = s.value(id_compile_verbose_upload, false).toBool();
     m_compile_switch_to_term = s.value(id_compile_switch_to_term, true).toBool();
+    m_compile_binary_upload = s.value(id_compile_binary_upload, false).toBool();
     s.endGroup();
 
     ui->action_Verbose_upload->setChecked(m_compile_verbose_upload);
     ui->action_Switch_to_term->setChecked(m_compile_switch_to_term);
+    ui->action_Binary_upload->setChecked(m_compile_binary_upload);
 
     if (geometry.isEmpty()) {
         // First run: adjust the size of the main window
@@ -472,6 +612,7 @@ void QFlexProp::save_settings()
     s.setValue(id_fixedfont_family, family);
     s.setValue(id_fixedfont_size, size);
     s.setValue(id_fixedfont_weight, weight);
+    s.setValue(id_capture_timestamps, m_capture_timestamps);
     s.endGroup();
 
     s.beginGroup(id_grp_serialport);
@@ -483,6 +624,7 @@ void QFlexProp::save_settings()
     s.setValue(id_stop_bits, m_stop_bits);
     s.setValue(id_flow_control, m_flow_control);
     s.setValue(id_local_echo, m_local_echo);
+    s.setValue(id_upload_baud_rate, m_upload_baud_rate);
     s.endGroup();
     s.beginGroup(id_grp_enabled);
     foreach(const QString& id, m_enabled_elements.keys()) {
@@ -505,12 +647,27 @@ void QFlexProp::save_settings()
     s.setValue(id_flexspin_skip_coginit, m_flexspin_skip_coginit);
     s.setValue(id_compile_verbose_upload, m_compile_verbose_upload);
     s.setValue(id_compile_switch_to_term, m_compile_switch_to_term);
+    s.setValue(id_compile_binary_upload, m_compile_binary_upload);
     s.endGroup();
 }
 
+/**
+ * @brief Slot called when the serial worker reports a changed status
+ * @param status QSerialPort::PinoutSignals ORed with SerialWorker::Status_* bits
+ */
+void QFlexProp::status_changed(quint32 status)
+{
+    m_status = status;
+    update_pinout();
+}
+
 /**
  * @brief Update the statusbar items and LEDs for the current signal states
- * @param redo if true, redo this update after 25 milliseconds
+ *
+ * While the serial worker owns the device, the status it last reported
+ * is used; otherwise the device is queried directly. Only labels whose
+ * state changed are touched.
+ * @param redo if true, also update the baud rate, parity, and flow control
  */
 void QFlexProp::update_pinout(bool redo)
 {
@@ -519,55 +676,31 @@ void QFlexProp::update_pinout(bool redo)
     static const int grn = 2;
     static const int yel = 3;
 
-    if (m_labels.contains(id_pwr)) {
-	m_labels[id_pwr]->setPixmap(led(id_pwr, m_dev->isOpen() ? yel : off));
-    }
-    if (m_labels.contains(id_rxd)) {
-	m_labels[id_rxd]->setPixmap(led(id_rxd, m_dev->bytesAvailable() > 0 ? yel : grn));
-    }
-    if (m_labels.contains(id_txd)) {
-	m_labels[id_txd]->setPixmap(led(id_txd, m_dev->bytesToWrite() > 0 ? yel : grn));
-    }
-
-    QSerialPort* stty = qobject_cast<QSerialPort*>(m_dev);
-    if (stty) {
-	QSerialPort::PinoutSignals pin = stty->pinoutSignals();
-	const QSerialPort::SerialPortError err = stty->error();
-
-	if (m_labels.contains(id_dcd)) {
-	    m_labels[id_dcd]->setPixmap(led(id_dcd, pin.testFlag(QSerialPort::DataCarrierDetectSignal) ? red : off));
-	}
-	if (m_labels.contains(id_dtr)) {
-	    m_labels[id_dtr]->setPixmap(led(id_dtr, pin.testFlag(QSerialPort::DataTerminalReadySignal) ? grn : off));
-	}
-	if (m_labels.contains(id_dsr)) {
-	    m_labels[id_dsr]->setPixmap(led(id_dsr, pin.testFlag(QSerialPort::DataSetReadySignal) ? red : off));
-	}
-	if (m_labels.contains(id_rts)) {
-	    m_labels[id_rts]->setPixmap(led(id_rts, pin.testFlag(QSerialPort::RequestToSendSignal) ? grn : off));
-	}
-	if (m_labels.contains(id_cts)) {
-	    m_labels[id_cts]->setPixmap(led(id_cts, pin.testFlag(QSerialPort::ClearToSendSignal) ? red : off));
-	}
-	if (m_labels.contains(id_brk)) {
-	    m_labels[id_brk]->setPixmap(led(id_brk, stty->isBreakEnabled() ? red : off));
-	}
-	if (m_labels.contains(id_ri)) {
-	    m_labels[id_ri]->setPixmap(led(id_ri, pin.testFlag(QSerialPort::RingIndicatorSignal) ? red : off));
-	}
-	if (m_labels.contains(id_fe)) {
-	    m_labels[id_fe]->setPixmap(led(id_fe, QSerialPort::FramingError == err ? red : off));
-	}
-	if (m_labels.contains(id_pe)) {
-	    m_labels[id_pe]->setPixmap(led(id_pe, QSerialPort::ParityError == err ? red : off));
-	}
+    const quint32 status = m_serial->is_attached()
+			   ? m_status
+			   : SerialWorker::poll_status(m_dev);
+    const bool rx = (status & SerialWorker::Status_Rx) || !m_rx_ring.isEmpty();
+
+    set_led(id_pwr, (status & SerialWorker::Status_Open) ? yel : off);
+    set_led(id_rxd, rx ? yel : grn);
+    set_led(id_txd, (status & SerialWorker::Status_Tx) ? yel : grn);
+
+    if (qobject_cast<QSerialPort*>(m_dev)) {
+	set_led(id_dcd, (status & QSerialPort::DataCarrierDetectSignal) ? red : off);
+	set_led(id_dtr, (status & QSerialPort::DataTerminalReadySignal) ? grn : off);
+	set_led(id_dsr, (status & QSerialPort::DataSetReadySignal) ? red : off);
+	set_led(id_rts, (status & QSerialPort::RequestToSendSignal) ? grn : off);
+	set_led(id_cts, (status & QSerialPort::ClearToSendSignal) ? red : off);
+	set_led(id_brk, (status & SerialWorker::Status_Break) ? red : off);
+	set_led(id_ri, (status & QSerialPort::RingIndicatorSignal) ? red : off);
+	set_led(id_fe, (status & SerialWorker::Status_FramingError) ? red : off);
+	set_led(id_pe, (status & SerialWorker::Status_ParityError) ? red : off);
     }
 
     if (redo) {
 	update_baud_rate();
 	update_parity_data_stop();
 	update_flow_control();
-	QTimer::singleShot(25, this, SLOT(dev_ready_read()));
     }
 }
 
@@ -590,9 +723,15 @@ void QFlexProp::tab_changed(int index)
 
     ui->action_Verbose_upload->setEnabled(enable);
     ui->action_Switch_to_term->setEnabled(enable);
-    ui->action_Build->setEnabled(enable);
-    ui->action_Upload->setEnabled(enable);
-    ui->action_Run->setEnabled(enable);
+    ui->action_Binary_upload->setEnabled(enable);
+    const bool building = m_flexspin != nullptr || m_build_queue != nullptr;
+    ui->action_Run_multiple->setEnabled(enable && !building);
+    ui->action_Build->setEnabled(enable && !building);
+    ui->action_Build_all->setEnabled(!building);
+    ui->action_Upload->setEnabled(enable && !building);
+    ui->action_Run->setEnabled(enable && !building);
+    ui->action_Flash_build->setEnabled(enable && !building);
+    ui->action_Cancel_build->setEnabled(building);
     if (index == ui->tabWidget->count() - 1) {
 	// Make sure that instead of the tab the terminal has the focus
 	ui->terminal->setFocus();
@@ -616,6 +755,10 @@ void QFlexProp::tab_close_requested(int index)
 	    pe->save(pe->filename());
 	}
     }
+    if (m_flexspin && m_build_propedit == pe) {
+	// the build's output has nowhere to go
+	m_flexspin->cancel();
+    }
     ui->tabWidget->removeTab(index);
 }
 
@@ -838,8 +981,10 @@ void QFlexProp::error_occured(QSerialPort::SerialPortError error)
 	message = tr("Device %1 is not opened.").arg(m_port_name);
 	break;
     }
-    if (!message.isEmpty())
+    if (!message.isEmpty()) {
+	m_stats->add_error();
 	log_error(message, true);
+    }
 }
 
 /**
@@ -925,10 +1070,11 @@ void QFlexProp::setup_statusbar()
  */
 void QFlexProp::setup_port()
 {
-    SerTerm* st = ui->tabWidget->findChild<SerTerm*>(id_terminal);
-    Q_ASSERT(st);
     bool ok;
 
+    // take the device back from the worker before replacing it
+    m_serial->detach();
+
     QSerialPortInfo si(m_port_name);
     if (si.isNull()) {
 	m_dev = new QFile(m_port_name);
@@ -999,11 +1145,6 @@ void QFlexProp::setup_port()
 	}
     }
 
-    ok = connect(m_dev, &QSerialPort::readyRead,
-		 this, &QFlexProp::dev_ready_read,
-		 Qt::UniqueConnection);
-    Q_ASSERT(ok);
-    st->set_device(m_dev);
 }
 
 /**
@@ -1086,9 +1227,11 @@ void QFlexProp::configure_port()
     } while (0);
 #endif
 
+    attach_port();
     setup_mainwindow();
     update_parity_data_stop();
     update_pinout();
+    prepare_stage2();
 }
 
 /**
@@ -1096,6 +1239,9 @@ void QFlexProp::configure_port()
  */
 void QFlexProp::close_port()
 {
+    if (m_propload)
+	m_propload->abort();
+    m_serial->detach();
     disconnect(m_dev);
     m_dev->close();
     setup_mainwindow();
@@ -1109,7 +1255,6 @@ void QFlexProp::close_port()
  */
 int QFlexProp::insert_tab(const QString& filename)
 {
-    QLocale locale = QLocale::system();
     QSettings s;
     const int tabs = ui->tabWidget->count();
     const int tabidx = tabs - 1;
@@ -1156,15 +1301,11 @@ int QFlexProp::insert_tab(const QString& filename)
     ui->tabWidget->setCurrentIndex(tabidx);
 
     if (info.exists()) {
-	if (pe->load(info.absoluteFilePath())) {
-	    log_message(tr("Loaded file '%1' (%2 Bytes).")
-			.arg(info.fileName())
-			.arg(locale.toString(info.size())));
-	    ui->tabWidget->setCurrentIndex(tabidx);
-	} else {
-	    log_message(tr("Could not load file '%1'.")
-			.arg(info.fileName()));
-	}
+	// the tab shows the loading state until file_loaded() fills it
+	pe->set_loading(info.absoluteFilePath());
+	m_file_loader->load(info.absoluteFilePath());
+    } else {
+	pe->setFilename(info.absoluteFilePath());
     }
     QString title = QString("%1 [%2]")
                     .arg(info.fileName())
@@ -1386,6 +1527,39 @@ void QFlexProp::line_number_finished()
     pe->gotoLineNumber(lnum);
 }
 
+/**
+ * @brief Edit -> Next error action
+ */
+void QFlexProp::on_action_Next_error_triggered()
+{
+    goto_diagnostic(false);
+}
+
+/**
+ * @brief Edit -> Previous error action
+ */
+void QFlexProp::on_action_Previous_error_triggered()
+{
+    goto_diagnostic(true);
+}
+
+/**
+ * @brief Move to the next or previous diagnostic in the current tab and show it
+ * @param backward if true, go to the previous diagnostic
+ */
+void QFlexProp::goto_diagnostic(bool backward)
+{
+    PropEdit* pe = current_propedit();
+    if (!pe)
+	return;
+    const int lnum = backward ? pe->goto_previous_diagnostic() : pe->goto_next_diagnostic();
+    if (lnum > 0) {
+	log_status(tr("Line %1: %2").arg(lnum).arg(pe->diagnostic(lnum).section(QChar::LineFeed, 0, 0)));
+    } else {
+	QApplication::beep();
+    }
+}
+
 void QFlexProp::on_action_Goto_line_triggered()
 {
     QWidget* wdg = ui->tabWidget->widget(ui->tabWidget->currentIndex());
@@ -1460,6 +1634,7 @@ void QFlexProp::on_action_Configure_serialport_triggered()
     settings.stop_bits = m_stop_bits;
     settings.flow_control = m_flow_control;
     settings.local_echo = m_local_echo;
+    settings.upload_baud_rate = m_upload_baud_rate;
     dlg.set_settings(settings);
 
     if (QDialog::Accepted != dlg.exec())
@@ -1477,6 +1652,7 @@ void QFlexProp::on_action_Configure_serialport_triggered()
     m_stop_bits = settings.stop_bits;
     m_flow_control = settings.flow_control;
     m_local_echo = settings.local_echo;
+    m_upload_baud_rate = settings.upload_baud_rate;
     if (was_open) {
 	configure_port();
     } else {
@@ -1507,6 +1683,10 @@ void QFlexProp::on_action_Configure_flexspin_triggered()
 	return;
 
     f = dlg.settings();
+    if (f.executable != m_flexspin_executable) {
+	// loaders built by another flexspin are not used anymore
+	m_stage2_cache.clear();
+    }
     m_flexspin_executable = f.executable;
     m_flexspin_quiet = f.quiet;
     m_flexspin_include_paths = f.include_paths;
@@ -1529,6 +1709,7 @@ void QFlexProp::on_action_Configure_flexspin_triggered()
     s.setValue(id_flexspin_hub_address, m_flexspin_hub_address);
     s.setValue(id_flexspin_skip_coginit, m_flexspin_skip_coginit);
     s.endGroup();
+    prepare_stage2();
 }
 
 /**
@@ -1539,9 +1720,9 @@ void QFlexProp::on_action_Show_listing_triggered()
     PropEdit* pe = current_propedit();
     if (!pe)
 	return;
-    QString text = pe->property(id_tab_lst).toString();
+    // decoded line by line as it is shown, since listings can be large
     TextBrowserDlg dlg(this);
-    dlg.set_text(text);
+    dlg.set_text(pe->property(id_tab_lst).toByteArray());
     dlg.exec();
 }
 
@@ -1550,9 +1731,8 @@ void QFlexProp::on_action_Show_intermediate_triggered()
     PropEdit* pe = current_propedit();
     if (!pe)
 	return;
-    QString text = pe->property(id_tab_p2asm).toString();
     TextBrowserDlg dlg(this);
-    dlg.set_text(text);
+    dlg.set_text(pe->property(id_tab_p2asm).toByteArray());
     dlg.exec();
 }
 
@@ -1564,10 +1744,8 @@ void QFlexProp::on_action_Show_binary_triggered()
     PropEdit* pe = current_propedit();
     if (!pe)
 	return;
-    QByteArray data = pe->property(id_tab_binary).toByteArray();
-    QString dump = util.dump(QString(), data);
     TextBrowserDlg dlg(this);
-    dlg.set_text(dump);
+    dlg.set_binary(pe->property(id_tab_binary).toByteArray());
     dlg.exec();
 }
 
@@ -1580,361 +1758,1125 @@ void QFlexProp::on_action_Toggle_80_132_mode_triggered()
 }
 
 /**
- * @brief Compile -> Verbose upload action
+ * @brief View -> Capture received data action
+ *
+ * When checked, everything received from the serial port is written
+ * to a file in addition to the terminal, until it is unchecked again.
  */
-void QFlexProp::on_action_Verbose_upload_triggered()
-{
-    m_compile_verbose_upload = ui->action_Verbose_upload->isChecked();
-}
+void QFlexProp::on_action_Capture_rx_triggered()
+{
+    if (!ui->action_Capture_rx->isChecked()) {
+	const QString filename = QFileInfo(m_rx_capture->filename()).fileName();
+	m_rx_capture->stop();
+	QString message = tr("Captured %1 bytes to '%2'.")
+			  .arg(m_rx_capture->captured())
+			  .arg(filename);
+	if (m_rx_capture->dropped() > 0)
+	    message += tr(" %1 bytes were dropped.").arg(m_rx_capture->dropped());
+	log_status(message);
+	return;
+    }
 
-/**
- * @brief Compile -> Switch to term action
- */
-void QFlexProp::on_action_Switch_to_term_triggered()
-{
-    m_compile_switch_to_term = ui->action_Switch_to_term->isChecked();
+    QFileDialog dlg(this);
+    QSettings s;
+    s.beginGroup(id_grp_application);
+    QStringList documents = QStandardPaths::standardLocations(QStandardPaths::DocumentsLocation);
+    QString capdflt = documents.isEmpty()
+		      ? QDir::homePath()
+		      : documents.first();
+    QString capdir = s.value(id_capture_dir, capdflt).toString();
+    s.endGroup();
+    QStringList filetypes = {
+	{"Capture (*.cap)"},
+	{"All files (*.*)"},
+    };
+
+    dlg.setWindowTitle(tr("Capture received data to file"));
+    dlg.setAcceptMode(QFileDialog::AcceptSave);
+    dlg.setDirectory(capdir);
+    dlg.setFileMode(QFileDialog::AnyFile);
+    dlg.setNameFilters(filetypes);
+    dlg.setDefaultSuffix(QLatin1String("cap"));
+    dlg.setOption(QFileDialog::DontUseNativeDialog, true);
+    dlg.setViewMode(QFileDialog::Detail);
+    dlg.selectFile(QString("capture-%1.cap")
+		   .arg(QDateTime::currentDateTime().toString(QLatin1String("yyyyMMdd-hhmmss"))));
+
+    QStringList files;
+    if (QFileDialog::Accepted == dlg.exec())
+	files = dlg.selectedFiles();
+    if (files.isEmpty() || !m_rx_capture->start(files.first(), m_capture_timestamps)) {
+	ui->action_Capture_rx->setChecked(false);
+	return;
+    }
+
+    s.beginGroup(id_grp_application);
+    s.setValue(id_capture_dir, QFileInfo(files.first()).dir().absolutePath());
+    s.endGroup();
+    log_status(tr("Capturing received data to '%1'.")
+	       .arg(QFileInfo(files.first()).fileName()));
 }
 
 /**
- * @brief Return a quoted string if @p src contains a space
- * @param src const reference to the source string
- * @param quote character to use for quoting
- * @return quoted or original string
+ * @brief View -> Capture with timestamps action
  */
-QString QFlexProp::quoted(const QString& src, const QChar quote)
+void QFlexProp::on_action_Capture_timestamps_triggered()
 {
-    if (src.contains(QChar::Space))
-	return QString("%1%2%3").arg(quote).arg(src).arg(quote);
-    return src;
+    m_capture_timestamps = ui->action_Capture_timestamps->isChecked();
 }
 
 /**
- * @brief Run flexspin with the configured switches and return the results
- * @param p_binary pointer to a QByteArray for the binary result
- * @param p_p2asm pointer to a QString for the p2asm output
- * @param p_lst pointer to a QString for the listing
- * @return true on success, or false on error
+ * @brief View -> Record trace action
+ *
+ * Checking it starts recording the hot paths; unchecking it stops
+ * recording and asks for a file to export the trace to.
  */
-bool QFlexProp::flexspin(QByteArray* p_binary, QString* p_p2asm, QString* p_lst)
+void QFlexProp::on_action_Record_trace_triggered()
 {
-    QTextBrowser *tb = current_textbrowser();
-    Q_ASSERT(tb);
-    PropEdit *pe = current_propedit();
-    if (!pe)
-	return false;
-
-    tb->clear();
-
-    QFile src(pe->filename());
-    QStringList args;
-
-    // compile for Prop2
-    args += QStringLiteral("-2");
-
-    // quiet mode if enabled
-    if (m_flexspin_quiet)
-	args += QStringLiteral("-q");
-
-    // append include paths
-    foreach(const QString& include_path, m_flexspin_include_paths) {
-	// We need to quote paths with embedded spaces (e.g. Windows)
-	args += QString("-I %1").arg(quoted(include_path));
+    if (ui->action_Record_trace->isChecked()) {
+	Trace::set_enabled(true);
+	log_status(tr("Recording a trace."));
+	return;
     }
 
-    // define the current terminal baud rate
-    args += QString("-D _BAUD=%1").arg(m_baud_rate);
-
-    // generate a listing if enabled
-    if (m_flexspin_listing)
-	args += QStringLiteral("-l");
-
-    // add option for warnings if enabled
-    if (m_flexspin_warnings)
-	args += QStringLiteral("-Wall");
-
-    // add option for errors if enabled
-    if (m_flexspin_errors)
-	args += QStringLiteral("-Werror");
-
-    // append a HUB address if configured
-    if (m_flexspin_hub_address > 0) {
-	args += QString("-H %1").arg(m_flexspin_hub_address, 4, 16, QChar('0'));
-	// Add flag for skip coginit
-	if (m_flexspin_skip_coginit)
-	    args += QStringLiteral("-E");
+    Trace::set_enabled(false);
+    QSettings s;
+    s.beginGroup(id_grp_application);
+    QString dir = s.value(id_trace_dir, QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).toString();
+    const QString filename = QFileDialog::getSaveFileName(this,
+	tr("Save trace"),
+	QDir(dir).filePath(QString("trace-%1.json")
+			   .arg(QDateTime::currentDateTime().toString(QLatin1String("yyyyMMdd-hhmmss")))),
+	tr("Chrome trace (*.json);;All files (*)"));
+    if (filename.isEmpty()) {
+	s.endGroup();
+	return;
     }
+    s.setValue(id_trace_dir, QFileInfo(filename).absolutePath());
+    s.endGroup();
 
-    // add source filename
-    args += src.fileName();
-
-    // print the command to be executed
-    tb->setTextColor(Qt::blue);
-    tb->append(QString("%1 %2")
-	       .arg(m_flexspin_executable)
-	       .arg(args.join(QStringLiteral(" \\\n\t"))));
-
-    QProcess process(this);
-    process.setProperty(id_process_tb, QVariant::fromValue(tb));
-    process.setProgram(m_flexspin_executable);
-#if defined(Q_OS_WIN)
-    // Windows really sucks: not even argument passing to a process works as elsewhere
-    process.setNativeArguments(args.join(QChar::Space));
-#else
-    process.setArguments(args);
-#endif
-    connect(&process, &QProcess::channelReadyRead,
-	    this, &QFlexProp::channelReadyRead);
-
-    // run the command
-    process.start();
-    if (QProcess::Starting == process.state()) {
-	if (!process.waitForStarted()) {
-	    qCritical("%s: result code %d", __func__, process.exitCode());
-	    tb->setTextColor(Qt::red);
-	    tb->append(tr("Result code %1.").arg(process.exitCode()));
-	    return false;
-	}
+    QString error;
+    if (!Trace::write_chrome_json(filename, &error)) {
+	log_error(error);
+	return;
     }
+    log_status(tr("Trace written to '%1'.")
+	       .arg(QFileInfo(filename).fileName()));
+}
 
-    // wait for the process to finish
-    do {
-	if (!process.waitForFinished()) {
-	    qCritical("%s: result code %d", __func__, process.exitCode());
-	    tb->setTextColor(Qt::red);
-	    tb->append(tr("Result code %1.").arg(process.exitCode()));
-	    return false;
-	}
-    } while (QProcess::Running == process.state());
-
-    QFileInfo info(src.fileName());
-
-    // check, load, and remove listing file
-    QString lst_filename = QString("%1/%2.lst")
-			     .arg(info.absoluteDir().path())
-			     .arg(info.baseName());
-    QFile lst(lst_filename);
-    if (lst.exists()) {
-	if (lst.open(QIODevice::ReadOnly)) {
-	    QString listing = QString::fromUtf8(lst.readAll());
-	    pe->setProperty(id_tab_lst, listing);
-	    if (p_lst) {
-		// caller wants the listing
-		*p_lst = listing;
-	    }
-	    lst.close();
-	}
-	lst.remove();
-    }
-
-    // check, load, and remove intermediate p2asm file
-    QString p2asm_filename = QString("%1/%2.p2asm")
-			     .arg(info.absoluteDir().path())
-			     .arg(info.baseName());
-    QFile p2asm(p2asm_filename);
-    if (p2asm.exists()) {
-	if (p2asm.open(QIODevice::ReadOnly)) {
-	    QString output = QString::fromUtf8(p2asm.readAll());
-	    pe->setProperty(id_tab_p2asm, output);
-	    if (p_p2asm) {
-		// caller wants the output
-		*p_p2asm = output;
-	    }
-	    p2asm.close();
-	}
-	p2asm.remove();
-    }
-
-    // check, load, and remove resulting binary file
-    QString binary_filename = QString("%1/%2.binary")
-				.arg(info.absoluteDir().path())
-				.arg(info.baseName());
-    QFile binfile(binary_filename);
-    if (binfile.exists()) {
-	if (binfile.open(QIODevice::ReadOnly)) {
-	    QByteArray binary = binfile.readAll();
-	    pe->setProperty(id_tab_binary, binary);
-	    if (p_binary) {
-		// caller wants the binary
-		*p_binary = binary;
-	    }
-	    binfile.close();
-	}
-	binfile.remove();
+/**
+ * @brief View -> Serial statistics action
+ */
+void QFlexProp::on_action_Serial_statistics_triggered()
+{
+    if (m_stats_dlg) {
+	m_stats_dlg->raise();
+	m_stats_dlg->activateWindow();
+	return;
     }
-
-    tab_changed(ui->tabWidget->currentIndex());
-
-    return true;
+    m_stats_dlg = new StatsDlg(m_stats, this);
+    m_stats_dlg->setAttribute(Qt::WA_DeleteOnClose);
+    m_stats_dlg->show();
 }
 
 /**
- * @brief Compile -> Build action
+ * @brief Slot called when creating or writing the statistics file failed
+ * @param message error message
  */
-void QFlexProp::on_action_Build_triggered()
+void QFlexProp::stats_error(const QString& message)
 {
-    flexspin();
+    log_error(message);
 }
 
 /**
- * @brief Compile -> Upload action
+ * @brief Slot called when the FileLoader read a file
+ *
+ * Each tab which is loading @p filename is filled with the text.
+ * @param filename absolute path of the file
+ * @param text const reference to the text of the file
+ * @param sha256 SHA-256 hash of the text
  */
-void QFlexProp::on_action_Upload_triggered()
+void QFlexProp::file_loaded(const QString& filename, const QString& text, const QByteArray& sha256)
 {
-    PropEdit* pe = current_propedit();
-    Q_ASSERT(pe);
-    QByteArray binary = pe->property(id_tab_binary).toByteArray();
-    if (binary.isEmpty()) {
-	// Need to compile first
-	flexspin(&binary);
+    QLocale locale = QLocale::system();
+    const QFileInfo info(filename);
+    // the last tab is the terminal
+    for (int index = 0; index < ui->tabWidget->count() - 1; index++) {
+	PropEdit* pe = current_propedit(index);
+	if (!pe || !pe->loading() || pe->filename() != filename)
+	    continue;
+	pe->set_loaded_text(text, sha256);
+	log_message(tr("Loaded file '%1' (%2 Bytes).")
+		    .arg(info.fileName())
+		    .arg(locale.toString(info.size())));
     }
 }
 
 /**
- * @brief Compile -> Run action
+ * @brief Slot called when the FileLoader could not read a file
+ *
+ * The tabs which were loading @p filename are closed, so that saving
+ * them can not overwrite the file with an empty text.
+ * @param filename absolute path of the file
+ * @param error error message
  */
-void QFlexProp::on_action_Run_triggered()
-{
-    SerTerm* st = ui->tabWidget->findChild<SerTerm*>(id_terminal);
-    Q_ASSERT(st);
-    QTextBrowser* tb = current_textbrowser();
-    Q_ASSERT(tb);
-
-    // compile and get resulting binary
-    QByteArray binary;
-    if (!flexspin(&binary))
-	return;
-
-    // if binary is empty we do not upload, of course
-    if (binary.isEmpty())
-	return;
-
-    // disconnect from the readyRead() signal during upload
-    disconnect(m_dev, &QSerialPort::readyRead,
-	       this, &QFlexProp::dev_ready_read);
-    st->reset();
-    PropLoad propload(m_dev, this);
-    // propload.set_mode(PropLoad::Prop_Txt);
-    propload.set_verbose(m_compile_verbose_upload);
-    propload.set_clock_freq(180000000);
-    propload.set_clock_mode(0);
-    propload.set_user_baud(m_baud_rate);
-    // phex.set_use_checksum(false);
-    propload.setProperty(id_process_tb, QVariant::fromValue(tb));
-    connect(&propload, &PropLoad::Error,
-	    this, &QFlexProp::printError);
-    connect(&propload, &PropLoad::Message,
-	    this, &QFlexProp::printMessage);
-    connect(&propload, &PropLoad::Progress,
-	    this, &QFlexProp::showProgress);
-    bool ok = propload.load_data(binary);
-
-    // re-connect to the readyRead() signal
-    connect(m_dev, &QSerialPort::readyRead,
-	    this, &QFlexProp::dev_ready_read,
-	    Qt::UniqueConnection);
-    if (ok) {
-	if (m_compile_switch_to_term) {
-	    // Select the terminal tab
-	    ui->tabWidget->setCurrentWidget(ui->terminal);
-	    ui->terminal->setFocus();
-	}
-	// Process any data which may have been received
-	// while the readyRead signal was disconnected
-	if (m_dev->bytesAvailable() > 0) {
-	    dev_ready_read();
-	}
+void QFlexProp::file_load_failed(const QString& filename, const QString& error)
+{
+    // the last tab is the terminal
+    for (int index = ui->tabWidget->count() - 2; index >= 0; index--) {
+	PropEdit* pe = current_propedit(index);
+	if (!pe || !pe->loading() || pe->filename() != filename)
+	    continue;
+	QWidget* tab = ui->tabWidget->widget(index);
+	ui->tabWidget->removeTab(index);
+	tab->deleteLater();
+	log_error(tr("Could not load file '%1': %2")
+		  .arg(QFileInfo(filename).fileName())
+		  .arg(error));
     }
 }
 
 /**
- * @brief Help -> About action
+ * @brief Slot called when creating or writing the capture file failed
+ * @param message error message
  */
-void QFlexProp::on_action_About_triggered()
+void QFlexProp::capture_error(const QString& message)
 {
-    AboutDlg dlg(this);
-    dlg.exec();
+    log_error(message);
+    m_rx_capture->stop();
+    ui->action_Capture_rx->setChecked(false);
 }
 
 /**
- * @brief Help -> About Qt5 action
+ * @brief Compile -> Verbose upload action
  */
-void QFlexProp::on_action_About_Qt5_triggered()
+void QFlexProp::on_action_Verbose_upload_triggered()
 {
-    qApp->aboutQt();
+    m_compile_verbose_upload = ui->action_Verbose_upload->isChecked();
 }
 
 /**
- * @brief Slot called when a process output channel has data to be read
- * @param channel which channel (stdout or stderr)
+ * @brief Compile -> Switch to term action
  */
-void QFlexProp::channelReadyRead(int channel)
+void QFlexProp::on_action_Switch_to_term_triggered()
 {
-    QProcess* process = qobject_cast<QProcess*>(sender());
-    if (!process)
-	return;
-    QTextBrowser* tb = qvariant_cast<QTextBrowser*>(process->property(id_process_tb));
-    if (!tb)
-	return;
-    process->setReadChannel(static_cast<QProcess::ProcessChannel>(channel));
-    QString message = QString::fromUtf8(process->readAll());
-    switch (channel) {
-    case QProcess::StandardOutput:
-	printMessage(message);
-	break;
-    case QProcess::StandardError:
-	printError(message);
-	break;
-    }
+    m_compile_switch_to_term = ui->action_Switch_to_term->isChecked();
 }
 
 /**
- * @brief Print an error message to the tab's QTextBrowser
- * @param message text to print
+ * @brief Compile -> Binary upload action
  */
-void QFlexProp::printError(const QString& message)
+void QFlexProp::on_action_Binary_upload_triggered()
 {
-    QEventLoop loop(this);
-    QTextBrowser* tb = qvariant_cast<QTextBrowser*>(sender()->property(id_process_tb));
-    if (!tb)
-	return;
-    tb->setTextColor(Qt::red);
-    tb->append(message);
-    loop.processEvents();
+    m_compile_binary_upload = ui->action_Binary_upload->isChecked();
+    prepare_stage2();
 }
 
 /**
- * @brief Print a normal message to the tab's QTextBrowser
- * @param message text to print
+ * @brief Return the flexspin options from the current settings
+ * @return Flexspin::Options
  */
-void QFlexProp::printMessage(const QString& message)
+Flexspin::Options QFlexProp::flexspin_options() const
 {
-    QEventLoop loop(this);
-    QTextBrowser* tb = qvariant_cast<QTextBrowser*>(sender()->property(id_process_tb));
-    if (!tb)
-	return;
-    tb->setTextColor(Qt::black);
-    tb->append(message);
-    loop.processEvents();
+    Flexspin::Options options;
+    options.executable = m_flexspin_executable;
+    options.include_paths = m_flexspin_include_paths;
+    options.baud_rate = m_baud_rate;
+    options.quiet = m_flexspin_quiet;
+    options.listing = m_flexspin_listing;
+    options.warnings = m_flexspin_warnings;
+    options.errors = m_flexspin_errors;
+    options.hub_address = m_flexspin_hub_address;
+    options.skip_coginit = m_flexspin_skip_coginit;
+    return options;
 }
 
 /**
- * @brief Update the statusbar's progress bar
- * @param value current value
- * @param total maximum value (which equals 100%)
+ * @brief Start flexspin on the source in the current tab
+ *
+ * The build runs asynchronously. Its output is streamed into the tab's
+ * QTextBrowser, and when it is finished flexspin_finished() stores the
+ * results and performs the @p action.
+ * @param action what to do with the binary after a successful build
+ * @return true if the build was started, or false otherwise
  */
-void QFlexProp::showProgress(qint64 value, qint64 total)
+bool QFlexProp::flexspin(BuildAction action)
 {
-    QEventLoop loop(this);
-    QProgressBar* pb = ui->statusbar->findChild<QProgressBar*>(id_progress);
-    if (!pb)
-	return;
-
-    // Scale down to 32 bit integer range
-    while (total >= INT32_MAX) {
-	total >>= 10;
+    if (m_flexspin || m_build_queue) {
+	// a build is still running
+	return false;
+    }
+    QTextBrowser *tb = current_textbrowser();
+    Q_ASSERT(tb);
+    PropEdit *pe = current_propedit();
+    if (!pe)
+	return false;
+
+    tb->clear();
+    // printMessage() and printError() mark them again, also from the
+    // compiler output a build served from the cache replays
+    pe->clear_diagnostics();
+
+    m_flexspin = new Flexspin(flexspin_options(), this);
+    m_flexspin->set_cache(&m_build_cache);
+    m_flexspin->setProperty(id_process_tb, QVariant::fromValue(tb));
+    m_build_action = action;
+    m_build_propedit = pe;
+    m_run_stage = Build_Run == action ? Run_Compiling : Run_Idle;
+    m_run_binary.clear();
+
+    // print the command to be executed
+    tb->setTextColor(Qt::blue);
+    tb->append(m_flexspin->command_line(pe->filename()));
+
+    bool ok;
+    ok = connect(m_flexspin, &Flexspin::Error,
+		 this, &QFlexProp::printError);
+    Q_ASSERT(ok);
+    ok = connect(m_flexspin, &Flexspin::Message,
+		 this, &QFlexProp::printMessage);
+    Q_ASSERT(ok);
+    ok = connect(m_flexspin, &Flexspin::Compiled,
+		 this, &QFlexProp::flexspin_compiled);
+    Q_ASSERT(ok);
+    ok = connect(m_flexspin, &Flexspin::Finished,
+		 this, &QFlexProp::flexspin_finished);
+    Q_ASSERT(ok);
+
+    m_flexspin->start(pe->filename());
+    tab_changed(ui->tabWidget->currentIndex());
+    return true;
+}
+
+/**
+ * @brief Slot called when the compiler of a build started by flexspin() exited successfully
+ *
+ * For Run the board is reset now, while the results are still being
+ * collected, so that its ROM loader is waiting when the binary is ready.
+ */
+void QFlexProp::flexspin_compiled()
+{
+    if (Run_Compiling != m_run_stage)
+	return;
+    if (m_propload || !m_serial->is_attached())
+	return;
+    SerTerm* st = ui->tabWidget->findChild<SerTerm*>(id_terminal);
+    Q_ASSERT(st);
+    m_run_stage = Run_Resetting;
+    st->reset_prop();
+}
+
+/**
+ * @brief Slot called when the serial worker finished pulsing DTR
+ *
+ * If the Run pipeline reset the board, its binary is uploaded as soon
+ * as it is there.
+ */
+void QFlexProp::dtr_pulsed()
+{
+    if (Run_Resetting != m_run_stage)
+	return;
+    m_run_stage = Run_Ready;
+    if (!m_run_binary.isEmpty())
+	run_upload();
+}
+
+/**
+ * @brief Slot called when a build started by flexspin() is finished
+ * @param ok true if the build succeeded
+ */
+void QFlexProp::flexspin_finished(bool ok)
+{
+    if (!m_flexspin)
+	return;
+    Flexspin* fs = m_flexspin;
+    m_flexspin = nullptr;
+    fs->deleteLater();
+
+    // the tab may have been closed during the build
+    PropEdit* pe = m_build_propedit;
+    if (pe) {
+	if (!fs->lst().isNull())
+	    pe->setProperty(id_tab_lst, fs->lst());
+	if (!fs->p2asm().isNull())
+	    pe->setProperty(id_tab_p2asm, fs->p2asm());
+	if (!fs->binary().isNull())
+	    pe->setProperty(id_tab_binary, fs->binary());
+    }
+    tab_changed(ui->tabWidget->currentIndex());
+
+    if (!ok || !pe) {
+	m_run_stage = Run_Idle;
+	return;
+    }
+
+    switch (m_build_action) {
+    case Build_Only:
+	break;
+    case Build_Run:
+	run_binary(fs->binary(), qvariant_cast<QTextBrowser*>(fs->property(id_process_tb)));
+	break;
+    case Build_Run_multiple:
+	run_multiple(fs->binary());
+	break;
+    case Build_Flash:
+	run_flash(fs->binary(), true, qvariant_cast<QTextBrowser*>(fs->property(id_process_tb)));
+	break;
+    }
+}
+
+/**
+ * @brief Compile -> Cancel build action
+ */
+void QFlexProp::on_action_Cancel_build_triggered()
+{
+    if (m_flexspin)
+	m_flexspin->cancel();
+    if (m_build_queue)
+	m_build_queue->cancel();
+}
+
+/**
+ * @brief Compile -> Build all action
+ *
+ * Builds the top level files of all open tabs, with one flexspin process
+ * per program. A file which another open file uses as an object is built
+ * as part of that file; the objects of one program are not built separately.
+ */
+void QFlexProp::on_action_Build_all_triggered()
+{
+    if (m_flexspin || m_build_queue)
+	return;
+
+    QStringList files;
+    for (int index = 0; index < ui->tabWidget->count() - 1; index++) {
+	const PropEdit* pe = current_propedit(index);
+	if (pe && !pe->filename().isEmpty())
+	    files += pe->filename();
+    }
+    if (files.isEmpty())
+	return;
+
+    m_build_queue = new BuildQueue(flexspin_options(), &m_build_cache, this);
+    bool ok;
+    ok = connect(m_build_queue, &BuildQueue::Started,
+		 this, &QFlexProp::build_all_started);
+    Q_ASSERT(ok);
+    ok = connect(m_build_queue, &BuildQueue::Built,
+		 this, &QFlexProp::build_all_built);
+    Q_ASSERT(ok);
+    ok = connect(m_build_queue, &BuildQueue::Finished,
+		 this, &QFlexProp::build_all_finished);
+    Q_ASSERT(ok);
+
+    const QStringList top = m_build_queue->top_level(files);
+    log_status(tr("Building %1 of %2 open files with up to %3 jobs.")
+	       .arg(top.count())
+	       .arg(files.count())
+	       .arg(m_build_queue->jobs()));
+    tab_changed(ui->tabWidget->currentIndex());
+    m_build_queue->start(top);
+}
+
+/**
+ * @brief Slot called when a job of "Build all" is about to start
+ * @param job pointer to the Flexspin instance
+ * @param filename source file name it is going to build
+ */
+void QFlexProp::build_all_started(Flexspin* job, const QString& filename)
+{
+    const int index = find_tab(filename);
+    QTextBrowser* tb = index < 0 ? nullptr : current_textbrowser(index);
+    if (!tb)
+	return;
+    PropEdit* pe = current_propedit(index);
+    // marked again from the (possibly replayed cached) compiler output
+    if (pe)
+	pe->clear_diagnostics();
+
+    tb->clear();
+    job->setProperty(id_process_tb, QVariant::fromValue(tb));
+    tb->setTextColor(Qt::blue);
+    tb->append(job->command_line(filename));
+
+    bool ok;
+    ok = connect(job, &Flexspin::Error,
+		 this, &QFlexProp::printError);
+    Q_ASSERT(ok);
+    ok = connect(job, &Flexspin::Message,
+		 this, &QFlexProp::printMessage);
+    Q_ASSERT(ok);
+}
+
+/**
+ * @brief Slot called when a job of "Build all" is finished
+ * @param job pointer to the Flexspin instance
+ * @param ok true if the build succeeded
+ */
+void QFlexProp::build_all_built(Flexspin* job, bool ok)
+{
+    Q_UNUSED(ok)
+    const int index = find_tab(job->filename());
+    PropEdit* pe = index < 0 ? nullptr : current_propedit(index);
+    if (!pe)
+	return;
+    if (!job->lst().isNull())
+	pe->setProperty(id_tab_lst, job->lst());
+    if (!job->p2asm().isNull())
+	pe->setProperty(id_tab_p2asm, job->p2asm());
+    if (!job->binary().isNull())
+	pe->setProperty(id_tab_binary, job->binary());
+}
+
+/**
+ * @brief Slot called when all jobs of "Build all" are finished
+ * @param built number of files built successfully
+ * @param failed number of files which failed to build
+ */
+void QFlexProp::build_all_finished(int built, int failed)
+{
+    if (!m_build_queue)
+	return;
+    m_build_queue->deleteLater();
+    m_build_queue = nullptr;
+    if (failed > 0) {
+	log_status(tr("Built %1 files, %2 failed.").arg(built).arg(failed));
+    } else {
+	log_status(tr("Built %1 files.").arg(built));
+    }
+    tab_changed(ui->tabWidget->currentIndex());
+}
+
+/**
+ * @brief Return the key of the second stage loader for a clock frequency and baud rate
+ * @param clock_freq clock frequency the loader runs at
+ * @param baud baud rate the loader talks at
+ * @return key into m_stage2_cache and m_stage2_builds
+ */
+QString QFlexProp::stage2_key(quint32 clock_freq, quint32 baud)
+{
+    return QString("%1/%2").arg(clock_freq).arg(baud);
+}
+
+/**
+ * @brief Return the baud rate uploads run at
+ * @return the upload baud rate, if the device can switch to it, or the terminal's
+ */
+quint32 QFlexProp::upload_baud() const
+{
+    return qobject_cast<QSerialPort*>(m_dev) && m_upload_baud_rate > 0
+	    ? static_cast<quint32>(m_upload_baud_rate)
+	    : static_cast<quint32>(m_baud_rate);
+}
+
+/**
+ * @brief Copy the second stage loader source from the resources to the cache directory
+ *
+ * The file is only rewritten if it differs, so that its path and
+ * contents stay the same and the BuildCache finds earlier builds.
+ * @return path of the source, or an empty string on error
+ */
+QString QFlexProp::stage2_source()
+{
+    QFile resource(QStringLiteral(":/loader/stage2.spin2"));
+    if (!resource.open(QIODevice::ReadOnly)) {
+	log_error(tr("Could not read the second stage loader source."));
+	return QString();
+    }
+    const QByteArray text = resource.readAll();
+
+    const QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    if (!dir.mkpath(QLatin1String("loader"))) {
+	log_error(tr("Could not create the directory for the second stage loader source."));
+	return QString();
+    }
+    const QString source = dir.filePath(QLatin1String("loader/stage2.spin2"));
+    QFile file(source);
+    if (file.open(QIODevice::ReadOnly) && file.readAll() == text)
+	return source;
+    file.close();
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(text) != text.size()) {
+	log_error(tr("Could not write the second stage loader source '%1'.")
+		  .arg(source));
+	return QString();
+    }
+    return source;
+}
+
+/**
+ * @brief Return the second stage loader for a clock frequency and baud rate
+ *
+ * The loader source is compiled from the resources with flexspin
+ * once per combination and cached for later uploads. If it is not
+ * cached yet, an asynchronous build is started, unless one is already
+ * running, and stage2_built() takes its result.
+ *
+ * @param clock_freq clock frequency the loader runs at
+ * @param baud baud rate the loader talks at
+ * @return binary image of the loader, or an empty array if it is not built (yet)
+ */
+QByteArray QFlexProp::stage2_loader(quint32 clock_freq, quint32 baud)
+{
+    const QString key = stage2_key(clock_freq, baud);
+    if (m_stage2_cache.contains(key))
+	return m_stage2_cache.value(key);
+    if (m_stage2_builds.contains(key))
+	return QByteArray();
+
+    const QString source = stage2_source();
+    if (source.isEmpty())
+	return QByteArray();
+
+    Flexspin::Options options;
+    options.executable = m_flexspin_executable;
+    options.quiet = true;
+    options.defines = Flexspin::stage2_defines(clock_freq, baud);
+    Flexspin* fs = new Flexspin(options, this);
+    fs->set_cache(&m_build_cache);
+    bool ok;
+    ok = connect(fs, &Flexspin::Error,
+		 this, &QFlexProp::printError);
+    Q_ASSERT(ok);
+    ok = connect(fs, &Flexspin::Finished,
+		 this, &QFlexProp::stage2_built);
+    Q_ASSERT(ok);
+    // the build may already fail while starting
+    m_stage2_builds.insert(key, fs);
+    if (!fs->start(source)) {
+	m_stage2_builds.remove(key);
+	delete fs;
+    }
+    return m_stage2_cache.value(key);
+}
+
+/**
+ * @brief Build the second stage loader for the next upload ahead of time
+ *
+ * This is done when binary uploads are enabled, so that Run does not
+ * have to wait for the loader between the board reset and the upload.
+ */
+void QFlexProp::prepare_stage2()
+{
+    if (!m_compile_binary_upload)
+	return;
+    stage2_loader(upload_clock_freq, upload_baud());
+}
+
+/**
+ * @brief Slot called when a second stage loader build is finished
+ *
+ * The loader is cached and handed to the upload or the multiple board
+ * run waiting for it, if any.
+ * @param ok true if flexspin succeeded
+ */
+void QFlexProp::stage2_built(bool ok)
+{
+    Flexspin* fs = qobject_cast<Flexspin*>(sender());
+    if (!fs)
+	return;
+    const QString key = m_stage2_builds.key(fs);
+    m_stage2_builds.remove(key);
+    const QByteArray binary = ok ? fs->binary() : QByteArray();
+    fs->deleteLater();
+
+    if (binary.isEmpty()) {
+	log_error(tr("Building the second stage loader failed."));
+    } else {
+	m_stage2_cache.insert(key, binary);
+    }
+
+    if (key == m_stage2_wait) {
+	m_stage2_wait.clear();
+	// this may finish the upload right away
+	if (m_propload)
+	    m_propload->set_stage2_loader(binary);
+    }
+    if (key == m_multi_wait) {
+	const QByteArray image = m_multi_binary;
+	m_multi_wait.clear();
+	m_multi_binary.clear();
+	start_multiple(image, binary);
+    }
+}
+
+/**
+ * @brief Compile -> Build action
+ */
+void QFlexProp::on_action_Build_triggered()
+{
+    flexspin(Build_Only);
+}
+
+/**
+ * @brief Compile -> Upload action
+ */
+void QFlexProp::on_action_Upload_triggered()
+{
+    PropEdit* pe = current_propedit();
+    Q_ASSERT(pe);
+    QByteArray binary = pe->property(id_tab_binary).toByteArray();
+    if (binary.isEmpty()) {
+	// Need to compile first
+	flexspin(Build_Only);
+    }
+}
+
+/**
+ * @brief Compile -> Upload ELF file action
+ */
+void QFlexProp::on_action_Upload_ELF_triggered()
+{
+    QFileDialog dlg(this);
+    QSettings s;
+    s.beginGroup(id_grp_application);
+    QString elfdflt = QString("%1/p2tools").arg(QDir::homePath());
+    QString elfdir = s.value(id_elf_dir, elfdflt).toString();
+    s.endGroup();
+    QStringList filetypes = {
+	{"ELF (*.elf)"},
+	{"All files (*.*)"},
+    };
+
+    dlg.setWindowTitle(tr("Upload ELF file"));
+    dlg.setAcceptMode(QFileDialog::AcceptOpen);
+    dlg.setDirectory(elfdir);
+    dlg.setFileMode(QFileDialog::ExistingFile);
+    dlg.setNameFilters(filetypes);
+    dlg.setOption(QFileDialog::DontUseNativeDialog, true);
+    dlg.setViewMode(QFileDialog::Detail);
+
+    if (QFileDialog::Accepted != dlg.exec())
+	return;
+    QStringList files = dlg.selectedFiles();
+    if (files.isEmpty())
+	return;
+
+    s.beginGroup(id_grp_application);
+    s.setValue(id_elf_dir, QFileInfo(files.first()).absolutePath());
+    s.endGroup();
+    run_elf(files.first(), current_textbrowser());
+}
+
+/**
+ * @brief Compile -> Write flash image action
+ */
+void QFlexProp::on_action_Write_flash_triggered()
+{
+    QFileDialog dlg(this);
+    QSettings s;
+    s.beginGroup(id_grp_application);
+    QString flashdflt = QString("%1/p2tools").arg(QDir::homePath());
+    QString flashdir = s.value(id_flash_dir, flashdflt).toString();
+    s.endGroup();
+    QStringList filetypes = {
+	{"Flash or hub image (*.bin *.binary)"},
+	{"All files (*.*)"},
+    };
+
+    dlg.setWindowTitle(tr("Write flash image"));
+    dlg.setAcceptMode(QFileDialog::AcceptOpen);
+    dlg.setDirectory(flashdir);
+    dlg.setFileMode(QFileDialog::ExistingFile);
+    dlg.setNameFilters(filetypes);
+    dlg.setOption(QFileDialog::DontUseNativeDialog, true);
+    dlg.setViewMode(QFileDialog::Detail);
+
+    if (QFileDialog::Accepted != dlg.exec())
+	return;
+    QStringList files = dlg.selectedFiles();
+    if (files.isEmpty())
+	return;
+
+    s.beginGroup(id_grp_application);
+    s.setValue(id_flash_dir, QFileInfo(files.first()).absolutePath());
+    s.endGroup();
+    run_flash(files.first(), current_textbrowser());
+}
+
+/**
+ * @brief Compile -> Write build to flash action
+ */
+void QFlexProp::on_action_Flash_build_triggered()
+{
+    // compile, then write the resulting binary to the flash
+    flexspin(Build_Flash);
+}
+
+/**
+ * @brief Compile -> Run action
+ */
+void QFlexProp::on_action_Run_triggered()
+{
+    // compile, then upload the resulting binary
+    flexspin(Build_Run);
+}
+
+/**
+ * @brief Upload the @p binary to the Prop and run it
+ *
+ * This is the last stage of the Run pipeline. If the board is still
+ * being reset after flexspin_compiled(), the upload starts when
+ * dtr_pulsed() reports the reset is done.
+ * @param binary const reference to the binary image
+ * @param tb pointer to the QTextBrowser to print the upload messages to
+ */
+void QFlexProp::run_binary(const QByteArray& binary, QTextBrowser* tb)
+{
+    Q_ASSERT(tb);
+
+    // if binary is empty we do not upload, of course
+    if (binary.isEmpty()) {
+	m_run_stage = Run_Idle;
+	return;
+    }
+
+    m_run_binary = binary;
+    m_run_tb = tb;
+    if (Run_Resetting == m_run_stage)
+	return;
+    run_upload();
+}
+
+/**
+ * @brief Upload the binary of the Run pipeline
+ *
+ * The board is reset here, unless the pipeline already did that.
+ */
+void QFlexProp::run_upload()
+{
+    const bool reset = Run_Ready != m_run_stage;
+    const QByteArray binary = m_run_binary;
+    m_run_stage = Run_Idle;
+    m_run_binary.clear();
+
+    if (!setup_upload(m_run_tb, m_compile_binary_upload, reset))
+	return;
+
+    // the result is delivered through upload_finished()
+    if (!m_propload->load_data(binary))
+	upload_finished(false);
+}
+
+/**
+ * @brief Upload the ELF file @p filename to the Prop and run it
+ *
+ * The ELF upload always uses the second stage loader, which loads
+ * the segments at their addresses and zero fills the rest.
+ * @param filename const reference to the name of the ELF file
+ * @param tb pointer to the QTextBrowser to print the upload messages to, or nullptr
+ */
+void QFlexProp::run_elf(const QString& filename, QTextBrowser* tb)
+{
+    if (!setup_upload(tb, true))
+	return;
+
+    // the result is delivered through upload_finished()
+    if (!m_propload->load_elf(filename))
+	upload_finished(false);
+}
+
+/**
+ * @brief Write the image file @p filename to the board's SPI flash
+ *
+ * A *.binary file is a hub image as flexspin builds it, and it gets
+ * the flash boot stub in front. Other files are complete flash images,
+ * which start with their own boot code, and are written as is.
+ * @param filename const reference to the name of the image file
+ * @param tb pointer to the QTextBrowser to print the upload messages to, or nullptr
+ */
+void QFlexProp::run_flash(const QString& filename, QTextBrowser* tb)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+	log_error(tr("Could not open '%1' for reading.")
+		  .arg(filename));
+	return;
+    }
+    const QByteArray image = file.readAll();
+    file.close();
+
+    const bool boot = !QFileInfo(filename).suffix().compare(QLatin1String("binary"), Qt::CaseInsensitive);
+    run_flash(image, boot, tb);
+}
+
+/**
+ * @brief Write @p image to the board's SPI flash
+ *
+ * Only the sectors which differ from the image are programmed.
+ * @param image const reference to the image
+ * @param boot true if @p image is a hub image which needs the flash boot stub
+ * @param tb pointer to the QTextBrowser to print the upload messages to, or nullptr
+ */
+void QFlexProp::run_flash(const QByteArray& image, bool boot, QTextBrowser* tb)
+{
+    if (!setup_upload(tb, true))
+	return;
+
+    // the result is delivered through upload_finished()
+    if (!m_propload->flash_data(image, boot))
+	upload_finished(false);
+}
+
+/**
+ * @brief Take the device from the serial worker and set up m_propload
+ * @param tb pointer to the QTextBrowser to print the upload messages to, or nullptr
+ * @param stage2 if true, upload through the second stage loader if it can be built
+ * @param reset if true, reset the board first; false if it was reset already
+ * @return true if m_propload is ready, or false if an upload is still running
+ */
+bool QFlexProp::setup_upload(QTextBrowser* tb, bool stage2, bool reset)
+{
+    SerTerm* st = ui->tabWidget->findChild<SerTerm*>(id_terminal);
+    Q_ASSERT(st);
+
+    if (m_propload) {
+	// an upload is still running
+	return false;
+    }
+
+    // take the device back from the serial worker during upload
+    if (reset)
+	st->reset();
+    m_serial->detach();
+    m_rx_ring.clear();
+    m_propload = new PropLoad(m_dev, this);
+    // m_propload->set_mode(PropLoad::Prop_Txt);
+    m_propload->set_verbose(m_compile_verbose_upload);
+    m_propload->set_clock_freq(upload_clock_freq);
+    m_propload->set_clock_mode(0);
+    m_propload->set_user_baud(m_baud_rate);
+    // m_propload->set_use_checksum(false);
+    m_propload->setProperty(id_process_tb, QVariant::fromValue(tb));
+    // upload at the upload baud rate, if the device can switch
+    const quint32 fast_baud = upload_baud();
+    m_propload->set_fast_baud(fast_baud);
+    m_stats->upload_started(fast_baud);
+    if (stage2) {
+	const QByteArray loader = stage2_loader(m_propload->clock_freq(), fast_baud);
+	const QString key = stage2_key(m_propload->clock_freq(), fast_baud);
+	if (!loader.isEmpty()) {
+	    m_propload->set_mode(PropLoad::Prop_Bin);
+	    m_propload->set_stage2_loader(loader);
+	} else if (m_stage2_builds.contains(key)) {
+	    // the upload waits in PropLoad until stage2_built() delivers the loader
+	    m_propload->set_mode(PropLoad::Prop_Bin);
+	    m_propload->set_stage2_pending();
+	    m_stage2_wait = key;
+	}
+    }
+    bool ok;
+    ok = connect(m_propload, &PropLoad::Error,
+		 this, &QFlexProp::printError);
+    Q_ASSERT(ok);
+    ok = connect(m_propload, &PropLoad::Message,
+		 this, &QFlexProp::printMessage);
+    Q_ASSERT(ok);
+    ok = connect(m_propload, &PropLoad::Progress,
+		 this, &QFlexProp::showProgress);
+    Q_ASSERT(ok);
+    ok = connect(m_propload, &PropLoad::Progress,
+		 m_stats, &SerialStats::upload_progress);
+    Q_ASSERT(ok);
+    ok = connect(m_propload, &PropLoad::Finished,
+		 this, &QFlexProp::upload_finished);
+    Q_ASSERT(ok);
+    return true;
+}
+
+/**
+ * @brief Slot called when an upload started by Run is finished
+ * @param ok true if the upload succeeded
+ */
+void QFlexProp::upload_finished(bool ok)
+{
+    if (!m_propload)
+	return;
+    m_propload->deleteLater();
+    m_propload = nullptr;
+    m_stage2_wait.clear();
+
+    // hand the device back to the serial worker once PropLoad is gone;
+    // this may be called from within one of the device's signals
+    QTimer::singleShot(0, this, &QFlexProp::attach_port);
+    if (ok) {
+	if (m_compile_switch_to_term) {
+	    // Select the terminal tab
+	    ui->tabWidget->setCurrentWidget(ui->terminal);
+	    ui->terminal->setFocus();
+	}
+    }
+}
+
+/**
+ * @brief Compile -> Run on multiple boards action
+ */
+void QFlexProp::on_action_Run_multiple_triggered()
+{
+    // compile once, then upload the resulting binary to several boards
+    flexspin(Build_Run_multiple);
+}
+
+/**
+ * @brief Upload the @p binary to multiple boards
+ * @param binary const reference to the binary image
+ */
+void QFlexProp::run_multiple(const QByteArray& binary)
+{
+    if (binary.isEmpty())
+	return;
+
+    const quint32 baud = m_upload_baud_rate > 0
+			 ? static_cast<quint32>(m_upload_baud_rate)
+			 : static_cast<quint32>(m_baud_rate);
+    QByteArray stage2;
+    if (m_compile_binary_upload) {
+	stage2 = stage2_loader(upload_clock_freq, baud);
+	const QString key = stage2_key(upload_clock_freq, baud);
+	if (stage2.isEmpty() && m_stage2_builds.contains(key)) {
+	    // continued by stage2_built()
+	    log_status(tr("Waiting for the second stage loader to be built."));
+	    m_multi_wait = key;
+	    m_multi_binary = binary;
+	    return;
+	}
+    }
+    start_multiple(binary, stage2);
+}
+
+/**
+ * @brief Open the dialog to upload the @p binary to multiple boards
+ * @param binary const reference to the binary image
+ * @param stage2 second stage loader to upload through, or empty to use Prop_Hex
+ */
+void QFlexProp::start_multiple(const QByteArray& binary, const QByteArray& stage2)
+{
+    UploadWorker::Options options;
+    options.baud_rate = m_baud_rate;
+    options.data_bits = m_data_bits;
+    options.parity = m_parity;
+    options.stop_bits = m_stop_bits;
+    options.flow_control = m_flow_control;
+    options.upload_baud_rate = m_upload_baud_rate > 0
+			       ? static_cast<quint32>(m_upload_baud_rate)
+			       : static_cast<quint32>(m_baud_rate);
+    options.clock_freq = upload_clock_freq;
+    options.clock_mode = 0;
+    options.mode = PropLoad::Prop_Hex;
+    if (!stage2.isEmpty()) {
+	options.stage2 = stage2;
+	options.mode = PropLoad::Prop_Bin;
+    }
+
+    MultiLoadDlg dlg(this);
+    dlg.set_options(options);
+    dlg.set_binary(binary);
+    dlg.exec();
+}
+
+/**
+ * @brief Help -> About action
+ */
+void QFlexProp::on_action_About_triggered()
+{
+    AboutDlg dlg(this);
+    dlg.exec();
+}
+
+/**
+ * @brief Help -> About Qt5 action
+ */
+void QFlexProp::on_action_About_Qt5_triggered()
+{
+    qApp->aboutQt();
+}
+
+/**
+ * @brief Print an error message to the tab's QTextBrowser, or log it if there is none
+ * @param message text to print
+ */
+void QFlexProp::printError(const QString& message)
+{
+    const Flexspin* fs = qobject_cast<const Flexspin*>(sender());
+    if (fs)
+	mark_diagnostics(fs->filename(), message);
+    QTextBrowser* tb = qvariant_cast<QTextBrowser*>(sender()->property(id_process_tb));
+    if (!tb) {
+	log_error(message);
+	return;
+    }
+    tb->setTextColor(Qt::red);
+    tb->append(message);
+}
+
+/**
+ * @brief Print a normal message to the tab's QTextBrowser, or log it if there is none
+ * @param message text to print
+ */
+void QFlexProp::printMessage(const QString& message)
+{
+    const Flexspin* fs = qobject_cast<const Flexspin*>(sender());
+    if (fs)
+	mark_diagnostics(fs->filename(), message);
+    QTextBrowser* tb = qvariant_cast<QTextBrowser*>(sender()->property(id_process_tb));
+    if (!tb) {
+	log_status(message);
+	return;
+    }
+    tb->setTextColor(Qt::black);
+    tb->append(message);
+}
+
+/**
+ * @brief Mark the diagnostics among the compiler output @p lines in the editor
+ *
+ * flexspin reports diagnostics as "file:line: error: text" or
+ * "file:line: warning: text". Only those for the source file shown in
+ * the tab of @p filename are marked; diagnostics for included files
+ * are left to the output. A build served from the cache replays the
+ * output of the original build, so its markers are set the same way.
+ * @param filename source file being compiled
+ * @param lines batch of output lines
+ */
+void QFlexProp::mark_diagnostics(const QString& filename, const QString& lines)
+{
+    static const QRegularExpression re(QStringLiteral("^(.*):(\\d+): *(error|warning): *(.*)$"),
+				       QRegularExpression::MultilineOption |
+				       QRegularExpression::CaseInsensitiveOption);
+    if (!lines.contains(QLatin1Char(':')))
+	return;
+    const int index = find_tab(filename);
+    PropEdit* pe = index < 0 ? nullptr : current_propedit(index);
+    if (!pe)
+	return;
+    const QString name = QFileInfo(filename).fileName();
+    QRegularExpressionMatchIterator it = re.globalMatch(lines);
+    while (it.hasNext()) {
+	const QRegularExpressionMatch match = it.next();
+	if (QFileInfo(match.captured(1)).fileName() != name)
+	    continue;
+	const PropEdit::Severity severity = match.captured(3).compare(QLatin1String("error"), Qt::CaseInsensitive)
+					    ? PropEdit::Diag_Warning
+					    : PropEdit::Diag_Error;
+	pe->add_diagnostic(match.captured(2).toInt(), severity, match.captured(4));
+    }
+}
+
+/**
+ * @brief Update the statusbar's progress bar
+ * @param value current value
+ * @param total maximum value (which equals 100%)
+ */
+void QFlexProp::showProgress(qint64 value, qint64 total)
+{
+    QProgressBar* pb = ui->statusbar->findChild<QProgressBar*>(id_progress);
+    if (!pb)
+	return;
+
+    // Scale down to 32 bit integer range
+    while (total >= INT32_MAX) {
+	total >>= 10;
 	value >>= 10;
     }
     pb->setRange(0, total);
     pb->setValue(value);
-    loop.processEvents();
 }
@@ -19,13 +19,24 @@
 #include <QFont>
 #include <QMutex>
 #include <QProcess>
+#include <QPointer>
+#include "buildcache.h"
+#include "buildqueue.h"
+#include "fileloader.h"
+#include "flexspin.h"
 #include "proptypes.h"
+#include "rxring.h"
+#include "rxcapture.h"
+#include "serialstats.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class QFlexProp; }
 QT_END_NAMESPACE
 
 class PropEdit;
+class PropLoad;
+class SerialWorker;
+class StatsDlg;
 
 class QFlexProp : public QMainWindow
 {
@@ -54,9 +65,11 @@ private slots:
 
     void dev_close();
     void dev_write_data(const QByteArray& data);
-    void dev_ready_read();
+    void rx_drain();
+    void attach_port();
 
     void update_pinout(bool redo = false);
+    void status_changed(quint32 status);
     void tab_changed(int index);
     void tab_close_requested(int index);
 
@@ -85,6 +98,8 @@ private slots:
     void on_action_Find_Replace_triggered();
     void line_number_finished();
     void on_action_Goto_line_triggered();
+    void on_action_Next_error_triggered();
+    void on_action_Previous_error_triggered();
 
     void on_action_Settings_triggered();
     void on_action_Configure_serialport_triggered();
@@ -94,29 +109,91 @@ private slots:
     void on_action_Show_intermediate_triggered();
     void on_action_Show_binary_triggered();
     void on_action_Toggle_80_132_mode_triggered();
+    void on_action_Capture_rx_triggered();
+    void on_action_Capture_timestamps_triggered();
+    void capture_error(const QString& message);
+    void on_action_Record_trace_triggered();
+    void on_action_Serial_statistics_triggered();
+    void stats_error(const QString& message);
+    void file_loaded(const QString& filename, const QString& text, const QByteArray& sha256);
+    void file_load_failed(const QString& filename, const QString& error);
 
     void on_action_Verbose_upload_triggered();
     void on_action_Switch_to_term_triggered();
+    void on_action_Binary_upload_triggered();
     void on_action_Build_triggered();
+    void on_action_Build_all_triggered();
     void on_action_Upload_triggered();
+    void on_action_Upload_ELF_triggered();
+    void on_action_Write_flash_triggered();
+    void on_action_Flash_build_triggered();
     void on_action_Run_triggered();
+    void on_action_Run_multiple_triggered();
+    void on_action_Cancel_build_triggered();
+    void flexspin_compiled();
+    void flexspin_finished(bool ok);
+    void stage2_built(bool ok);
+    void dtr_pulsed();
+    void build_all_started(Flexspin* job, const QString& filename);
+    void build_all_built(Flexspin* job, bool ok);
+    void build_all_finished(int built, int failed);
 
     void on_action_About_triggered();
     void on_action_About_Qt5_triggered();
 
-    void channelReadyRead(int channel);
     void printError(const QString& message);
     void printMessage(const QString& message);
 
     void showProgress(qint64 value, qint64 total);
+    void upload_finished(bool ok);
 
 private:
+    //! What to do with the binary after a build
+    typedef enum {
+	Build_Only,		//!< just store the results
+	Build_Run,		//!< upload the binary and run it
+	Build_Run_multiple,	//!< upload the binary to multiple boards
+	Build_Flash,		//!< write the binary to the flash and boot from it
+    } BuildAction;
+
+    //! Stage of the Run pipeline
+    typedef enum {
+	Run_Idle,		//!< no Run in progress
+	Run_Compiling,		//!< the compiler is running
+	Run_Resetting,		//!< the compiler exited, the board is being reset
+	Run_Ready,		//!< the board was reset and its ROM loader waits
+    } RunStage;
+
+    //! Milliseconds between drains of the receive ring (one frame)
+    static constexpr int rx_frame_interval = 16;
+    //! Maximum number of bytes to pass to the terminal per frame
+    static constexpr qint64 rx_frame_bytes = 256 * 1024;
+    //! Clock frequency the P2 is set up with for uploads
+    static constexpr quint32 upload_clock_freq = 180000000;
+
     Ui::QFlexProp *ui;
     QIODevice* m_dev;				//!< serial port (or tty)
+    RxRing m_rx_ring;				//!< data received by the serial worker
+    RxCapture* m_rx_capture;			//!< capture of the received data to a file
+    SerialWorker* m_serial;			//!< serial worker thread reading m_dev
+    SerialStats* m_stats;			//!< throughput and latency statistics
+    QPointer<StatsDlg> m_stats_dlg;		//!< statistics dialog, while it is open
+    QTimer m_rx_timer;				//!< frame timer to drain m_rx_ring
+    quint32 m_status;				//!< most recent status reported by m_serial
+    PropLoad* m_propload;			//!< running upload, if any
+    Flexspin* m_flexspin;			//!< running build, if any
+    BuildAction m_build_action;			//!< what to do after the running build
+    BuildQueue* m_build_queue;			//!< running builds of all open files, if any
+    QPointer<PropEdit> m_build_propedit;	//!< editor the running build was started from
+    RunStage m_run_stage;			//!< stage of the Run pipeline
+    QByteArray m_run_binary;			//!< binary waiting for the board reset to finish
+    QPointer<QTextBrowser> m_run_tb;		//!< text browser for the messages of m_run_binary's upload
     QFont m_fixedfont;
     QStringList m_leds;				//!< list of LED names
     QHash<QString,bool> m_enabled_elements;	//!< list of element enabled (visible) status
     QHash<QString,QLabel*> m_labels;		//!< labels for LEDs
+    QHash<QString,int> m_led_state;		//!< state currently displayed per LED
+    QHash<QPair<QString,int>,QPixmap> m_led_cache; //!< LED pixmaps per type and state
     QString m_stty_operation;			//!< serial port most recent operation
     QString m_port_name;			//!< serial port device name
     Serial_BaudRate m_baud_rate;		//!< serial port baud rate
@@ -125,6 +202,7 @@ private:
     QSerialPort::StopBits m_stop_bits;		//!< serial port stop bits
     QSerialPort::FlowControl m_flow_control;	//!< serial port flow control
     bool m_local_echo;				//!< Local echo flag
+    Serial_BaudRate m_upload_baud_rate;		//!< baud rate for uploads (0 = same as terminal)
 
     QString m_flexspin_executable;
     QStringList m_flexspin_include_paths;
@@ -137,17 +215,41 @@ private:
     bool m_flexspin_skip_coginit;
     bool m_compile_verbose_upload;
     bool m_compile_switch_to_term;
+    bool m_compile_binary_upload;
+    bool m_capture_timestamps;			//!< capture with timestamped records
+    QHash<QString,QByteArray> m_stage2_cache;	//!< second stage loaders per clock and baud
+    QHash<QString,Flexspin*> m_stage2_builds;	//!< second stage loaders being built per clock and baud
+    QString m_stage2_wait;			//!< key of the loader m_propload waits for
+    QString m_multi_wait;			//!< key of the loader m_multi_binary waits for
+    QByteArray m_multi_binary;			//!< binary to upload to multiple boards once its loader is built
+    BuildCache m_build_cache;			//!< results of previous builds
+    FileLoader* m_file_loader;			//!< reads the files of new tabs in the background
 
     int insert_tab(const QString& filename);
     PropEdit* current_propedit(int index = -1) const;
+    int find_tab(const QString& filename) const;
     QTextBrowser* current_textbrowser(int index = -1) const;
     QString load_file(const QString& title);
     QString save_file(const QString& filename, const QString& title);
 
-    bool flexspin(QByteArray* p_binary = nullptr,
-		  QString* p_p2asm = nullptr,
-		  QString* p_lst = nullptr);
+    Flexspin::Options flexspin_options() const;
+    bool flexspin(BuildAction action = Build_Only);
+    bool setup_upload(QTextBrowser* tb, bool stage2, bool reset = true);
+    void run_upload();
+    void run_binary(const QByteArray& binary, QTextBrowser* tb);
+    void run_elf(const QString& filename, QTextBrowser* tb);
+    void run_flash(const QString& filename, QTextBrowser* tb);
+    void run_flash(const QByteArray& image, bool boot, QTextBrowser* tb);
+    void run_multiple(const QByteArray& binary);
+    void start_multiple(const QByteArray& binary, const QByteArray& stage2);
+    quint32 upload_baud() const;
+    static QString stage2_key(quint32 clock_freq, quint32 baud);
+    QString stage2_source();
+    QByteArray stage2_loader(quint32 clock_freq, quint32 baud);
+    void prepare_stage2();
+    void mark_diagnostics(const QString& filename, const QString& lines);
+    void goto_diagnostic(bool backward);
 
     QPixmap led(const QString& type, int state);
-    static QString quoted(const QString& src, const QChar quote = QChar('"'));
+    void set_led(const QString& type, int state);
 };
@@ -18,43 +18,82 @@ SOURCES += \
     $$PWD/propconst.cpp \
     $$PWD/idstrings.cpp \
     $$PWD/propload.cpp \
+    $$PWD/rxcapture.cpp \
+    $$PWD/serialstats.cpp \
+    $$PWD/buildcache.cpp \
+    $$PWD/buildqueue.cpp \
+    $$PWD/clirunner.cpp \
+    $$PWD/filesender.cpp \
+    $$PWD/flexspin.cpp \
+    $$PWD/serialworker.cpp \
     $$PWD/serterm.cpp \
+    $$PWD/fileloader.cpp \
+    $$PWD/trace.cpp \
     $$PWD/qflexprop.cpp \
+    $$PWD/uploadworker.cpp \
     $$PWD/util.cpp \
+    $$PWD/widgets/hexdumpmodel.cpp \
     $$PWD/widgets/propedit.cpp \
+    $$PWD/widgets/textlinesmodel.cpp \
     $$PWD/dialogs/flexspindlg.cpp \
+    $$PWD/dialogs/multiloaddlg.cpp \
     $$PWD/dialogs/serialportdlg.cpp \
+    $$PWD/dialogs/statsdlg.cpp \
     $$PWD/term/vt220.cpp \
     $$PWD/term/vtattr.cpp \
-    $$PWD/term/vtglyph.cpp \
-    $$PWD/term/vtglyphidx.cpp \
+    $$PWD/term/vtbacklog.cpp \
+    $$PWD/term/vtcell.cpp \
+    $$PWD/term/vtcore.cpp \
+    $$PWD/term/vtglyphcache.cpp \
     $$PWD/term/vtglyphs.cpp \
     $$PWD/term/vtline.cpp \
+    $$PWD/term/vtpage.cpp \
     $$PWD/term/vtscrollarea.cpp \
+    $$PWD/term/vttextindex.cpp \
     dialogs/aboutdlg.cpp \
     dialogs/settingsdlg.cpp \
     dialogs/textbrowserdlg.cpp \
     loadelf.cpp
 
 HEADERS += \
+    $$PWD/fileloader.h \
     $$PWD/propconst.h \
     $$PWD/idstrings.h \
+    $$PWD/rxcapture.h \
+    $$PWD/rxring.h \
+    $$PWD/serialstats.h \
+    $$PWD/buildcache.h \
+    $$PWD/buildqueue.h \
+    $$PWD/clirunner.h \
+    $$PWD/filesender.h \
+    $$PWD/flexspin.h \
+    $$PWD/serialworker.h \
     $$PWD/serterm.h \
+    $$PWD/trace.h \
     $$PWD/qflexprop.h \
     $$PWD/propload.h \
     $$PWD/proptypes.h \
+    $$PWD/uploadworker.h \
     $$PWD/util.h \
+    $$PWD/widgets/hexdumpmodel.h \
     $$PWD/widgets/propedit.h \
+    $$PWD/widgets/textlinesmodel.h \
     $$PWD/dialogs/flexspindlg.h \
+    $$PWD/dialogs/multiloaddlg.h \
     $$PWD/dialogs/serialportdlg.h \
+    $$PWD/dialogs/statsdlg.h \
     $$PWD/term/vt220.h \
     $$PWD/term/vtattr.h \
+    $$PWD/term/vtbacklog.h \
+    $$PWD/term/vtcell.h \
     $$PWD/term/vtchar.h \
-    $$PWD/term/vtglyph.h \
-    $$PWD/term/vtglyphidx.h \
+    $$PWD/term/vtcore.h \
+    $$PWD/term/vtglyphcache.h \
     $$PWD/term/vtglyphs.h \
     $$PWD/term/vtline.h \
+    $$PWD/term/vtpage.h \
     $$PWD/term/vtscrollarea.h \
+    $$PWD/term/vttextindex.h \
     dialogs/aboutdlg.h \
     dialogs/settingsdlg.h \
     dialogs/textbrowserdlg.h \
@@ -63,7 +102,9 @@ HEADERS += \
 FORMS += \
     $$PWD/qflexprop.ui \
     $$PWD/dialogs/flexspindlg.ui \
+    $$PWD/dialogs/multiloaddlg.ui \
     $$PWD/dialogs/serialportdlg.ui \
+    $$PWD/dialogs/statsdlg.ui \
     $$PWD/serterm.ui \
     dialogs/aboutdlg.ui \
     dialogs/settingsdlg.ui \
@@ -84,3 +125,9 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 
 RESOURCES += \
     qflexprop.qrc
+
+# Optional OpenGL renderer of the terminal
+qtConfig(opengl) {
+    SOURCES += $$PWD/term/vtglview.cpp
+    HEADERS += $$PWD/term/vtglview.h
+}
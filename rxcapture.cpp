@@ -0,0 +1,247 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 capture of the received serial data to a file
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QDateTime>
+#include <QFileInfo>
+#include <QtEndian>
+#include <cstring>
+#include "rxcapture.h"
+
+RxCapture::RxCapture(int size_log2)
+    : QObject()
+    , m_thread()
+    , m_ring(size_log2)
+    , m_file(nullptr)
+    , m_drain(new QTimer(this))
+    , m_since_start()
+    , m_since_write()
+    , m_filename()
+    , m_timestamps(false)
+    , m_active(false)
+    , m_captured(0)
+    , m_dropped(0)
+{
+    m_drain->setInterval(drain_interval);
+    bool ok;
+    ok = connect(m_drain, &QTimer::timeout,
+		 this, &RxCapture::drain);
+    Q_ASSERT(ok);
+
+    m_thread.setObjectName(QLatin1String("RxCapture"));
+    moveToThread(&m_thread);
+    m_thread.start();
+}
+
+RxCapture::~RxCapture()
+{
+    stop();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+/**
+ * @brief Return true, if received data is being captured
+ */
+bool RxCapture::is_active() const
+{
+    return m_active.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Return the name of the current or most recent capture file
+ */
+QString RxCapture::filename() const
+{
+    return m_filename;
+}
+
+/**
+ * @brief Return the number of received bytes captured since start()
+ */
+qint64 RxCapture::captured() const
+{
+    return m_captured.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Return the number of received bytes dropped since start()
+ */
+qint64 RxCapture::dropped() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Start capturing to the file @p filename
+ *
+ * This is to be called from the GUI thread.
+ * @param filename name of the file to create or overwrite
+ * @param timestamps if true, write timestamped records instead of raw data
+ * @return true on success, or false if the file could not be created
+ */
+bool RxCapture::start(const QString& filename, bool timestamps)
+{
+    if (m_file)
+	stop();
+
+    QFile* file = new QFile(filename);
+    if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+	emit Error(tr("Could not create capture file '%1': %2")
+		   .arg(QFileInfo(filename).fileName())
+		   .arg(file->errorString()));
+	delete file;
+	return false;
+    }
+    if (timestamps) {
+	uchar header[16];
+	std::memcpy(header, "QFPCAP1", 8);
+	qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 8);
+	if (file->write(reinterpret_cast<const char*>(header), sizeof(header)) != static_cast<qint64>(sizeof(header))) {
+	    emit Error(tr("Writing capture file '%1' failed: %2")
+		       .arg(QFileInfo(filename).fileName())
+		       .arg(file->errorString()));
+	    delete file;
+	    return false;
+	}
+    }
+
+    m_filename = filename;
+    m_timestamps = timestamps;
+    m_captured.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    file->moveToThread(&m_thread);
+    m_file = file;
+    QMetaObject::invokeMethod(this, "do_start", Qt::BlockingQueuedConnection);
+    m_since_start.start();
+    m_active.store(true, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Stop capturing, write the pending data and close the file
+ *
+ * This is to be called from the GUI thread.
+ */
+void RxCapture::stop()
+{
+    if (!m_file)
+	return;
+    m_active.store(false, std::memory_order_release);
+    QMetaObject::invokeMethod(this, "do_stop", Qt::BlockingQueuedConnection);
+}
+
+/**
+ * @brief Append received data to the capture
+ *
+ * This is called from the serial worker thread only.
+ * @param data pointer to the received bytes
+ * @param len number of bytes
+ */
+void RxCapture::append(const char* data, qint64 len)
+{
+    if (len <= 0 || !m_active.load(std::memory_order_acquire))
+	return;
+
+    const qint64 need = m_timestamps ? record_header + len : len;
+    if (m_ring.capacity() - m_ring.size() < need) {
+	m_dropped.fetch_add(len, std::memory_order_relaxed);
+	return;
+    }
+    if (m_timestamps) {
+	uchar header[record_header];
+	qToLittleEndian<quint64>(static_cast<quint64>(m_since_start.nsecsElapsed() / 1000), header);
+	qToLittleEndian<quint32>(static_cast<quint32>(len), header + 8);
+	put(reinterpret_cast<const char*>(header), record_header);
+    }
+    put(data, len);
+    m_captured.fetch_add(len, std::memory_order_relaxed);
+}
+
+void RxCapture::do_start()
+{
+    // a block appended while the previous capture stopped is stale
+    m_ring.clear();
+    m_since_write.start();
+    m_drain->start();
+}
+
+void RxCapture::do_stop()
+{
+    m_drain->stop();
+    write_all(true);
+    m_ring.clear();
+    m_file->close();
+    delete m_file;
+    m_file = nullptr;
+}
+
+/**
+ * @brief Write the ring's contents when a block is full or is pending for too long
+ */
+void RxCapture::drain()
+{
+    write_all(false);
+}
+
+/**
+ * @brief Copy @p len bytes into the ring, which must have enough room
+ * @param data pointer to the bytes
+ * @param len number of bytes
+ * @return true on success, false if the ring ran full
+ */
+bool RxCapture::put(const char* data, qint64 len)
+{
+    while (len > 0) {
+	qint64 room = 0;
+	char* dst = m_ring.write_span(&room);
+	if (!dst)
+	    return false;
+	room = qMin(room, len);
+	std::memcpy(dst, data, static_cast<size_t>(room));
+	m_ring.commit(room);
+	data += room;
+	len -= room;
+    }
+    return true;
+}
+
+/**
+ * @brief Write the ring's contents to the file
+ *
+ * This runs in the writer thread.
+ * @param flush if true, write even less than write_block bytes
+ * @return true on success, false if writing failed
+ */
+bool RxCapture::write_all(bool flush)
+{
+    if (!m_file)
+	return true;
+    if (!flush && m_ring.size() < write_block && m_since_write.elapsed() < flush_interval)
+	return true;
+
+    for (;;) {
+	qint64 len = 0;
+	const char* src = m_ring.read_span(&len);
+	if (!src)
+	    break;
+	const qint64 written = m_file->write(src, len);
+	if (written <= 0) {
+	    m_active.store(false, std::memory_order_release);
+	    m_drain->stop();
+	    m_ring.clear();
+	    emit Error(tr("Writing capture file '%1' failed: %2")
+		       .arg(QFileInfo(m_filename).fileName())
+		       .arg(m_file->errorString()));
+	    return false;
+	}
+	m_ring.consume(written);
+    }
+    m_since_write.restart();
+    return true;
+}
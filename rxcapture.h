@@ -0,0 +1,85 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 capture of the received serial data to a file
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include "rxring.h"
+
+/**
+ * @brief Writes everything the serial worker receives to a file in a thread of its own
+ *
+ * The serial worker thread calls append() with each block it received.
+ * The data goes into a ring buffer of its own, so the terminal and the
+ * capture never wait for each other. The writer thread drains the ring
+ * in large blocks straight into an unbuffered file.
+ *
+ * Without timestamps the file holds the raw received bytes. With
+ * timestamps it starts with the 8 byte magic "QFPCAP1\0" and the
+ * capture start as milliseconds since the epoch (UTC), followed by
+ * records made of the microseconds since the start, the record length
+ * in bytes, and the received bytes. The numbers are little endian
+ * 64 and 32 bit integers.
+ *
+ * If the disk can not keep up and the ring runs full, blocks are
+ * dropped and counted, see dropped().
+ */
+class RxCapture : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RxCapture(int size_log2 = 23);
+    ~RxCapture();
+
+    bool is_active() const;
+    QString filename() const;
+    qint64 captured() const;
+    qint64 dropped() const;
+
+    bool start(const QString& filename, bool timestamps);
+    void stop();
+    void append(const char* data, qint64 len);
+
+signals:
+    void Error(const QString& message);
+
+private slots:
+    void do_start();
+    void do_stop();
+    void drain();
+
+private:
+    //! Milliseconds between checks of the ring
+    static constexpr int drain_interval = 20;
+    //! Minimum bytes to write at once, unless flush_interval expired
+    static constexpr qint64 write_block = 256 * 1024;
+    //! Milliseconds after which pending data is written anyway
+    static constexpr int flush_interval = 500;
+    //! Size of a record header: microseconds and length
+    static constexpr qint64 record_header = 8 + 4;
+
+    QThread m_thread;			//!< thread the writer runs in
+    RxRing m_ring;			//!< captured data waiting to be written
+    QFile* m_file;			//!< file owned by the writer thread
+    QTimer* m_drain;			//!< timer to drain the ring
+    QElapsedTimer m_since_start;	//!< time since the capture started
+    QElapsedTimer m_since_write;	//!< time since the last write (writer thread)
+    QString m_filename;			//!< name of the capture file
+    bool m_timestamps;			//!< true to write timestamped records
+    std::atomic<bool> m_active;		//!< true while capturing
+    std::atomic<qint64> m_captured;	//!< bytes of received data captured
+    std::atomic<qint64> m_dropped;	//!< bytes of received data dropped
+
+    bool put(const char* data, qint64 len);
+    bool write_all(bool flush);
+};
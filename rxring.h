@@ -0,0 +1,127 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 single producer, single consumer receive ring buffer
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QtGlobal>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief Lock-free ring buffer for exactly one producer and one consumer thread
+ *
+ * The producer (the serial worker thread) asks for a contiguous free span
+ * with write_span(), fills it, and publishes it with commit(). The consumer
+ * (the GUI thread) asks for a contiguous used span with read_span() and
+ * releases it with consume(). The head index is only written by the producer
+ * and the tail index is only written by the consumer, so no locks are needed.
+ */
+class RxRing
+{
+public:
+    /**
+     * @brief Construct a ring with 2^@p size_log2 bytes of storage
+     * @param size_log2 log2 of the capacity in bytes
+     */
+    explicit RxRing(int size_log2 = 20)
+	: m_data(1 << size_log2)
+	, m_mask(static_cast<quint64>(m_data.size()) - 1)
+	, m_head(0)
+	, m_tail(0)
+    {}
+
+    /**
+     * @brief Return the capacity of the ring in bytes
+     */
+    qint64 capacity() const
+    {
+	return m_data.size();
+    }
+
+    /**
+     * @brief Return the number of bytes ready to be consumed
+     */
+    qint64 size() const
+    {
+	return static_cast<qint64>(m_head.load(std::memory_order_acquire) -
+				   m_tail.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Return true, if there are no bytes to be consumed
+     */
+    bool isEmpty() const
+    {
+	return size() == 0;
+    }
+
+    /**
+     * @brief Producer: return a pointer to the next contiguous free span
+     * @param p_len pointer to a qint64 receiving the length of the span
+     * @return pointer to the span, or nullptr if the ring is full
+     */
+    char* write_span(qint64* p_len)
+    {
+	const quint64 head = m_head.load(std::memory_order_relaxed);
+	const quint64 tail = m_tail.load(std::memory_order_acquire);
+	const quint64 room = static_cast<quint64>(m_data.size()) - (head - tail);
+	const quint64 offs = head & m_mask;
+	const quint64 len = qMin(room, static_cast<quint64>(m_data.size()) - offs);
+	*p_len = static_cast<qint64>(len);
+	return len > 0 ? m_data.data() + offs : nullptr;
+    }
+
+    /**
+     * @brief Producer: publish @p len bytes written to the span from write_span()
+     * @param len number of bytes written
+     */
+    void commit(qint64 len)
+    {
+	m_head.store(m_head.load(std::memory_order_relaxed) + static_cast<quint64>(len),
+		     std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer: return a pointer to the next contiguous used span
+     * @param p_len pointer to a qint64 receiving the length of the span
+     * @return pointer to the span, or nullptr if the ring is empty
+     */
+    const char* read_span(qint64* p_len) const
+    {
+	const quint64 tail = m_tail.load(std::memory_order_relaxed);
+	const quint64 head = m_head.load(std::memory_order_acquire);
+	const quint64 offs = tail & m_mask;
+	const quint64 len = qMin(head - tail, static_cast<quint64>(m_data.size()) - offs);
+	*p_len = static_cast<qint64>(len);
+	return len > 0 ? m_data.constData() + offs : nullptr;
+    }
+
+    /**
+     * @brief Consumer: release @p len bytes of the span from read_span()
+     * @param len number of bytes consumed
+     */
+    void consume(qint64 len)
+    {
+	m_tail.store(m_tail.load(std::memory_order_relaxed) + static_cast<quint64>(len),
+		     std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer: discard all bytes ready to be consumed
+     */
+    void clear()
+    {
+	m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    QVector<char> m_data;			//!< storage; size is a power of 2
+    const quint64 m_mask;			//!< mask for offsets into m_data
+    alignas(64) std::atomic<quint64> m_head;	//!< total bytes produced
+    alignas(64) std::atomic<quint64> m_tail;	//!< total bytes consumed
+};
@@ -0,0 +1,263 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 serial throughput and latency statistics
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QFileInfo>
+#include "serialstats.h"
+#include "serialworker.h"
+#include "rxcapture.h"
+
+SerialStats::SerialStats(SerialWorker* worker, RxCapture* capture, QObject* parent)
+    : QObject(parent)
+    , m_worker(worker)
+    , m_capture(capture)
+    , m_timer()
+    , m_since_reset()
+    , m_since_tick()
+    , m_upload()
+    , m_csv()
+    , m_sample()
+    , m_rx_base(0)
+    , m_tx_base(0)
+    , m_stalls_base(0)
+    , m_rx_last(0)
+    , m_tx_last(0)
+    , m_errors(0)
+    , m_parse_bytes(0)
+    , m_parse_nsecs(0)
+    , m_pending_stamp(0)
+    , m_latency_sum(0)
+    , m_latency_max(0)
+    , m_latency_count(0)
+{
+    Q_ASSERT(m_worker);
+    m_timer.setInterval(sample_interval);
+    bool ok;
+    ok = connect(&m_timer, &QTimer::timeout,
+		 this, &SerialStats::tick);
+    Q_ASSERT(ok);
+    reset();
+    m_timer.start();
+}
+
+/**
+ * @brief Return the most recent sample
+ */
+const SerialStats::Sample& SerialStats::sample() const
+{
+    return m_sample;
+}
+
+/**
+ * @brief Return true, if samples are written to a CSV file
+ */
+bool SerialStats::is_csv_active() const
+{
+    return m_csv.isOpen();
+}
+
+/**
+ * @brief Return the name of the current or most recent CSV file
+ */
+QString SerialStats::csv_filename() const
+{
+    return m_csv.fileName();
+}
+
+/**
+ * @brief Start writing one line per sample to the CSV file @p filename
+ * @param filename name of the file to create or overwrite
+ * @return true on success, or false if the file could not be created
+ */
+bool SerialStats::start_csv(const QString& filename)
+{
+    stop_csv();
+    m_csv.setFileName(filename);
+    if (!m_csv.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+	emit Error(tr("Could not create statistics file '%1': %2")
+		   .arg(QFileInfo(filename).fileName())
+		   .arg(m_csv.errorString()));
+	return false;
+    }
+    m_csv.write("msecs,rx_bytes_per_sec,tx_bytes_per_sec,rx_total,tx_total,"
+		"rx_stalls,errors,capture_dropped,latency_avg_ms,latency_max_ms,"
+		"parse_mb_per_sec,upload_bits_per_sec,upload_baud\n");
+    m_csv.flush();
+    return true;
+}
+
+/**
+ * @brief Stop writing the CSV file and close it
+ */
+void SerialStats::stop_csv()
+{
+    if (m_csv.isOpen())
+	m_csv.close();
+}
+
+/**
+ * @brief Count an error reported by the serial port
+ */
+void SerialStats::add_error()
+{
+    m_errors++;
+}
+
+/**
+ * @brief Account for the terminal parsing @p bytes in @p nsecs nanoseconds
+ */
+void SerialStats::add_parse(qint64 bytes, qint64 nsecs)
+{
+    m_parse_bytes += bytes;
+    m_parse_nsecs += nsecs;
+}
+
+/**
+ * @brief Note that data received at @p stamp was given to the terminal
+ *
+ * The latency is measured from the oldest data not yet painted.
+ * @param stamp SerialWorker::now_ns() when the data was received, or 0
+ */
+void SerialStats::delivered(qint64 stamp)
+{
+    if (stamp && !m_pending_stamp)
+	m_pending_stamp = stamp;
+}
+
+/**
+ * @brief Note that the terminal was painted
+ */
+void SerialStats::painted()
+{
+    if (!m_pending_stamp)
+	return;
+    const qint64 latency = SerialWorker::now_ns() - m_pending_stamp;
+    m_pending_stamp = 0;
+    m_latency_sum += latency;
+    m_latency_max = qMax(m_latency_max, latency);
+    m_latency_count++;
+}
+
+/**
+ * @brief Note that an upload at @p baud started
+ * @param baud nominal baud rate of the upload
+ */
+void SerialStats::upload_started(quint32 baud)
+{
+    m_upload.start();
+    m_sample.upload_rate = 0.0;
+    m_sample.upload_baud = baud;
+}
+
+/**
+ * @brief Compute the effective upload rate from the progress
+ *
+ * The rate is in bits per second of payload at 10 bits per byte,
+ * so it is directly comparable to the nominal baud rate.
+ * @param value bytes of the image uploaded so far
+ * @param total size of the image
+ */
+void SerialStats::upload_progress(qint64 value, qint64 total)
+{
+    Q_UNUSED(total);
+    if (!m_upload.isValid())
+	return;
+    const qint64 msecs = m_upload.elapsed();
+    if (msecs > 0 && value > 0)
+	m_sample.upload_rate = static_cast<double>(value) * 10.0 * 1000.0 / msecs;
+}
+
+/**
+ * @brief Reset the totals and the latency measurement
+ */
+void SerialStats::reset()
+{
+    m_rx_base = m_rx_last = m_worker->rx_bytes();
+    m_tx_base = m_tx_last = m_worker->tx_bytes();
+    m_stalls_base = m_worker->rx_stalls();
+    m_errors = 0;
+    m_parse_bytes = 0;
+    m_parse_nsecs = 0;
+    m_pending_stamp = 0;
+    m_latency_sum = 0;
+    m_latency_max = 0;
+    m_latency_count = 0;
+    const double upload_rate = m_sample.upload_rate;
+    const quint32 upload_baud = m_sample.upload_baud;
+    m_sample = Sample();
+    m_sample.upload_rate = upload_rate;
+    m_sample.upload_baud = upload_baud;
+    m_since_reset.start();
+    m_since_tick.start();
+}
+
+/**
+ * @brief Compute a sample from the counters since the last one
+ */
+void SerialStats::tick()
+{
+    const qint64 msecs = qMax(Q_INT64_C(1), m_since_tick.restart());
+    const quint64 rx = m_worker->rx_bytes();
+    const quint64 tx = m_worker->tx_bytes();
+
+    m_sample.msecs = m_since_reset.elapsed();
+    m_sample.rx_rate = static_cast<double>(rx - m_rx_last) * 1000.0 / msecs;
+    m_sample.tx_rate = static_cast<double>(tx - m_tx_last) * 1000.0 / msecs;
+    m_sample.rx_total = rx - m_rx_base;
+    m_sample.tx_total = tx - m_tx_base;
+    m_sample.rx_stalls = m_worker->rx_stalls() - m_stalls_base;
+    m_sample.errors = m_errors;
+    m_sample.dropped = m_capture ? static_cast<quint64>(m_capture->dropped()) : 0;
+    if (m_latency_count > 0) {
+	m_sample.latency_avg = m_latency_sum / 1e6 / m_latency_count;
+	m_sample.latency_max = m_latency_max / 1e6;
+    }
+    if (m_parse_nsecs > 0)
+	m_sample.parse_rate = static_cast<double>(m_parse_bytes) * 1e3 / m_parse_nsecs;
+    m_rx_last = rx;
+    m_tx_last = tx;
+    m_parse_bytes = 0;
+    m_parse_nsecs = 0;
+    m_latency_sum = 0;
+    m_latency_max = 0;
+    m_latency_count = 0;
+
+    if (m_csv.isOpen())
+	write_csv_row();
+    emit Sampled(m_sample);
+}
+
+/**
+ * @brief Append the current sample to the CSV file
+ */
+void SerialStats::write_csv_row()
+{
+    const Sample& s = m_sample;
+    const QString row = QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11,%12,%13\n")
+			.arg(s.msecs)
+			.arg(s.rx_rate, 0, 'f', 0)
+			.arg(s.tx_rate, 0, 'f', 0)
+			.arg(s.rx_total)
+			.arg(s.tx_total)
+			.arg(s.rx_stalls)
+			.arg(s.errors)
+			.arg(s.dropped)
+			.arg(s.latency_avg, 0, 'f', 3)
+			.arg(s.latency_max, 0, 'f', 3)
+			.arg(s.parse_rate, 0, 'f', 2)
+			.arg(s.upload_rate, 0, 'f', 0)
+			.arg(s.upload_baud);
+    if (m_csv.write(row.toLatin1()) < 0) {
+	emit Error(tr("Writing statistics file '%1' failed: %2")
+		   .arg(QFileInfo(m_csv.fileName()).fileName())
+		   .arg(m_csv.errorString()));
+	stop_csv();
+	return;
+    }
+    m_csv.flush();
+}
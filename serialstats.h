@@ -0,0 +1,100 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 serial throughput and latency statistics
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTimer>
+
+class SerialWorker;
+class RxCapture;
+
+/**
+ * @brief Samples the serial counters once per second
+ *
+ * The byte counters come from the SerialWorker and the RxCapture; the
+ * GUI thread reports errors, the time the terminal spent parsing, when
+ * received data was painted, and the upload progress. Each second a
+ * Sample is computed, emitted with Sampled(), and optionally appended
+ * to a CSV file.
+ */
+class SerialStats : public QObject
+{
+    Q_OBJECT
+public:
+    struct Sample {
+	qint64 msecs = 0;		//!< milliseconds since the last reset()
+	double rx_rate = 0.0;		//!< received bytes per second
+	double tx_rate = 0.0;		//!< transmitted bytes per second
+	quint64 rx_total = 0;		//!< bytes received since the last reset()
+	quint64 tx_total = 0;		//!< bytes transmitted since the last reset()
+	quint64 rx_stalls = 0;		//!< times the receive ring was full
+	quint64 errors = 0;		//!< errors reported by the serial port
+	quint64 dropped = 0;		//!< bytes dropped by the capture
+	double latency_avg = 0.0;	//!< average milliseconds from reception to paint
+	double latency_max = 0.0;	//!< maximum milliseconds from reception to paint
+	double parse_rate = 0.0;	//!< MB/s parsed by the terminal while it was busy
+	double upload_rate = 0.0;	//!< effective bits/s of the last upload
+	quint32 upload_baud = 0;	//!< nominal baud rate of the last upload
+    };
+
+    explicit SerialStats(SerialWorker* worker, RxCapture* capture, QObject* parent = nullptr);
+
+    const Sample& sample() const;
+    bool is_csv_active() const;
+    QString csv_filename() const;
+
+    bool start_csv(const QString& filename);
+    void stop_csv();
+
+    void add_error();
+    void add_parse(qint64 bytes, qint64 nsecs);
+    void delivered(qint64 stamp);
+    void painted();
+    void upload_started(quint32 baud);
+    void upload_progress(qint64 value, qint64 total);
+
+public slots:
+    void reset();
+
+signals:
+    void Sampled(const SerialStats::Sample& sample);
+    void Error(const QString& message);
+
+private slots:
+    void tick();
+
+private:
+    //! Milliseconds between samples
+    static constexpr int sample_interval = 1000;
+
+    SerialWorker* m_worker;		//!< worker with the byte counters
+    RxCapture* m_capture;		//!< capture with the dropped bytes counter
+    QTimer m_timer;			//!< sample timer
+    QElapsedTimer m_since_reset;	//!< time since the last reset()
+    QElapsedTimer m_since_tick;		//!< time since the last sample
+    QElapsedTimer m_upload;		//!< time since the upload started
+    QFile m_csv;			//!< CSV file, if open
+    Sample m_sample;			//!< most recent sample
+    quint64 m_rx_base;			//!< worker's rx_bytes() at the last reset()
+    quint64 m_tx_base;			//!< worker's tx_bytes() at the last reset()
+    quint64 m_stalls_base;		//!< worker's rx_stalls() at the last reset()
+    quint64 m_rx_last;			//!< worker's rx_bytes() at the last sample
+    quint64 m_tx_last;			//!< worker's tx_bytes() at the last sample
+    quint64 m_errors;			//!< errors since the last reset()
+    qint64 m_parse_bytes;		//!< bytes parsed since the last sample
+    qint64 m_parse_nsecs;		//!< nanoseconds spent parsing since the last sample
+    qint64 m_pending_stamp;		//!< reception time of data not yet painted, or 0
+    qint64 m_latency_sum;		//!< sum of latencies since the last sample (ns)
+    qint64 m_latency_max;		//!< maximum latency since the last sample (ns)
+    int m_latency_count;		//!< number of latencies since the last sample
+
+    void write_csv_row();
+};
@@ -0,0 +1,326 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 serial port worker thread
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QSerialPort>
+#include <chrono>
+#include "serialworker.h"
+#include "rxcapture.h"
+
+SerialWorker::SerialWorker(RxRing* ring, RxCapture* capture)
+    : QObject()
+    , m_thread()
+    , m_ring(ring)
+    , m_capture(capture)
+    , m_dev(nullptr)
+    , m_retry(new QTimer(this))
+    , m_attached(nullptr)
+    , m_status(new QTimer(this))
+    , m_last_status(0)
+    , m_rx_seen(false)
+    , m_rx_bytes(0)
+    , m_tx_bytes(0)
+    , m_rx_stalls(0)
+    , m_rx_stamp(0)
+{
+    qRegisterMetaType<QIODevice*>();
+    qRegisterMetaType<QThread*>();
+
+    m_retry->setSingleShot(true);
+    m_retry->setInterval(full_retry);
+    bool ok;
+    ok = connect(m_retry, &QTimer::timeout,
+		 this, &SerialWorker::dev_ready_read);
+    Q_ASSERT(ok);
+
+    m_status->setInterval(status_interval);
+    ok = connect(m_status, &QTimer::timeout,
+		 this, &SerialWorker::status_poll);
+    Q_ASSERT(ok);
+
+    m_thread.setObjectName(QLatin1String("SerialWorker"));
+    moveToThread(&m_thread);
+    m_thread.start();
+}
+
+SerialWorker::~SerialWorker()
+{
+    detach();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+/**
+ * @brief Return true, if a device is attached to the worker
+ * @return true if attached, false otherwise
+ */
+bool SerialWorker::is_attached() const
+{
+    return m_attached != nullptr;
+}
+
+/**
+ * @brief Return the status bits for the device @p dev
+ *
+ * This must be called from the thread the device lives in.
+ * @param dev pointer to the QIODevice (QSerialPort or QFile)
+ * @return QSerialPort::PinoutSignals ORed with the Status_* bits
+ */
+quint32 SerialWorker::poll_status(QIODevice* dev)
+{
+    if (!dev)
+	return 0;
+    quint32 status = 0;
+    if (dev->isOpen())
+	status |= Status_Open;
+    if (dev->bytesToWrite() > 0)
+	status |= Status_Tx;
+    QSerialPort* stty = qobject_cast<QSerialPort*>(dev);
+    if (stty && stty->isOpen()) {
+	status |= static_cast<quint32>(stty->pinoutSignals()) & 0xffff;
+	if (stty->isBreakEnabled())
+	    status |= Status_Break;
+	switch (stty->error()) {
+	case QSerialPort::FramingError:
+	    status |= Status_FramingError;
+	    break;
+	case QSerialPort::ParityError:
+	    status |= Status_ParityError;
+	    break;
+	default:
+	    break;
+	}
+    }
+    return status;
+}
+
+/**
+ * @brief Return a monotonic time stamp in nanoseconds, usable across threads
+ */
+qint64 SerialWorker::now_ns()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Return the total number of bytes received
+ */
+quint64 SerialWorker::rx_bytes() const
+{
+    return m_rx_bytes.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Return the total number of bytes the device reported as written
+ */
+quint64 SerialWorker::tx_bytes() const
+{
+    return m_tx_bytes.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Return how often the ring was full when data arrived
+ */
+quint64 SerialWorker::rx_stalls() const
+{
+    return m_rx_stalls.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Return and reset the time stamp of the oldest data received since the last call
+ * @return now_ns() when the data arrived, or 0 if nothing arrived
+ */
+qint64 SerialWorker::take_rx_stamp()
+{
+    return m_rx_stamp.exchange(0, std::memory_order_acq_rel);
+}
+
+/**
+ * @brief Hand the device @p dev over to the worker thread
+ *
+ * The device must not have a parent and must live in the calling thread.
+ * @param dev pointer to the QIODevice (QSerialPort or QFile)
+ */
+void SerialWorker::attach(QIODevice* dev)
+{
+    if (m_attached || !dev)
+	return;
+    dev->moveToThread(&m_thread);
+    m_attached = dev;
+    QMetaObject::invokeMethod(this, "do_attach", Qt::QueuedConnection,
+			      Q_ARG(QIODevice*, dev));
+}
+
+/**
+ * @brief Take the device back from the worker thread
+ *
+ * Pending data in the device is moved to the ring as far as it fits.
+ * When this returns, the device lives in the calling thread again.
+ * @return pointer to the previously attached QIODevice, or nullptr
+ */
+QIODevice* SerialWorker::detach()
+{
+    if (!m_attached)
+	return nullptr;
+    QIODevice* dev = m_attached;
+    QMetaObject::invokeMethod(this, "do_detach", Qt::BlockingQueuedConnection,
+			      Q_ARG(QThread*, QThread::currentThread()));
+    m_attached = nullptr;
+    return dev;
+}
+
+/**
+ * @brief Write @p data to the attached device
+ * @param data QByteArray with the data to write
+ */
+void SerialWorker::write(const QByteArray& data)
+{
+    QMetaObject::invokeMethod(this, "do_write", Qt::QueuedConnection,
+			      Q_ARG(QByteArray, data));
+}
+
+/**
+ * @brief Pulse the DTR line low for @p msecs milliseconds to reset the Propeller
+ * @param msecs milliseconds to keep DTR low
+ */
+void SerialWorker::pulse_dtr(int msecs)
+{
+    QMetaObject::invokeMethod(this, "do_pulse_dtr", Qt::QueuedConnection,
+			      Q_ARG(int, msecs));
+}
+
+/**
+ * @brief Discard the data pending in the attached device
+ */
+void SerialWorker::discard()
+{
+    QMetaObject::invokeMethod(this, "do_discard", Qt::QueuedConnection);
+}
+
+void SerialWorker::do_attach(QIODevice* dev)
+{
+    m_dev = dev;
+    bool ok;
+    ok = connect(m_dev, &QIODevice::readyRead,
+		 this, &SerialWorker::dev_ready_read,
+		 Qt::UniqueConnection);
+    Q_ASSERT(ok);
+    ok = connect(m_dev, &QIODevice::bytesWritten,
+		 this, &SerialWorker::dev_bytes_written,
+		 Qt::UniqueConnection);
+    Q_ASSERT(ok);
+    dev_ready_read();
+    // report the initial status on the next poll
+    m_last_status = ~0u;
+    m_status->start();
+}
+
+void SerialWorker::do_detach(QThread* target)
+{
+    if (!m_dev)
+	return;
+    disconnect(m_dev, &QIODevice::readyRead,
+	       this, &SerialWorker::dev_ready_read);
+    disconnect(m_dev, &QIODevice::bytesWritten,
+	       this, &SerialWorker::dev_bytes_written);
+    dev_ready_read();
+    m_retry->stop();
+    m_status->stop();
+    m_dev->moveToThread(target);
+    m_dev = nullptr;
+}
+
+void SerialWorker::do_write(const QByteArray& data)
+{
+    if (!m_dev)
+	return;
+    const qint64 written = m_dev->write(data);
+    // a QFile for a tty writes through without emitting bytesWritten()
+    if (written > 0 && !qobject_cast<QSerialPort*>(m_dev))
+	dev_bytes_written(written);
+}
+
+void SerialWorker::do_pulse_dtr(int msecs)
+{
+    QSerialPort* stty = qobject_cast<QSerialPort*>(m_dev);
+    if (stty) {
+	stty->setDataTerminalReady(false);
+	QThread::msleep(static_cast<unsigned long>(msecs));
+	stty->setDataTerminalReady(true);
+    }
+    // reported even without a serial port, so that nobody waits forever
+    emit DtrPulsed();
+}
+
+void SerialWorker::do_discard()
+{
+    if (!m_dev)
+	return;
+    m_dev->readAll();
+}
+
+/**
+ * @brief Move the data available in the device into the ring buffer
+ *
+ * If the ring is full, the remainder stays in the device's read buffer
+ * and the retry timer is started to try again shortly.
+ */
+void SerialWorker::dev_ready_read()
+{
+    if (!m_dev)
+	return;
+    while (m_dev->bytesAvailable() > 0) {
+	qint64 room = 0;
+	char* dst = m_ring->write_span(&room);
+	if (!dst) {
+	    if (!m_retry->isActive()) {
+		m_rx_stalls.fetch_add(1, std::memory_order_relaxed);
+		m_retry->start();
+	    }
+	    return;
+	}
+	const qint64 got = m_dev->read(dst, qMin(room, m_dev->bytesAvailable()));
+	if (got <= 0)
+	    break;
+	if (m_capture)
+	    m_capture->append(dst, got);
+	m_ring->commit(got);
+	m_rx_seen = true;
+	m_rx_bytes.fetch_add(static_cast<quint64>(got), std::memory_order_relaxed);
+	qint64 none = 0;
+	m_rx_stamp.compare_exchange_strong(none, now_ns(), std::memory_order_acq_rel);
+    }
+}
+
+/**
+ * @brief Count the @p bytes written by the device and report them
+ * @param bytes number of bytes written
+ */
+void SerialWorker::dev_bytes_written(qint64 bytes)
+{
+    m_tx_bytes.fetch_add(static_cast<quint64>(bytes), std::memory_order_relaxed);
+    emit BytesWritten(bytes);
+}
+
+/**
+ * @brief Poll the device status and report it if it changed
+ */
+void SerialWorker::status_poll()
+{
+    if (!m_dev)
+	return;
+    quint32 status = poll_status(m_dev);
+    if (m_rx_seen)
+	status |= Status_Rx;
+    m_rx_seen = false;
+    if (status == m_last_status)
+	return;
+    m_last_status = status;
+    emit StatusChanged(status);
+}
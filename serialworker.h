@@ -0,0 +1,100 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 serial port worker thread
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QObject>
+#include <QIODevice>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include "rxring.h"
+
+class RxCapture;
+
+/**
+ * @brief Reader for the serial device running in a thread of its own
+ *
+ * While a device is attached, it is owned by the worker thread. Everything
+ * received is stored in the RxRing passed to the constructor, which the GUI
+ * thread drains at its own pace. If the ring is full, the data stays in the
+ * device's (unlimited) read buffer until there is room again, so the
+ * serial side never overruns, no matter how slow the consumer is. With an
+ * RxCapture, everything stored in the ring is also appended to the capture.
+ *
+ * The public methods are meant to be called from the GUI thread; they forward
+ * to the worker thread with queued invocations. BytesWritten() reports the
+ * data the device passed on to the driver, so senders can pace themselves.
+ */
+class SerialWorker : public QObject
+{
+    Q_OBJECT
+public:
+    //! Status bits in addition to the QSerialPort::PinoutSignals in bits 0 to 15
+    enum {
+	Status_Open		= 1 << 16,	//!< device is open
+	Status_Rx		= 1 << 17,	//!< data was received since the last poll
+	Status_Tx		= 1 << 18,	//!< data is waiting to be transmitted
+	Status_Break		= 1 << 19,	//!< break is enabled
+	Status_FramingError	= 1 << 20,	//!< the device reported a framing error
+	Status_ParityError	= 1 << 21,	//!< the device reported a parity error
+    };
+
+    explicit SerialWorker(RxRing* ring, RxCapture* capture = nullptr);
+    ~SerialWorker();
+
+    bool is_attached() const;
+    static quint32 poll_status(QIODevice* dev);
+    static qint64 now_ns();
+
+    quint64 rx_bytes() const;
+    quint64 tx_bytes() const;
+    quint64 rx_stalls() const;
+    qint64 take_rx_stamp();
+
+    void attach(QIODevice* dev);
+    QIODevice* detach();
+    void write(const QByteArray& data);
+    void pulse_dtr(int msecs = 10);
+    void discard();
+
+signals:
+    void StatusChanged(quint32 status);
+    void BytesWritten(qint64 bytes);
+    void DtrPulsed();
+
+private slots:
+    void do_attach(QIODevice* dev);
+    void do_detach(QThread* target);
+    void do_write(const QByteArray& data);
+    void do_pulse_dtr(int msecs);
+    void do_discard();
+    void dev_ready_read();
+    void dev_bytes_written(qint64 bytes);
+    void status_poll();
+
+private:
+    //! Milliseconds to wait before retrying while the ring is full
+    static constexpr int full_retry = 2;
+    //! Milliseconds between polls of the modem lines and error state
+    static constexpr int status_interval = 100;
+
+    QThread m_thread;		//!< thread the worker runs in
+    RxRing* m_ring;		//!< ring buffer to store received data in
+    RxCapture* m_capture;	//!< capture of the received data, or nullptr
+    QIODevice* m_dev;		//!< currently attached device
+    QTimer* m_retry;		//!< timer to retry reading while the ring is full
+    QIODevice* m_attached;	//!< device handed over by the GUI thread
+    QTimer* m_status;		//!< timer to poll the device status
+    quint32 m_last_status;	//!< most recently reported status
+    bool m_rx_seen;		//!< true if data was received since the last poll
+    std::atomic<quint64> m_rx_bytes;	//!< total bytes received
+    std::atomic<quint64> m_tx_bytes;	//!< total bytes written by the device
+    std::atomic<quint64> m_rx_stalls;	//!< times the ring was found full
+    std::atomic<qint64> m_rx_stamp;	//!< now_ns() of the oldest data not yet taken, or 0
+};
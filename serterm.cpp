@@ -6,15 +6,21 @@
  * See the file LICENSE for the details of the BSD-3-Clause terms.
  *
  *****************************************************************************/
+#include <QApplication>
 #include <QPair>
-#include <QEventLoop>
 #include <QSerialPortInfo>
 #include <QLocale>
 #include <QFileDialog>
-#include <QTextStream>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QMenu>
+#include <QMessageBox>
+#include <QProgressBar>
 #include <QStandardPaths>
 #include <QTimer>
 #include "serterm.h"
+#include "serialworker.h"
+#include "filesender.h"
 #include "vtscrollarea.h"
 #include "ui_serterm.h"
 #include "idstrings.h"
@@ -23,16 +29,36 @@
 SerTerm::SerTerm(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::SerTerm)
-    , m_dev(nullptr)
+    , m_worker(nullptr)
     , m_font_family()
     , m_zoom(100)
+    , m_backlog_lines(100000)
+    , m_backlog_memory(16384)
+    , m_opengl(false)
     , m_download_path()
     , m_caps_lock(false)
     , m_num_lock(false)
     , m_scroll_lock(false)
     , m_local_echo(false)
+    , m_sender(nullptr)
+    , m_act_sendfile(nullptr)
+    , m_act_send_prompt(nullptr)
+    , m_act_send_xon_xoff(nullptr)
+    , m_act_opengl(nullptr)
+    , m_act_send_progress(nullptr)
+    , m_send_progress(nullptr)
+    , m_send_prompt()
+    , m_send_prompt_timeout(2000)
+    , m_send_xon_xoff(false)
+    , m_find_edit(nullptr)
+    , m_act_find_regex(nullptr)
+    , m_act_find_case(nullptr)
+    , m_find_regex(false)
+    , m_find_case(false)
 {
     ui->setupUi(this);
+    // the terminal is shown in the scroll area's virtual viewport
+    ui->scrollArea->setWidget(ui->vterm);
     load_config();
     setup_terminal();
     setFocusPolicy(Qt::StrongFocus);
@@ -44,9 +70,9 @@ SerTerm::~SerTerm()
     delete ui;
 }
 
-void SerTerm::set_device(QIODevice* dev)
+void SerTerm::set_worker(SerialWorker* worker)
 {
-    m_dev = dev;
+    m_worker = worker;
 }
 
 void SerTerm::term_set_size(int width, int height)
@@ -79,9 +105,20 @@ int SerTerm::write(const QByteArray& data)
     return ui->vterm->write(data);
 }
 
+/**
+ * @brief Write data received from the Prop to the terminal
+ *
+ * A running file transfer looks at the data for XON/XOFF and its prompt.
+ * @param data pointer to the received bytes
+ * @param len number of bytes
+ * @return number of bytes written
+ */
 int SerTerm::write(const char* data, size_t len)
 {
-    return ui->vterm->write(data, len);
+    const int res = ui->vterm->write(data, len);
+    if (m_sender)
+	m_sender->received(data, len);
+    return res;
 }
 
 void SerTerm::display_text(const QString& filename)
@@ -107,7 +144,8 @@ void SerTerm::set_zoom(int percent)
 void SerTerm::reset()
 {
     reset_prop();
-    m_dev->readAll();
+    if (m_worker)
+	m_worker->discard();
 }
 void SerTerm::term_clear()
 {
@@ -139,7 +177,7 @@ void SerTerm::zoom_in()
 {
     int zoom = ui->vterm->zoom();
     if (zoom < 300) {
-	m_zoom = zoom + 4;
+	m_zoom = zoom + vt220::zoom_step;
 	ui->vterm->set_zoom(m_zoom);
     }
 }
@@ -148,11 +186,33 @@ void SerTerm::zoom_out()
 {
     int zoom = ui->vterm->zoom();
     if (zoom > 5) {
-	m_zoom = zoom - 4;
+	m_zoom = zoom - vt220::zoom_step;
 	ui->vterm->set_zoom(m_zoom);
     }
 }
 
+/**
+ * @brief Switch between the raster and the OpenGL renderer
+ * @param checked if true, draw the terminal with OpenGL
+ */
+void SerTerm::opengl_triggered(bool checked)
+{
+    m_opengl = checked;
+    ui->vterm->set_renderer(m_opengl ? vt220::OpenGL : vt220::Raster);
+}
+
+/**
+ * @brief Report that the terminal fell back to the raster renderer
+ * @param message error message of the terminal
+ */
+void SerTerm::renderer_error(const QString& message)
+{
+    m_opengl = ui->vterm->renderer() == vt220::OpenGL;
+    if (m_act_opengl)
+	m_act_opengl->setChecked(m_opengl);
+    QMessageBox::warning(this, tr("OpenGL renderer"), message);
+}
+
 void SerTerm::setup_terminal()
 {
     bool ok;
@@ -167,6 +227,21 @@ void SerTerm::setup_terminal()
 	    Qt::UniqueConnection);
     Q_ASSERT(ok);
 
+    ok = connect(ui->vterm, &vt220::UpdateLines,
+	    ui->scrollArea, &vtScrollArea::UpdateLines,
+	    Qt::UniqueConnection);
+    Q_ASSERT(ok);
+
+    ok = connect(ui->vterm, &vt220::Painted,
+	    this, &SerTerm::painted,
+	    Qt::UniqueConnection);
+    Q_ASSERT(ok);
+
+    ok = connect(ui->vterm, &vt220::Error,
+	    this, &SerTerm::renderer_error,
+	    Qt::UniqueConnection);
+    Q_ASSERT(ok);
+
     ui->toolbar->setIconSize(QSize(20, 20));
     ui->toolbar->setToolButtonStyle(Qt::ToolButtonIconOnly);
 
@@ -194,11 +269,33 @@ void SerTerm::setup_terminal()
     Q_ASSERT(ok);
     ui->toolbar->addAction(act_taqoz);
 
-    QAction* act_sendfile = new QAction(QIcon(":/images/sendfile.png"), tr("Send file"));
-    ok = connect(act_sendfile, &QAction::triggered,
+    m_act_sendfile = new QAction(QIcon(":/images/sendfile.png"), tr("Send file"));
+    ok = connect(m_act_sendfile, &QAction::triggered,
 	    this, &SerTerm::sendfile_triggered);
     Q_ASSERT(ok);
-    ui->toolbar->addAction(act_sendfile);
+
+    QMenu* menu_sendfile = new QMenu(this);
+    m_act_send_prompt = menu_sendfile->addAction(tr("Wait for a prompt after each line..."));
+    m_act_send_prompt->setCheckable(true);
+    m_act_send_prompt->setChecked(!m_send_prompt.isEmpty());
+    ok = connect(m_act_send_prompt, &QAction::triggered,
+	    this, &SerTerm::send_prompt_triggered);
+    Q_ASSERT(ok);
+    m_act_send_xon_xoff = menu_sendfile->addAction(tr("Pause on received XOFF until XON"));
+    m_act_send_xon_xoff->setCheckable(true);
+    m_act_send_xon_xoff->setChecked(m_send_xon_xoff);
+    ok = connect(m_act_send_xon_xoff, &QAction::triggered,
+	    this, &SerTerm::send_xon_xoff_triggered);
+    Q_ASSERT(ok);
+    m_act_sendfile->setMenu(menu_sendfile);
+    ui->toolbar->addAction(m_act_sendfile);
+
+    m_send_progress = new QProgressBar();
+    m_send_progress->setToolTip(tr("Shows the progress and throughput of sending the file."));
+    m_send_progress->setFixedWidth(200);
+    m_send_progress->setRange(0, 100);
+    m_act_send_progress = ui->toolbar->addWidget(m_send_progress);
+    m_act_send_progress->setVisible(false);
 
     ui->toolbar->addSeparator();
 
@@ -222,8 +319,68 @@ void SerTerm::setup_terminal()
     Q_ASSERT(ok);
     ui->toolbar->addAction(act_zoom_in);
 
+    m_act_opengl = new QAction(tr("GL"));
+    m_act_opengl->setToolTip(tr("Draw the terminal with OpenGL"));
+    m_act_opengl->setCheckable(true);
+    m_act_opengl->setChecked(m_opengl);
+    ok = connect(m_act_opengl, &QAction::triggered,
+            this, &SerTerm::opengl_triggered);
+    Q_ASSERT(ok);
+    ui->toolbar->addAction(m_act_opengl);
+
+    ui->toolbar->addSeparator();
+
+    m_find_edit = new QLineEdit();
+    m_find_edit->setPlaceholderText(tr("Find in terminal"));
+    m_find_edit->setToolTip(tr("Text to find in the terminal output and backlog."));
+    m_find_edit->setClearButtonEnabled(true);
+    m_find_edit->setFixedWidth(200);
+    ok = connect(m_find_edit, &QLineEdit::returnPressed,
+	    this, &SerTerm::find_return_pressed);
+    Q_ASSERT(ok);
+    ok = connect(m_find_edit, &QLineEdit::textChanged,
+	    this, &SerTerm::find_text_changed);
+    Q_ASSERT(ok);
+    ui->toolbar->addWidget(m_find_edit);
+
+    QAction* act_find_next = new QAction(QIcon(":/images/find.png"), tr("Find next"));
+    act_find_next->setShortcut(QKeySequence::FindNext);
+    act_find_next->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    ok = connect(act_find_next, &QAction::triggered,
+	    this, &SerTerm::find_next_triggered);
+    Q_ASSERT(ok);
+
+    QMenu* menu_find = new QMenu(this);
+    QAction* act_find_previous = menu_find->addAction(tr("Find previous"));
+    act_find_previous->setShortcut(QKeySequence::FindPrevious);
+    act_find_previous->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    ok = connect(act_find_previous, &QAction::triggered,
+	    this, &SerTerm::find_previous_triggered);
+    Q_ASSERT(ok);
+    menu_find->addSeparator();
+    m_act_find_regex = menu_find->addAction(tr("Regular expression"));
+    m_act_find_regex->setCheckable(true);
+    m_act_find_regex->setChecked(m_find_regex);
+    ok = connect(m_act_find_regex, &QAction::triggered,
+	    this, &SerTerm::find_regex_triggered);
+    Q_ASSERT(ok);
+    m_act_find_case = menu_find->addAction(tr("Match case"));
+    m_act_find_case->setCheckable(true);
+    m_act_find_case->setChecked(m_find_case);
+    ok = connect(m_act_find_case, &QAction::triggered,
+	    this, &SerTerm::find_case_triggered);
+    Q_ASSERT(ok);
+    act_find_next->setMenu(menu_find);
+    ui->toolbar->addAction(act_find_next);
+    // the shortcuts work while the terminal has the focus
+    addAction(act_find_next);
+    addAction(act_find_previous);
+
     ui->vterm->set_font_family(m_font_family);
     ui->vterm->set_zoom(m_zoom);
+    ui->vterm->set_backlog_lines(m_backlog_lines);
+    ui->vterm->set_backlog_memory(m_backlog_memory);
+    ui->vterm->set_renderer(m_opengl ? vt220::OpenGL : vt220::Raster);
 }
 
 void SerTerm::setup_signals()
@@ -247,6 +404,17 @@ void SerTerm::save_config()
     s.beginGroup(id_terminal);
     m_zoom = ui->vterm->zoom();
     s.setValue(id_zoom, m_zoom);
+    s.setValue(id_backlog_lines, m_backlog_lines);
+    s.setValue(id_backlog_memory, m_backlog_memory);
+    s.setValue(id_opengl, m_opengl);
+    s.endGroup();
+
+    s.beginGroup(id_grp_serterm);
+    s.setValue(id_send_prompt, m_send_prompt);
+    s.setValue(id_send_prompt_timeout, m_send_prompt_timeout);
+    s.setValue(id_send_xon_xoff, m_send_xon_xoff);
+    s.setValue(id_find_regex, m_find_regex);
+    s.setValue(id_find_case, m_find_case);
     s.endGroup();
 }
 
@@ -257,6 +425,17 @@ void SerTerm::load_config()
     s.beginGroup(id_terminal);
     m_zoom = s.value(id_zoom, 100).toInt();
     m_font_family = s.value(id_font_family, QString()).toString();
+    m_backlog_lines = s.value(id_backlog_lines, m_backlog_lines).toInt();
+    m_backlog_memory = s.value(id_backlog_memory, m_backlog_memory).toInt();
+    m_opengl = s.value(id_opengl, m_opengl).toBool();
+    s.endGroup();
+
+    s.beginGroup(id_grp_serterm);
+    m_send_prompt = s.value(id_send_prompt, m_send_prompt).toString();
+    m_send_prompt_timeout = s.value(id_send_prompt_timeout, m_send_prompt_timeout).toInt();
+    m_send_xon_xoff = s.value(id_send_xon_xoff, m_send_xon_xoff).toBool();
+    m_find_regex = s.value(id_find_regex, m_find_regex).toBool();
+    m_find_case = s.value(id_find_case, m_find_case).toBool();
     s.endGroup();
 
     QStringList download_paths = QStandardPaths::standardLocations(QStandardPaths::DownloadLocation);
@@ -324,12 +503,8 @@ QString SerTerm::load_file(const QString& title)
 
 void SerTerm::reset_prop()
 {
-    QSerialPort* port = qobject_cast<QSerialPort*>(m_dev);
-    if (port) {
-	QEventLoop loop(this);
-	port->setDataTerminalReady(false);
-	loop.processEvents(QEventLoop::AllEvents, 10);
-	port->setDataTerminalReady(true);
+    if (m_worker) {
+	m_worker->pulse_dtr(10);
     }
 }
 
@@ -342,59 +517,261 @@ void SerTerm::reset_triggered(bool checked)
 void SerTerm::version_triggered(bool checked)
 {
     Q_UNUSED(checked);
-    QSerialPort* port = qobject_cast<QSerialPort*>(m_dev);
-    if (port) {
+    if (m_worker) {
 	reset_prop();
 	QByteArray version("> Prop_Chk 0 0 0 0\015");
-	port->write(version);
+	m_worker->write(version);
     }
 }
 
 void SerTerm::monitor_triggered(bool checked)
 {
     Q_UNUSED(checked);
-    QSerialPort* port = qobject_cast<QSerialPort*>(m_dev);
-    if (port) {
+    if (m_worker) {
 	reset_prop();
 	QByteArray monitor("> \004");
-	port->write(monitor);
+	m_worker->write(monitor);
     }
 }
 
 void SerTerm::taqoz_triggered(bool checked)
 {
     Q_UNUSED(checked);
-    QSerialPort* port = qobject_cast<QSerialPort*>(m_dev);
-    if (port) {
+    if (m_worker) {
 	reset_prop();
 	QByteArray taqoz("> \033");
-	port->write(taqoz);
+	m_worker->write(taqoz);
     }
 }
 
+/**
+ * @brief Send a file to the Prop, or cancel sending it
+ *
+ * The file is streamed by a FileSender in the background, so the
+ * terminal keeps running and shows what the Prop answers.
+ * @param checked unused
+ */
 void SerTerm::sendfile_triggered(bool checked)
 {
     Q_UNUSED(checked);
-    QEventLoop loop(this);
+    if (m_sender) {
+	m_sender->cancel();
+	return;
+    }
+    if (!m_worker)
+	return;
     QString filename = load_file(tr("Select file to send"));
     if (filename.isEmpty())
 	return;
-    QFile file(filename);
-    if (file.open(QIODevice::ReadOnly)) {
-	QTextStream str(&file);
-	str.setCodec("UTF-8");
-
-	while (!str.atEnd()) {
-	    QString line = str.readLine();
-	    QByteArray utf8 =  line.toUtf8() + '\n';
-	    emit term_response(utf8);
-	    if (m_local_echo) {
-		ui->vterm->write(utf8);
-	    }
-	    loop.processEvents();
-	}
-	file.close();
+
+    FileSender::Options options;
+    options.prompt = m_send_prompt.toUtf8();
+    options.prompt_timeout = m_send_prompt_timeout;
+    options.xon_xoff = m_send_xon_xoff;
+    m_sender = new FileSender(m_worker, options, this);
+
+    bool ok;
+    ok = connect(m_sender, &FileSender::Sent,
+		 this, &SerTerm::sender_sent);
+    Q_ASSERT(ok);
+    ok = connect(m_sender, &FileSender::Error,
+		 this, &SerTerm::sender_error);
+    Q_ASSERT(ok);
+    ok = connect(m_sender, &FileSender::Progress,
+		 this, &SerTerm::sender_progress);
+    Q_ASSERT(ok);
+    ok = connect(m_sender, &FileSender::Finished,
+		 this, &SerTerm::sender_finished);
+    Q_ASSERT(ok);
+
+    if (!m_sender->start(filename)) {
+	m_sender->deleteLater();
+	m_sender = nullptr;
+	return;
+    }
+    m_act_sendfile->setText(tr("Cancel sending the file"));
+    m_send_progress->setValue(0);
+    m_send_progress->setFormat(QStringLiteral("%p%"));
+    m_act_send_progress->setVisible(true);
+}
+
+/**
+ * @brief Toggle waiting for a prompt after each line sent
+ * @param checked if true, ask for the prompt to wait for
+ */
+void SerTerm::send_prompt_triggered(bool checked)
+{
+    QString prompt;
+    if (checked) {
+	bool ok = false;
+	prompt = QInputDialog::getText(this, tr("Send file"),
+				       tr("Prompt to wait for after each line:"),
+				       QLineEdit::Normal,
+				       m_send_prompt.isEmpty() ? QStringLiteral("> ") : m_send_prompt,
+				       &ok);
+	if (!ok)
+	    prompt.clear();
+    }
+    m_send_prompt = prompt;
+    m_act_send_prompt->setChecked(!m_send_prompt.isEmpty());
+}
+
+/**
+ * @brief Toggle pausing on received XOFF until XON
+ * @param checked if true, pause on XOFF
+ */
+void SerTerm::send_xon_xoff_triggered(bool checked)
+{
+    m_send_xon_xoff = checked;
+}
+
+/**
+ * @brief Echo the data sent, if local echo is enabled
+ * @param data sent bytes
+ */
+void SerTerm::sender_sent(const QByteArray& data)
+{
+    if (m_local_echo) {
+	ui->vterm->write(data);
+    }
+}
+
+/**
+ * @brief Report an error sending the file
+ * @param message error message
+ */
+void SerTerm::sender_error(const QString& message)
+{
+    QMessageBox::warning(this, tr("Send file"), message);
+}
+
+/**
+ * @brief Show the progress and throughput of sending the file
+ * @param value number of bytes sent
+ * @param total size of the file
+ */
+void SerTerm::sender_progress(qint64 value, qint64 total)
+{
+    const int percent = total > 0 ? static_cast<int>(value * 100 / total) : 100;
+    const qint64 rate = m_sender ? m_sender->rate() : 0;
+    m_send_progress->setValue(percent);
+    m_send_progress->setFormat(tr("%p% at %1 KiB/s")
+			       .arg(static_cast<double>(rate) / 1024.0, 0, 'f', 1));
+}
+
+/**
+ * @brief Clean up when sending the file finished or was canceled
+ * @param ok true if the whole file was sent
+ */
+void SerTerm::sender_finished(bool ok)
+{
+    Q_UNUSED(ok);
+    m_act_send_progress->setVisible(false);
+    m_act_sendfile->setText(tr("Send file"));
+    if (m_sender) {
+	m_sender->deleteLater();
+	m_sender = nullptr;
+    }
+}
+
+/**
+ * @brief Find the next match of the find text
+ */
+void SerTerm::find_next_triggered(bool checked)
+{
+    Q_UNUSED(checked);
+    find(false);
+}
+
+/**
+ * @brief Find the previous match of the find text
+ */
+void SerTerm::find_previous_triggered(bool checked)
+{
+    Q_UNUSED(checked);
+    find(true);
+}
+
+/**
+ * @brief Toggle finding regular expressions
+ * @param checked if true, the find text is a regular expression
+ */
+void SerTerm::find_regex_triggered(bool checked)
+{
+    m_find_regex = checked;
+}
+
+/**
+ * @brief Toggle matching the case when finding
+ * @param checked if true, upper and lower case are distinguished
+ */
+void SerTerm::find_case_triggered(bool checked)
+{
+    m_find_case = checked;
+}
+
+/**
+ * @brief Remove the highlight when the find text changes
+ *
+ * The next search then starts at the top of the view again.
+ */
+void SerTerm::find_text_changed(const QString& text)
+{
+    Q_UNUSED(text);
+    ui->vterm->set_highlight(vtMatch());
+}
+
+/**
+ * @brief Find the next match when Return is pressed in the find text
+ */
+void SerTerm::find_return_pressed()
+{
+    find(false);
+}
+
+/**
+ * @brief Find, highlight, and scroll to the next or previous match
+ *
+ * The search starts at the highlighted match, or at the top of the view
+ * (for backward searches at the end) if nothing is highlighted.
+ * @param backward if true, search towards the oldest line
+ */
+void SerTerm::find(bool backward)
+{
+    const QString pattern = m_find_edit->text();
+    if (pattern.isEmpty()) {
+	ui->vterm->set_highlight(vtMatch());
+	return;
+    }
+    int flags = 0;
+    if (m_find_regex)
+	flags |= vtTextIndex::Find_Regex;
+    if (m_find_case)
+	flags |= vtTextIndex::Find_CaseSensitive;
+    if (backward)
+	flags |= vtTextIndex::Find_Backward;
+
+    const vtMatch& current = ui->vterm->highlight();
+    int line = backward ? ui->vterm->content_lines() : ui->vterm->top_line();
+    int column = 0;
+    if (current.isValid()) {
+	line = current.line;
+	column = backward ? current.column : current.column + 1;
+    }
+
+    QString error;
+    const vtMatch match = ui->vterm->core()->find(pattern, flags, line, column, &error);
+    if (!error.isEmpty()) {
+	QMessageBox::warning(this, tr("Find in terminal"),
+			     tr("The regular expression is invalid: %1").arg(error));
+	return;
+    }
+    ui->vterm->set_highlight(match);
+    if (!match.isValid()) {
+	QApplication::beep();
+	return;
     }
+    ui->scrollArea->show_line(match.line, match.column);
 }
 
 /**
@@ -14,6 +14,12 @@ QT_BEGIN_NAMESPACE
 namespace Ui { class SerTerm; }
 QT_END_NAMESPACE
 
+class QAction;
+class QLineEdit;
+class QProgressBar;
+class SerialWorker;
+class FileSender;
+
 class SerTerm : public QWidget
 {
     Q_OBJECT
@@ -25,9 +31,10 @@ public:
 signals:
     void update_pinout(bool redo);
     void term_response(QByteArray response);
+    void painted();
 
 public slots:
-    void set_device(QIODevice* dev);
+    void set_worker(SerialWorker* worker);
     void term_set_size(int width, int height);
     void term_set_width(int width);
     void term_set_height(int height);
@@ -40,6 +47,7 @@ public slots:
     void set_font_family(const QString& family);
     void set_zoom(int percent);
     void reset();
+    void reset_prop();
 
 private slots:
     void term_clear();
@@ -50,6 +58,8 @@ private slots:
     void zoom_original();
     void zoom_in();
     void zoom_out();
+    void opengl_triggered(bool checked = false);
+    void renderer_error(const QString& message);
     void save_config();
     void load_config();
 
@@ -58,24 +68,54 @@ private slots:
     void monitor_triggered(bool checked = false);
     void taqoz_triggered(bool checked = false);
     void sendfile_triggered(bool checked = false);
+    void send_prompt_triggered(bool checked = false);
+    void send_xon_xoff_triggered(bool checked = false);
+    void sender_sent(const QByteArray& data);
+    void sender_error(const QString& message);
+    void sender_progress(qint64 value, qint64 total);
+    void sender_finished(bool ok);
+    void find_next_triggered(bool checked = false);
+    void find_previous_triggered(bool checked = false);
+    void find_regex_triggered(bool checked = false);
+    void find_case_triggered(bool checked = false);
+    void find_text_changed(const QString& text);
+    void find_return_pressed();
 
 protected:
     void keyPressEvent(QKeyEvent* event) override;
 
 private:
     Ui::SerTerm* ui;
-    QIODevice* m_dev;				//!< serial port (or tty)
+    SerialWorker* m_worker;			//!< serial worker owning the port (or tty)
     QString m_font_family;			//!< Terminal font family
     int m_zoom;					//!< Terminal zoom factor
+    int m_backlog_lines;			//!< Maximum number of lines in the backlog
+    int m_backlog_memory;			//!< Maximum KiB of compressed backlog lines in memory
+    bool m_opengl;				//!< Draw the terminal with the OpenGL renderer
     QString m_download_path;
     bool m_caps_lock;				//!< Keyboard CAPS lock flag
     bool m_num_lock;				//!< Keyboard NUM lock flag
     bool m_scroll_lock;				//!< Keyboard SCROLL lock flag
     bool m_local_echo;				//!< Local echo if true
+    FileSender* m_sender;			//!< file transfer in progress, or nullptr
+    QAction* m_act_sendfile;			//!< action to send a file, or cancel sending
+    QAction* m_act_send_prompt;			//!< action to toggle waiting for a prompt
+    QAction* m_act_send_xon_xoff;		//!< action to toggle pausing on XOFF
+    QAction* m_act_opengl;			//!< action to toggle the OpenGL renderer
+    QAction* m_act_send_progress;		//!< toolbar action holding m_send_progress
+    QProgressBar* m_send_progress;		//!< progress and throughput of the transfer
+    QString m_send_prompt;			//!< prompt to wait for after each line, or empty
+    int m_send_prompt_timeout;			//!< milliseconds to wait for the prompt
+    bool m_send_xon_xoff;			//!< pause sending on XOFF, resume on XON
+    QLineEdit* m_find_edit;			//!< text to find in the terminal
+    QAction* m_act_find_regex;			//!< action to toggle regular expressions
+    QAction* m_act_find_case;			//!< action to toggle matching the case
+    bool m_find_regex;				//!< find regular expressions
+    bool m_find_case;				//!< find with matching case
 
     QString load_file(const QString& title);
-    void reset_prop();
     void setup_signals();
     void setup_terminal();
+    void find(bool backward);
 
 };
@@ -34,7 +34,7 @@ vtAttr::vtAttr(quint32 code, quint32 mark)
  * @brief Return the Unicode value of the VT attribute
  * @return quint32 with Unicode value
  */
-QChar vtAttr::code() const
+uint vtAttr::code() const
 {
     return m_code;
 }
@@ -52,7 +52,7 @@ void vtAttr::set_code(uint code)
  * @brief Return the Unicode value of the mark (combining, enclosing, non-spacing, ...) VT attribute
  * @return quint32 with Unicode value
  */
-QChar vtAttr::mark() const
+uint vtAttr::mark() const
 {
     return m_mark;
 }
@@ -46,10 +46,10 @@ class vtAttr
 public:
     explicit vtAttr(quint32 code = 0x20, quint32 mark = 0x00);
 
-    QChar code() const;
+    uint code() const;
     void set_code(uint code);
 
-    QChar mark() const;
+    uint mark() const;
     void set_mark(uint mark);
 
     uint flag() const;
@@ -106,8 +106,8 @@ public:
     bool operator== (const vtAttr& other);
 
 private:
-    QChar m_code;		    //!< Unicode character code
-    QChar m_mark;		    //!< Unicode combining code
+    quint32 m_code;		    //!< Unicode character code (up to U+10FFFF)
+    quint32 m_mark;		    //!< Unicode combining code
     union {
 	uint w;
 	struct {
@@ -133,5 +133,5 @@ private:
 
 inline uint qHash(const vtAttr& attr, uint seed = 0)
 {
-    return qHash(attr.code(), seed) ^ qHash(attr.mark()) ^ qHash(attr.flag());
+    return qHash(attr.code(), seed) ^ qHash(attr.mark() << 11) ^ qHash(attr.flag());
 }
@@ -0,0 +1,599 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal tiered backlog
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QDir>
+#include <QVarLengthArray>
+#include "vtbacklog.h"
+#include "vttextindex.h"
+
+/**
+ * @brief Append @p value as variable length integer to @p out
+ * @param out reference to the QByteArray
+ * @param value value to append
+ */
+static void put_varint(QByteArray& out, quint32 value)
+{
+    while (value >= 0x80) {
+	out.append(static_cast<char>((value & 0x7f) | 0x80));
+	value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+/**
+ * @brief Return the variable length integer at @p src and advance it
+ * @param src reference to the source pointer
+ * @param end end of the source data
+ * @return decoded value
+ */
+static quint32 get_varint(const char*& src, const char* end)
+{
+    quint32 value = 0;
+    int shift = 0;
+    while (src < end) {
+	const uchar b = static_cast<uchar>(*src++);
+	value |= static_cast<quint32>(b & 0x7f) << shift;
+	if (0 == (b & 0x80))
+	    break;
+	shift += 7;
+    }
+    return value;
+}
+
+/**
+ * @brief vtBacklog constructor
+ * @param attrs pointer to the attribute table of the cells
+ * @param pack function to pack a vtAttr into a vtCell
+ * @param max maximum number of lines
+ */
+vtBacklog::vtBacklog(const vtAttrTable* attrs, Packer pack, int max)
+    : m_attrs(attrs)
+    , m_pack(pack)
+    , m_hot()
+    , m_blocks()
+    , m_file()
+    , m_file_blocks(0)
+    , m_skip(0)
+    , m_cold(0)
+    , m_max(max)
+    , m_memory(0)
+    , m_memory_max(16 * 1024 * 1024)
+    , m_base(0)
+    , m_cache()
+    , m_cache_tag(cache_lines, -1)
+{
+}
+
+vtBacklog::~vtBacklog()
+{
+    clear();
+}
+
+/**
+ * @brief Return the maximum number of lines
+ * @return maximum number of lines
+ */
+int vtBacklog::max() const
+{
+    return m_max;
+}
+
+/**
+ * @brief Set the maximum number of lines, dropping the oldest ones if required
+ * @param max maximum number of lines
+ */
+void vtBacklog::set_max(int max)
+{
+    m_max = qMax(0, max);
+    while (size() > m_max)
+	drop_first();
+}
+
+/**
+ * @brief Return the maximum number of bytes of compressed lines in memory
+ * @return number of bytes
+ */
+qint64 vtBacklog::memory_max() const
+{
+    return m_memory_max;
+}
+
+/**
+ * @brief Set the maximum number of bytes of compressed lines in memory
+ *
+ * Blocks exceeding the limit are spilled to temporary files.
+ * @param bytes number of bytes
+ */
+void vtBacklog::set_memory_max(qint64 bytes)
+{
+    m_memory_max = qMax(Q_INT64_C(0), bytes);
+    for (int i = 0; i < m_blocks.size() - 1 && m_memory > m_memory_max; i++)
+	spill(m_blocks[i]);
+}
+
+/**
+ * @brief Return the number of bytes of compressed lines in memory
+ * @return number of bytes
+ */
+qint64 vtBacklog::memory() const
+{
+    return m_memory;
+}
+
+/**
+ * @brief Return the number of columns per line
+ * @return number of columns
+ */
+int vtBacklog::width() const
+{
+    return m_hot.width();
+}
+
+/**
+ * @brief Set the number of columns per line
+ *
+ * Hot lines are clipped or padded when accessed. Compressed lines keep
+ * their width and are adjusted when decoded, so the decoded lines are
+ * only marked as stale.
+ * @param width number of columns
+ */
+void vtBacklog::set_width(int width)
+{
+    m_hot.set_width(width);
+    m_cache.set_width(width);
+    m_cache_tag.fill(-1);
+}
+
+/**
+ * @brief Return the number of lines in the backlog
+ * @return number of lines
+ */
+int vtBacklog::size() const
+{
+    return m_cold + m_hot.size();
+}
+
+/**
+ * @brief Return the number of lines in the backlog
+ * @return number of lines
+ */
+int vtBacklog::count() const
+{
+    return size();
+}
+
+/**
+ * @brief Return the number of compressed lines
+ *
+ * These are the oldest lines; rows from cold() on are kept as cells.
+ * @return number of lines
+ */
+int vtBacklog::cold() const
+{
+    return m_cold;
+}
+
+/**
+ * @brief Return true, if the backlog has no lines
+ * @return true if empty, or false otherwise
+ */
+bool vtBacklog::isEmpty() const
+{
+    return 0 == size();
+}
+
+/**
+ * @brief Remove all lines and the spill files
+ */
+void vtBacklog::clear()
+{
+    for (Block& block : m_blocks)
+	release(block);
+    m_blocks.clear();
+    m_file.reset();
+    m_file_blocks = 0;
+    m_skip = 0;
+    m_cold = 0;
+    m_memory = 0;
+    m_base = 0;
+    m_hot.clear();
+    m_cache_tag.fill(-1);
+}
+
+/**
+ * @brief Return a handle for the line at @p row
+ *
+ * Compressed lines are decoded into the cache; the handle is valid
+ * until the next access to the backlog.
+ * @param row row number (0 is the oldest line)
+ * @return const vtLine handle
+ */
+const vtLine vtBacklog::operator[](int row) const
+{
+    Q_ASSERT(row >= 0 && row < size());
+    if (row >= m_cold)
+	return m_hot[row - m_cold];
+
+    const qint64 seq = m_base + row;
+    const int idx = static_cast<int>(seq % cache_lines);
+    if (m_cache.size() < cache_lines) {
+	while (m_cache.size() < cache_lines)
+	    m_cache.append(vtCell());
+    }
+    vtLine line = m_cache[idx];
+    if (m_cache_tag[idx] != seq) {
+	const int n = m_skip + row;
+	const QByteArray data = line_data(m_blocks.at(n / block_lines), n % block_lines);
+	decode(line, data.constData(), data.constData() + data.size());
+	m_cache_tag[idx] = seq;
+    }
+    return line;
+}
+
+/**
+ * @brief Extract the text of the compressed lines in the block of @p row for searching
+ *
+ * The block's encoded data, in memory or in the mapped spill file, is
+ * read in one pass without decoding the lines into the cache. The text
+ * is written to @p chunk, which keeps its capacity, so a search can
+ * reuse it for each block.
+ * @param row compressed row number (0 is the oldest line)
+ * @param chunk reference to the vtTextIndex::Chunk receiving the lines of the block
+ * @return row number of the first line in @p chunk
+ */
+int vtBacklog::text_block(int row, vtTextIndex::Chunk& chunk) const
+{
+    Q_ASSERT(row >= 0 && row < m_cold);
+    const int n = m_skip + row;
+    const int bi = n / block_lines;
+    const Block& block = m_blocks.at(bi);
+    const int first = 0 == bi ? m_skip : 0;
+    const QByteArray data = block_data(block);
+    const char* base = data.constData();
+
+    // resizing to 0 keeps the capacity once it was reserved
+    chunk.text.resize(0);
+    chunk.text.reserve(qMax(chunk.text.capacity(), data.size()));
+    chunk.offsets.clear();
+    QVarLengthArray<uint, 256> codes;
+    for (int line = first; line < block.offsets.size(); line++) {
+	// the lines of a block which could not be read are left empty
+	const char* src = data.isEmpty() ? base : base + block.offsets[line];
+	const char* end = data.isEmpty() ? base : base + (line + 1 < block.offsets.size() ? block.offsets[line + 1] : block.size);
+	if (src < end)
+	    src++;	// line attributes
+	const int width = static_cast<int>(get_varint(src, end));
+	codes.clear();
+	while (codes.size() < width && src < end) {
+	    const quint32 tag = get_varint(src, end);
+	    const int count = static_cast<int>(tag >> 1);
+	    get_varint(src, end);	// flags
+	    get_varint(src, end);	// mark
+	    uint code = get_varint(src, end);
+	    for (int i = 0; i < count; i++) {
+		if (i > 0 && 0 == (tag & 1))
+		    code = get_varint(src, end);
+		codes.append(code);
+	    }
+	}
+	chunk.offsets.append(chunk.text.size());
+	vtTextIndex::append_text(chunk.text, codes.constData(), codes.size());
+	chunk.text += '\n';
+    }
+    return bi * block_lines + first - m_skip;
+}
+
+/**
+ * @brief Append a copy of @p line to the backlog
+ * @param line const reference to the vtLine
+ * @return true if the oldest line was dropped, or false otherwise
+ */
+bool vtBacklog::append(const vtLine& line)
+{
+    m_hot.append(line);
+    if (m_hot.size() > hot_lines)
+	freeze();
+    bool dropped = false;
+    while (size() > m_max) {
+	drop_first();
+	dropped = true;
+    }
+    return dropped;
+}
+
+/**
+ * @brief Remove the most recent line of the backlog
+ */
+void vtBacklog::removeLast()
+{
+    Q_ASSERT(size() > 0);
+    m_cache_tag[static_cast<int>((m_base + size() - 1) % cache_lines)] = -1;
+    if (!m_hot.isEmpty()) {
+	m_hot.removeLast();
+	return;
+    }
+    Block& block = m_blocks.last();
+    const quint32 offs = block.offsets.takeLast();
+    if (!block.file) {
+	m_memory -= block.data.size() - static_cast<int>(offs);
+	block.data.truncate(static_cast<int>(offs));
+    }
+    block.size = offs;
+    m_cold--;
+    if (block.offsets.isEmpty()) {
+	release(block);
+	m_blocks.removeLast();
+	if (m_blocks.isEmpty())
+	    m_skip = 0;
+    }
+}
+
+/**
+ * @brief Return the page of the most recent lines
+ *
+ * This is meant for operations on every cell (e.g. remapping the
+ * attribute indices).
+ * @return reference to the vtPage
+ */
+vtPage& vtBacklog::hot()
+{
+    return m_hot;
+}
+
+/**
+ * @brief Return the page of decoded lines
+ *
+ * This is meant for operations on every cell (e.g. remapping the
+ * attribute indices).
+ * @return reference to the vtPage
+ */
+vtPage& vtBacklog::cache()
+{
+    return m_cache;
+}
+
+/**
+ * @brief Compress the oldest hot line and append it to the last block
+ */
+void vtBacklog::freeze()
+{
+    if (m_blocks.isEmpty() || m_blocks.last().offsets.size() >= block_lines || m_blocks.last().file) {
+	m_blocks.append(Block());
+	// spill the oldest blocks in memory, but never the one being filled
+	for (int i = 0; i < m_blocks.size() - 1 && m_memory > m_memory_max; i++)
+	    spill(m_blocks[i]);
+    }
+    Block& block = m_blocks.last();
+    const int before = block.data.size();
+    block.offsets.append(static_cast<quint32>(before));
+    encode(block.data, m_hot[0]);
+    block.size = block.data.size();
+    m_memory += block.data.size() - before;
+    m_hot.removeFirst();
+    m_cold++;
+}
+
+/**
+ * @brief Drop the oldest line of the backlog
+ */
+void vtBacklog::drop_first()
+{
+    m_base++;
+    if (0 == m_cold) {
+	m_hot.removeFirst();
+	return;
+    }
+    m_cold--;
+    m_skip++;
+    if (m_skip >= m_blocks.first().offsets.size()) {
+	release(m_blocks.first());
+	m_blocks.removeFirst();
+	m_skip = 0;
+    }
+}
+
+/**
+ * @brief Release the memory and mapping of @p block
+ * @param block reference to the Block
+ */
+void vtBacklog::release(Block& block)
+{
+    if (block.file) {
+	if (block.map)
+	    block.file->unmap(block.map);
+	block.map = nullptr;
+	block.file.reset();
+    } else {
+	m_memory -= block.data.size();
+    }
+    block.data.clear();
+}
+
+/**
+ * @brief Write @p block to the current spill file and release its memory
+ *
+ * If no spill file can be created, the block stays in memory.
+ * @param block reference to the Block
+ */
+void vtBacklog::spill(Block& block)
+{
+    if (block.file || block.data.isEmpty())
+	return;
+    if (!m_file || m_file_blocks >= file_blocks) {
+	m_file.reset(new QTemporaryFile(QDir::temp().filePath(QLatin1String("vt220-backlog-XXXXXX"))));
+	m_file_blocks = 0;
+	if (!m_file->open()) {
+	    m_file.reset();
+	    return;
+	}
+    }
+    const qint64 pos = m_file->size();
+    if (!m_file->seek(pos) || m_file->write(block.data) != block.data.size())
+	return;
+    block.file = m_file;
+    block.pos = pos;
+    block.size = block.data.size();
+    m_memory -= block.data.size();
+    block.data.clear();
+    block.data.squeeze();
+    m_file_blocks++;
+}
+
+/**
+ * @brief Return the encoded data of @p line in @p block
+ *
+ * Spilled blocks are memory-mapped on the first access.
+ * @param block const reference to the Block
+ * @param line line number in the block
+ * @return QByteArray with the encoded line (not a deep copy, if possible)
+ */
+QByteArray vtBacklog::line_data(const Block& block, int line) const
+{
+    const qint64 offs = block.offsets[line];
+    const qint64 next = line + 1 < block.offsets.size() ? block.offsets[line + 1] : block.size;
+    const int len = static_cast<int>(next - offs);
+    if (!block.file)
+	return QByteArray::fromRawData(block.data.constData() + offs, len);
+    if (!block.map)
+	block.map = block.file->map(block.pos, block.size);
+    if (block.map)
+	return QByteArray::fromRawData(reinterpret_cast<const char*>(block.map) + offs, len);
+    // the mapping failed: read the line from the file
+    if (!block.file->seek(block.pos + offs))
+	return QByteArray();
+    return block.file->read(len);
+}
+
+/**
+ * @brief Return the encoded data of all lines in @p block
+ * @param block const reference to the Block
+ * @return QByteArray with the data (not a deep copy if in memory or mapped)
+ */
+QByteArray vtBacklog::block_data(const Block& block) const
+{
+    if (!block.file)
+	return QByteArray::fromRawData(block.data.constData(), static_cast<int>(block.size));
+    if (!block.map)
+	block.map = block.file->map(block.pos, block.size);
+    if (block.map)
+	return QByteArray::fromRawData(reinterpret_cast<const char*>(block.map), static_cast<int>(block.size));
+    // the mapping failed: read the block from the file
+    if (!block.file->seek(block.pos))
+	return QByteArray();
+    return block.file->read(block.size);
+}
+
+/**
+ * @brief Append the compressed @p line to @p out
+ *
+ * A line is encoded as a byte with its line attributes, the number of
+ * cells, and runs of cells with the same attributes. Each run is a count,
+ * the flags and the mark of its attributes, followed by either one code
+ * (if all cells of the run have the same code) or one code per cell.
+ * All numbers are variable length integers.
+ * @param out reference to the QByteArray to append to
+ * @param line const reference to the vtLine
+ */
+void vtBacklog::encode(QByteArray& out, const vtLine& line) const
+{
+    const vtLineAttr& la = line.attr();
+    out.append(static_cast<char>((la.decdwl - 1) | ((la.decdhl - 1) << 1) | (la.bottom << 2)));
+    const int width = line.size();
+    put_varint(out, static_cast<quint32>(width));
+    // number of cells with the same code as the one at x, up to end
+    auto repeat = [&line](int x, int end) {
+	int i = x + 1;
+	while (i < end && line[i].code() == line[x].code())
+	    i++;
+	return i - x;
+    };
+    int x = 0;
+    while (x < width) {
+	// find the run of cells with the same attributes
+	const uint attr = line[x].attr();
+	int end = x + 1;
+	while (end < width && line[end].attr() == attr)
+	    end++;
+	const vtAttr a = m_attrs->attr(line[x]);
+	while (x < end) {
+	    // split into repeated codes and literals
+	    int n = repeat(x, end);
+	    if (n < 4) {
+		int i = x + n;
+		while (i < end) {
+		    const int r = repeat(i, end);
+		    if (r >= 4)
+			break;
+		    i += r;
+		}
+		n = i - x;
+	    }
+	    const bool same = 1 == n || repeat(x, x + n) == n;
+	    put_varint(out, (static_cast<quint32>(n) << 1) | (same ? 1u : 0u));
+	    put_varint(out, a.flag());
+	    put_varint(out, a.mark());
+	    if (same) {
+		put_varint(out, line[x].code());
+	    } else {
+		for (int i = x; i < x + n; i++)
+		    put_varint(out, line[i].code());
+	    }
+	    x += n;
+	}
+    }
+}
+
+/**
+ * @brief Decode the compressed line from @p src to @p end into @p dst
+ *
+ * Lines are truncated, or extended with blanks with the attributes of their
+ * first cell, to the width of @p dst.
+ * @param dst reference to the destination vtLine
+ * @param src pointer to the encoded data
+ * @param end pointer to the end of the encoded data
+ */
+void vtBacklog::decode(vtLine& dst, const char* src, const char* end) const
+{
+    vtLineAttr la;
+    if (src < end) {
+	const uchar b = static_cast<uchar>(*src++);
+	la.decdwl = static_cast<quint8>(1 + (b & 1));
+	la.decdhl = static_cast<quint8>(1 + ((b >> 1) & 1));
+	la.bottom = (b >> 2) & 1;
+    }
+    const int width = static_cast<int>(get_varint(src, end));
+    int x = 0;
+    int blinking = 0;
+    while (x < width && src < end) {
+	const quint32 tag = get_varint(src, end);
+	const int n = static_cast<int>(tag >> 1);
+	vtAttr attr;
+	attr.set_flag(get_varint(src, end));
+	attr.set_mark(get_varint(src, end));
+	attr.set_code(get_varint(src, end));
+	const uint idx = m_pack(attr).attr();
+	if (attr.blink())
+	    blinking += qMax(0, qMin(n, dst.size() - x));
+	for (int i = 0; i < n; i++) {
+	    if (i > 0 && 0 == (tag & 1))
+		attr.set_code(get_varint(src, end));
+	    if (x < dst.size())
+		dst[x] = vtCell(attr.code(), idx);
+	    x++;
+	}
+    }
+    if (x < dst.size()) {
+	const vtCell blank(0x20, x > 0 ? dst[0].attr() : 0);
+	if (m_attrs->blink(blank))
+	    blinking += dst.size() - x;
+	for (; x < dst.size(); x++)
+	    dst[x] = blank;
+    }
+    la.blinking = static_cast<quint16>(qMin(blinking, 0xffff));
+    dst.set_attr(la);
+}
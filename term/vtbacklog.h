@@ -0,0 +1,110 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal tiered backlog
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <functional>
+#include <QByteArray>
+#include <QList>
+#include <QSharedPointer>
+#include <QTemporaryFile>
+#include <QVector>
+#include "vtpage.h"
+#include "vttextindex.h"
+
+/**
+ * @brief The vtBacklog class stores the lines which scrolled out of view.
+ *
+ * The backlog is kept in three tiers:
+ *<ul>
+ * <li>the most recent @ref hot_lines lines as vtCell in a vtPage</li>
+ * <li>older lines run-length compressed into blocks of @ref block_lines in memory</li>
+ * <li>when the compressed blocks exceed the memory limit, the oldest blocks
+ *     are spilled to temporary files and memory-mapped when accessed</li>
+ *</ul>
+ * Compressed lines are decoded lazily, when they are accessed, into a small
+ * direct-mapped cache of lines. Compressed lines store the attributes by
+ * value, so they do not depend on the indices of the vtAttrTable.
+ */
+class vtBacklog
+{
+public:
+    //! Function used to pack a vtAttr into a vtCell when decoding lines
+    typedef std::function<vtCell(const vtAttr&)> Packer;
+
+    //! Number of most recent lines kept as cells
+    static constexpr int hot_lines = 1024;
+    //! Number of lines per compressed block
+    static constexpr int block_lines = 256;
+    //! Number of blocks per spill file
+    static constexpr int file_blocks = 64;
+    //! Number of decoded lines cached
+    static constexpr int cache_lines = 256;
+
+    vtBacklog(const vtAttrTable* attrs, Packer pack, int max = 10000);
+    ~vtBacklog();
+
+    int max() const;
+    void set_max(int max);
+
+    qint64 memory_max() const;
+    void set_memory_max(qint64 bytes);
+    qint64 memory() const;
+
+    int width() const;
+    void set_width(int width);
+
+    int size() const;
+    int count() const;
+    int cold() const;
+    bool isEmpty() const;
+    void clear();
+
+    const vtLine operator[](int row) const;
+    int text_block(int row, vtTextIndex::Chunk& chunk) const;
+
+    bool append(const vtLine& line);
+    void removeLast();
+
+    vtPage& hot();
+    vtPage& cache();
+
+private:
+    /** @brief Block of compressed lines */
+    struct Block {
+	QByteArray data;			//!< encoded lines, while in memory
+	QVector<quint32> offsets;		//!< offset of each line in the encoded data
+	QSharedPointer<QTemporaryFile> file;	//!< spill file, if spilled
+	qint64 pos = 0;				//!< position of the data in the file
+	qint64 size = 0;			//!< size of the encoded data
+	mutable uchar* map = nullptr;		//!< memory-mapped data, if spilled and accessed
+    };
+
+    void freeze();
+    void drop_first();
+    void release(Block& block);
+    void spill(Block& block);
+    QByteArray line_data(const Block& block, int line) const;
+    QByteArray block_data(const Block& block) const;
+    void encode(QByteArray& out, const vtLine& line) const;
+    void decode(vtLine& dst, const char* src, const char* end) const;
+
+    const vtAttrTable* m_attrs;		//!< attribute table of the cells
+    Packer m_pack;			//!< function to pack decoded attributes
+    vtPage m_hot;			//!< most recent lines
+    QList<Block> m_blocks;		//!< compressed lines, oldest first
+    QSharedPointer<QTemporaryFile> m_file;	//!< current spill file
+    int m_file_blocks;			//!< number of blocks in the current spill file
+    int m_skip;				//!< number of dropped lines in the first block
+    int m_cold;				//!< number of compressed lines
+    int m_max;				//!< maximum number of lines
+    qint64 m_memory;			//!< bytes of compressed lines in memory
+    qint64 m_memory_max;		//!< maximum bytes of compressed lines in memory
+    qint64 m_base;			//!< sequence number of row 0
+    mutable vtPage m_cache;		//!< decoded lines
+    mutable QVector<qint64> m_cache_tag;//!< sequence number per cached line, or -1
+};
@@ -0,0 +1,118 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal packed character cell
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include "vtcell.h"
+
+vtAttrTable::vtAttrTable()
+    : m_index()
+    , m_attrs()
+    , m_last_key(0)
+    , m_last_idx(-1)
+{
+    clear();
+}
+
+/**
+ * @brief Remove all attributes but the default one at index 0
+ */
+void vtAttrTable::clear()
+{
+    m_index.clear();
+    m_attrs.clear();
+    m_last_idx = -1;
+    intern(vtAttr());
+}
+
+/**
+ * @brief Return the number of attributes in the table
+ * @return number of attributes
+ */
+int vtAttrTable::size() const
+{
+    return m_attrs.size();
+}
+
+/**
+ * @brief Return the index of @p attr, adding it to the table if required
+ * @param attr const reference to the vtAttr
+ * @return index of the attribute, or -1 if the table is full
+ */
+int vtAttrTable::intern(const vtAttr& attr)
+{
+    const quint64 k = key(attr);
+    if (m_last_idx >= 0 && k == m_last_key)
+	return m_last_idx;
+    auto it = m_index.constFind(k);
+    if (it != m_index.constEnd()) {
+	m_last_key = k;
+	m_last_idx = it.value();
+	return m_last_idx;
+    }
+    if (m_attrs.size() >= max_attrs)
+	return -1;
+    vtAttr entry(attr);
+    entry.set_code(0x20);
+    m_last_key = k;
+    m_last_idx = m_attrs.size();
+    m_index.insert(k, static_cast<quint16>(m_last_idx));
+    m_attrs.append(entry);
+    return m_last_idx;
+}
+
+/**
+ * @brief Return the vtAttr for @p cell
+ * @param cell const reference to the vtCell
+ * @return vtAttr with the code of the cell and its interned attributes
+ */
+vtAttr vtAttrTable::attr(const vtCell& cell) const
+{
+    vtAttr attr(m_attrs.value(static_cast<int>(cell.attr())));
+    attr.set_code(cell.code());
+    return attr;
+}
+
+/**
+ * @brief Return true, if the attributes of @p cell have the blink flag set
+ * @param cell const reference to the vtCell
+ * @return true if the cell blinks, or false otherwise
+ */
+bool vtAttrTable::blink(const vtCell& cell) const
+{
+    const int idx = static_cast<int>(cell.attr());
+    return idx < m_attrs.size() && m_attrs[idx].blink();
+}
+
+/**
+ * @brief Remove the attributes not flagged in @p used from the table
+ * @param used vector of flags per index; true if the index is still in use
+ * @return mapping from the old to the new indices
+ */
+QVector<quint16> vtAttrTable::compact(const QVector<bool>& used)
+{
+    QVector<vtAttr> attrs;
+    attrs.swap(m_attrs);
+    QVector<quint16> remap(max_attrs, 0);
+    m_index.clear();
+    m_last_idx = -1;
+    for (int i = 0; i < attrs.size(); i++) {
+	if (i > 0 && !used.value(i))
+	    continue;
+	remap[i] = static_cast<quint16>(intern(attrs[i]));
+    }
+    return remap;
+}
+
+/**
+ * @brief Return the lookup key for the mark and flags of @p attr
+ * @param attr const reference to the vtAttr
+ * @return 64 bit key
+ */
+quint64 vtAttrTable::key(const vtAttr& attr)
+{
+    return (static_cast<quint64>(attr.mark()) << 32) | attr.flag();
+}
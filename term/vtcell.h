@@ -0,0 +1,73 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal packed character cell
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QHash>
+#include <QVector>
+#include "vtattr.h"
+
+/**
+ * @brief The vtCell class is the packed storage format of a character cell.
+ *
+ * A cell is 32 bits: the Unicode code (up to U+10FFFF) in the lower 21 bits,
+ * and the index of the cell's attributes, including the mark, in the
+ * vtAttrTable in the upper 11 bits.
+ */
+class vtCell
+{
+public:
+    //! Number of bits for the Unicode code
+    static constexpr int code_bits = 21;
+    //! Number of bits for the attribute index
+    static constexpr int attr_bits = 32 - code_bits;
+    //! Mask for the Unicode code
+    static constexpr quint32 code_mask = (1u << code_bits) - 1;
+
+    vtCell(uint code = 0x20, uint attr = 0)
+	: m_cell((code & code_mask) | (attr << code_bits))
+    {}
+
+    uint code() const { return m_cell & code_mask; }
+    uint attr() const { return m_cell >> code_bits; }
+    void set_attr(uint attr) { m_cell = (m_cell & code_mask) | (attr << code_bits); }
+    bool operator== (const vtCell& other) const { return m_cell == other.m_cell; }
+
+private:
+    quint32 m_cell;
+};
+Q_DECLARE_TYPEINFO(vtCell, Q_PRIMITIVE_TYPE);
+
+/**
+ * @brief The vtAttrTable class interns the attributes of cells.
+ *
+ * All of a vtAttr except for its code, i.e. the mark and the flags,
+ * is stored once in the table and referenced by index from the vtCell.
+ * Index 0 is always the default attribute.
+ */
+class vtAttrTable
+{
+public:
+    //! Maximum number of attributes in the table
+    static constexpr int max_attrs = 1 << vtCell::attr_bits;
+
+    vtAttrTable();
+    void clear();
+    int size() const;
+    int intern(const vtAttr& attr);
+    vtAttr attr(const vtCell& cell) const;
+    bool blink(const vtCell& cell) const;
+    QVector<quint16> compact(const QVector<bool>& used);
+
+private:
+    static quint64 key(const vtAttr& attr);
+
+    QHash<quint64,quint16> m_index;	//!< index per attribute key
+    QVector<vtAttr> m_attrs;		//!< attributes per index
+    quint64 m_last_key;			//!< key of the most recently interned attribute
+    int m_last_idx;			//!< index of the most recently interned attribute
+};
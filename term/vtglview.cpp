@@ -0,0 +1,490 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal OpenGL renderer
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <QVector2D>
+#include <cstddef>
+#include "vtglview.h"
+#include "vt220.h"
+#include "trace.h"
+
+//! Name the function for messages, and record it as a scope while Trace::enabled()
+#define FUN(_name_) static const char* _func = _name_; Q_UNUSED(_func); TRACE_SCOPE("vtGLView::" _name_)
+
+namespace {
+
+//! Vertex shader; the #version line is prepended for the context
+const char vertex_shader[] =
+    "in vec2 a_corner;\n"
+    "in vec4 a_rect;\n"
+    "in vec4 a_src;\n"
+    "in vec4 a_fg;\n"
+    "in vec4 a_bg;\n"
+    "in float a_mode;\n"
+    "uniform vec2 u_view;\n"
+    "uniform vec2 u_atlas;\n"
+    "out vec2 v_tex;\n"
+    "out vec4 v_clamp;\n"
+    "out vec2 v_local;\n"
+    "out vec2 v_size;\n"
+    "out vec4 v_fg;\n"
+    "out vec4 v_bg;\n"
+    "flat out int v_mode;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 pos = a_rect.xy + a_corner * a_rect.zw;\n"
+    "    gl_Position = vec4(2.0 * pos.x / u_view.x - 1.0, 1.0 - 2.0 * pos.y / u_view.y, 0.0, 1.0);\n"
+    "    v_tex = (a_src.xy + a_corner * a_src.zw) / u_atlas;\n"
+    "    v_clamp = vec4(a_src.xy + 0.5, a_src.xy + a_src.zw - 0.5) / u_atlas.xyxy;\n"
+    "    v_local = a_corner * a_rect.zw;\n"
+    "    v_size = a_rect.zw;\n"
+    "    v_fg = a_fg;\n"
+    "    v_bg = a_bg;\n"
+    "    v_mode = int(a_mode);\n"
+    "}\n";
+
+//! Fragment shader; the #version line is prepended for the context
+const char fragment_shader[] =
+    "uniform sampler2D u_coverage;\n"
+    "in vec2 v_tex;\n"
+    "in vec4 v_clamp;\n"
+    "in vec2 v_local;\n"
+    "in vec2 v_size;\n"
+    "in vec4 v_fg;\n"
+    "in vec4 v_bg;\n"
+    "flat in int v_mode;\n"
+    "out vec4 o_color;\n"
+    "void main()\n"
+    "{\n"
+    "    float a = 1.0;\n"
+    "    if (v_mode == 1) {\n"
+    "        a = texture(u_coverage, clamp(v_tex, v_clamp.xy, v_clamp.zw)).r;\n"
+    "    } else if (v_mode == 2) {\n"
+    "        float len = length(v_size);\n"
+    "        float d1 = abs(v_size.y * v_local.x - v_size.x * v_local.y) / len;\n"
+    "        float d2 = abs(v_size.y * v_local.x + v_size.x * v_local.y - v_size.x * v_size.y) / len;\n"
+    "        a = clamp(1.0 - min(d1, d2), 0.0, 1.0);\n"
+    "    }\n"
+    "    o_color = v_fg * a + v_bg * (1.0 - a);\n"
+    "}\n";
+
+//! Corners of the unit quad as a triangle strip
+const GLfloat quad_corners[] = {
+    0.0f, 0.0f,
+    1.0f, 0.0f,
+    0.0f, 1.0f,
+    1.0f, 1.0f
+};
+
+}
+
+/**
+ * @brief Construct a renderer covering the vt220 @p view
+ * @param view pointer to the vt220 to render
+ */
+vtGLView::vtGLView(vt220* view)
+    : QOpenGLWidget(view)
+    , m_view(view)
+    , m_program(nullptr)
+    , m_vao()
+    , m_corners(QOpenGLBuffer::VertexBuffer)
+    , m_instances(QOpenGLBuffer::VertexBuffer)
+    , m_atlas(0)
+    , m_atlas_size()
+    , m_atlas_slots(0)
+    , m_rows()
+    , m_frame()
+    , m_columns(-1)
+    , m_top(-1)
+    , m_font_h(-1)
+    , m_ok(false)
+{
+    // ask for the version initializeGL() needs; some platforms (macOS,
+    // Mesa) otherwise create a legacy 2.1 context
+    QSurfaceFormat fmt = format();
+    if (QOpenGLContext::LibGLES == QOpenGLContext::openGLModuleType()) {
+	fmt.setRenderableType(QSurfaceFormat::OpenGLES);
+	fmt.setVersion(3, 0);
+    } else {
+	fmt.setRenderableType(QSurfaceFormat::OpenGL);
+	fmt.setVersion(3, 3);
+	fmt.setProfile(QSurfaceFormat::CoreProfile);
+    }
+    setFormat(fmt);
+
+    // input and focus stay with the vt220
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+}
+
+vtGLView::~vtGLView()
+{
+    if (!m_ok)
+	return;
+    makeCurrent();
+    if (m_atlas)
+	glDeleteTextures(1, &m_atlas);
+    m_instances.destroy();
+    m_corners.destroy();
+    m_vao.destroy();
+    delete m_program;
+    doneCurrent();
+}
+
+/**
+ * @brief Rebuild all rows for the next frame
+ */
+void vtGLView::invalidate()
+{
+    for (Row& row : m_rows)
+	row.dirty = true;
+    update();
+}
+
+/**
+ * @brief Rebuild the rows touched by @p region for the next frame
+ * @param region damaged region in widget coordinates
+ */
+void vtGLView::invalidate(const QRegion& region)
+{
+    const int fh = qMax(1, m_font_h);
+    for (const QRect& rect : region) {
+	const int y0 = qMax(0, rect.top() / fh);
+	const int y1 = qMin(m_rows.size() - 1, rect.bottom() / fh);
+	for (int y = y0; y <= y1; y++)
+	    m_rows[y].dirty = true;
+    }
+    update();
+}
+
+/**
+ * @brief Upload the glyph atlas again, after the vt220 replaced it
+ */
+void vtGLView::reset_atlas()
+{
+    m_atlas_slots = 0;
+    m_atlas_size = QSize();
+    invalidate();
+}
+
+/**
+ * @brief Rebuild the rows with blinking cells for the next frame
+ *
+ * The cursor cell is damaged by the core when it blinks.
+ */
+void vtGLView::blink()
+{
+    bool any = false;
+    for (int y = 0; y < m_rows.size(); y++) {
+	Row& r = m_rows[y];
+	if (r.blinking) {
+	    r.dirty = true;
+	    any = true;
+	}
+    }
+    if (any)
+	update();
+}
+
+void vtGLView::initializeGL()
+{
+    FUN("initializeGL");
+    initializeOpenGLFunctions();
+    QOpenGLContext* ctx = context();
+    const QSurfaceFormat fmt = ctx->format();
+    const bool es = ctx->isOpenGLES();
+    const QPair<int,int> version = fmt.version();
+    if (version < qMakePair(3, es ? 0 : 3)) {
+	emit Failed(tr("The OpenGL renderer requires OpenGL 3.3 or OpenGL ES 3.0, but the context has version %1.%2.")
+		    .arg(version.first)
+		    .arg(version.second));
+	return;
+    }
+
+    const QByteArray prefix = es
+	? QByteArray("#version 300 es\nprecision highp float;\n")
+	: QByteArray("#version 330 core\n");
+    m_program = new QOpenGLShaderProgram();
+    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, prefix + vertex_shader) ||
+	!m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, prefix + fragment_shader) ||
+	!m_program->link()) {
+	emit Failed(tr("Building the OpenGL renderer's shaders failed: %1")
+		    .arg(m_program->log()));
+	delete m_program;
+	m_program = nullptr;
+	return;
+    }
+
+    m_vao.create();
+    QOpenGLVertexArrayObject::Binder binder(&m_vao);
+    m_program->bind();
+
+    m_corners.create();
+    m_corners.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_corners.bind();
+    m_corners.allocate(quad_corners, sizeof(quad_corners));
+    const int corner = m_program->attributeLocation("a_corner");
+    m_program->enableAttributeArray(corner);
+    m_program->setAttributeBuffer(corner, GL_FLOAT, 0, 2);
+    m_corners.release();
+
+    m_instances.create();
+    m_instances.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    m_instances.bind();
+    const struct {
+	const char* name;
+	GLenum type;
+	int offset;
+	int size;
+	GLboolean normalize;
+    } attributes[] = {
+	{"a_rect", GL_FLOAT, offsetof(Instance, rect), 4, GL_FALSE},
+	{"a_src", GL_FLOAT, offsetof(Instance, src), 4, GL_FALSE},
+	{"a_fg", GL_UNSIGNED_BYTE, offsetof(Instance, fg), 4, GL_TRUE},
+	{"a_bg", GL_UNSIGNED_BYTE, offsetof(Instance, bg), 4, GL_TRUE},
+	{"a_mode", GL_FLOAT, offsetof(Instance, mode), 1, GL_FALSE}
+    };
+    for (const auto& attr : attributes) {
+	const GLuint loc = static_cast<GLuint>(m_program->attributeLocation(attr.name));
+	glEnableVertexAttribArray(loc);
+	glVertexAttribPointer(loc, attr.size, attr.type, attr.normalize, sizeof(Instance),
+			      reinterpret_cast<const void*>(static_cast<quintptr>(attr.offset)));
+	glVertexAttribDivisor(loc, 1);
+    }
+    m_instances.release();
+    m_program->release();
+
+    glGenTextures(1, &m_atlas);
+    glBindTexture(GL_TEXTURE_2D, m_atlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_atlas_size = QSize();
+    m_atlas_slots = 0;
+    m_ok = true;
+}
+
+void vtGLView::paintGL()
+{
+    FUN("paintGL");
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (!m_ok)
+	return;
+
+    const vtCore& core = *m_view->m_core;
+    const int top = m_view->top_line();
+    if (m_rows.size() != core.rows() || m_columns != core.columns() ||
+	m_top != top || m_font_h != m_view->m_font_h) {
+	m_rows.resize(core.rows());
+	m_columns = core.columns();
+	m_top = top;
+	m_font_h = m_view->m_font_h;
+	for (Row& row : m_rows)
+	    row.dirty = true;
+    }
+
+    int count = 0;
+    for (int y = 0; y < m_rows.size(); y++) {
+	if (m_rows[y].dirty)
+	    build_row(y);
+	count += m_rows[y].cells.size() + m_rows[y].overlays.size();
+    }
+
+    // cells first, so that the overlays of double height rows are not covered
+    m_frame.resize(0);
+    m_frame.reserve(count);
+    for (const Row& row : m_rows)
+	m_frame += row.cells;
+    for (const Row& row : m_rows)
+	m_frame += row.overlays;
+
+    // building the rows may have added glyphs
+    upload_atlas();
+
+    if (!m_frame.isEmpty()) {
+	QOpenGLVertexArrayObject::Binder binder(&m_vao);
+	m_program->bind();
+	m_program->setUniformValue("u_view", QVector2D(width(), height()));
+	m_program->setUniformValue("u_atlas", QVector2D(qMax(1, m_atlas_size.width()),
+							qMax(1, m_atlas_size.height())));
+	m_program->setUniformValue("u_coverage", 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, m_atlas);
+	m_instances.bind();
+	m_instances.allocate(m_frame.constData(), m_frame.size() * static_cast<int>(sizeof(Instance)));
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, m_frame.size());
+	glDisable(GL_BLEND);
+	m_instances.release();
+	glBindTexture(GL_TEXTURE_2D, 0);
+	m_program->release();
+    }
+    emit Painted();
+}
+
+/**
+ * @brief Rebuild the instances of widget row @p row from the core
+ *
+ * This follows vt220::paintEvent() for the whole row.
+ * @param row widget row
+ */
+void vtGLView::build_row(int row)
+{
+    FUN("build_row");
+    const vt220& view = *m_view;
+    const vtCore& core = *view.m_core;
+    const vtBacklog& backlog = core.backlog();
+    const vtPage& screen = core.screen();
+    const vtAttrTable& attrs = core.attrs();
+    const vtCore::Cursor& cursor = core.cursor();
+    const vtGlyphs& glyphs = view.m_glyphs;
+    const int fw = view.m_font_w;
+    const int fh = view.m_font_h;
+    const int bh = backlog.size();
+    const int y = m_top + row;		// virtual line
+    const int sy = row * fh;
+    Row& r = m_rows[row];
+    r.cells.resize(0);
+    r.overlays.resize(0);
+    r.dirty = false;
+    r.blinking = false;
+
+    if ((y - bh) >= core.rows())
+	return;
+
+    // line attributes
+    const vtLine pl = y < bh ? backlog[y] : screen[y - bh];
+
+    // skip bottom half of double height lines
+    if (pl.bottom())
+	return;
+
+    const int fwl = pl.decdwl() * fw;
+    const int fhl = pl.decdhl() * fh;
+    const int columns = qMin(core.columns(), (core.columns() * fw + fwl - 1) / fwl);
+    r.cells.reserve(columns);
+    const vtMatch& hl = view.m_highlight;
+    if (y == hl.line)
+	r.overlays += instance(QRect(hl.column * fwl, sy, hl.length * fwl, fhl),
+			       Mode_Solid, vt220::highlight_color, 0);
+
+    r.blinking = pl.blinking() > 0;
+    for (int x = 0; x < columns; x++) {
+	const vtAttr pa = attrs.attr(pl[x]);
+	const vt220::CellColors cc = view.cell_colors(pa);
+
+	const QRect cellrc(x * fwl, sy, fwl, fhl);
+	const QRgb bgcolor = core.color(cc.bg);
+	if (cc.fg != cc.bg && (pa.code() != 0x20 || pa.mark())) {
+	    Instance inst = instance(cellrc, Mode_Glyph, core.color(cc.fg), bgcolor);
+	    const QRect src = glyphs.source(glyphs.glyph(pa));
+	    inst.src[0] = src.x();
+	    inst.src[1] = src.y();
+	    inst.src[2] = src.width();
+	    inst.src[3] = src.height();
+	    r.cells += inst;
+	} else {
+	    r.cells += instance(cellrc, Mode_Solid, bgcolor, bgcolor);
+	}
+
+	if (cc.fg != cc.bg) {
+	    const QRgb ucolor = core.color(cc.uc);
+	    const int ty = cellrc.bottom() - view.m_font_d + 1;
+	    if (pa.underline())
+		r.overlays += instance(QRect(cellrc.left(), ty, cellrc.width(), 1), Mode_Solid, ucolor, 0);
+	    if (pa.underldbl()) {
+		r.overlays += instance(QRect(cellrc.left(), ty, cellrc.width(), 1), Mode_Solid, ucolor, 0);
+		r.overlays += instance(QRect(cellrc.left(), cellrc.bottom() - 1, cellrc.width(), 1), Mode_Solid, ucolor, 0);
+	    }
+	    if (pa.crossed())
+		r.overlays += instance(cellrc.adjusted(0, 2, 0, -2), Mode_Cross, ucolor, 0);
+	}
+
+	if (cursor.on && (y - bh) == cursor.y && x == cursor.newx) {
+	    vtAttr cur(pa);
+	    cur.set_code(0x2588);   // FULL BLOCK
+	    cur.set_mark(0);
+	    const QRgb color = qRgb(255 - qRed(bgcolor), 255 - qGreen(bgcolor), 255 - qBlue(bgcolor));
+	    Instance inst = instance(cellrc, Mode_Glyph, color, 0);
+	    const QRect src = glyphs.source(glyphs.glyph(cur));
+	    inst.src[0] = src.x();
+	    inst.src[1] = src.y();
+	    inst.src[2] = src.width();
+	    inst.src[3] = src.height();
+	    r.overlays += inst;
+	}
+    }
+}
+
+/**
+ * @brief Upload the slots added to the glyph atlas since the last frame
+ *
+ * The whole coverage is uploaded when its size changed, otherwise only
+ * the atlas rows of the new slots.
+ */
+void vtGLView::upload_atlas()
+{
+    const vtGlyphs& glyphs = m_view->m_glyphs;
+    const QImage& coverage = glyphs.coverage();
+    const int slots = glyphs.slots();
+    if (coverage.isNull() || slots == m_atlas_slots)
+	return;
+
+    glBindTexture(GL_TEXTURE_2D, m_atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, coverage.bytesPerLine());
+    if (coverage.size() != m_atlas_size || slots < m_atlas_slots) {
+	m_atlas_size = coverage.size();
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, coverage.width(), coverage.height(), 0,
+		     GL_RED, GL_UNSIGNED_BYTE, coverage.constBits());
+    } else {
+	const int y0 = glyphs.source(m_atlas_slots).top();
+	const int y1 = glyphs.source(slots - 1).bottom();
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y0, coverage.width(), y1 + 1 - y0,
+			GL_RED, GL_UNSIGNED_BYTE, coverage.constScanLine(y0));
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_atlas_slots = slots;
+}
+
+/**
+ * @brief Return an instance covering @p rect
+ * @param rect rectangle in widget coordinates
+ * @param mode Mode of the instance
+ * @param fg foreground as 0xAARRGGBB
+ * @param bg background as 0xAARRGGBB, or 0 for a transparent overlay
+ * @return Instance without an atlas source
+ */
+vtGLView::Instance vtGLView::instance(const QRect& rect, Mode mode, quint32 fg, quint32 bg)
+{
+    const QRgb pfg = qPremultiply(fg);
+    const QRgb pbg = qPremultiply(bg);
+    Instance inst;
+    inst.rect[0] = rect.x();
+    inst.rect[1] = rect.y();
+    inst.rect[2] = rect.width();
+    inst.rect[3] = rect.height();
+    inst.src[0] = inst.src[1] = inst.src[2] = inst.src[3] = 0.0f;
+    inst.fg[0] = static_cast<GLubyte>(qRed(pfg));
+    inst.fg[1] = static_cast<GLubyte>(qGreen(pfg));
+    inst.fg[2] = static_cast<GLubyte>(qBlue(pfg));
+    inst.fg[3] = static_cast<GLubyte>(qAlpha(pfg));
+    inst.bg[0] = static_cast<GLubyte>(qRed(pbg));
+    inst.bg[1] = static_cast<GLubyte>(qGreen(pbg));
+    inst.bg[2] = static_cast<GLubyte>(qBlue(pbg));
+    inst.bg[3] = static_cast<GLubyte>(qAlpha(pbg));
+    inst.mode = static_cast<GLfloat>(mode);
+    return inst;
+}
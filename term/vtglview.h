@@ -0,0 +1,101 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal OpenGL renderer
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLWidget>
+#include <QRegion>
+#include <QVector>
+
+class vt220;
+
+/**
+ * @brief The vtGLView class renders a vt220 with OpenGL
+ *
+ * The view is a child covering its vt220 and draws the same vtCore state,
+ * glyph atlas, and virtual top line. The atlas coverage is uploaded to a
+ * texture when it grows, and every cell, decoration line, and the cursor
+ * is one instance of a single quad, drawn with one instanced draw call.
+ * The foreground is applied in the fragment shader, so neither the number
+ * of colors nor the zoom factor changes the cost of a frame.
+ *
+ * The instances are kept per widget row; only rows marked with invalidate()
+ * are rebuilt from the core, and blink() rebuilds the rows which contain
+ * blinking cells. A frame thus costs little more than one
+ * buffer upload, even for a full 132 column redraw.
+ *
+ * The renderer requires OpenGL 3.3 or OpenGL ES 3.0; otherwise Failed()
+ * is emitted from initializeGL().
+ */
+class vtGLView : public QOpenGLWidget, protected QOpenGLExtraFunctions
+{
+    Q_OBJECT
+public:
+    explicit vtGLView(vt220* view);
+    ~vtGLView() override;
+
+    void invalidate();
+    void invalidate(const QRegion& region);
+    void reset_atlas();
+    void blink();
+
+signals:
+    void Failed(const QString& message);
+    void Painted();
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+
+private:
+    /** @brief How the fragment shader computes the coverage of an instance */
+    typedef enum {
+	Mode_Solid,		//!< fully covered, e.g. a cell without a glyph or a line
+	Mode_Glyph,		//!< coverage sampled from the atlas
+	Mode_Cross		//!< coverage of the two diagonals of the quad
+    }   Mode;
+
+    /** @brief One quad as it is uploaded to the instance buffer */
+    struct Instance {
+	GLfloat rect[4];	//!< x, y, width, height in widget pixels
+	GLfloat src[4];		//!< x, y, width, height in atlas texels
+	GLubyte fg[4];		//!< premultiplied RGBA foreground
+	GLubyte bg[4];		//!< premultiplied RGBA background
+	GLfloat mode;		//!< Mode of the instance
+    };
+
+    /** @brief Instances of one widget row */
+    struct Row {
+	QVector<Instance> cells;	//!< backgrounds and glyphs, drawn first
+	QVector<Instance> overlays;	//!< decoration lines and the cursor
+	bool dirty = true;		//!< rebuild from the core before the next frame
+	bool blinking = false;		//!< row contains blinking cells
+    };
+
+    vt220* m_view;			//!< view whose core and atlas are rendered
+    QOpenGLShaderProgram* m_program;	//!< instanced quad program
+    QOpenGLVertexArrayObject m_vao;	//!< attribute setup of the program
+    QOpenGLBuffer m_corners;		//!< the four corners of the unit quad
+    QOpenGLBuffer m_instances;		//!< Instance array of the frame
+    GLuint m_atlas;			//!< coverage texture, or 0
+    QSize m_atlas_size;			//!< size of the coverage texture
+    int m_atlas_slots;			//!< number of slots uploaded to the texture
+    QVector<Row> m_rows;		//!< instances per widget row
+    QVector<Instance> m_frame;		//!< concatenated instances of all rows
+    int m_columns;			//!< columns when m_rows were built
+    int m_top;				//!< top line when m_rows were built
+    int m_font_h;			//!< line height when m_rows were built
+    bool m_ok;				//!< true if initializeGL() succeeded
+
+    void build_row(int row);
+    void upload_atlas();
+    static Instance instance(const QRect& rect, Mode mode, quint32 fg, quint32 bg);
+};
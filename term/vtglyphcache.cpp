@@ -0,0 +1,165 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal cache of glyph atlases per font size
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include "vtglyphcache.h"
+
+vtGlyphWorker::vtGlyphWorker(QObject* parent)
+    : QObject(parent)
+{
+}
+
+/**
+ * @brief Render the common glyphs of @p font into a new atlas
+ * @param font const reference to the QFont
+ * @param fw cell width in pixels
+ * @param fh cell height in pixels
+ */
+void vtGlyphWorker::prerender(const QFont& font, int fw, int fh)
+{
+    vtGlyphs glyphs(font, fw, fh);
+    glyphs.prerender();
+    emit Prerendered(glyphs);
+}
+
+vtGlyphCache::vtGlyphCache(QObject* parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_worker(new vtGlyphWorker)
+    , m_lru()
+    , m_pending()
+{
+    qRegisterMetaType<vtGlyphs>();
+    m_thread->setObjectName(QLatin1String("glyphs"));
+    m_worker->moveToThread(m_thread);
+    bool ok;
+    ok = connect(m_thread, &QThread::finished,
+		 m_worker, &QObject::deleteLater);
+    Q_ASSERT(ok);
+    ok = connect(m_worker, &vtGlyphWorker::Prerendered,
+		 this, &vtGlyphCache::prerendered);
+    Q_ASSERT(ok);
+    m_thread->start(QThread::LowPriority);
+}
+
+vtGlyphCache::~vtGlyphCache()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+/**
+ * @brief Return the atlas for @p font with a cell size of @p fw x @p fh
+ *
+ * If the atlas is not cached, an empty atlas is returned, which renders
+ * its glyphs when they are first used, and the common glyphs are rendered
+ * on the worker thread.
+ * @param font const reference to the QFont
+ * @param fw cell width in pixels
+ * @param fh cell height in pixels
+ * @return vtGlyphs atlas
+ */
+vtGlyphs vtGlyphCache::glyphs(const QFont& font, int fw, int fh)
+{
+    const int i = index(vtGlyphs::font_key(font, fw, fh));
+    if (i >= 0) {
+	m_lru.move(i, 0);
+	return m_lru.first();
+    }
+    prerender(font, fw, fh);
+    return vtGlyphs(font, fw, fh);
+}
+
+/**
+ * @brief Find the cached atlas for @p key
+ * @param key font key as returned by vtGlyphs::font_key()
+ * @param p_glyphs pointer to a vtGlyphs to receive the atlas
+ * @return true if the atlas is cached, false otherwise
+ */
+bool vtGlyphCache::find(const QString& key, vtGlyphs* p_glyphs) const
+{
+    const int i = index(key);
+    if (i < 0)
+	return false;
+    if (p_glyphs)
+	*p_glyphs = m_lru[i];
+    return true;
+}
+
+/**
+ * @brief Store @p glyphs as the most recently used atlas
+ *
+ * An atlas with the same key is replaced, and the least recently used
+ * atlas is dropped if the cache is full. Copies of vtGlyphs share their
+ * data, so this is cheap.
+ * @param glyphs const reference to the vtGlyphs
+ */
+void vtGlyphCache::store(const vtGlyphs& glyphs)
+{
+    if (0 == glyphs.slots())
+	return;
+    const int i = index(glyphs.font_key());
+    if (i >= 0)
+	m_lru.removeAt(i);
+    m_lru.prepend(glyphs);
+    while (m_lru.size() > max_sizes)
+	m_lru.removeLast();
+}
+
+/**
+ * @brief Render the common glyphs for @p font on the worker thread
+ *
+ * Nothing is done if the atlas is cached or already being rendered.
+ * @param font const reference to the QFont
+ * @param fw cell width in pixels
+ * @param fh cell height in pixels
+ */
+void vtGlyphCache::prerender(const QFont& font, int fw, int fh)
+{
+    const QString key = vtGlyphs::font_key(font, fw, fh);
+    if (index(key) >= 0 || m_pending.contains(key))
+	return;
+    m_pending.insert(key);
+    QMetaObject::invokeMethod(m_worker, "prerender", Qt::QueuedConnection,
+			      Q_ARG(QFont, font), Q_ARG(int, fw), Q_ARG(int, fh));
+}
+
+/**
+ * @brief Cache an atlas rendered by the worker and emit Prerendered()
+ *
+ * A cached atlas of the same key with at least as many glyphs is kept.
+ * The new atlas is stored as the least recently used, so that prefetched
+ * sizes do not push out the sizes in use.
+ * @param glyphs const reference to the vtGlyphs
+ */
+void vtGlyphCache::prerendered(const vtGlyphs& glyphs)
+{
+    const QString key = glyphs.font_key();
+    m_pending.remove(key);
+    const int i = index(key);
+    if (i >= 0) {
+	if (m_lru[i].slots() >= glyphs.slots())
+	    return;
+	m_lru[i] = glyphs;
+    } else {
+	if (m_lru.size() >= max_sizes)
+	    m_lru.removeLast();
+	m_lru.append(glyphs);
+    }
+    emit Prerendered(key);
+}
+
+/**
+ * @brief Return the index of the atlas for @p key in m_lru, or -1
+ */
+int vtGlyphCache::index(const QString& key) const
+{
+    for (int i = 0; i < m_lru.size(); i++)
+	if (m_lru[i].font_key() == key)
+	    return i;
+    return -1;
+}
@@ -0,0 +1,73 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal cache of glyph atlases per font size
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QFont>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QThread>
+#include "vtglyphs.h"
+
+/**
+ * @brief The vtGlyphWorker class renders the common glyphs of an atlas
+ *
+ * It lives on the thread of its vtGlyphCache.
+ */
+class vtGlyphWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit vtGlyphWorker(QObject* parent = nullptr);
+
+signals:
+    void Prerendered(const vtGlyphs& glyphs);
+
+public slots:
+    void prerender(const QFont& font, int fw, int fh);
+};
+
+/**
+ * @brief The vtGlyphCache class keeps the glyph atlases of recent font sizes
+ *
+ * The atlases are kept in least recently used order for up to
+ * @ref max_sizes combinations of font and cell size, so that switching
+ * back to a zoom factor or font family reuses the glyphs rendered before.
+ * Atlases which are not cached are started on a worker thread, which
+ * renders the glyphs most sessions use (see vtGlyphs::prerender()) and
+ * reports the atlas with Prerendered().
+ */
+class vtGlyphCache : public QObject
+{
+    Q_OBJECT
+public:
+    //! Maximum number of cached atlases
+    static constexpr int max_sizes = 6;
+
+    explicit vtGlyphCache(QObject* parent = nullptr);
+    ~vtGlyphCache() override;
+
+    vtGlyphs glyphs(const QFont& font, int fw, int fh);
+    bool find(const QString& key, vtGlyphs* p_glyphs) const;
+    void store(const vtGlyphs& glyphs);
+    void prerender(const QFont& font, int fw, int fh);
+
+signals:
+    void Prerendered(const QString& key);
+
+private slots:
+    void prerendered(const vtGlyphs& glyphs);
+
+private:
+    int index(const QString& key) const;
+
+    QThread* m_thread;			//!< thread of the worker
+    vtGlyphWorker* m_worker;		//!< renders atlases on m_thread
+    QList<vtGlyphs> m_lru;		//!< cached atlases, most recently used first
+    QSet<QString> m_pending;		//!< keys of atlases being rendered
+};
@@ -1,35 +1,315 @@
 /*****************************************************************************
  *
- *  VT - Virtual Terminal glyph hash
+ *  VT - Virtual Terminal glyph atlas
  * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
  *
  * See the file LICENSE for the details of the BSD-3-Clause terms.
  *
  *****************************************************************************/
+#include <cstring>
 #include "vtglyphs.h"
 
 vtGlyphs::vtGlyphs(const QFont& font, int fw, int fh)
-    : m_glyphs()
+    : m_index()
+    , m_width()
+    , m_coverage()
+    , m_tinted()
     , m_font(font)
     , m_fw(fw)
     , m_fh(fh)
 {
 }
 
+/**
+ * @brief Drop all rendered glyphs and tinted atlases
+ */
 void vtGlyphs::clear()
 {
-    m_glyphs.clear();
+    m_index.clear();
+    m_width.clear();
+    m_coverage = QImage();
+    m_tinted.clear();
 }
 
-const vtGlyph& vtGlyphs::glyph(const vtAttr& attr, QRgb fg) const
+/**
+ * @brief Return the key identifying the font and cell size of the atlas
+ */
+QString vtGlyphs::font_key() const
 {
-    vtGlyphIdx idx(attr, fg);
-    if (!m_glyphs.contains(idx)) {
-	QFont font(m_font);
-	font.setBold(attr.bold());
-	font.setItalic(attr.italic());
-	vtGlyph glyph(attr, font, m_fw, m_fh, fg);
-	m_glyphs.insert(idx, glyph);
+    return font_key(m_font, m_fw, m_fh);
+}
+
+/**
+ * @brief Return the key identifying @p font with a cell size of @p fw x @p fh
+ * @param font const reference to the QFont
+ * @param fw cell width in pixels
+ * @param fh cell height in pixels
+ * @return QString with the key
+ */
+QString vtGlyphs::font_key(const QFont& font, int fw, int fh)
+{
+    return QString("%1/%2x%3").arg(font.key()).arg(fw).arg(fh);
+}
+
+/**
+ * @brief Render the glyphs most terminal sessions use
+ *
+ * These are printable ASCII in regular and bold, the box drawing and
+ * block elements, and the remaining symbols of the DEC special graphics
+ * set. This is meant to be called on a worker thread before the atlas
+ * is used for painting.
+ */
+void vtGlyphs::prerender()
+{
+    static const uint dec_graphics[] = {
+	0x2190, 0x2191, 0x2192, 0x2193,		// ← ↑ → ↓
+	0x25c6, 0x2409, 0x240c, 0x240d,		// ◆ ␉ ␌ ␍
+	0x240a, 0x240b, 0x00b0, 0x00b1,		// ␊ ␋ ° ±
+	0x23ba, 0x23bb, 0x23bc, 0x23bd,		// ⎺ ⎻ ⎼ ⎽
+	0x2264, 0x2265, 0x03c0, 0x2260,		// ≤ ≥ π ≠
+	0x00a3, 0x00b7, 0x00b8			// £ · ¸
+    };
+    vtAttr attr;
+    for (uint code = 0x21; code < 0x7f; code++) {
+	attr.set_code(code);
+	attr.set_bold(false);
+	glyph(attr);
+	attr.set_bold(true);
+	glyph(attr);
+    }
+    attr.set_bold(false);
+    for (uint code = 0x2500; code < 0x25a0; code++) {
+	attr.set_code(code);
+	glyph(attr);
+    }
+    for (const uint code : dec_graphics) {
+	attr.set_code(code);
+	glyph(attr);
+    }
+}
+
+/**
+ * @brief Return the atlas slot for the glyph described by @p attr
+ *
+ * The glyph is rendered into a new slot, if it is not yet in the atlas.
+ * @param attr const reference to the vtAttr with code, mark, bold, and italic
+ * @return slot index
+ */
+int vtGlyphs::glyph(const vtAttr& attr) const
+{
+    const quint64 k = key(attr);
+    auto it = m_index.constFind(k);
+    if (it != m_index.constEnd())
+	return it.value();
+    const int slot = render(attr);
+    m_index.insert(k, slot);
+    return slot;
+}
+
+/**
+ * @brief Return the width in cells of the glyph in @p slot
+ * @param slot slot index
+ * @return 1 or 2
+ */
+int vtGlyphs::width(int slot) const
+{
+    return m_width.value(slot, 1);
+}
+
+/**
+ * @brief Return the number of slots rendered so far
+ */
+int vtGlyphs::slots() const
+{
+    return m_width.size();
+}
+
+/**
+ * @brief Return the rectangle of the glyph in @p slot in the atlas
+ * @param slot slot index
+ * @return QRect in atlas coordinates
+ */
+QRect vtGlyphs::source(int slot) const
+{
+    const int sw = 2 * m_fw;
+    return QRect((slot % atlas_columns) * sw, (slot / atlas_columns) * m_fh,
+		 width(slot) * m_fw, m_fh);
+}
+
+/**
+ * @brief Return the atlas tinted with foreground color @p fg
+ *
+ * Slots added since the last call for this color are tinted first.
+ * @param fg QRgb of the foreground color
+ * @return const reference to the QPixmap
+ */
+const QPixmap& vtGlyphs::atlas(QRgb fg) const
+{
+    Tinted& tinted = m_tinted[fg];
+    if (tinted.slots < m_width.size())
+	tint(tinted, fg);
+    return tinted.pix;
+}
+
+/**
+ * @brief Return the alpha-only coverage of all slots
+ *
+ * This is the untinted atlas, for renderers which apply the foreground
+ * color themselves. It grows as new glyphs are rendered.
+ * @return const reference to the QImage in Format_Alpha8
+ */
+const QImage& vtGlyphs::coverage() const
+{
+    return m_coverage;
+}
+
+/**
+ * @brief Draw the glyph in @p slot with color @p fg into @p dst
+ * @param painter reference to the QPainter to use
+ * @param dst destination rectangle (the glyph is scaled to fit)
+ * @param slot slot index
+ * @param fg QRgb of the foreground color
+ */
+void vtGlyphs::draw(QPainter& painter, const QRect& dst, int slot, QRgb fg) const
+{
+    painter.drawPixmap(dst, atlas(fg), source(slot));
+}
+
+/**
+ * @brief Return a fragment to draw the glyph in @p slot into @p dst
+ *
+ * The fragments for one color can be drawn in a single call to
+ * QPainter::drawPixmapFragments() with the atlas for that color.
+ * @param dst destination rectangle (the glyph is scaled to fit)
+ * @param slot slot index
+ * @return QPainter::PixmapFragment
+ */
+QPainter::PixmapFragment vtGlyphs::fragment(const QRect& dst, int slot) const
+{
+    const QRect src = source(slot);
+    return QPainter::PixmapFragment::create(QRectF(dst).center(), src,
+					    qreal(dst.width()) / src.width(),
+					    qreal(dst.height()) / src.height());
+}
+
+/**
+ * @brief Return the lookup key for a glyph's code, mark, bold, and italic
+ * @param attr const reference to the vtAttr
+ * @return 64 bit key
+ */
+quint64 vtGlyphs::key(const vtAttr& attr)
+{
+    return static_cast<quint64>(attr.code()) |
+	   (static_cast<quint64>(attr.mark()) << 21) |
+	   (static_cast<quint64>(attr.bold()) << 42) |
+	   (static_cast<quint64>(attr.italic()) << 43);
+}
+
+/**
+ * @brief Render the glyph for @p attr into the next free slot
+ * @param attr const reference to the vtAttr
+ * @return slot index
+ */
+int vtGlyphs::render(const vtAttr& attr) const
+{
+    const int slot = m_width.size();
+    int width;
+    switch (QChar::category(attr.mark())) {
+    case QChar::Mark_SpacingCombining:
+    case QChar::Mark_Enclosing:
+	width = 2;
+	break;
+    default:
+	width = 1;
+    }
+    m_width.append(uchar(width));
+
+    // grow the atlas by doubling the number of rows
+    const int rows = slot / atlas_columns + 1;
+    if (m_coverage.height() < rows * m_fh) {
+	const int grow = qMax(rows, 2 * m_coverage.height() / qMax(1, m_fh));
+	QImage coverage(atlas_columns * 2 * m_fw, grow * m_fh, QImage::Format_Alpha8);
+	coverage.fill(0);
+	for (int y = 0; y < m_coverage.height(); y++)
+	    memcpy(coverage.scanLine(y), m_coverage.constScanLine(y),
+		   static_cast<size_t>(m_coverage.bytesPerLine()));
+	m_coverage = coverage;
+	// tinted atlases must be rebuilt for the new size
+	for (Tinted& tinted : m_tinted)
+	    tinted.slots = 0;
+    }
+
+    // render white text and keep its alpha channel
+    const QRect bbx(0, 0, width * m_fw, m_fh);
+    QImage buff(bbx.size(), QImage::Format_ARGB32_Premultiplied);
+    buff.fill(Qt::transparent);
+    QFont font(m_font);
+    font.setBold(attr.bold());
+    font.setItalic(attr.italic());
+    QPainter painter(&buff);
+    painter.setBackgroundMode(Qt::TransparentMode);
+    painter.setPen(Qt::white);
+    painter.setFont(font);
+    const int pw = painter.pen().width();
+    const uint code = attr.code();
+    const uint mark = attr.mark();
+    painter.drawText(bbx.adjusted(0,0,pw,pw), Qt::AlignLeft | Qt::AlignTop,
+		     QString::fromUcs4(&code, 1));
+    if (mark) {
+	painter.drawText(bbx.adjusted(0,0,pw,pw), Qt::AlignLeft | Qt::AlignTop,
+			 QString::fromUcs4(&mark, 1));
+    }
+    painter.end();
+
+    const QRect rc = source(slot);
+    for (int y = 0; y < rc.height(); y++) {
+	const QRgb* src = reinterpret_cast<const QRgb*>(buff.constScanLine(y));
+	uchar* dst = m_coverage.scanLine(rc.y() + y) + rc.x();
+	for (int x = 0; x < rc.width(); x++)
+	    dst[x] = uchar(qAlpha(src[x]));
+    }
+    return slot;
+}
+
+/**
+ * @brief Bring the atlas @p tinted with color @p fg up to date
+ * @param tinted reference to the Tinted atlas
+ * @param fg QRgb of the foreground color
+ */
+void vtGlyphs::tint(Tinted& tinted, QRgb fg) const
+{
+    if (0 == tinted.slots || tinted.pix.size() != m_coverage.size()) {
+	tinted.pix = QPixmap::fromImage(tinted_image(m_coverage.rect(), fg));
+    } else {
+	QPainter painter(&tinted.pix);
+	painter.setCompositionMode(QPainter::CompositionMode_Source);
+	for (int slot = tinted.slots; slot < m_width.size(); slot++) {
+	    const QRect rc = source(slot);
+	    painter.drawImage(rc.topLeft(), tinted_image(rc, fg));
+	}
+    }
+    tinted.slots = m_width.size();
+}
+
+/**
+ * @brief Return the coverage in @p rect tinted with color @p fg
+ * @param rect rectangle in atlas coordinates
+ * @param fg QRgb of the foreground color
+ * @return QImage in premultiplied ARGB32 format
+ */
+QImage vtGlyphs::tinted_image(const QRect& rect, QRgb fg) const
+{
+    QImage img(rect.size(), QImage::Format_ARGB32_Premultiplied);
+    const int r = qRed(fg);
+    const int g = qGreen(fg);
+    const int b = qBlue(fg);
+    for (int y = 0; y < rect.height(); y++) {
+	const uchar* src = m_coverage.constScanLine(rect.y() + y) + rect.x();
+	QRgb* dst = reinterpret_cast<QRgb*>(img.scanLine(y));
+	for (int x = 0; x < rect.width(); x++) {
+	    const int a = src[x];
+	    dst[x] = qRgba(r * a / 255, g * a / 255, b * a / 255, a);
+	}
     }
-    return m_glyphs[idx];
+    return img;
 }
@@ -1,30 +1,73 @@
 /*****************************************************************************
  *
- *  VT - Virtual Terminal glyph hash
+ *  VT - Virtual Terminal glyph atlas
  * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
  *
  * See the file LICENSE for the details of the BSD-3-Clause terms.
  *
  *****************************************************************************/
 #pragma once
-#include "vtglyph.h"
-#include "vtglyphidx.h"
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QMetaType>
+#include <QPainter>
+#include <QPixmap>
+#include <QVector>
+#include "vtattr.h"
 
 /**
- * @brief The vtGlyphs class implements a QHash of @ref vtGlyph by their @ref vtGlypIdx.
+ * @brief The vtGlyphs class implements a texture atlas of rendered glyphs.
  *
- * The class is used to avoid repeated rendering of glyphs using the
- * same Unicode value, font, foreground color
+ * Glyphs are keyed by their Unicode code, mark, and the bold and italic
+ * font attributes only. Each glyph is rendered once as an alpha-only
+ * coverage mask into a slot of the atlas. The foreground color is applied
+ * at blit time from a tinted copy of the atlas per color, which is updated
+ * lazily as new glyphs are added. Cycling colors thus does not grow the
+ * cache of glyphs.
+ *
+ * The coverage can be rendered on any thread; the tinted atlases are
+ * pixmaps and must only be requested on the GUI thread.
  */
 class vtGlyphs
 {
 public:
     explicit vtGlyphs(const QFont& font = QFont(), int fw = 8, int fh = 12);
     void clear();
-    const vtGlyph& glyph(const vtAttr& attr = vtAttr(), QRgb fg = Qt::white) const;
+    QString font_key() const;
+    static QString font_key(const QFont& font, int fw, int fh);
+    void prerender();
+    int glyph(const vtAttr& attr = vtAttr()) const;
+    int width(int slot) const;
+    int slots() const;
+    QRect source(int slot) const;
+    const QPixmap& atlas(QRgb fg) const;
+    const QImage& coverage() const;
+    void draw(QPainter& painter, const QRect& dst, int slot, QRgb fg) const;
+    QPainter::PixmapFragment fragment(const QRect& dst, int slot) const;
+
 private:
-    mutable QHash<vtGlyphIdx,vtGlyph> m_glyphs;
+    //! Number of glyph slots per row of the atlas
+    static constexpr int atlas_columns = 32;
+
+    /** @brief Atlas tinted with a foreground color */
+    struct Tinted {
+	QPixmap pix;			//!< tinted copy of m_coverage
+	int slots = 0;			//!< number of slots tinted so far
+    };
+
+    static quint64 key(const vtAttr& attr);
+    int render(const vtAttr& attr) const;
+    void tint(Tinted& tinted, QRgb fg) const;
+    QImage tinted_image(const QRect& rect, QRgb fg) const;
+
+    mutable QHash<quint64,int> m_index;	//!< slot index per glyph key
+    mutable QVector<uchar> m_width;	//!< glyph width in cells per slot
+    mutable QImage m_coverage;		//!< alpha-only coverage of all slots
+    mutable QHash<QRgb,Tinted> m_tinted;	//!< atlas tinted per foreground color
     QFont m_font;
     int m_fw;
     int m_fh;
 };
+
+Q_DECLARE_METATYPE(vtGlyphs)
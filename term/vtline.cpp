@@ -6,19 +6,78 @@
  * See the file LICENSE for the details of the BSD-3-Clause terms.
  *
  *****************************************************************************/
+#include <algorithm>
 #include "vtline.h"
 
 /**
  * @brief vtLine constructor
- * @param size number of columns
- * @param att default attribute for this line
+ * @param cells pointer to the first cell of the line
+ * @param attr pointer to the line attributes
+ * @param width number of columns
  */
-vtLine::vtLine(int size, const vtAttr& att)
-    : m_decdwl(1)
-    , m_decdhl(1)
-    , m_decdhl_bottom(false)
+vtLine::vtLine(vtCell* cells, vtLineAttr* attr, int width)
+    : m_cells(cells)
+    , m_attr(attr)
+    , m_width(width)
 {
-    fill(att, size);
+}
+
+/**
+ * @brief Return the number of columns
+ * @return number of cells in the line
+ */
+int vtLine::size() const
+{
+    return m_width;
+}
+
+/**
+ * @brief Return a reference to the cell at column @p x
+ * @param x column
+ * @return reference to the vtCell
+ */
+vtCell& vtLine::operator[](int x)
+{
+    Q_ASSERT(x >= 0 && x < m_width);
+    return m_cells[x];
+}
+
+/**
+ * @brief Return a const reference to the cell at column @p x
+ * @param x column
+ * @return const reference to the vtCell
+ */
+const vtCell& vtLine::operator[](int x) const
+{
+    Q_ASSERT(x >= 0 && x < m_width);
+    return m_cells[x];
+}
+
+/**
+ * @brief Return a pointer to the first cell of the line
+ * @return pointer to the vtCell array
+ */
+vtCell* vtLine::data()
+{
+    return m_cells;
+}
+
+/**
+ * @brief Return a pointer to the first cell of the line
+ * @return const pointer to the vtCell array
+ */
+const vtCell* vtLine::constData() const
+{
+    return m_cells;
+}
+
+/**
+ * @brief Fill all cells of the line with @p cell
+ * @param cell const reference to the vtCell
+ */
+void vtLine::fill(const vtCell& cell)
+{
+    std::fill(m_cells, m_cells + m_width, cell);
 }
 
 /**
@@ -27,7 +86,7 @@ vtLine::vtLine(int size, const vtAttr& att)
  */
 int vtLine::decdwl() const
 {
-    return m_decdwl;
+    return m_attr->decdwl;
 }
 
 /**
@@ -36,7 +95,7 @@ int vtLine::decdwl() const
  */
 int vtLine::decdhl() const
 {
-    return m_decdhl_bottom ? 1 : m_decdhl;
+    return m_attr->bottom ? 1 : m_attr->decdhl;
 }
 
 /**
@@ -45,7 +104,47 @@ int vtLine::decdhl() const
  */
 bool vtLine::bottom() const
 {
-    return m_decdhl_bottom;
+    return m_attr->bottom;
+}
+
+/**
+ * @brief Return the line attributes
+ * @return const reference to the vtLineAttr
+ */
+const vtLineAttr& vtLine::attr() const
+{
+    return *m_attr;
+}
+
+/**
+ * @brief Set the line attributes
+ * @param attr const reference to the vtLineAttr
+ */
+void vtLine::set_attr(const vtLineAttr& attr)
+{
+    *m_attr = attr;
+}
+
+/**
+ * @brief Return the number of blinking cells
+ *
+ * The count is kept by the writers of the cells, i.e. vtCore, and moves
+ * with the line when the page scrolls. A line with no blinking cells
+ * need not be repainted when the blink phase changes.
+ * @return number of cells with the blink attribute
+ */
+int vtLine::blinking() const
+{
+    return m_attr->blinking;
+}
+
+/**
+ * @brief Set the number of blinking cells
+ * @param count number of cells with the blink attribute
+ */
+void vtLine::set_blinking(int count)
+{
+    m_attr->blinking = static_cast<quint16>(qBound(0, count, 0xffff));
 }
 
 /**
@@ -53,8 +152,8 @@ bool vtLine::bottom() const
  */
 void vtLine::set_decshl()
 {
-    m_decdhl = 1;
-    m_decdhl_bottom = false;
+    m_attr->decdhl = 1;
+    m_attr->bottom = false;
 }
 
 /**
@@ -63,8 +162,8 @@ void vtLine::set_decshl()
  */
 void vtLine::set_decdhl(bool bottom)
 {
-    m_decdhl = 2;
-    m_decdhl_bottom = bottom;
+    m_attr->decdhl = 2;
+    m_attr->bottom = bottom;
 }
 
 /**
@@ -72,7 +171,7 @@ void vtLine::set_decdhl(bool bottom)
  */
 void vtLine::set_decswl()
 {
-    m_decdwl = 1;
+    m_attr->decdwl = 1;
 }
 
 /**
@@ -80,5 +179,5 @@ void vtLine::set_decswl()
  */
 void vtLine::set_decdwl()
 {
-    m_decdwl = 2;
+    m_attr->decdwl = 2;
 }
@@ -7,15 +7,44 @@
  *
  *****************************************************************************/
 #pragma once
-#include "vtattr.h"
+#include "vtcell.h"
 
-class vtLine : public QVector<vtAttr>
+/**
+ * @brief The line attributes stored per line of a vtPage
+ */
+struct vtLineAttr
+{
+    quint8 decdwl = 1;		//!< DEC double width line (1 or 2)
+    quint8 decdhl = 1;		//!< DEC double height line (1 or 2)
+    bool bottom = false;	//!< bottom half of a DEC double height line
+    quint16 blinking = 0;	//!< number of cells with the blink attribute
+};
+
+/**
+ * @brief The vtLine class is a handle for a line of cells in a vtPage.
+ *
+ * It does not own the cells; it is valid until the page is modified
+ * by anything but writing to cells or line attributes.
+ */
+class vtLine
 {
 public:
-    vtLine(int size = -1, const vtAttr& att = vtAttr());
+    vtLine(vtCell* cells = nullptr, vtLineAttr* attr = nullptr, int width = 0);
+
+    int size() const;
+    vtCell& operator[](int x);
+    const vtCell& operator[](int x) const;
+    vtCell* data();
+    const vtCell* constData() const;
+    void fill(const vtCell& cell);
+
     int decdwl() const;
     int decdhl() const;
     bool bottom() const;
+    const vtLineAttr& attr() const;
+    void set_attr(const vtLineAttr& attr);
+    int blinking() const;
+    void set_blinking(int count);
 
     void set_decswl();
     void set_decshl();
@@ -23,9 +52,7 @@ public:
     void set_decdhl(bool bottom = false);
 
 private:
-    int m_decdwl;
-    int m_decdhl;
-    bool m_decdhl_bottom;
+    vtCell* m_cells;
+    vtLineAttr* m_attr;
+    int m_width;
 };
-
-typedef QList<vtLine> vtPage;	//!< a QList of lines makes a page (screen)
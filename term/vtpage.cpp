@@ -0,0 +1,414 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal page of lines
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <algorithm>
+#include <utility>
+#include "vtpage.h"
+
+/**
+ * @brief vtPage constructor
+ * @param max maximum number of lines, or 0 for no limit
+ */
+vtPage::vtPage(int max)
+    : m_cells()
+    , m_attrs()
+    , m_map()
+    , m_length()
+    , m_width(0)
+    , m_stride(0)
+    , m_first(0)
+    , m_count(0)
+    , m_max(max)
+{
+}
+
+/**
+ * @brief Return the maximum number of lines
+ * @return maximum number of lines, or 0 for no limit
+ */
+int vtPage::max() const
+{
+    return m_max;
+}
+
+/**
+ * @brief Set the maximum number of lines, dropping the oldest ones if required
+ * @param max maximum number of lines, or 0 for no limit
+ */
+void vtPage::set_max(int max)
+{
+    m_max = max;
+    while (m_max > 0 && m_count > m_max)
+	removeFirst();
+}
+
+/**
+ * @brief Return the number of columns per line
+ * @return number of columns
+ */
+int vtPage::width() const
+{
+    return m_width;
+}
+
+/**
+ * @brief Set the number of columns per line
+ *
+ * Lines longer than @p width are clipped, and shorter lines are extended
+ * with blanks with the attributes of their first cell when they are
+ * accessed. The cells are only moved if @p width exceeds the columns
+ * allocated per slot.
+ * @param width number of columns
+ */
+void vtPage::set_width(int width)
+{
+    if (width > m_stride)
+	restride(qMax(width, min_stride));
+    m_width = width;
+}
+
+/**
+ * @brief Return the number of lines in the page
+ * @return number of lines
+ */
+int vtPage::size() const
+{
+    return m_count;
+}
+
+/**
+ * @brief Return the number of lines in the page
+ * @return number of lines
+ */
+int vtPage::count() const
+{
+    return m_count;
+}
+
+/**
+ * @brief Return true, if the page has no lines
+ * @return true if empty, or false otherwise
+ */
+bool vtPage::isEmpty() const
+{
+    return 0 == m_count;
+}
+
+/**
+ * @brief Remove all lines and release the storage
+ */
+void vtPage::clear()
+{
+    m_cells.clear();
+    m_attrs.clear();
+    m_map.clear();
+    m_length.clear();
+    m_first = 0;
+    m_count = 0;
+}
+
+/**
+ * @brief Return a handle for the line at @p row
+ *
+ * The handle may be used to modify the line, so its natural length
+ * becomes the current width; any clipped cells are discarded.
+ * @param row row number (0 is the first line)
+ * @return vtLine handle
+ */
+vtLine vtPage::operator[](int row)
+{
+    Q_ASSERT(row >= 0 && row < m_count);
+    const int s = slot(row);
+    pad(s);
+    m_length[s] = m_width;
+    return line(s);
+}
+
+/**
+ * @brief Return a const handle for the line at @p row
+ *
+ * A line shorter than the width is padded, cells clipped by the width
+ * are kept.
+ * @param row row number (0 is the first line)
+ * @return const vtLine handle
+ */
+const vtLine vtPage::operator[](int row) const
+{
+    Q_ASSERT(row >= 0 && row < m_count);
+    vtPage* page = const_cast<vtPage*>(this);
+    const int s = slot(row);
+    page->pad(s);
+    return page->line(s);
+}
+
+/**
+ * @brief Append a line filled with @p fill to the page
+ * @param fill const reference to the vtCell to fill the line with
+ * @return true if the oldest line was dropped, or false otherwise
+ */
+bool vtPage::append(const vtCell& fill)
+{
+    const bool dropped = add_slot();
+    const int s = slot(m_count - 1);
+    vtLine dst = line(s);
+    dst.set_attr(vtLineAttr());
+    dst.fill(fill);
+    m_length[s] = m_width;
+    return dropped;
+}
+
+/**
+ * @brief Append a copy of @p line to the page
+ * @param line const reference to the vtLine of another page
+ * @return true if the oldest line was dropped, or false otherwise
+ */
+bool vtPage::append(const vtLine& line)
+{
+    const bool dropped = add_slot();
+    copy(slot(m_count - 1), line);
+    return dropped;
+}
+
+/**
+ * @brief Insert a copy of @p line before the first line of the page
+ * @param line const reference to the vtLine of another page
+ */
+void vtPage::prepend(const vtLine& line)
+{
+    if (m_count == m_map.size())
+	grow();
+    m_first = m_first > 0 ? m_first - 1 : m_map.size() - 1;
+    m_count++;
+    copy(slot(0), line);
+}
+
+/**
+ * @brief Remove the first line of the page
+ */
+void vtPage::removeFirst()
+{
+    Q_ASSERT(m_count > 0);
+    m_first = ring(1);
+    m_count--;
+}
+
+/**
+ * @brief Remove the last line of the page
+ */
+void vtPage::removeLast()
+{
+    Q_ASSERT(m_count > 0);
+    m_count--;
+}
+
+/**
+ * @brief Rotate the rows @p top to @p bottom - 1 up by one row
+ *
+ * The line at @p top becomes the line at @p bottom - 1. If the region
+ * covers the entire page, the origin is moved.
+ * @param top first row of the region
+ * @param bottom row after the last row of the region
+ */
+void vtPage::rotate_up(int top, int bottom)
+{
+    if (bottom - top < 2)
+	return;
+    if (0 == top && m_count == bottom) {
+	// move the first slot behind the last and advance the origin
+	if (m_count < m_map.size())
+	    std::swap(m_map[ring(m_count)], m_map[m_first]);
+	m_first = ring(1);
+	return;
+    }
+    const int first = m_map[ring(top)];
+    for (int y = top; y < bottom - 1; y++)
+	m_map[ring(y)] = m_map[ring(y + 1)];
+    m_map[ring(bottom - 1)] = first;
+}
+
+/**
+ * @brief Rotate the rows @p top to @p bottom - 1 down by one row
+ *
+ * The line at @p bottom - 1 becomes the line at @p top. If the region
+ * covers the entire page, the origin is moved.
+ * @param top first row of the region
+ * @param bottom row after the last row of the region
+ */
+void vtPage::rotate_dn(int top, int bottom)
+{
+    if (bottom - top < 2)
+	return;
+    if (0 == top && m_count == bottom) {
+	// move the last slot before the first and step back the origin
+	const int first = m_first > 0 ? m_first - 1 : m_map.size() - 1;
+	if (m_count < m_map.size())
+	    std::swap(m_map[first], m_map[ring(m_count - 1)]);
+	m_first = first;
+	return;
+    }
+    const int last = m_map[ring(bottom - 1)];
+    for (int y = bottom - 1; y > top; y--)
+	m_map[ring(y)] = m_map[ring(y - 1)];
+    m_map[ring(top)] = last;
+}
+
+/**
+ * @brief Return a pointer to the cells of all slots
+ *
+ * This is meant for operations on every cell (e.g. remapping the
+ * attribute indices); it includes the cells of unused slots.
+ * @return pointer to the vtCell array
+ */
+vtCell* vtPage::cells()
+{
+    return m_cells.data();
+}
+
+/**
+ * @brief Return the number of cells of all slots
+ * @return number of cells
+ */
+int vtPage::cells_size() const
+{
+    return m_cells.size();
+}
+
+/**
+ * @brief Return the index into the ring for @p row
+ * @param row row number
+ * @return index into m_map
+ */
+int vtPage::ring(int row) const
+{
+    const int r = m_first + row;
+    return r < m_map.size() ? r : r - m_map.size();
+}
+
+/**
+ * @brief Return the slot number for @p row
+ * @param row row number
+ * @return slot number
+ */
+int vtPage::slot(int row) const
+{
+    return m_map[ring(row)];
+}
+
+/**
+ * @brief Return a handle for the line in @p slot
+ * @param slot slot number
+ * @return vtLine handle
+ */
+vtLine vtPage::line(int slot)
+{
+    return vtLine(m_cells.data() + slot * m_stride, m_attrs.data() + slot, m_width);
+}
+
+/**
+ * @brief Extend the line in @p slot with blanks up to the width
+ *
+ * The blanks have the attributes of the line's first cell.
+ * @param slot slot number
+ */
+void vtPage::pad(int slot)
+{
+    const int len = m_length[slot];
+    if (len >= m_width)
+	return;
+    vtCell* cells = m_cells.data() + slot * m_stride;
+    const vtCell blank = len > 0 ? vtCell(0x20, cells[0].attr()) : vtCell();
+    std::fill(cells + len, cells + m_width, blank);
+    m_length[slot] = m_width;
+}
+
+/**
+ * @brief Add a slot for a new last line, reusing the oldest if the page is full
+ * @return true if the oldest line was dropped, or false otherwise
+ */
+bool vtPage::add_slot()
+{
+    if (m_max > 0 && m_count >= m_max) {
+	m_first = ring(1);
+	return true;
+    }
+    if (m_count == m_map.size())
+	grow();
+    m_count++;
+    return false;
+}
+
+/**
+ * @brief Copy the cells and line attributes of @p src to the line in @p slot
+ *
+ * The line keeps the natural length of @p src, as far as the slot has room.
+ * @param slot slot number
+ * @param src const reference to the source vtLine
+ */
+void vtPage::copy(int slot, const vtLine& src)
+{
+    const int n = qMin(m_stride, src.size());
+    std::copy(src.constData(), src.constData() + n, m_cells.data() + slot * m_stride);
+    m_attrs[slot] = src.attr();
+    m_length[slot] = n;
+}
+
+/**
+ * @brief Allocate @p stride columns per slot, moving the lines to start at slot 0
+ * @param stride number of columns per slot
+ */
+void vtPage::restride(int stride)
+{
+    const int slots = m_map.size();
+    QVector<vtCell> cells(slots * stride);
+    QVector<vtLineAttr> attrs(slots);
+    QVector<int> length(slots);
+    for (int row = 0; row < m_count; row++) {
+	const int s = slot(row);
+	const vtCell* src = m_cells.constData() + s * m_stride;
+	const int n = qMin(stride, m_length[s]);
+	std::copy(src, src + n, cells.data() + row * stride);
+	attrs[row] = m_attrs[s];
+	length[row] = n;
+    }
+    m_cells.swap(cells);
+    m_attrs.swap(attrs);
+    m_length.swap(length);
+    for (int i = 0; i < slots; i++)
+	m_map[i] = i;
+    m_stride = stride;
+    m_first = 0;
+}
+
+/**
+ * @brief Double the number of slots, moving the lines to start at slot 0
+ */
+void vtPage::grow()
+{
+    int slots = qMax(16, 2 * m_map.size());
+    if (m_max > 0)
+	slots = qMin(slots, qMax(m_max, m_count + 1));
+    QVector<vtCell> cells(slots * m_stride);
+    QVector<vtLineAttr> attrs(slots);
+    QVector<int> length(slots);
+    QVector<int> map(slots);
+    for (int row = 0; row < m_count; row++) {
+	const int s = slot(row);
+	std::copy(m_cells.constData() + s * m_stride,
+		  m_cells.constData() + (s + 1) * m_stride,
+		  cells.data() + row * m_stride);
+	attrs[row] = m_attrs[s];
+	length[row] = m_length[s];
+    }
+    for (int i = 0; i < slots; i++)
+	map[i] = i;
+    m_cells.swap(cells);
+    m_attrs.swap(attrs);
+    m_length.swap(length);
+    m_map.swap(map);
+    m_first = 0;
+}
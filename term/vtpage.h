@@ -0,0 +1,84 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal page of lines
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QVector>
+#include "vtline.h"
+
+/**
+ * @brief The vtPage class implements a circular buffer of lines.
+ *
+ * The cells of all lines are stored in one contiguous array of vtCell
+ * with a fixed number of columns per line slot, i.e. 4 bytes per cell plus
+ * 14 bytes per line for the line attributes, the length and the slot map. Rows are mapped
+ * to slots through a ring with a moving origin: scrolling the entire page
+ * moves the origin, and scrolling a region rotates the slot numbers of the
+ * region instead of copying cells. If a maximum number of lines is set,
+ * appending to a full page reuses the slot of the oldest line.
+ *
+ * The slots have room for at least @ref min_stride columns, and each slot
+ * keeps the natural length of its line. Changing the width only changes
+ * the number of columns the handles show: longer lines are clipped, and
+ * shorter lines are padded with blanks when they are accessed, so that
+ * resizing costs nothing per line and text clipped by a narrower width is
+ * shown again when the width grows before the line was modified.
+ */
+class vtPage
+{
+public:
+    explicit vtPage(int max = 0);
+
+    int max() const;
+    void set_max(int max);
+
+    int width() const;
+    void set_width(int width);
+
+    int size() const;
+    int count() const;
+    bool isEmpty() const;
+    void clear();
+
+    vtLine operator[](int row);
+    const vtLine operator[](int row) const;
+
+    bool append(const vtCell& fill);
+    bool append(const vtLine& line);
+    void prepend(const vtLine& line);
+    void removeFirst();
+    void removeLast();
+
+    void rotate_up(int top, int bottom);
+    void rotate_dn(int top, int bottom);
+
+    vtCell* cells();
+    int cells_size() const;
+
+private:
+    int ring(int row) const;
+    int slot(int row) const;
+    vtLine line(int slot);
+    void pad(int slot);
+    bool add_slot();
+    void copy(int slot, const vtLine& src);
+    void restride(int stride);
+    void grow();
+
+    QVector<vtCell> m_cells;	//!< cells of all slots; m_stride cells per slot
+    QVector<vtLineAttr> m_attrs;//!< line attributes per slot
+    //! Minimum number of columns allocated per slot
+    static constexpr int min_stride = 132;
+
+    QVector<int> m_map;		//!< ring of slot numbers; row 0 is at m_first
+    QVector<int> m_length;	//!< natural length of the line per slot
+    int m_width;		//!< number of columns shown per line
+    int m_stride;		//!< number of columns allocated per slot
+    int m_first;		//!< index of row 0 in m_map
+    int m_count;		//!< number of rows in use
+    int m_max;			//!< maximum number of rows, or 0 for no limit
+};
@@ -7,17 +7,17 @@
  *
  *****************************************************************************/
 #include <QEvent>
+#include <QResizeEvent>
 #include <QScrollBar>
 #include "vtscrollarea.h"
 #include "vt220.h"
 
 vtScrollArea::vtScrollArea(QWidget* parent)
-    : QScrollArea(parent)
-    , m_widget_size()
+    : QAbstractScrollArea(parent)
+    , m_widget(nullptr)
 {
     setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-    setAlignment(Qt::AlignHCenter | Qt::AlignTop);
 }
 
 QSize vtScrollArea::sizeHint() const
@@ -25,15 +25,9 @@ QSize vtScrollArea::sizeHint() const
     const int f = 2 * frameWidth();
     const int h = fontMetrics().height();
     QSize sz(f, f);
-    QWidget* wdg = widget();
-
-    if (wdg) {
-	if (!m_widget_size.isValid()) {
-	    m_widget_size = widgetResizable() ?
-				wdg->sizeHint() :
-				wdg->size();
-	}
-	sz += m_widget_size;
+
+    if (m_widget) {
+	sz += m_widget->size();
     } else {
 	sz += QSize(12 * h, 8 * h);
     }
@@ -47,29 +41,207 @@ QSize vtScrollArea::sizeHint() const
     return sz;
 }
 
-bool vtScrollArea::event(QEvent *e)
+/**
+ * @brief Return the contained widget
+ */
+QWidget* vtScrollArea::widget() const
+{
+    return m_widget;
+}
+
+/**
+ * @brief Make @p widget the contained widget and show it in the viewport
+ * @param widget pointer to the widget, usually a vt220
+ */
+void vtScrollArea::setWidget(QWidget* widget)
+{
+    if (m_widget == widget)
+	return;
+    if (m_widget)
+	m_widget->removeEventFilter(this);
+    m_widget = widget;
+    if (m_widget) {
+	m_widget->setParent(viewport());
+	m_widget->installEventFilter(this);
+	m_widget->show();
+    }
+    update_scrollbars();
+    updateGeometry();
+}
+
+/**
+ * @brief Follow resizes of the contained widget
+ */
+bool vtScrollArea::eventFilter(QObject* obj, QEvent* e)
 {
-    vt220* vterm = qobject_cast<vt220*>(widget());
-    if (vterm) {
-	if (QEvent::LayoutRequest == e->type()) {
-	    QSize new_size = widgetResizable()
-			     ? vterm->sizeHint()
-			     : vterm->size();
-	    if (m_widget_size != new_size) {
-		m_widget_size = new_size;
-		updateGeometry();
-	    }
-	}
+    if (obj == m_widget && QEvent::Resize == e->type()) {
+	update_scrollbars();
+	updateGeometry();
     }
-    return QScrollArea::event(e);
+    return QAbstractScrollArea::eventFilter(obj, e);
+}
+
+void vtScrollArea::resizeEvent(QResizeEvent* e)
+{
+    QAbstractScrollArea::resizeEvent(e);
+    update_scrollbars();
 }
 
+void vtScrollArea::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    update_widget_position();
+}
+
+/**
+ * @brief Return the contained widget, if it is a vt220
+ */
+vt220* vtScrollArea::vterm() const
+{
+    return qobject_cast<vt220*>(m_widget);
+}
+
+/**
+ * @brief Return the number of lines visible at once
+ *
+ * This is the smaller of the lines fitting the viewport and the screen rows.
+ */
+int vtScrollArea::page_lines() const
+{
+    const vt220* vt = vterm();
+    if (!vt)
+	return 1;
+    const int fit = viewport()->height() / qMax(1, vt->line_height());
+    return qBound(1, fit, vt->core()->rows());
+}
+
+/**
+ * @brief Set the scroll bar ranges from the contained widget and the viewport
+ *
+ * If the vertical scroll bar was at its end, it stays there, so that the
+ * view follows the output.
+ */
+void vtScrollArea::update_scrollbars()
+{
+    QScrollBar* hbar = horizontalScrollBar();
+    QScrollBar* vbar = verticalScrollBar();
+    if (!m_widget) {
+	hbar->setRange(0, 0);
+	vbar->setRange(0, 0);
+	return;
+    }
+
+    const QSize vs = viewport()->size();
+    const QSize ws = m_widget->size();
+    hbar->setRange(0, qMax(0, ws.width() - vs.width()));
+    hbar->setPageStep(vs.width());
+    hbar->setSingleStep(20);
+
+    const vt220* vt = vterm();
+    if (vt) {
+	const bool at_end = vbar->value() >= vbar->maximum();
+	const int page = page_lines();
+	const int max = qMax(0, vt->content_lines() - page);
+	vbar->setRange(0, max);
+	vbar->setPageStep(page);
+	vbar->setSingleStep(1);
+	if (at_end)
+	    vbar->setValue(max);
+    } else {
+	vbar->setRange(0, qMax(0, ws.height() - vs.height()));
+	vbar->setPageStep(vs.height());
+	vbar->setSingleStep(20);
+    }
+    update_widget_position();
+}
+
+/**
+ * @brief Place the contained widget and tell a vt220 its top line
+ */
+void vtScrollArea::update_widget_position()
+{
+    if (!m_widget)
+	return;
+    const QScrollBar* hbar = horizontalScrollBar();
+    const QScrollBar* vbar = verticalScrollBar();
+    const int vw = viewport()->width();
+    const int ww = m_widget->width();
+    const int x = ww < vw ? (vw - ww) / 2 : -hbar->value();
+
+    vt220* vt = vterm();
+    if (!vt) {
+	m_widget->move(x, -vbar->value());
+	return;
+    }
+    m_widget->move(x, 0);
+    if (vbar->value() >= vbar->maximum() && page_lines() >= vt->core()->rows()) {
+	// the whole screen is visible: follow it
+	vt->set_top_line(-1);
+    } else {
+	vt->set_top_line(vbar->value());
+    }
+}
+
+/**
+ * @brief Scroll the cursor's rectangle into view
+ * @param rect cursor rectangle in the vt220's virtual coordinates
+ */
 void vtScrollArea::UpdateCursor(const QRect& rect)
 {
-    ensureVisible(rect.x(), rect.y());
+    QScrollBar* hbar = horizontalScrollBar();
+    QScrollBar* vbar = verticalScrollBar();
+    const int vw = viewport()->width();
+    if (rect.left() < hbar->value())
+	hbar->setValue(rect.left());
+    else if (rect.right() >= hbar->value() + vw)
+	hbar->setValue(rect.right() - vw + 1);
+
+    const vt220* vt = vterm();
+    if (!vt)
+	return;
+    const int line = rect.top() / qMax(1, vt->line_height());
+    const int page = page_lines();
+    if (line < vbar->value())
+	vbar->setValue(line);
+    else if (line >= vbar->value() + page)
+	vbar->setValue(line - page + 1);
+}
+
+/**
+ * @brief Scroll the virtual @p line and @p column into view
+ *
+ * The line is centered vertically, if the view has to scroll.
+ * @param line virtual line of the vt220
+ * @param column column in the line
+ */
+void vtScrollArea::show_line(int line, int column)
+{
+    const vt220* vt = vterm();
+    if (!vt)
+	return;
+    QScrollBar* hbar = horizontalScrollBar();
+    QScrollBar* vbar = verticalScrollBar();
+    const int page = page_lines();
+    if (line < vbar->value() || line >= vbar->value() + page)
+	vbar->setValue(line - page / 2);
+
+    const int x = column * vt->width() / qMax(1, vt->core()->columns());
+    const int vw = viewport()->width();
+    if (x < hbar->value() || x >= hbar->value() + vw)
+	hbar->setValue(x - vw / 2);
 }
 
 void vtScrollArea::UpdateSize()
 {
+    update_scrollbars();
     updateGeometry();
 }
+
+/**
+ * @brief The number of backlog lines changed: update the vertical range
+ */
+void vtScrollArea::UpdateLines()
+{
+    update_scrollbars();
+}
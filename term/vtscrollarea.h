@@ -8,27 +8,45 @@
  *****************************************************************************/
 #pragma once
 #include <QWidget>
-#include <QScrollArea>
+#include <QAbstractScrollArea>
+
+class vt220;
 
 /**
- * @brief The qsScrollArea class derives from QScrollArea and handles
- * the contained widget's sizeHint() appropriately.
+ * @brief The vtScrollArea class is a virtual viewport for a vt220
+ *
+ * The contained vt220 stays the size of the terminal screen. The
+ * vertical scroll bar ranges over the lines of the backlog plus screen,
+ * and its value is passed to the vt220 as the line to show at the top,
+ * so that neither the geometry nor the layout cost grow with the backlog.
+ * The horizontal scroll bar moves the widget when it is wider than the
+ * viewport, otherwise it is centered. Other widgets are scrolled by pixels.
  */
-class vtScrollArea : public QScrollArea
+class vtScrollArea : public QAbstractScrollArea
 {
     Q_OBJECT
 public:
     explicit vtScrollArea(QWidget* parent = nullptr);
-    QSize sizeHint() const;
-
+    QSize sizeHint() const override;
+    QWidget* widget() const;
+    void setWidget(QWidget* widget);
 
 public slots:
     void UpdateCursor(const QRect& rect);
     void UpdateSize();
+    void UpdateLines();
+    void show_line(int line, int column = 0);
 
 protected:
-    bool event(QEvent* e);
+    bool eventFilter(QObject* obj, QEvent* e) override;
+    void resizeEvent(QResizeEvent* e) override;
+    void scrollContentsBy(int dx, int dy) override;
 
 private:
-    mutable QSize m_widget_size;
+    QWidget* m_widget;		//!< contained widget, usually a vt220
+
+    vt220* vterm() const;
+    int page_lines() const;
+    void update_scrollbars();
+    void update_widget_position();
 };
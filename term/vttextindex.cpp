@@ -0,0 +1,647 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal plain text index for searching
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include "vttextindex.h"
+
+namespace {
+
+/**
+ * @brief Return the number of UTF-8 characters in @p len bytes at @p s
+ */
+int columns_in(const char* s, int len)
+{
+    int n = 0;
+    for (int i = 0; i < len; i++)
+	if ((static_cast<uchar>(s[i]) & 0xc0) != 0x80)
+	    n++;
+    return n;
+}
+
+/**
+ * @brief Return the byte offset of character @p column in @p len bytes at @p s
+ */
+int byte_of_column(const char* s, int len, int column)
+{
+    int i = 0;
+    for (int n = 0; i < len; i++) {
+	if ((static_cast<uchar>(s[i]) & 0xc0) == 0x80)
+	    continue;
+	if (n++ == column)
+	    return i;
+    }
+    return len;
+}
+
+/**
+ * @brief Return the number of characters in the first @p pos UTF-16 units of @p s
+ */
+int column_of(const QString& s, int pos)
+{
+    int n = 0;
+    for (int i = 0; i < pos && i < s.size(); i++)
+	if (!s.at(i).isLowSurrogate())
+	    n++;
+    return n;
+}
+
+/**
+ * @brief Return the UTF-16 offset of character @p column in @p s
+ */
+int utf16_of(const QString& s, int column)
+{
+    int i = 0;
+    for (int n = 0; i < s.size(); i++) {
+	if (s.at(i).isLowSurrogate())
+	    continue;
+	if (n++ == column)
+	    return i;
+    }
+    return s.size();
+}
+
+/**
+ * @brief Return a pointer to the text of line @p li in @p chunk
+ * @param chunk const reference to the chunk
+ * @param li line number in the chunk
+ * @param p_len pointer to an int receiving the number of bytes, without the newline
+ */
+const char* chunk_line(const vtTextIndex::Chunk& chunk, int li, int* p_len)
+{
+    const int offs = chunk.offsets[li];
+    const int next = li + 1 < chunk.offsets.size() ? chunk.offsets[li + 1] : chunk.text.size();
+    *p_len = next - offs - 1;
+    return chunk.text.constData() + offs;
+}
+
+/**
+ * @brief Return the ASCII lower case of @p c
+ */
+inline char fold_ascii(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+/**
+ * @brief Return a pointer to the first match of @p pat starting before @p last
+ *
+ * The text is scanned with memchr() for the first byte of the pattern,
+ * and for its upper case, too, if @p fold is set. The rest of the
+ * pattern is compared only at the hits; the text after @p last must
+ * hold at least the rest of the pattern.
+ * @param p pointer to the first byte to scan
+ * @param last pointer behind the last position a match may start at
+ * @param pat pattern bytes, in lower case if @p fold is set
+ * @param fold true to compare ASCII letters case insensitive
+ * @return pointer to the match, or nullptr if there is none
+ */
+const char* scan_bytes(const char* p, const char* last, const QByteArray& pat, bool fold)
+{
+    if (p >= last)
+	return nullptr;
+    const int plen = pat.size();
+    const char c0 = pat[0];
+    const char c1 = fold && c0 >= 'a' && c0 <= 'z' ? static_cast<char>(c0 - ('a' - 'A')) : c0;
+    auto next = [last](const char* from, char c) {
+	return static_cast<const char*>(std::memchr(from, c, static_cast<size_t>(last - from)));
+    };
+    auto equal = [&pat, plen, fold](const char* s) {
+	if (!fold)
+	    return 0 == std::memcmp(s + 1, pat.constData() + 1, static_cast<size_t>(plen - 1));
+	for (int i = 1; i < plen; i++)
+	    if (fold_ascii(s[i]) != pat[i])
+		return false;
+	return true;
+    };
+    const char* a = next(p, c0);
+    const char* b = c1 != c0 ? next(p, c1) : nullptr;
+    while (a || b) {
+	const bool take_a = a && (!b || a < b);
+	const char* hit = take_a ? a : b;
+	if (equal(hit))
+	    return hit;
+	if (take_a)
+	    a = next(a + 1, c0);
+	else
+	    b = next(b + 1, c1);
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Append the UTF-8 encoding of @p code to @p out
+ */
+void put_utf8(QByteArray& out, uint code)
+{
+    if (code < 0x80) {
+	out.append(static_cast<char>(code));
+    } else if (code < 0x800) {
+	out.append(static_cast<char>(0xc0 | (code >> 6)));
+	out.append(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+	out.append(static_cast<char>(0xe0 | (code >> 12)));
+	out.append(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+	out.append(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+	out.append(static_cast<char>(0xf0 | (code >> 18)));
+	out.append(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+	out.append(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+	out.append(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+}
+
+}
+
+/**
+ * @brief Compile @p pattern for searching with @p flags
+ *
+ * Case sensitive searches for plain text are done on the UTF-8 bytes,
+ * all others with a QRegularExpression.
+ * @param pattern text or regular expression to search for
+ * @param flags FindFlag bits
+ */
+vtTextIndex::Pattern::Pattern(const QString& pattern, int flags)
+    : m_bytes(pattern.toUtf8())
+    , m_regex()
+    , m_flags(flags)
+    , m_ascii(true)
+{
+    for (const char c : qAsConst(m_bytes))
+	if (static_cast<uchar>(c) >= 0x80)
+	    m_ascii = false;
+    if (plain()) {
+	if (fold())
+	    for (char& c : m_bytes)
+		c = fold_ascii(c);
+	return;
+    }
+    m_bytes.clear();
+    QRegularExpression::PatternOptions options = QRegularExpression::UseUnicodePropertiesOption;
+    if (!(flags & Find_CaseSensitive))
+	options |= QRegularExpression::CaseInsensitiveOption;
+    m_regex.setPattern(flags & Find_Regex ? pattern : QRegularExpression::escape(pattern));
+    m_regex.setPatternOptions(options);
+    m_regex.optimize();
+}
+
+/**
+ * @brief Return true, if the pattern compiled
+ */
+bool vtTextIndex::Pattern::isValid() const
+{
+    return plain() || m_regex.isValid();
+}
+
+/**
+ * @brief Return true, if the pattern is empty
+ */
+bool vtTextIndex::Pattern::isEmpty() const
+{
+    return plain() ? m_bytes.isEmpty() : m_regex.pattern().isEmpty();
+}
+
+/**
+ * @brief Return the error message, if the regular expression did not compile
+ */
+QString vtTextIndex::Pattern::error() const
+{
+    return isValid() ? QString() : m_regex.errorString();
+}
+
+/**
+ * @brief Return the FindFlag bits
+ */
+int vtTextIndex::Pattern::flags() const
+{
+    return m_flags;
+}
+
+/**
+ * @brief Return true, if the pattern is searched as plain bytes
+ *
+ * These are the case sensitive searches for text, and the case
+ * insensitive ones for ASCII text.
+ */
+bool vtTextIndex::Pattern::plain() const
+{
+    return !(m_flags & Find_Regex) && ((m_flags & Find_CaseSensitive) || m_ascii);
+}
+
+/**
+ * @brief Return true, if a plain pattern is compared with ASCII case folding
+ */
+bool vtTextIndex::Pattern::fold() const
+{
+    return plain() && !(m_flags & Find_CaseSensitive);
+}
+
+/**
+ * @brief Return the UTF-8 bytes of a plain pattern
+ */
+const QByteArray& vtTextIndex::Pattern::bytes() const
+{
+    return m_bytes;
+}
+
+/**
+ * @brief Match the regular expression in @p line starting at @p from
+ *
+ * Empty matches are skipped.
+ * @param line line of text
+ * @param from UTF-16 offset to start at
+ * @param p_start pointer to an int receiving the UTF-16 offset of the match
+ * @param p_len pointer to an int receiving the UTF-16 length of the match
+ * @return true if there is a match, or false otherwise
+ */
+bool vtTextIndex::Pattern::match(const QString& line, int from, int* p_start, int* p_len) const
+{
+    while (from <= line.size()) {
+	const QRegularExpressionMatch m = m_regex.match(line, from);
+	if (!m.hasMatch())
+	    return false;
+	if (m.capturedLength() > 0) {
+	    *p_start = m.capturedStart();
+	    *p_len = m.capturedLength();
+	    return true;
+	}
+	from = m.capturedStart() + 1;
+    }
+    return false;
+}
+
+vtTextIndex::vtTextIndex()
+    : m_chunks()
+    , m_skip(0)
+    , m_count(0)
+{
+}
+
+/**
+ * @brief Return the number of lines
+ */
+int vtTextIndex::size() const
+{
+    return m_count;
+}
+
+/**
+ * @brief Return true, if there are no lines
+ */
+bool vtTextIndex::isEmpty() const
+{
+    return 0 == m_count;
+}
+
+/**
+ * @brief Remove all lines
+ */
+void vtTextIndex::clear()
+{
+    m_chunks.clear();
+    m_skip = 0;
+    m_count = 0;
+}
+
+/**
+ * @brief Return the text of the line at @p row
+ * @param row row number (0 is the oldest line)
+ * @return QByteArray with the UTF-8 text (not a deep copy)
+ */
+QByteArray vtTextIndex::line(int row) const
+{
+    int len = 0;
+    const char* data = line_data(row, &len);
+    return QByteArray::fromRawData(data, len);
+}
+
+/**
+ * @brief Append the text of @p line
+ * @param line const reference to the vtLine
+ */
+void vtTextIndex::append(const vtLine& line)
+{
+    if (m_chunks.isEmpty() || m_chunks.last().offsets.size() >= chunk_lines)
+	m_chunks.append(Chunk());
+    Chunk& chunk = m_chunks.last();
+    chunk.offsets.append(chunk.text.size());
+    chunk.text += text(line);
+    chunk.text += '\n';
+    m_count++;
+}
+
+/**
+ * @brief Remove the oldest line
+ */
+void vtTextIndex::removeFirst()
+{
+    Q_ASSERT(m_count > 0);
+    m_count--;
+    if (++m_skip >= chunk_lines) {
+	m_chunks.removeFirst();
+	m_skip = 0;
+    }
+}
+
+/**
+ * @brief Remove the most recent line
+ */
+void vtTextIndex::removeLast()
+{
+    Q_ASSERT(m_count > 0);
+    m_count--;
+    Chunk& chunk = m_chunks.last();
+    chunk.text.truncate(chunk.offsets.takeLast());
+    if (chunk.offsets.isEmpty()) {
+	m_chunks.removeLast();
+	if (m_chunks.isEmpty())
+	    m_skip = 0;
+    }
+}
+
+/**
+ * @brief Return the first match at or after @p row, @p column
+ * @param pattern const reference to the compiled Pattern
+ * @param row row to start at
+ * @param column column in @p row to start at
+ * @return vtMatch with the row as line, or an invalid vtMatch
+ */
+vtMatch vtTextIndex::find(const Pattern& pattern, int row, int column) const
+{
+    vtMatch match;
+    if (pattern.isEmpty() || !pattern.isValid())
+	return match;
+    row = qMax(0, row);
+    column = qMax(0, column);
+    if (row >= m_count)
+	return match;
+
+    const int idx = m_skip + row;
+    for (int ci = idx / chunk_lines, li = idx % chunk_lines; ci < m_chunks.size(); ci++, li = 0, column = 0) {
+	if (find_in(pattern, m_chunks.at(ci), li, column, &match)) {
+	    match.line += ci * chunk_lines - m_skip;
+	    return match;
+	}
+    }
+    return vtMatch();
+}
+
+/**
+ * @brief Return the last match before @p row, @p column
+ * @param pattern const reference to the compiled Pattern
+ * @param row row to start at, or size() to search all lines
+ * @param column column in @p row before which a match has to start
+ * @return vtMatch with the row as line, or an invalid vtMatch
+ */
+vtMatch vtTextIndex::find_backward(const Pattern& pattern, int row, int column) const
+{
+    vtMatch match;
+    if (pattern.isEmpty() || !pattern.isValid() || row < 0 || 0 == m_count)
+	return match;
+    if (row >= m_count) {
+	row = m_count - 1;
+	column = INT_MAX;
+    }
+
+    const int idx = m_skip + row;
+    for (int ci = idx / chunk_lines, li = idx % chunk_lines; ci >= 0; ci--, li = chunk_lines - 1, column = INT_MAX) {
+	if (find_backward_in(pattern, m_chunks.at(ci), li, column, &match)) {
+	    match.line += ci * chunk_lines - m_skip;
+	    // a match in a dropped line means there is none in the others
+	    return match.line >= 0 ? match : vtMatch();
+	}
+    }
+    return vtMatch();
+}
+
+/**
+ * @brief Find the first match in @p chunk at or after line @p row, @p column
+ *
+ * Plain patterns are searched in the whole text of the chunk with
+ * memchr() for the first byte of the pattern, regular expressions
+ * line by line.
+ * @param pattern const reference to the compiled Pattern
+ * @param chunk const reference to the Chunk to search
+ * @param row line of the chunk to start at
+ * @param column column in @p row to start at
+ * @param p_match pointer to the vtMatch receiving the line of the chunk, column, and length
+ * @return true if there is a match, or false otherwise
+ */
+bool vtTextIndex::find_in(const Pattern& pattern, const Chunk& chunk, int row, int column, vtMatch* p_match)
+{
+    if (pattern.isEmpty() || row < 0 || row >= chunk.offsets.size())
+	return false;
+
+    if (!pattern.plain()) {
+	for (int li = row; li < chunk.offsets.size(); li++) {
+	    int len = 0;
+	    const char* data = chunk_line(chunk, li, &len);
+	    if (first_match(pattern, QByteArray::fromRawData(data, len), li == row ? column : 0, p_match)) {
+		p_match->line = li;
+		return true;
+	    }
+	}
+	return false;
+    }
+
+    // scan the chunk's text for the first byte of the pattern
+    const QByteArray& pat = pattern.bytes();
+    const int plen = pat.size();
+    const char* base = chunk.text.constData();
+    const char* end = base + chunk.text.size();
+    int len = 0;
+    const char* data = chunk_line(chunk, row, &len);
+    const char* p = scan_bytes(data + byte_of_column(data, len, column), end - plen + 1, pat, pattern.fold());
+    if (!p)
+	return false;
+    const int offs = static_cast<int>(p - base);
+    const int line = static_cast<int>(std::upper_bound(chunk.offsets.constBegin(),
+						       chunk.offsets.constEnd(), offs)
+				      - chunk.offsets.constBegin()) - 1;
+    const int start = chunk.offsets[line];
+    p_match->line = line;
+    p_match->column = columns_in(base + start, offs - start);
+    p_match->length = columns_in(p, plen);
+    return true;
+}
+
+/**
+ * @brief Find the last match in @p chunk before line @p row, @p column
+ * @param pattern const reference to the compiled Pattern
+ * @param chunk const reference to the Chunk to search
+ * @param row line of the chunk to start at; beyond the last line all lines are searched
+ * @param column column in @p row before which a match has to start, or INT_MAX
+ * @param p_match pointer to the vtMatch receiving the line of the chunk, column, and length
+ * @return true if there is a match, or false otherwise
+ */
+bool vtTextIndex::find_backward_in(const Pattern& pattern, const Chunk& chunk, int row, int column, vtMatch* p_match)
+{
+    if (pattern.isEmpty() || row < 0 || chunk.offsets.isEmpty())
+	return false;
+    if (row >= chunk.offsets.size()) {
+	row = chunk.offsets.size() - 1;
+	column = INT_MAX;
+    }
+    for (int li = row; li >= 0; li--) {
+	int len = 0;
+	const char* data = chunk_line(chunk, li, &len);
+	if (last_match(pattern, QByteArray::fromRawData(data, len), li == row ? column : INT_MAX, p_match)) {
+	    p_match->line = li;
+	    return true;
+	}
+    }
+    return false;
+}
+
+/**
+ * @brief Return the text of @p line as UTF-8 without trailing blanks
+ *
+ * Each cell contributes its code, so that the characters of the text
+ * correspond to the columns of the line.
+ * @param line const reference to the vtLine
+ * @return QByteArray with the text
+ */
+QByteArray vtTextIndex::text(const vtLine& line)
+{
+    int n = line.size();
+    const vtCell* cells = line.constData();
+    while (n > 0 && (0x20 == cells[n - 1].code() || 0 == cells[n - 1].code()))
+	n--;
+    QByteArray out;
+    out.reserve(n);
+    for (int x = 0; x < n; x++) {
+	const uint code = cells[x].code();
+	put_utf8(out, code ? code : 0x20);
+    }
+    return out;
+}
+
+/**
+ * @brief Return the text of @p n cell codes as UTF-8 without trailing blanks
+ *
+ * This is the text() of a line which is not available as vtCell.
+ * @param codes pointer to the codes of the cells
+ * @param n number of codes
+ * @return QByteArray with the text
+ */
+QByteArray vtTextIndex::text(const uint* codes, int n)
+{
+    QByteArray out;
+    out.reserve(n);
+    append_text(out, codes, n);
+    return out;
+}
+
+/**
+ * @brief Append the text of @p n cell codes as UTF-8 without trailing blanks to @p out
+ * @param out reference to the QByteArray to append to
+ * @param codes pointer to the codes of the cells
+ * @param n number of codes
+ */
+void vtTextIndex::append_text(QByteArray& out, const uint* codes, int n)
+{
+    while (n > 0 && (0x20 == codes[n - 1] || 0 == codes[n - 1]))
+	n--;
+    for (int x = 0; x < n; x++)
+	put_utf8(out, codes[x] ? codes[x] : 0x20);
+}
+
+/**
+ * @brief Find the first match in the line @p text which starts at or after @p column
+ * @param pattern const reference to the compiled Pattern
+ * @param text const reference to the UTF-8 text of the line, as made by text()
+ * @param column column at which the search starts
+ * @param p_match pointer to the vtMatch to fill in the column and length of
+ * @return true if there is a match, or false otherwise
+ */
+bool vtTextIndex::first_match(const Pattern& pattern, const QByteArray& text, int column, vtMatch* p_match)
+{
+    if (pattern.isEmpty())
+	return false;
+
+    if (!pattern.plain()) {
+	const QString s = QString::fromUtf8(text);
+	int start = 0;
+	int len = 0;
+	if (!pattern.match(s, utf16_of(s, column), &start, &len))
+	    return false;
+	p_match->column = column_of(s, start);
+	p_match->length = column_of(s, start + len) - p_match->column;
+	return true;
+    }
+
+    const QByteArray& pat = pattern.bytes();
+    const int plen = pat.size();
+    const char* data = text.constData();
+    const char* end = data + text.size();
+    const char* p = scan_bytes(data + byte_of_column(data, text.size(), column), end - plen + 1, pat, pattern.fold());
+    if (!p)
+	return false;
+    p_match->column = columns_in(data, static_cast<int>(p - data));
+    p_match->length = columns_in(p, plen);
+    return true;
+}
+
+/**
+ * @brief Return a pointer to the text of the line at @p row
+ * @param row row number
+ * @param p_len pointer to an int receiving the number of bytes, without the newline
+ * @return pointer to the UTF-8 text
+ */
+const char* vtTextIndex::line_data(int row, int* p_len) const
+{
+    Q_ASSERT(row >= 0 && row < m_count);
+    const int idx = m_skip + row;
+    return chunk_line(m_chunks.at(idx / chunk_lines), idx % chunk_lines, p_len);
+}
+
+/**
+ * @brief Find the last match in the line @p text which starts before @p column
+ * @param pattern const reference to the compiled Pattern
+ * @param text const reference to the UTF-8 text of the line, as made by text()
+ * @param column column before which the match has to start, or INT_MAX
+ * @param p_match pointer to the vtMatch to fill in the column and length of
+ * @return true if there is a match, or false otherwise
+ */
+bool vtTextIndex::last_match(const Pattern& pattern, const QByteArray& text, int column, vtMatch* p_match)
+{
+    if (pattern.isEmpty())
+	return false;
+    const char* data = text.constData();
+    const int len = text.size();
+    bool found = false;
+
+    if (!pattern.plain()) {
+	const QString s = QString::fromUtf8(data, len);
+	const int limit = column == INT_MAX ? s.size() : utf16_of(s, column);
+	int from = 0;
+	int start = 0;
+	int mlen = 0;
+	while (from < limit && pattern.match(s, from, &start, &mlen) && start < limit) {
+	    p_match->column = column_of(s, start);
+	    p_match->length = column_of(s, start + mlen) - p_match->column;
+	    found = true;
+	    from = start + 1;
+	}
+	return found;
+    }
+
+    const QByteArray& pat = pattern.bytes();
+    const int plen = pat.size();
+    const char* end = data + (column == INT_MAX ? len : byte_of_column(data, len, column));
+    const char* last = std::min(end, data + len - plen + 1);
+    const char* p = data;
+    while ((p = scan_bytes(p, last, pat, pattern.fold())) != nullptr) {
+	p_match->column = columns_in(data, static_cast<int>(p - data));
+	p_match->length = columns_in(p, plen);
+	found = true;
+	p++;
+    }
+    return found;
+}
@@ -0,0 +1,117 @@
+/*****************************************************************************
+ *
+ *  VT - Virtual Terminal plain text index for searching
+ * Copyright © 2013-2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+#include "vtline.h"
+
+/**
+ * @brief A match of a search in the terminal
+ *
+ * Lines are virtual lines, i.e. the backlog followed by the screen.
+ */
+struct vtMatch {
+    int line = -1;		//!< virtual line of the match, or -1 if there is none
+    int column = 0;		//!< first column of the match
+    int length = 0;		//!< number of columns of the match
+
+    bool isValid() const { return line >= 0; }
+};
+
+/**
+ * @brief The vtTextIndex class keeps a plain text copy of lines for searching
+ *
+ * Each line is stored as UTF-8 without trailing blanks, one character per
+ * cell, in chunks of @ref chunk_lines lines separated by newlines. Plain
+ * searches scan a whole chunk with memchr() for the first byte of the
+ * pattern, which the C library implements with vector instructions, and
+ * compare the rest only at its hits. Case insensitive searches for ASCII
+ * text are plain searches, too: they scan for both cases of the first
+ * byte and compare the rest case folded. Regular expressions and other
+ * case insensitive searches are matched line by line. Dropping the oldest line and appending a line are O(1),
+ * so the index can follow the backlog as lines scroll into it.
+ *
+ * The index only holds the text of lines which are kept as cells. Lines
+ * which are stored compressed elsewhere are extracted a block at a time
+ * into a Chunk and searched with find_in() and find_backward_in().
+ */
+class vtTextIndex
+{
+public:
+    //! Number of lines per chunk
+    static constexpr int chunk_lines = 1024;
+
+    /** @brief Search options */
+    typedef enum {
+	Find_Regex = 1 << 0,		//!< the pattern is a regular expression
+	Find_CaseSensitive = 1 << 1,	//!< distinguish upper and lower case
+	Find_Backward = 1 << 2		//!< search towards the first line
+    }   FindFlag;
+
+    /**
+     * @brief A compiled search pattern
+     */
+    class Pattern
+    {
+    public:
+	Pattern(const QString& pattern, int flags);
+	bool isValid() const;
+	bool isEmpty() const;
+	QString error() const;
+	int flags() const;
+	bool plain() const;
+	bool fold() const;
+	const QByteArray& bytes() const;
+	bool match(const QString& line, int from, int* p_start, int* p_len) const;
+
+    private:
+	QByteArray m_bytes;		//!< UTF-8 pattern for plain searches, lower case if folded
+	QRegularExpression m_regex;	//!< expression for all other searches
+	int m_flags;			//!< FindFlag bits
+	bool m_ascii;			//!< true if the pattern is plain ASCII
+    };
+
+    /** @brief Lines stored in one contiguous text */
+    struct Chunk {
+	QByteArray text;		//!< lines, each followed by a newline
+	QVector<int> offsets;		//!< offset of each line in the text
+    };
+
+    vtTextIndex();
+
+    int size() const;
+    bool isEmpty() const;
+    void clear();
+
+    QByteArray line(int row) const;
+    void append(const vtLine& line);
+    void removeFirst();
+    void removeLast();
+
+    vtMatch find(const Pattern& pattern, int row, int column) const;
+    vtMatch find_backward(const Pattern& pattern, int row, int column) const;
+
+    static QByteArray text(const vtLine& line);
+    static QByteArray text(const uint* codes, int n);
+    static void append_text(QByteArray& out, const uint* codes, int n);
+    static bool find_in(const Pattern& pattern, const Chunk& chunk, int row, int column, vtMatch* p_match);
+    static bool find_backward_in(const Pattern& pattern, const Chunk& chunk, int row, int column, vtMatch* p_match);
+    static bool first_match(const Pattern& pattern, const QByteArray& text, int column, vtMatch* p_match);
+    static bool last_match(const Pattern& pattern, const QByteArray& text, int column, vtMatch* p_match);
+
+private:
+    const char* line_data(int row, int* p_len) const;
+
+    QList<Chunk> m_chunks;		//!< lines, oldest first
+    int m_skip;				//!< number of dropped lines in the first chunk
+    int m_count;			//!< number of lines
+};
@@ -0,0 +1,269 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 low overhead event tracing
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+#include <chrono>
+#include "trace.h"
+
+std::atomic<bool> Trace::s_enabled(false);
+
+namespace {
+
+/**
+ * @brief Events of one thread
+ *
+ * Only the owning thread writes events and advances head. The rings
+ * are never freed, so the events of finished threads can be exported.
+ */
+struct Ring {
+    Ring(int id, const QString& name)
+	: events(Trace::ring_size)
+	, data(events.data())
+	, head(0)
+	, tail(0)
+	, tid(id)
+	, thread_name(name)
+    {}
+    QVector<Trace::Event> events;	//!< events; size is a power of 2
+    Trace::Event* data;			//!< events.data(), to store without detach checks
+    std::atomic<quint64> head;		//!< total events recorded
+    quint64 tail;			//!< head at the last clear()
+    int tid;				//!< thread id for the export
+    QString thread_name;		//!< thread name for the export
+};
+
+QMutex& rings_mutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QList<Ring*>& rings()
+{
+    static QList<Ring*> list;
+    return list;
+}
+
+thread_local Ring* t_ring = nullptr;
+
+/**
+ * @brief Return the ring of the calling thread, creating it on first use
+ */
+Ring* thread_ring()
+{
+    if (t_ring)
+	return t_ring;
+    QString name;
+    QThread* thread = QThread::currentThread();
+    if (thread)
+	name = thread->objectName();
+    if (name.isEmpty()) {
+	const QCoreApplication* app = QCoreApplication::instance();
+	name = (app && thread == app->thread())
+	       ? QStringLiteral("main")
+	       : QStringLiteral("thread");
+    }
+    QMutexLocker lock(&rings_mutex());
+    t_ring = new Ring(rings().size() + 1, name);
+    rings().append(t_ring);
+    return t_ring;
+}
+
+/**
+ * @brief Append @p str to @p json as a JSON string
+ */
+void append_string(QByteArray& json, const char* str)
+{
+    json += '"';
+    for (const char* s = str; s && *s; s++) {
+	const uchar ch = static_cast<uchar>(*s);
+	switch (ch) {
+	case '"':
+	    json += "\\\"";
+	    break;
+	case '\\':
+	    json += "\\\\";
+	    break;
+	case '\n':
+	    json += "\\n";
+	    break;
+	default:
+	    if (ch < 0x20) {
+		json += QByteArray("\\u00") + QByteArray::number(ch, 16).rightJustified(2, '0');
+	    } else {
+		json += static_cast<char>(ch);
+	    }
+	}
+    }
+    json += '"';
+}
+
+/**
+ * @brief Append the nanoseconds @p ns to @p json as microseconds
+ */
+void append_usecs(QByteArray& json, qint64 ns)
+{
+    json += QByteArray::number(ns / 1000);
+    json += '.';
+    json += QByteArray::number(ns % 1000).rightJustified(3, '0');
+}
+
+}
+
+/**
+ * @brief Switch tracing on or off
+ *
+ * Switching it on discards the events recorded so far.
+ * @param on if true, start recording events
+ */
+void Trace::set_enabled(bool on)
+{
+    if (on && !enabled())
+	clear();
+    s_enabled.store(on, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Return a monotonic time stamp in nanoseconds
+ */
+qint64 Trace::now_ns()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Record a complete event from @p start to @p end
+ *
+ * This is for spans which do not map to a C++ scope, such as an
+ * asynchronous build or upload.
+ * @param name static name of the event
+ * @param start now_ns() at the start
+ * @param end now_ns() at the end
+ */
+void Trace::complete(const char* name, qint64 start, qint64 end)
+{
+    if (enabled())
+	record(name, start, qMax(Q_INT64_C(0), end - start));
+}
+
+/**
+ * @brief Record an instant event now
+ * @param name static name of the event
+ */
+void Trace::instant(const char* name)
+{
+    if (enabled())
+	record(name, now_ns(), -1);
+}
+
+/**
+ * @brief Discard the events of all threads
+ */
+void Trace::clear()
+{
+    QMutexLocker lock(&rings_mutex());
+    foreach(Ring* ring, rings())
+	ring->tail = ring->head.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Write the events of all threads to @p filename in the Chrome trace format
+ * @param filename name of the JSON file to write
+ * @param p_error optional pointer to a QString receiving an error message
+ * @return true on success, false on error
+ */
+bool Trace::write_chrome_json(const QString& filename, QString* p_error)
+{
+    QByteArray json;
+    json += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    const qint64 pid = QCoreApplication::applicationPid();
+    bool first = true;
+    qint64 base = -1;
+
+    QMutexLocker lock(&rings_mutex());
+    // the earliest event is time zero
+    foreach(const Ring* ring, rings()) {
+	const quint64 head = ring->head.load(std::memory_order_acquire);
+	const quint64 tail = qMax(ring->tail, head > ring_size ? head - ring_size : 0);
+	for (quint64 i = tail; i < head; i++) {
+	    const qint64 start = ring->data[i & (ring_size - 1)].start;
+	    base = base < 0 ? start : qMin(base, start);
+	}
+    }
+
+    foreach(const Ring* ring, rings()) {
+	const quint64 head = ring->head.load(std::memory_order_acquire);
+	const quint64 tail = qMax(ring->tail, head > ring_size ? head - ring_size : 0);
+	if (!first)
+	    json += ",\n";
+	first = false;
+	json += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":";
+	json += QByteArray::number(pid);
+	json += ",\"tid\":";
+	json += QByteArray::number(ring->tid);
+	json += ",\"args\":{\"name\":";
+	append_string(json, ring->thread_name.toUtf8().constData());
+	json += "}}";
+
+	for (quint64 i = tail; i < head; i++) {
+	    const Event& ev = ring->data[i & (ring_size - 1)];
+	    json += ",\n{\"name\":";
+	    append_string(json, ev.name);
+	    if (ev.duration < 0) {
+		json += ",\"ph\":\"i\",\"s\":\"t\"";
+	    } else {
+		json += ",\"ph\":\"X\",\"dur\":";
+		append_usecs(json, ev.duration);
+	    }
+	    json += ",\"ts\":";
+	    append_usecs(json, qMax(Q_INT64_C(0), ev.start - base));
+	    json += ",\"pid\":";
+	    json += QByteArray::number(pid);
+	    json += ",\"tid\":";
+	    json += QByteArray::number(ring->tid);
+	    json += '}';
+	}
+    }
+    lock.unlock();
+    json += "\n]}\n";
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly) ||
+	file.write(json) != json.size() ||
+	!file.commit()) {
+	if (p_error)
+	    *p_error = QCoreApplication::translate("Trace", "Could not write trace file '%1': %2")
+		       .arg(QFileInfo(filename).fileName())
+		       .arg(file.errorString());
+	return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Store an event in the ring of the calling thread
+ */
+void Trace::record(const char* name, qint64 start, qint64 duration)
+{
+    Ring* ring = thread_ring();
+    const quint64 head = ring->head.load(std::memory_order_relaxed);
+    Event& ev = ring->data[head & (ring_size - 1)];
+    ev.start = start;
+    ev.duration = duration;
+    ev.name = name;
+    ring->head.store(head + 1, std::memory_order_release);
+}
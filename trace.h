@@ -0,0 +1,94 @@
+/*****************************************************************************
+ *
+ * Qt5 Propeller 2 low overhead event tracing
+ *
+ * Copyright © 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ *****************************************************************************/
+#pragma once
+#include <QtGlobal>
+#include <QString>
+#include <atomic>
+
+/**
+ * @brief Records timed events in per-thread rings, to be viewed as a Chrome trace
+ *
+ * Tracing is switched on and off at runtime with set_enabled(). While it
+ * is off, a TRACE_SCOPE costs one relaxed atomic load. While it is on,
+ * recording an event stores a few words into a ring owned by the calling
+ * thread, without locks or string formatting; the names must be string
+ * literals or otherwise outlive the trace. Each ring keeps the most recent
+ * ring_size events of its thread.
+ *
+ * write_chrome_json() exports all rings in the Trace Event Format, which
+ * chrome://tracing and Perfetto load directly. Export while tracing
+ * is off, or events being recorded at that moment may be garbled.
+ */
+class Trace
+{
+public:
+    //! Number of events kept per thread
+    static constexpr int ring_size = 1 << 16;
+
+    /**
+     * @brief One recorded event
+     */
+    struct Event {
+	qint64 start;		//!< now_ns() at the start
+	qint64 duration;	//!< duration in ns, or -1 for instant events
+	const char* name;	//!< static name of the event
+    };
+
+    /**
+     * @brief Records the lifetime of the scope as a complete event
+     */
+    class Scope
+    {
+    public:
+	explicit Scope(const char* name)
+	    : m_name(name)
+	    , m_start(Trace::enabled() ? Trace::now_ns() : 0)
+	{}
+	~Scope()
+	{
+	    if (m_start)
+		Trace::complete(m_name, m_start, Trace::now_ns());
+	}
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+    private:
+	const char* m_name;	//!< static name of the event
+	qint64 m_start;		//!< now_ns() at the start, or 0 if tracing was off
+    };
+
+    /**
+     * @brief Return true, if tracing is enabled
+     */
+    static bool enabled()
+    {
+	return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static void set_enabled(bool on);
+    static qint64 now_ns();
+    static void complete(const char* name, qint64 start, qint64 end);
+    static void instant(const char* name);
+    static void clear();
+    static bool write_chrome_json(const QString& filename, QString* p_error = nullptr);
+
+private:
+    static std::atomic<bool> s_enabled;	//!< true while tracing
+
+    static void record(const char* name, qint64 start, qint64 duration);
+};
+
+#define	TRACE_CAT2(a,b)	a##b
+#define	TRACE_CAT(a,b)	TRACE_CAT2(a,b)
+
+//! Record the rest of the enclosing scope as an event named @p name
+#define	TRACE_SCOPE(name) Trace::Scope TRACE_CAT(_trace_scope_, __LINE__)(name)
+
+//! Record an instant event named @p name
+#define	TRACE_MARK(name) do { if (Trace::enabled()) Trace::instant(name); } while (0)
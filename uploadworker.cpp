@@ -0,0 +1,192 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 upload worker for multiple serial ports
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#include <QThread>
+#include <QTimer>
+#include "uploadworker.h"
+
+UploadWorker::UploadWorker(int row, const QString& port_name, const Options& options,
+			   const QByteArray& binary, QObject* parent)
+    : QObject(parent)
+    , m_row(row)
+    , m_port_name(port_name)
+    , m_options(options)
+    , m_binary(binary)
+    , m_port(nullptr)
+    , m_propload(nullptr)
+    , m_capture(nullptr)
+    , m_captured(0)
+    , m_checksum(0)
+{
+}
+
+/**
+ * @brief Open the port, reset the Prop, and start the upload
+ *
+ * This must run in the worker's thread, so it is invoked queued.
+ */
+void UploadWorker::start()
+{
+    m_port = new QSerialPort(m_port_name, this);
+    if (!m_port->open(QIODevice::ReadWrite)) {
+	emit Error(m_row, tr("Could not open device %1: %2")
+		   .arg(m_port_name)
+		   .arg(m_port->errorString()));
+	emit Finished(m_row, false, 0);
+	return;
+    }
+    m_port->setBaudRate(m_options.baud_rate);
+    m_port->setDataBits(m_options.data_bits);
+    m_port->setParity(m_options.parity);
+    m_port->setStopBits(m_options.stop_bits);
+    m_port->setFlowControl(m_options.flow_control);
+
+    // Reset the Prop by pulsing DTR low
+    m_port->setDataTerminalReady(false);
+    QThread::msleep(10);
+    m_port->setDataTerminalReady(true);
+    QThread::msleep(10);
+    m_port->readAll();
+
+    m_propload = new PropLoad(m_port, this);
+    m_propload->set_mode(m_options.mode);
+    m_propload->set_clock_freq(m_options.clock_freq);
+    m_propload->set_clock_mode(m_options.clock_mode);
+    m_propload->set_user_baud(static_cast<quint32>(m_options.baud_rate));
+    m_propload->set_fast_baud(m_options.upload_baud_rate);
+    m_propload->set_stage2_loader(m_options.stage2);
+
+    bool ok;
+    ok = connect(m_propload, &PropLoad::Error,
+		 this, &UploadWorker::propload_error);
+    Q_ASSERT(ok);
+    ok = connect(m_propload, &PropLoad::Message,
+		 this, &UploadWorker::propload_message);
+    Q_ASSERT(ok);
+    ok = connect(m_propload, &PropLoad::Progress,
+		 this, &UploadWorker::propload_progress);
+    Q_ASSERT(ok);
+    ok = connect(m_propload, &PropLoad::Finished,
+		 this, &UploadWorker::propload_finished);
+    Q_ASSERT(ok);
+
+    if (!m_propload->load_data(m_binary))
+	propload_finished(false);
+}
+
+/**
+ * @brief Abort a running upload
+ */
+void UploadWorker::abort()
+{
+    if (m_propload)
+	m_propload->abort();
+}
+
+void UploadWorker::propload_error(const QString& text)
+{
+    emit Error(m_row, text);
+}
+
+void UploadWorker::propload_message(const QString& text)
+{
+    emit Message(m_row, text);
+}
+
+void UploadWorker::propload_progress(qint64 value, qint64 total)
+{
+    emit Progress(m_row, value, total);
+}
+
+/**
+ * @brief The upload on this port is done: capture the output or release the port
+ * @param ok true on success
+ */
+void UploadWorker::propload_finished(bool ok)
+{
+    const quint32 checksum = m_propload ? m_propload->checksum() : 0;
+    if (m_propload) {
+	m_propload->deleteLater();
+	m_propload = nullptr;
+    }
+    if (ok && m_port && m_options.capture_msecs > 0) {
+	m_checksum = checksum;
+	if (start_capture())
+	    return;
+	ok = false;
+    }
+    release_port();
+    emit Finished(m_row, ok, checksum);
+}
+
+/**
+ * @brief Open the capture file and collect the output for capture_msecs
+ * @return true if capturing, or false if the file could not be opened
+ */
+bool UploadWorker::start_capture()
+{
+    m_capture = new QFile(m_options.capture_file, this);
+    const bool opened = m_options.capture_file.isEmpty()
+			? m_capture->open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered)
+			: m_capture->open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (!opened) {
+	emit Error(m_row, tr("Could not open capture file %1: %2")
+		   .arg(m_options.capture_file)
+		   .arg(m_capture->errorString()));
+	delete m_capture;
+	m_capture = nullptr;
+	return false;
+    }
+    m_captured = 0;
+    bool ok;
+    ok = connect(m_port, &QSerialPort::readyRead,
+		 this, &UploadWorker::capture_ready_read);
+    Q_ASSERT(ok);
+    QTimer::singleShot(m_options.capture_msecs, this, &UploadWorker::capture_finished);
+    // the Prop may have answered before the connection was made
+    capture_ready_read();
+    return true;
+}
+
+void UploadWorker::capture_ready_read()
+{
+    if (!m_capture || !m_port)
+	return;
+    const QByteArray data = m_port->readAll();
+    m_capture->write(data);
+    m_captured += data.size();
+}
+
+/**
+ * @brief The capture time expired: close the file and release the port
+ */
+void UploadWorker::capture_finished()
+{
+    capture_ready_read();
+    if (m_capture) {
+	m_capture->close();
+	delete m_capture;
+	m_capture = nullptr;
+    }
+    emit Message(m_row, tr("Captured %1 bytes of output.").arg(m_captured));
+    release_port();
+    emit Finished(m_row, true, m_checksum);
+}
+
+/**
+ * @brief Close and release the serial port
+ */
+void UploadWorker::release_port()
+{
+    if (m_port) {
+	m_port->close();
+	m_port->deleteLater();
+	m_port = nullptr;
+    }
+}
@@ -0,0 +1,81 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 upload worker for multiple serial ports
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QSerialPort>
+#include "propload.h"
+
+/**
+ * @brief Uploads an image to a P2 on one serial port
+ *
+ * The worker is moved to a thread of the multi-board upload pool.
+ * It opens its own QSerialPort in that thread, resets the Prop,
+ * and runs a PropLoad whose signals are forwarded with the row
+ * of the port in the caller's table.
+ *
+ * If a capture time is set, the output of the Prop is written to a
+ * file for that long after a successful upload, before Finished().
+ */
+class UploadWorker : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options {
+	qint32 baud_rate;
+	QSerialPort::DataBits data_bits;
+	QSerialPort::Parity parity;
+	QSerialPort::StopBits stop_bits;
+	QSerialPort::FlowControl flow_control;
+	quint32 upload_baud_rate;
+	quint32 clock_freq;
+	quint32 clock_mode;
+	PropLoad::PropLoadMode mode;
+	QByteArray stage2;
+	QString capture_file;	//!< file for the output after the upload, or empty for stdout
+	int capture_msecs = 0;	//!< milliseconds to capture the output, or 0 for none
+    };
+
+    UploadWorker(int row, const QString& port_name, const Options& options,
+		 const QByteArray& binary, QObject* parent = nullptr);
+
+public slots:
+    void start();
+    void abort();
+
+signals:
+    void Progress(int row, qint64 value, qint64 total);
+    void Error(int row, const QString& text);
+    void Message(int row, const QString& text);
+    void Finished(int row, bool ok, quint32 checksum);
+
+private slots:
+    void propload_error(const QString& text);
+    void propload_message(const QString& text);
+    void propload_progress(qint64 value, qint64 total);
+    void propload_finished(bool ok);
+    void capture_ready_read();
+    void capture_finished();
+
+private:
+    int m_row;			//!< row of the port in the caller's table
+    QString m_port_name;	//!< serial port device name
+    Options m_options;		//!< serial port and upload options
+    QByteArray m_binary;	//!< image to upload
+    QSerialPort* m_port;	//!< serial port owned by this worker's thread
+    PropLoad* m_propload;	//!< loader running on m_port
+    QFile* m_capture;		//!< file receiving the output, while capturing
+    qint64 m_captured;		//!< number of bytes captured
+    quint32 m_checksum;		//!< checksum of the upload, while capturing
+
+    bool start_capture();
+    void release_port();
+};
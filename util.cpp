@@ -7,8 +7,19 @@
  * See the file LICENSE for the details of the BSD-3-Clause terms.
  *
  *****************************************************************************/
+#include <cstring>
+#include <QtEndian>
 #include "util.h"
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define	UTIL_X86_SIMD	1	//!< x86 kernels selected at runtime via cpuid
+#define	UTIL_TARGET(t)	__attribute__((target(t)))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define	UTIL_NEON_SIMD	1	//!< AArch64 NEON kernels
+#endif
+
 static const QMultiMap<FileType,QString> g_filetype_to_suffix = {
     {FT_UNKNOWN, QLatin1String("*")},
     {FT_BASIC, QLatin1String("BAS")},
@@ -173,4 +184,388 @@ quint32 Util::get_le32(const QByteArray& data, int offs)
     return (b0 <<  0) | (b1 <<  8) | (b2 << 16) | (b3 << 24);
 }
 
+/**
+ * @brief Read a 32 bit little endian value from an unaligned pointer
+ */
+static inline quint32 load_le32(const uchar* p)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    quint32 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+#else
+    return qFromLittleEndian<quint32>(p);
+#endif
+}
+
+/**
+ * @brief Scalar tail of sum_le32(): sum words, zero padding a partial one
+ */
+static quint32 sum_le32_scalar(const uchar* src, int size)
+{
+    quint32 sum = 0;
+    int i = 0;
+    for (; i + 4 <= size; i += 4)
+	sum += load_le32(src + i);
+    if (i < size) {
+	uchar last[4] = {0, 0, 0, 0};
+	memcpy(last, src + i, static_cast<size_t>(size - i));
+	sum += load_le32(last);
+    }
+    return sum;
+}
+
+static const char g_base64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789+/";
+
+static const char g_hex_digits[] = "0123456789abcdef";
+
+/**
+ * @brief Scalar base64 encoder without trailing '=' padding
+ */
+static int base64_scalar(char* dst, const uchar* src, int size)
+{
+    char* out = dst;
+    int i = 0;
+    for (; i + 3 <= size; i += 3) {
+	const quint32 v = static_cast<quint32>(src[i] << 16) |
+			  static_cast<quint32>(src[i+1] << 8) |
+			  static_cast<quint32>(src[i+2]);
+	*out++ = g_base64_alphabet[(v >> 18) & 63];
+	*out++ = g_base64_alphabet[(v >> 12) & 63];
+	*out++ = g_base64_alphabet[(v >>  6) & 63];
+	*out++ = g_base64_alphabet[(v >>  0) & 63];
+    }
+    switch (size - i) {
+    case 1:
+	*out++ = g_base64_alphabet[src[i] >> 2];
+	*out++ = g_base64_alphabet[(src[i] & 3) << 4];
+	break;
+    case 2:
+	*out++ = g_base64_alphabet[src[i] >> 2];
+	*out++ = g_base64_alphabet[((src[i] & 3) << 4) | (src[i+1] >> 4)];
+	*out++ = g_base64_alphabet[(src[i+1] & 15) << 2];
+	break;
+    }
+    return static_cast<int>(out - dst);
+}
+
+/**
+ * @brief Scalar spaced hex encoder
+ */
+static int hex_scalar(char* dst, const uchar* src, int size)
+{
+    char* out = dst;
+    for (int i = 0; i < size; i++) {
+	if (i > 0)
+	    *out++ = ' ';
+	*out++ = g_hex_digits[src[i] >> 4];
+	*out++ = g_hex_digits[src[i] & 15];
+    }
+    return static_cast<int>(out - dst);
+}
+
+#if defined(UTIL_X86_SIMD)
+/**
+ * @brief SSE2 32 bit little endian sum, 16 bytes per step
+ */
+UTIL_TARGET("sse2")
+static quint32 sum_le32_sse2(const uchar* src, int size)
+{
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= size; i += 16)
+	acc = _mm_add_epi32(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<quint32>(_mm_cvtsi128_si32(acc)) + sum_le32_scalar(src + i, size - i);
+}
+
+/**
+ * @brief AVX2 32 bit little endian sum, 32 bytes per step
+ */
+UTIL_TARGET("avx2")
+static quint32 sum_le32_avx2(const uchar* src, int size)
+{
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= size; i += 32)
+	acc = _mm256_add_epi32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<quint32>(_mm_cvtsi128_si32(sum)) + sum_le32_scalar(src + i, size - i);
+}
+
+/**
+ * @brief SSSE3 base64 encoder, 12 bytes to 16 characters per step
+ *
+ * This is Wojciech Muła's pshufb method: the 12 bytes are spread over
+ * the 16 lanes, the four 6 bit fields of each 24 bit group are moved
+ * in place with two multiplies, and the indices are translated to
+ * ASCII with a 16 entry offset table.
+ * The loop loads 16 bytes, so it stops while 16 bytes remain.
+ */
+UTIL_TARGET("ssse3")
+static int base64_ssse3(char* dst, const uchar* src, int size)
+{
+    const __m128i shuf = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i mask0 = _mm_set1_epi32(0x0fc0fc00);
+    const __m128i mul0 = _mm_set1_epi32(0x04000040);
+    const __m128i mask1 = _mm_set1_epi32(0x003f03f0);
+    const __m128i mul1 = _mm_set1_epi32(0x01000010);
+    const __m128i shift_lut = _mm_setr_epi8('a' - 26,
+					    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+					    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+					    '+' - 62, '/' - 63, 'A', 0, 0);
+    char* out = dst;
+    int i = 0;
+    for (; i + 16 <= size; i += 12) {
+	__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+	in = _mm_shuffle_epi8(in, shuf);
+	const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, mask0), mul0);
+	const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, mask1), mul1);
+	const __m128i idx = _mm_or_si128(t0, t1);
+	// 0..25 -> 13, 26..51 -> 0, 52..63 -> 1..12
+	__m128i lut = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+	const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+	lut = _mm_or_si128(lut, _mm_and_si128(less, _mm_set1_epi8(13)));
+	const __m128i ascii = _mm_add_epi8(_mm_shuffle_epi8(shift_lut, lut), idx);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out), ascii);
+	out += 16;
+    }
+    out += base64_scalar(out, src + i, size - i);
+    return static_cast<int>(out - dst);
+}
+
+/**
+ * @brief SSSE3 spaced hex encoder, 16 bytes to 48 characters per step
+ *
+ * The nibbles are translated with pshufb, interleaved to digit pairs,
+ * and spread into "hh " triples with three more shuffles per 16 output
+ * characters. The loop only runs while more than 16 bytes remain, so
+ * the space after each group is always followed by another digit pair.
+ */
+UTIL_TARGET("ssse3")
+static int hex_ssse3(char* dst, const uchar* src, int size)
+{
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g_hex_digits));
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i a0 = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+    const __m128i a1 = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4, 5);
+    const __m128i b2 = _mm_setr_epi8(-1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15, -1);
+    const __m128i s0 = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+    const __m128i s1 = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0);
+    const __m128i s2 = _mm_setr_epi8(' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ');
+    char* out = dst;
+    int i = 0;
+    for (; i + 16 < size; i += 16) {
+	const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+	const __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+	const __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(in, nibble));
+	const __m128i pa = _mm_unpacklo_epi8(hi, lo);	// pairs of bytes 0..7
+	const __m128i pb = _mm_unpackhi_epi8(hi, lo);	// pairs of bytes 8..15
+	const __m128i o0 = _mm_or_si128(_mm_shuffle_epi8(pa, a0), s0);
+	const __m128i o1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(pa, a1),
+						     _mm_shuffle_epi8(pb, b1)), s1);
+	const __m128i o2 = _mm_or_si128(_mm_shuffle_epi8(pb, b2), s2);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out +  0), o0);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), o1);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), o2);
+	out += 48;
+    }
+    out += hex_scalar(out, src + i, size - i);
+    return static_cast<int>(out - dst);
+}
+#endif
+
+#if defined(UTIL_NEON_SIMD)
+/**
+ * @brief NEON 32 bit little endian sum, 16 bytes per step
+ */
+static quint32 sum_le32_neon(const uchar* src, int size)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    uint32x4_t acc = vdupq_n_u32(0);
+    int i = 0;
+    for (; i + 16 <= size; i += 16)
+	acc = vaddq_u32(acc, vreinterpretq_u32_u8(vld1q_u8(src + i)));
+    return vaddvq_u32(acc) + sum_le32_scalar(src + i, size - i);
+#else
+    return sum_le32_scalar(src, size);
+#endif
+}
+
+/**
+ * @brief NEON base64 encoder, 48 bytes to 64 characters per step
+ */
+static int base64_neon(char* dst, const uchar* src, int size)
+{
+    const uint8_t* alphabet = reinterpret_cast<const uint8_t*>(g_base64_alphabet);
+    uint8x16x4_t lut;
+    lut.val[0] = vld1q_u8(alphabet +  0);
+    lut.val[1] = vld1q_u8(alphabet + 16);
+    lut.val[2] = vld1q_u8(alphabet + 32);
+    lut.val[3] = vld1q_u8(alphabet + 48);
+    const uint8x16_t m6 = vdupq_n_u8(0x3f);
+    char* out = dst;
+    int i = 0;
+    for (; i + 48 <= size; i += 48) {
+	const uint8x16x3_t in = vld3q_u8(src + i);
+	uint8x16x4_t idx;
+	idx.val[0] = vshrq_n_u8(in.val[0], 2);
+	idx.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), m6);
+	idx.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), m6);
+	idx.val[3] = vandq_u8(in.val[2], m6);
+	uint8x16x4_t ascii;
+	ascii.val[0] = vqtbl4q_u8(lut, idx.val[0]);
+	ascii.val[1] = vqtbl4q_u8(lut, idx.val[1]);
+	ascii.val[2] = vqtbl4q_u8(lut, idx.val[2]);
+	ascii.val[3] = vqtbl4q_u8(lut, idx.val[3]);
+	vst4q_u8(reinterpret_cast<uint8_t*>(out), ascii);
+	out += 64;
+    }
+    out += base64_scalar(out, src + i, size - i);
+    return static_cast<int>(out - dst);
+}
+
+/**
+ * @brief NEON spaced hex encoder, 16 bytes to 48 characters per step
+ */
+static int hex_neon(char* dst, const uchar* src, int size)
+{
+    const uint8x16_t digits = vld1q_u8(reinterpret_cast<const uint8_t*>(g_hex_digits));
+    const uint8x16_t nibble = vdupq_n_u8(0x0f);
+    char* out = dst;
+    int i = 0;
+    for (; i + 16 < size; i += 16) {
+	const uint8x16_t in = vld1q_u8(src + i);
+	uint8x16x3_t triple;
+	triple.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(in, 4));
+	triple.val[1] = vqtbl1q_u8(digits, vandq_u8(in, nibble));
+	triple.val[2] = vdupq_n_u8(' ');
+	vst3q_u8(reinterpret_cast<uint8_t*>(out), triple);
+	out += 48;
+    }
+    out += hex_scalar(out, src + i, size - i);
+    return static_cast<int>(out - dst);
+}
+#endif
+
+typedef quint32 (*sum_le32_fn)(const uchar* src, int size);
+typedef int (*encode_fn)(char* dst, const uchar* src, int size);
+
+/**
+ * @brief Kernels selected once for the CPU we are running on
+ */
+struct UtilKernels {
+    UtilKernels()
+	: sum_le32(sum_le32_scalar)
+	, base64(base64_scalar)
+	, hex(hex_scalar)
+    {
+#if defined(UTIL_X86_SIMD)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+	    sum_le32 = sum_le32_sse2;
+	if (__builtin_cpu_supports("avx2"))
+	    sum_le32 = sum_le32_avx2;
+	if (__builtin_cpu_supports("ssse3")) {
+	    base64 = base64_ssse3;
+	    hex = hex_ssse3;
+	}
+#elif defined(UTIL_NEON_SIMD)
+	sum_le32 = sum_le32_neon;
+	base64 = base64_neon;
+	hex = hex_neon;
+#endif
+    }
+    sum_le32_fn sum_le32;
+    encode_fn base64;
+    encode_fn hex;
+};
+
+static const UtilKernels& kernels()
+{
+    static const UtilKernels k;
+    return k;
+}
+
+/**
+ * @brief Sum the 32 bit little endian words in @p src
+ *
+ * A trailing partial word is zero padded, just like get_le32() does.
+ *
+ * @param src pointer to the data
+ * @param size number of bytes
+ * @return sum of the words modulo 2^32
+ */
+quint32 Util::sum_le32(const uchar* src, int size)
+{
+    return kernels().sum_le32(src, size);
+}
+
+/**
+ * @brief Sum the 32 bit little endian words in @p data
+ * @param data const reference to the byte array
+ * @return sum of the words modulo 2^32
+ */
+quint32 Util::sum_le32(const QByteArray& data)
+{
+    return sum_le32(reinterpret_cast<const uchar*>(data.constData()), data.size());
+}
+
+/**
+ * @brief Encode @p size bytes as base64 without trailing '=' padding
+ *
+ * The output is identical to QByteArray::toBase64(QByteArray::OmitTrailingEquals).
+ *
+ * @param dst pointer to the output buffer of base64_size() characters
+ * @param src pointer to the bytes to encode
+ * @param size number of bytes
+ * @return number of characters written
+ */
+int Util::encode_base64(char* dst, const uchar* src, int size)
+{
+    return kernels().base64(dst, src, size);
+}
+
+/**
+ * @brief Encode @p size bytes as lower case hex pairs separated by spaces
+ *
+ * The output is identical to QByteArray::toHex(' ').
+ *
+ * @param dst pointer to the output buffer of hex_size() characters
+ * @param src pointer to the bytes to encode
+ * @param size number of bytes
+ * @return number of characters written
+ */
+int Util::encode_hex(char* dst, const uchar* src, int size)
+{
+    return kernels().hex(dst, src, size);
+}
+
+/**
+ * @brief Return the number of characters encode_base64() writes
+ * @param size number of bytes
+ * @return number of characters
+ */
+int Util::base64_size(int size)
+{
+    return (4 * size + 2) / 3;
+}
+
+/**
+ * @brief Return the number of characters encode_hex() writes
+ * @param size number of bytes
+ * @return number of characters
+ */
+int Util::hex_size(int size)
+{
+    return size > 0 ? 3 * size - 1 : 0;
+}
+
 Util util;
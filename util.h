@@ -46,6 +46,13 @@ public:
 
     static void put_le32(QByteArray& data, int offs, quint32 value);
     static quint32 get_le32(const QByteArray& data, int offs);
+
+    static quint32 sum_le32(const uchar* src, int size);
+    static quint32 sum_le32(const QByteArray& data);
+    static int encode_base64(char* dst, const uchar* src, int size);
+    static int encode_hex(char* dst, const uchar* src, int size);
+    static int base64_size(int size);
+    static int hex_size(int size);
 };
 
 extern Util util;
@@ -0,0 +1,83 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 hex dump model
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#include <QFontMetrics>
+#include "hexdumpmodel.h"
+
+HexDumpModel::HexDumpModel(const QByteArray& data, QObject* parent, int bytes_per_line)
+    : QAbstractListModel(parent)
+    , m_data(data)
+    , m_bytes_per_line(qMax(1, bytes_per_line))
+    , m_digits(4)
+    , m_size_hint()
+{
+    // widen the offsets for images larger than 64KiB
+    for (qint64 max = 0x10000; m_data.size() > max; max <<= 4)
+	m_digits++;
+}
+
+/**
+ * @brief Set the font the rows are shown in
+ *
+ * The rows all have the same width, which is reported as their size hint,
+ * so that a view with uniform item sizes never has to measure them.
+ * @param font const reference to the (fixed pitch) QFont of the view
+ */
+void HexDumpModel::set_font(const QFont& font)
+{
+    const QFontMetrics fm(font);
+    m_size_hint = QSize(fm.horizontalAdvance(row_text(0) + QChar::Space), fm.height());
+}
+
+int HexDumpModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+	return 0;
+    return (m_data.size() + m_bytes_per_line - 1) / m_bytes_per_line;
+}
+
+QVariant HexDumpModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+	return QVariant();
+    switch (role) {
+    case Qt::DisplayRole:
+	return row_text(index.row());
+    case Qt::SizeHintRole:
+	if (m_size_hint.isValid())
+	    return m_size_hint;
+	break;
+    }
+    return QVariant();
+}
+
+/**
+ * @brief Format the hex dump of @p row
+ * @param row row number
+ * @return QString with offset, hex bytes, and ASCII
+ */
+QString HexDumpModel::row_text(int row) const
+{
+    const int offs = row * m_bytes_per_line;
+    const int len = qBound(0, m_data.size() - offs, m_bytes_per_line);
+    const uchar* src = reinterpret_cast<const uchar*>(m_data.constData()) + offs;
+    static const char hex[] = "0123456789abcdef";
+    QString bytes(3 * m_bytes_per_line, QChar::Space);
+    QString ascii(len, QChar::Space);
+    for (int i = 0; i < len; i++) {
+	const uchar ch = src[i];
+	bytes[3*i+0] = QChar(hex[ch >> 4]);
+	bytes[3*i+1] = QChar(hex[ch & 15]);
+	ascii[i] = ch < 32 || ch > 126 ? QChar(L'·') : QChar(ch);
+    }
+    return QString("%1: %2 - %3")
+	    .arg(offs, m_digits, 16, QChar('0'))
+	    .arg(bytes)
+	    .arg(ascii);
+}
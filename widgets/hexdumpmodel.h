@@ -0,0 +1,40 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 hex dump model
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#pragma once
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QFont>
+
+/**
+ * @brief The HexDumpModel class shows binary data as rows of a hex dump
+ *
+ * Each row is formatted from the raw data only when a view asks for it,
+ * in the same layout as Util::dump(), so opening a view of a large image
+ * costs nothing beyond the rows on screen.
+ */
+class HexDumpModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit HexDumpModel(const QByteArray& data, QObject* parent = nullptr,
+			  int bytes_per_line = 16);
+
+    void set_font(const QFont& font);
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    QByteArray m_data;		//!< data to dump
+    int m_bytes_per_line;	//!< number of bytes per row
+    int m_digits;		//!< number of hex digits of the offsets
+    QSize m_size_hint;		//!< size of every row in the font of the view
+
+    QString row_text(int row) const;
+};
@@ -9,9 +9,13 @@
  ***************************************************************************************/
 #include <QCryptographicHash>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QPair>
 #include <QTextStream>
+#include <QVector>
 #include "idstrings.h"
+#include "fileloader.h"
 #include "propedit.h"
 #include "propconst.h"
 #include "util.h"
@@ -25,9 +29,18 @@ PropEdit::PropEdit(QWidget *parent,
     , m_highlighter(nullptr)
     , m_tabsize(tabsize)
     , m_options(options)
-    , m_error_lines()
+    , m_diagnostics(0)
+    , m_loading(false)
+    , m_fill_text()
+    , m_fill_pos(0)
+    , m_fill_timer()
 {
     setWordWrapMode(QTextOption::NoWrap);
+    m_fill_timer.setInterval(0);
+    bool ok = connect(&m_fill_timer, &QTimer::timeout,
+		      this, &PropEdit::fill_chunk);
+    Q_ASSERT(ok);
+
     if (m_options.testFlag(PropEdit::PE_USE_LINENUMBERS)) {
 	m_lineno_area = new LineNumberArea(this, css_linearea);
 
@@ -43,6 +56,8 @@ PropEdit::PropEdit(QWidget *parent,
 
     if (m_options.testFlag(PE_DO_HIGHLIGHT)) {
 	m_highlighter = new PropHighlighter(document(), m_options);
+	connect(this, &PropEdit::updateRequest,
+		this, &PropEdit::update_visible_blocks);
 	highlight_current_line();
     }
     setFont(font());
@@ -71,13 +86,64 @@ void PropEdit::prepend_rule(HighlightingRule rule)
 }
 
 /**
- * @brief Set a list of line numbers to indicate as lines containing errors
- * @param list of line numbers
+ * @brief Remove the markers of all compiler diagnostics
+ */
+void PropEdit::clear_diagnostics()
+{
+    if (0 == m_diagnostics)
+	return;
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next())
+	if (block.userData())
+	    block.setUserData(nullptr);
+    m_diagnostics = 0;
+    if (m_lineno_area)
+	m_lineno_area->update();
+}
+
+/**
+ * @brief Mark line @p lnum with a compiler diagnostic
+ *
+ * Several diagnostics for the same line are combined, keeping the
+ * highest severity.
+ * @param lnum line number (1 based)
+ * @param severity Severity of the diagnostic
+ * @param message text of the diagnostic
  */
-void PropEdit::set_error_line_list(const QList<int>& list)
+void PropEdit::add_diagnostic(int lnum, Severity severity, const QString& message)
 {
-    m_error_lines = list;
-    update();
+    QTextBlock block = document()->findBlockByNumber(lnum - 1);
+    if (!block.isValid())
+	return;
+    DiagnosticData* data = static_cast<DiagnosticData*>(block.userData());
+    if (data) {
+	data->severity = qMax(data->severity, severity);
+	data->message += QChar::LineFeed + message;
+    } else {
+	block.setUserData(new DiagnosticData(severity, message));
+	m_diagnostics++;
+    }
+    if (m_lineno_area)
+	m_lineno_area->update();
+}
+
+/**
+ * @brief Return the number of lines marked with diagnostics
+ */
+int PropEdit::diagnostics() const
+{
+    return m_diagnostics;
+}
+
+/**
+ * @brief Return the diagnostics of line @p lnum
+ * @param lnum line number (1 based)
+ * @return QString with the messages, or an empty string if there are none
+ */
+QString PropEdit::diagnostic(int lnum) const
+{
+    const QTextBlock block = document()->findBlockByNumber(lnum - 1);
+    const DiagnosticData* data = static_cast<const DiagnosticData*>(block.userData());
+    return data ? data->message : QString();
 }
 
 /**
@@ -86,6 +152,8 @@ void PropEdit::set_error_line_list(const QList<int>& list)
  */
 bool PropEdit::changed() const
 {
+    if (m_loading)
+	return false;
     QString text = QPlainTextEdit::toPlainText();
     QCryptographicHash sha256(QCryptographicHash::Sha256);
     sha256.addData(text.toUtf8());
@@ -94,6 +162,14 @@ bool PropEdit::changed() const
     return old_hash != new_hash;
 }
 
+/**
+ * @brief Return true, while the text of the file is being loaded
+ */
+bool PropEdit::loading() const
+{
+    return m_loading;
+}
+
 /**
  * @brief Return the plain text
  * @return QString with text
@@ -141,11 +217,15 @@ void PropEdit::setText(const QString& text)
     if (old_hash == new_hash)
 	return;
     setProperty(prop_sha256, new_hash);
-    delete m_highlighter;
-    m_highlighter = nullptr;
+    if (m_highlighter) {
+	// large texts get the visible lines highlighted first, and the rest when idle
+	const bool lazy = m_options.testFlag(PE_LAZY_HIGHLIGHT) &&
+			  text.count(QChar('\n')) >= lazy_line_count;
+	m_highlighter->set_lazy(lazy);
+    }
     setPlainText(text);
-    if (m_options.testFlag(PE_DO_HIGHLIGHT)) {
-	m_highlighter = new PropHighlighter(document(), m_options);
+    if (m_highlighter) {
+	update_visible_blocks();
 	highlight_current_line();
     }
 }
@@ -168,27 +248,169 @@ void PropEdit::gotoLineNumber(int lnum)
     highlight_current_line();
 }
 
+/**
+ * @brief Move the cursor to the next line with a diagnostic
+ * @return line number (1 based), or 0 if there is none
+ */
+int PropEdit::goto_next_diagnostic()
+{
+    return goto_diagnostic(false);
+}
+
+/**
+ * @brief Move the cursor to the previous line with a diagnostic
+ * @return line number (1 based), or 0 if there is none
+ */
+int PropEdit::goto_previous_diagnostic()
+{
+    return goto_diagnostic(true);
+}
+
+/**
+ * @brief Move the cursor to the next line with a diagnostic in either direction
+ *
+ * The search starts at the line after (or before) the cursor and wraps
+ * around at the end (or start) of the document.
+ * @param backward if true, search towards the start of the document
+ * @return line number (1 based), or 0 if there is none
+ */
+int PropEdit::goto_diagnostic(bool backward)
+{
+    if (0 == m_diagnostics)
+	return 0;
+    const QTextBlock start = textCursor().block();
+    QTextBlock block = start;
+    do {
+	block = backward ? block.previous() : block.next();
+	if (!block.isValid())
+	    block = backward ? document()->lastBlock() : document()->firstBlock();
+	if (block.userData()) {
+	    const int lnum = block.blockNumber() + 1;
+	    QTextCursor cursor(block);
+	    setTextCursor(cursor);
+	    centerCursor();
+	    setFocus();
+	    highlight_current_line();
+	    return lnum;
+	}
+    } while (block != start);
+    return 0;
+}
+
+/**
+ * @brief Load the file @p filename, or reload the current file
+ *
+ * The file is read on the caller's thread. To keep the window responsive
+ * with large files, use set_loading() and read the file with a FileLoader.
+ * @param filename name of the file, or empty for the current file
+ * @return true on success, false on error
+ */
 bool PropEdit::load(const QString& filename)
 {
     QString load_filename = filename.isEmpty() ? property(prop_filename).toString() : filename;
     QFileInfo info(load_filename);
-    QFile file(info.absoluteFilePath());
-    if (file.open(QIODevice::ReadOnly)) {
-	QTextStream str(&file);
-	str.setCodec("UTF-8");
-	QString text = str.readAll();
-	file.close();
-	setProperty(prop_filename, info.absoluteFilePath());
-	FileType filetype = util.filetype(filename);
-	setProperty(prop_filetype, filetype);
-	setText(text);
-	return true;
+    QString text;
+    QByteArray sha256;
+    if (!FileLoader::read(info.absoluteFilePath(), &text, &sha256))
+	return false;
+    set_loading(info.absoluteFilePath());
+    set_loaded_text(text, sha256);
+    return true;
+}
+
+/**
+ * @brief Show the editor for @p filename in the loading state
+ *
+ * The document is empty and read-only until set_loaded_text() filled it
+ * with the text of the file. While loading, changed() is false and save()
+ * fails, because the document does not hold the file's text yet.
+ * @param filename name of the file being loaded
+ */
+void PropEdit::set_loading(const QString& filename)
+{
+    m_fill_timer.stop();
+    m_fill_text.clear();
+    if (m_highlighter)
+	m_highlighter->set_filling(false);
+    m_loading = true;
+    setFilename(QFileInfo(filename).absoluteFilePath());
+    clear();
+    setReadOnly(true);
+    setPlaceholderText(tr("Loading %1 …").arg(QFileInfo(filename).fileName()));
+}
+
+/**
+ * @brief Fill the document with the loaded @p text
+ *
+ * The text is inserted in chunks of @ref fill_chunk_chars characters
+ * with the event loop running in between, so that the first page is
+ * shown and the window stays responsive while large files are inserted.
+ * Loaded() is emitted when the document is complete.
+ * @param text const reference to the text of the file
+ * @param sha256 SHA-256 hash of the text encoded as UTF-8
+ */
+void PropEdit::set_loaded_text(const QString& text, const QByteArray& sha256)
+{
+    setProperty(prop_sha256, sha256);
+    if (m_highlighter) {
+	const bool lazy = m_options.testFlag(PE_LAZY_HIGHLIGHT) &&
+			  text.count(QChar('\n')) >= lazy_line_count;
+	m_highlighter->set_lazy(lazy);
+	m_highlighter->set_filling(true);
     }
-    return false;
+    m_loading = true;
+    clear();
+    document()->setUndoRedoEnabled(false);
+    m_fill_text = text;
+    m_fill_pos = 0;
+    fill_chunk();
+    if (m_loading)
+	m_fill_timer.start();
+}
+
+/**
+ * @brief Insert the next chunk of the loaded text into the document
+ *
+ * Chunks end at a line feed, if there is one, so that no block is
+ * laid out twice.
+ */
+void PropEdit::fill_chunk()
+{
+    int len = m_fill_text.size() - m_fill_pos;
+    if (len > fill_chunk_chars) {
+	const int lf = m_fill_text.indexOf(QChar::LineFeed, m_fill_pos + fill_chunk_chars);
+	len = lf < 0 ? len : lf + 1 - m_fill_pos;
+    }
+    if (len > 0) {
+	QTextCursor cursor(document());
+	cursor.movePosition(QTextCursor::End);
+	cursor.insertText(m_fill_text.mid(m_fill_pos, len));
+	m_fill_pos += len;
+    }
+    if (m_fill_pos < m_fill_text.size())
+	return;
+
+    m_fill_timer.stop();
+    m_fill_text.clear();
+    m_fill_pos = 0;
+    m_loading = false;
+    document()->setUndoRedoEnabled(true);
+    document()->setModified(false);
+    setPlaceholderText(QString());
+    setReadOnly(false);
+    setTextCursor(QTextCursor(document()));
+    if (m_highlighter) {
+	m_highlighter->set_filling(false);
+	update_visible_blocks();
+	highlight_current_line();
+    }
+    emit Loaded();
 }
 
 bool PropEdit::save(const QString& filename)
 {
+    if (m_loading)
+	return false;
     QString save_filename = filename.isEmpty() ?
 			   property(prop_filename).toString() :
 			   filename;
@@ -259,6 +481,18 @@ void PropEdit::update_line_number_area(const QRect &rect, int dy)
 	update_line_number_area_width(0);
 }
 
+/**
+ * @brief Tell a lazy highlighter which blocks are visible
+ */
+void PropEdit::update_visible_blocks()
+{
+    if (!m_highlighter || !m_highlighter->is_lazy())
+	return;
+    const int first = firstVisibleBlock().blockNumber();
+    const int rows = viewport()->height() / qMax(1, fontMetrics().lineSpacing()) + 1;
+    m_highlighter->set_visible_blocks(first, first + rows);
+}
+
 /**
  * @brief Resize event for the line number area
  * @param e pointer to the QResizeEvent
@@ -266,6 +500,7 @@ void PropEdit::update_line_number_area(const QRect &rect, int dy)
 void PropEdit::resizeEvent(QResizeEvent *e)
 {
     QPlainTextEdit::resizeEvent(e);
+    update_visible_blocks();
 
     if (!m_lineno_area)
 	return;
@@ -375,8 +610,10 @@ void PropEdit::line_number_area_paint_event(QPaintEvent *event)
 
 	    QString number = QString::number(blockNumber + 1);
 
-	    if (m_error_lines.contains(blockNumber + 1)) {
-		painter.fillRect(0, top, m_lineno_area->width(), fontMetrics().height(), Qt::red);
+	    const DiagnosticData* data = static_cast<const DiagnosticData*>(block.userData());
+	    if (data) {
+		const QRgb color = Diag_Error == data->severity ? color_error_line : color_warning_line;
+		painter.fillRect(0, top, m_lineno_area->width(), fontMetrics().height(), QColor(color));
 	    }
 
 	    painter.drawText(0, top,
@@ -393,6 +630,49 @@ void PropEdit::line_number_area_paint_event(QPaintEvent *event)
 
 }
 
+/**
+ * @brief Classes of the tokens, built once from the token lists
+ */
+struct PropHighlighter::Lexicon {
+    QVector<TokenClass> classes;	//!< class per PropToken
+    int max_symbol = 0;			//!< length of the longest operator made of punctuation
+};
+
+/**
+ * @brief Return the lexicon shared by all highlighters
+ *
+ * Names are looked up with CPropTokens::token(), which returns the first
+ * of several tokens with the same name, so the class is set for that one.
+ * If a name is in several lists, the later one wins, just like the later
+ * regular expression rules used to override the earlier ones.
+ */
+const PropHighlighter::Lexicon& PropHighlighter::lexicon()
+{
+    static const Lexicon lex = [] {
+	Lexicon result;
+	result.classes.fill(TC_none, TOK_);
+	const QList<QPair<const QList<PropToken>*,TokenClass>> groups = {
+	    {&g_sections, TC_section},
+	    {&g_operator, TC_operator},
+	    {&g_keywords, TC_keyword},
+	    {&g_conditionals, TC_conditional},
+	    {&g_preproc, TC_preproc},
+	};
+	for (const auto& group : groups) {
+	    foreach(const PropToken t, *group.first) {
+		const QString name = g_tokens.name(t);
+		if (name.isEmpty())
+		    continue;
+		result.classes[g_tokens.token(name)] = group.second;
+		if (TC_operator == group.second && !name.at(0).isLetter() && name.at(0) != QChar('_'))
+		    result.max_symbol = qMax(result.max_symbol, name.length());
+	    }
+	}
+	return result;
+    }();
+    return lex;
+}
+
 /**
  * @brief prop_highlighter constructor
  * @param doc pointer to the QTextDocument to highlight
@@ -401,160 +681,85 @@ void PropEdit::line_number_area_paint_event(QPaintEvent *event)
 PropHighlighter::PropHighlighter(QTextDocument *doc, PropEdit::Options options)
     : QSyntaxHighlighter(doc)
     , m_options(options)
+    , highlightingRules()
+    , m_lazy(false)
+    , m_filling(false)
+    , m_done(0)
+    , m_visible_first(0)
+    , m_visible_last(-1)
+    , m_idle_timer()
 {
-    // Enable Multi-Line Comments ?
-    // Starting with "{" or multiple "{{", ending with "}" or multiple "}}"
-    if (options.testFlag(PropEdit::PE_USE_MULTI_LINE_COMMENTS)) {
-	HighlightingRule rule;
-	multiLineCommentFormat.setBackground(QColor(color_background));
-	multiLineCommentFormat.setForeground(QColor(color_comment));
-	commentStartExpression = QRegExp(QString("%1+").arg(QRegExp::escape("{")));
-	rule.pattern = commentStartExpression;
-	rule.format = multiLineCommentFormat;
-	highlightingRules.append(rule);
-	commentEndExpression = QRegExp(QString("%1+").arg(QRegExp::escape("}")));
+    m_idle_timer.setInterval(0);
+    bool ok;
+    ok = connect(&m_idle_timer, &QTimer::timeout,
+		 this, &PropHighlighter::idle_chunk);
+    Q_ASSERT(ok);
+    if (doc) {
+	ok = connect(doc, &QTextDocument::contentsChange,
+		     this, &PropHighlighter::contents_change);
+	Q_ASSERT(ok);
     }
 
-    // Enable In-Line Comments ? enclosed in "{" and "}"
-    if (m_options.testFlag(PropEdit::PE_USE_IN_LINE_COMMENTS)) {
-	HighlightingRule rule;
-	inLineCommentFormat.setBackground(QColor(color_background));
-	inLineCommentFormat.setForeground(QColor(color_comment));
-	rule.pattern = QRegExp(QString("%1[^}]*%2")
-			       .arg(QRegExp::escape("{"))
-			       .arg(QRegExp::escape("}")));
-	rule.format = inLineCommentFormat;
-	highlightingRules.append(rule);
-    }
+    // Multi-Line Comments starting with "{" or multiple "{{", ending with "}" or multiple "}}"
+    multiLineCommentFormat.setBackground(QColor(color_background));
+    multiLineCommentFormat.setForeground(QColor(color_comment));
 
-    // Highlight section names ?
-    if (m_options.testFlag(PropEdit::PE_USE_SECTIONS)) {
-	HighlightingRule rule;
-	QStringList sections = g_tokens.list(g_sections);
-	sectionsFormat.setFontUnderline(true);
-	sectionsFormat.setBackground(QColor(color_background));
-	sectionsFormat.setForeground(QColor(color_section));
-	rule.pattern = QRegExp(QString("^(%1)")
-			       .arg(sections.join(QChar('|'))));
-	rule.format = sectionsFormat;
-	highlightingRules.append(rule);
-    }
+    // In-Line Comments enclosed in "{" and "}"
+    inLineCommentFormat.setBackground(QColor(color_background));
+    inLineCommentFormat.setForeground(QColor(color_comment));
 
-    // Highlight operators?
-    if (m_options.testFlag(PropEdit::PE_USE_OPERATORS)) {
-	HighlightingRule rule;
-	operatorFormat.setBackground(QColor(color_background));
-	operatorFormat.setForeground(QColor(color_operator));
-	operatorFormat.setFontWeight(QFont::Bold);
-	QStringList patterns = g_tokens.list_esc(g_operator);
-	rule.pattern = QRegExp(QString("(%1)")
-			       .arg(patterns.join(QChar('|'))),
-			       Qt::CaseInsensitive);
-	rule.format = operatorFormat;
-	highlightingRules.append(rule);
-    }
+    // Section names at the start of a line
+    sectionsFormat.setFontUnderline(true);
+    sectionsFormat.setBackground(QColor(color_background));
+    sectionsFormat.setForeground(QColor(color_section));
 
-    // Highlight decimal constants?
-    if (m_options.testFlag(PropEdit::PE_USE_DEC)) {
-	HighlightingRule rule;
-	decFormat.setBackground(QColor(color_background));
-	decFormat.setForeground(QColor(color_dec));
-	rule.pattern = QRegExp(QString("\\W[0-9_]+\\b"));
-	rule.format = decFormat;
-	highlightingRules.append(rule);
-    }
+    // Operators
+    operatorFormat.setBackground(QColor(color_background));
+    operatorFormat.setForeground(QColor(color_operator));
+    operatorFormat.setFontWeight(QFont::Bold);
 
-    // Highlight binary constants?
-    if (m_options.testFlag(PropEdit::PE_USE_BIN)) {
-	HighlightingRule rule;
-	binFormat.setBackground(QColor(color_background));
-	binFormat.setForeground(QColor(color_bin));
-	rule.pattern = QRegExp(QString("\\W\\%[0-1_]+\\b"));
-	rule.format = binFormat;
-	highlightingRules.append(rule);
-    }
+    // Decimal constants
+    decFormat.setBackground(QColor(color_background));
+    decFormat.setForeground(QColor(color_dec));
 
-    // Highlight hexadecimal constants?
-    if (m_options.testFlag(PropEdit::PE_USE_HEX)) {
-	HighlightingRule rule;
-	hexFormat.setBackground(QColor(color_background));
-	hexFormat.setForeground(QColor(color_hex));
-	rule.pattern = QRegExp(QString("\\W\\$[0-9A-Fa-f_]+"));
-	rule.format = hexFormat;
-	highlightingRules.append(rule);
-    }
+    // Binary constants
+    binFormat.setBackground(QColor(color_background));
+    binFormat.setForeground(QColor(color_bin));
 
-    // Highlight float constants?
-    if (m_options.testFlag(PropEdit::PE_USE_FLOAT)) {
-	HighlightingRule rule;
-	fltFormat.setBackground(QColor(color_background));
-	fltFormat.setForeground(QColor(color_flt));
-	rule.pattern = QRegExp(QString("\\W[0-9]+\\.[0-9]*"));
-	rule.format = fltFormat;
-	highlightingRules.append(rule);
-    }
+    // Hexadecimal constants
+    hexFormat.setBackground(QColor(color_background));
+    hexFormat.setForeground(QColor(color_hex));
 
-    // Highlight string constants in double quotes?
-    if (m_options.testFlag(PropEdit::PE_USE_STRING)) {
-	HighlightingRule rule;
-	strFormat.setBackground(QColor(color_background));
-	strFormat.setForeground(QColor(color_str));
-	rule.pattern = QRegExp(QLatin1String("\"([^\\\"]|\\\\.)*\""));
-	rule.format = strFormat;
-	highlightingRules.append(rule);
-    }
+    // Float constants
+    fltFormat.setBackground(QColor(color_background));
+    fltFormat.setForeground(QColor(color_flt));
 
-    // Highlight keywords (reserved names)?
+    // String constants in double quotes
+    strFormat.setBackground(QColor(color_background));
+    strFormat.setForeground(QColor(color_str));
+
+    // Keywords (reserved names)
     // i.e. BYTE, WORD, LONG, ORG, ORG, ORGF, RES, FIT, ...
-    if (m_options.testFlag(PropEdit::PE_USE_KEYWORDS)) {
-	HighlightingRule rule;
-	keywordFormat.setFontWeight(QFont::ExtraBold);
-	keywordFormat.setBackground(QColor(color_background));
-	keywordFormat.setForeground(QColor(color_keyword));
-	QStringList patterns = g_tokens.list_esc(g_keywords);
-	rule.pattern = QRegExp(QString("\\b(%1)\\b")
-			       .arg(patterns.join(QChar('|'))),
-			       Qt::CaseInsensitive);
-	rule.format = keywordFormat;
-	highlightingRules.append(rule);
-    }
+    keywordFormat.setFontWeight(QFont::ExtraBold);
+    keywordFormat.setBackground(QColor(color_background));
+    keywordFormat.setForeground(QColor(color_keyword));
 
-    // Highlight conditionals ?
+    // Conditionals
     // i.e. IF_NZ, IF_C, ...
-    if (m_options.testFlag(PropEdit::PE_USE_CONDITIONALS)) {
-	HighlightingRule rule;
-	conditionalFormat.setBackground(QColor(color_background));
-	conditionalFormat.setForeground(QColor(color_conditional));
-	QStringList patterns = g_tokens.list_esc(g_conditionals);
-	rule.pattern = QRegExp(QString("\\b(%1)\\b")
-			       .arg(patterns.join(QChar('|'))),
-			       Qt::CaseInsensitive);
-	rule.format = conditionalFormat;
-	highlightingRules.append(rule);
-    }
+    conditionalFormat.setBackground(QColor(color_background));
+    conditionalFormat.setForeground(QColor(color_conditional));
 
-    // Highlight preprocessor statements
+    // Preprocessor statements
     // i.e. #define, #undef, #if, #ifdef, #else, ...
-    if (m_options.testFlag(PropEdit::PE_USE_PREPROC)) {
-	HighlightingRule rule;
-	preprocFormat.setBackground(QColor(color_background));
-	preprocFormat.setForeground(QColor(color_preproc));
-	QStringList patterns = g_tokens.list_esc(g_preproc);
-	rule.pattern = QRegExp(QString("(^|\\b)(%1)\\b")
-			       .arg(patterns.join(QChar('|'))));
-	rule.format = preprocFormat;
-	highlightingRules.append(rule);
-    }
+    preprocFormat.setBackground(QColor(color_background));
+    preprocFormat.setForeground(QColor(color_preproc));
 
-    // Enable until-end-of-line Comments ? (starting with ')
-    if (m_options.testFlag(PropEdit::PE_USE_SINGLE_LINE_COMMENTS)) {
-	HighlightingRule rule;
-	singleLineCommentFormat.setBackground(QColor(color_background));
-	singleLineCommentFormat.setForeground(QColor(color_comment));
-	rule.pattern = QRegExp("'[^\n]*");
-	rule.format = singleLineCommentFormat;
-	highlightingRules.append(rule);
-    }
+    // Until-end-of-line Comments (starting with ')
+    singleLineCommentFormat.setBackground(QColor(color_background));
+    singleLineCommentFormat.setForeground(QColor(color_comment));
+
+    // build the lexicon now rather than when the first block is highlighted
+    lexicon();
 }
 
 QBrush PropHighlighter::background()
@@ -565,51 +770,387 @@ QBrush PropHighlighter::background()
 // ------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------
 
+/**
+ * @brief Return the format for a name of class @p tc, if enabled
+ * @param tc token class of the name
+ * @param first true if the name starts the line
+ * @return pointer to the QTextCharFormat, or nullptr if not highlighted
+ */
+const QTextCharFormat* PropHighlighter::class_format(TokenClass tc, bool first) const
+{
+    switch (tc) {
+    case TC_none:
+	break;
+    case TC_section:
+	if (first && m_options.testFlag(PropEdit::PE_USE_SECTIONS))
+	    return &sectionsFormat;
+	break;
+    case TC_keyword:
+	if (m_options.testFlag(PropEdit::PE_USE_KEYWORDS))
+	    return &keywordFormat;
+	break;
+    case TC_conditional:
+	if (m_options.testFlag(PropEdit::PE_USE_CONDITIONALS))
+	    return &conditionalFormat;
+	break;
+    case TC_operator:
+	if (m_options.testFlag(PropEdit::PE_USE_OPERATORS))
+	    return &operatorFormat;
+	break;
+    case TC_preproc:
+	if (m_options.testFlag(PropEdit::PE_USE_PREPROC))
+	    return &preprocFormat;
+	break;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Return the index after the run of '}' ending a comment in @p text
+ * @param text const reference to the QString with the text
+ * @param from index to start searching at
+ * @return index after the comment, or -1 if it does not end in @p text
+ */
+int PropHighlighter::comment_end(const QString& text, int from)
+{
+    int end = text.indexOf(QChar('}'), from);
+    if (end < 0)
+	return -1;
+    while (end < text.length() && text.at(end) == QChar('}'))
+	end++;
+    return end;
+}
+
+static inline bool is_word(QChar ch)
+{
+    return ch.isLetterOrNumber() || ch == QChar('_');
+}
+
+static inline bool is_hex(QChar ch)
+{
+    return (ch >= QChar('0') && ch <= QChar('9')) ||
+	    (ch >= QChar('a') && ch <= QChar('f')) ||
+	    (ch >= QChar('A') && ch <= QChar('F')) ||
+	    ch == QChar('_');
+}
+
+/**
+ * @brief Scan a block of text and format its tokens
+ *
+ * The text is scanned once from left to right. Comments and strings
+ * are skipped as a whole, names are looked up in the lexicon, and
+ * operators are matched longest first. Without @p format, only the
+ * comments and strings are scanned to find the state at the end of
+ * the block, which is much cheaper and yields the same state.
+ * @param text const reference to the QString with the text to scan
+ * @param state state at the end of the previous block (1 inside a multi-line comment)
+ * @param format if true, set the formats, otherwise only compute the state
+ * @return state at the end of the block
+ */
+int PropHighlighter::tokenize(const QString& text, int state, bool format)
+{
+    const Lexicon& lex = lexicon();
+    const bool multi_line = m_options.testFlag(PropEdit::PE_USE_MULTI_LINE_COMMENTS);
+    const bool in_line = m_options.testFlag(PropEdit::PE_USE_IN_LINE_COMMENTS);
+    const int length = text.length();
+    int pos = 0;
+
+    // Continue a multi-line comment from the previous block
+    if (multi_line && 1 == state) {
+	const int end = comment_end(text, 0);
+	if (end < 0) {
+	    if (format)
+		setFormat(0, length, multiLineCommentFormat);
+	    return 1;
+	}
+	if (format)
+	    setFormat(0, end, multiLineCommentFormat);
+	pos = end;
+    }
+
+    while (pos < length) {
+	const QChar ch = text.at(pos);
+	const int start = pos;
+
+	if (ch == QChar('{') && (multi_line || in_line)) {
+	    const int end = comment_end(text, pos + 1);
+	    if (end >= 0) {
+		if (format)
+		    setFormat(start, end - start, in_line ? inLineCommentFormat : multiLineCommentFormat);
+		pos = end;
+		continue;
+	    }
+	    if (multi_line) {
+		if (format)
+		    setFormat(start, length - start, multiLineCommentFormat);
+		return 1;
+	    }
+	    pos++;
+	    continue;
+	}
+
+	if (ch == QChar('\'') && m_options.testFlag(PropEdit::PE_USE_SINGLE_LINE_COMMENTS)) {
+	    if (format)
+		setFormat(start, length - start, singleLineCommentFormat);
+	    return 0;
+	}
+
+	if (ch == QChar('"') && m_options.testFlag(PropEdit::PE_USE_STRING)) {
+	    pos++;
+	    while (pos < length && text.at(pos) != QChar('"'))
+		pos += text.at(pos) == QChar('\\') ? 2 : 1;
+	    pos = qMin(pos + 1, length);
+	    if (format)
+		setFormat(start, pos - start, strFormat);
+	    continue;
+	}
+
+	if (!format) {
+	    // no other token contains a '{', '\'', or '"'
+	    pos++;
+	    continue;
+	}
+
+	if (ch.isLetter() || ch == QChar('_')) {
+	    while (pos < length && is_word(text.at(pos)))
+		pos++;
+	    const PropToken t = g_tokens.token(text.constData() + start, pos - start);
+	    const QTextCharFormat* fmt = class_format(lex.classes[t], 0 == start);
+	    if (fmt)
+		setFormat(start, pos - start, *fmt);
+	    continue;
+	}
+
+	if (ch.isDigit()) {
+	    while (pos < length && (text.at(pos).isDigit() || text.at(pos) == QChar('_')))
+		pos++;
+	    const QTextCharFormat* fmt = m_options.testFlag(PropEdit::PE_USE_DEC) ? &decFormat : nullptr;
+	    if (pos < length && text.at(pos) == QChar('.') &&
+		!(pos + 1 < length && text.at(pos + 1) == QChar('.'))) {
+		// a float, but not the start of a range (1..5)
+		pos++;
+		while (pos < length && text.at(pos).isDigit())
+		    pos++;
+		fmt = m_options.testFlag(PropEdit::PE_USE_FLOAT) ? &fltFormat : nullptr;
+	    }
+	    if (pos < length && is_word(text.at(pos))) {
+		// not a number, but e.g. 0x12 or 4th
+		while (pos < length && is_word(text.at(pos)))
+		    pos++;
+		continue;
+	    }
+	    if (fmt)
+		setFormat(start, pos - start, *fmt);
+	    continue;
+	}
+
+	if (ch == QChar('%') && pos + 1 < length &&
+	    (text.at(pos + 1) == QChar('0') || text.at(pos + 1) == QChar('1')) &&
+	    m_options.testFlag(PropEdit::PE_USE_BIN)) {
+	    pos++;
+	    while (pos < length && (text.at(pos) == QChar('0') ||
+				    text.at(pos) == QChar('1') ||
+				    text.at(pos) == QChar('_')))
+		pos++;
+	    setFormat(start, pos - start, binFormat);
+	    continue;
+	}
+
+	if (ch == QChar('$') && pos + 1 < length && is_hex(text.at(pos + 1)) &&
+	    m_options.testFlag(PropEdit::PE_USE_HEX)) {
+	    pos++;
+	    while (pos < length && is_hex(text.at(pos)))
+		pos++;
+	    setFormat(start, pos - start, hexFormat);
+	    continue;
+	}
+
+	if (ch == QChar('#') && pos + 1 < length && text.at(pos + 1).isLetter()) {
+	    pos++;
+	    while (pos < length && is_word(text.at(pos)))
+		pos++;
+	    const PropToken t = g_tokens.token(text.constData() + start, pos - start);
+	    if (TC_preproc == lex.classes[t]) {
+		if (const QTextCharFormat* fmt = class_format(TC_preproc, 0 == start))
+		    setFormat(start, pos - start, *fmt);
+		continue;
+	    }
+	    // treat the '#' as an operator character, e.g. #>
+	    pos = start;
+	}
+
+	// Operators, longest match first
+	int len = qMin(lex.max_symbol, length - pos);
+	while (len > 0 && TC_operator != lex.classes[g_tokens.token(text.constData() + pos, len)])
+	    len--;
+	if (len > 0) {
+	    if (const QTextCharFormat* fmt = class_format(TC_operator, 0 == start))
+		setFormat(start, len, *fmt);
+	    pos += len;
+	    continue;
+	}
+	pos++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Return true, if the block @p number is to be formatted now
+ *
+ * Outside of the lazy mode all blocks are. In the lazy mode these are
+ * the blocks done by the idle time chunks and the visible ones.
+ * @param number block number
+ */
+bool PropHighlighter::formatting(int number) const
+{
+    if (!m_lazy)
+	return true;
+    return number < m_done || (number >= m_visible_first && number <= m_visible_last);
+}
+
 /**
  * @brief Highlight a block of text
  * @param text const reference to the QString with the text to highlight
  */
 void PropHighlighter::highlightBlock(const QString &text)
 {
-    foreach (const HighlightingRule &rule, highlightingRules) {
-
-	QRegExp expression(rule.pattern);
-	int index = expression.indexIn(text);
+    const bool format = formatting(currentBlock().blockNumber());
+    setCurrentBlockState(tokenize(text, previousBlockState(), format));
+    if (!format)
+	return;
 
+    // Additional rules
+    for (HighlightingRule& rule : highlightingRules) {
+	int index = rule.pattern.indexIn(text);
 	while (index >= 0) {
-	    const int length = expression.matchedLength();
-	    setFormat(index, length, rule.format);
-	    index = expression.indexIn(text, index + length);
+	    const int matched = rule.pattern.matchedLength();
+	    setFormat(index, matched, rule.format);
+	    index = rule.pattern.indexIn(text, index + qMax(1, matched));
 	}
+    }
+}
 
+/**
+ * @brief Enable or disable the lazy mode
+ *
+ * In the lazy mode, a (re)highlight of the document formats only the
+ * visible blocks and computes the comment state of the others. The
+ * remaining blocks are then formatted in chunks from the top while
+ * the application is idle.
+ * @param on true to enable the lazy mode
+ */
+void PropHighlighter::set_lazy(bool on)
+{
+    m_lazy = on;
+    m_done = 0;
+    m_visible_first = 0;
+    m_visible_last = -1;
+    if (m_lazy) {
+	m_idle_timer.start();
+    } else {
+	m_idle_timer.stop();
     }
+}
 
-    setCurrentBlockState(0);
+/**
+ * @brief Return true, if the lazy mode is still formatting blocks
+ */
+bool PropHighlighter::is_lazy() const
+{
+    return m_lazy;
+}
 
-    // Multi-Line Comments supported ?
-    if (m_options.testFlag(PropEdit::PE_USE_MULTI_LINE_COMMENTS)) {
+/**
+ * @brief Tell the highlighter whether the document is being filled in chunks
+ *
+ * While it is, the lazy mode stays on when the idle time chunks reach
+ * the end of the document, so the chunks inserted later are formatted
+ * lazily as well. The idle time chunks resume when more text arrives
+ * and when the filling is done.
+ * @param on true while filling
+ */
+void PropHighlighter::set_filling(bool on)
+{
+    m_filling = on;
+    if (!m_filling && m_lazy)
+	m_idle_timer.start();
+}
 
-	int startIndex = 0;
-	if (previousBlockState() != 1)
-	    startIndex = commentStartExpression.indexIn(text);
+/**
+ * @brief Set the range of visible blocks, plus a margin, and format them
+ * @param first number of the first visible block
+ * @param last number of the last visible block
+ */
+void PropHighlighter::set_visible_blocks(int first, int last)
+{
+    first = qMax(0, first - visible_margin);
+    last = last + visible_margin;
+    if (first == m_visible_first && last == m_visible_last)
+	return;
+    const int old_first = m_visible_first;
+    const int old_last = m_visible_last;
+    m_visible_first = first;
+    m_visible_last = last;
+    if (!m_lazy || !document())
+	return;
 
-	while (startIndex >= 0) {
-	    const int endIndex = commentEndExpression.indexIn(text, startIndex);
-	    int commentLength;
-	    if (endIndex == -1) {
-		setCurrentBlockState(1);
-		commentLength = text.length() - startIndex;
-	    } else {
-		commentLength = endIndex - startIndex
-			+ commentEndExpression.matchedLength();
-	    }
+    // format the blocks which became visible and are not done yet
+    QTextBlock block = document()->findBlockByNumber(qMax(first, m_done));
+    while (block.isValid() && block.blockNumber() <= last) {
+	const int number = block.blockNumber();
+	if (number < old_first || number > old_last)
+	    rehighlightBlock(block);
+	block = block.next();
+    }
+}
 
-	    setFormat(startIndex, commentLength, multiLineCommentFormat);
-	    startIndex = commentStartExpression.indexIn(text, startIndex + commentLength);
-	}
+/**
+ * @brief Format the next chunk of blocks while the application is idle
+ */
+void PropHighlighter::idle_chunk()
+{
+    if (!m_lazy || !document()) {
+	m_idle_timer.stop();
+	return;
+    }
+    QElapsedTimer et;
+    et.start();
+    QTextBlock block = document()->findBlockByNumber(m_done);
+    while (block.isValid() && et.elapsed() < idle_chunk_msecs) {
+	const int number = block.blockNumber();
+	const bool visible = number >= m_visible_first && number <= m_visible_last;
+	m_done = number + 1;
+	if (!visible)
+	    rehighlightBlock(block);
+	block = block.next();
+    }
+    if (!block.isValid()) {
+	// more chunks of the document are still to come
+	if (!m_filling)
+	    m_lazy = false;
+	m_idle_timer.stop();
     }
 }
 
+/**
+ * @brief Restart the idle time chunks at an edit before the blocks done so far
+ * @param position position of the change in the document
+ * @param removed number of characters removed
+ * @param added number of characters added
+ */
+void PropHighlighter::contents_change(int position, int removed, int added)
+{
+    Q_UNUSED(removed)
+    Q_UNUSED(added)
+    if (!m_lazy || !document())
+	return;
+    const int number = document()->findBlock(position).blockNumber();
+    if (number >= 0 && number < m_done)
+	m_done = number;
+    if (!m_idle_timer.isActive())
+	m_idle_timer.start();
+}
+
 void PropHighlighter::appendRule(HighlightingRule rule)
 {
     highlightingRules.append(rule);
@@ -14,11 +14,13 @@
 #include <QWidget>
 #include <QSyntaxHighlighter>
 #include <QTextCharFormat>
+#include <QTextBlockUserData>
 #include <QTextCursor>
 #include <QTextDocument>
 #include <QPaintEvent>
 #include <QResizeEvent>
 #include <QPainter>
+#include <QTimer>
 #include "util.h"
 
 class LineNumberArea;
@@ -56,6 +58,7 @@ public:
 	PE_USE_IN_LINE_COMMENTS	    = (1 <<13),
 	PE_USE_SINGLE_LINE_COMMENTS = (1 <<14),
 	PE_USE_MULTI_LINE_COMMENTS  = (1 <<15),
+	PE_LAZY_HIGHLIGHT	    = (1 <<16),
 
 	PE_DEFAULT = PE_NONE
 	    | PE_USE_LINENUMBERS
@@ -73,10 +76,18 @@ public:
 	    | PE_USE_IN_LINE_COMMENTS
 	    | PE_USE_SINGLE_LINE_COMMENTS
 	    | PE_USE_MULTI_LINE_COMMENTS
+	    | PE_LAZY_HIGHLIGHT
     };
 
     Q_DECLARE_FLAGS(Options, Option)
 
+    /** @brief Severity of a compiler diagnostic */
+    typedef enum {
+	Diag_None,		//!< no diagnostic
+	Diag_Warning,		//!< warning
+	Diag_Error		//!< error
+    }   Severity;
+
     PropEdit(QWidget *parent = nullptr,
 	     const int tabsize = 8,
 	     const QString& css_linearea = QString(),
@@ -86,9 +97,13 @@ public:
     int  line_number_area_width();
     void append_rule(HighlightingRule rule);
     void prepend_rule(HighlightingRule rule);
-    void set_error_line_list(const QList<int>& list = QList<int>());
+    void clear_diagnostics();
+    void add_diagnostic(int lnum, Severity severity, const QString& message);
+    int diagnostics() const;
+    QString diagnostic(int lnum) const;
 
     bool changed() const;
+    bool loading() const;
     QString text() const;
     QString filename() const;
     FileType filetype() const;
@@ -97,10 +112,17 @@ public:
 public slots:
     bool load(const QString& filename = QString());
     bool save(const QString& filename = QString());
+    void set_loading(const QString& filename);
+    void set_loaded_text(const QString& text, const QByteArray& sha256);
     void setFont(const QFont& font);
     void setText(const QString& text);
     void setFilename(const QString& filename);
     void gotoLineNumber(int lnum);
+    int goto_next_diagnostic();
+    int goto_previous_diagnostic();
+
+signals:
+    void Loaded();
 
 protected:
     void resizeEvent(QResizeEvent *event);
@@ -112,20 +134,58 @@ private slots:
     void update_line_number_area_width(int newBlockCount);
     void highlight_current_line();
     void update_line_number_area(const QRect& rect, int dy);
+    void update_visible_blocks();
+    void fill_chunk();
 
 private:
     static constexpr QRgb color_line_number_area = qRgb(0xf0,0xf0,0xf0);
+    static constexpr QRgb color_error_line = qRgb(0xff,0x00,0x00);
+    static constexpr QRgb color_warning_line = qRgb(0xff,0xc0,0x40);
+    //! Number of lines from which on a text is highlighted lazily
+    static constexpr int lazy_line_count = 2000;
+    //! Number of characters to insert into the document per chunk while loading
+    static constexpr int fill_chunk_chars = 256 * 1024;
 
     QWidget* m_lineno_area;
     PropHighlighter* m_highlighter;
     int m_tabsize;
     PropEdit::Options m_options;
-    QList<int> m_error_lines;
+    int m_diagnostics;		//!< number of marked blocks; an upper bound once lines were deleted
+    bool m_loading;		//!< true until the loaded text is completely in the document
+    QString m_fill_text;	//!< loaded text being inserted into the document
+    int m_fill_pos;		//!< position of the next chunk in m_fill_text
+    QTimer m_fill_timer;	//!< timer to insert the next chunk
+
+    int goto_diagnostic(bool backward);
+};
+
+/**
+ * @brief Compiler diagnostic attached to a block of a PropEdit
+ *
+ * Being block user data, the marker moves with its line while the text
+ * is edited, and looking it up while painting is O(1) per line.
+ */
+class DiagnosticData : public QTextBlockUserData
+{
+public:
+    DiagnosticData(PropEdit::Severity severity, const QString& message)
+	: severity(severity)
+	, message(message)
+    {}
+    PropEdit::Severity severity;	//!< most severe diagnostic of the line
+    QString message;			//!< messages for the line, one per line
 };
 
 /**
  * @brief The Highlighter class is derived from the QSyntaxHighlighter class
  * and implements highlighting for a number of rules.
+ *
+ * Each block is split into tokens in one linear pass. Names and operators
+ * are classified by looking them up in the compile time table of g_tokens.
+ * Rules added with appendRule() or prependRule() are applied afterwards.
+ *
+ * For large documents a lazy mode formats only the visible blocks first
+ * and the rest in chunks while the application is idle.
  */
 class PropHighlighter : public QSyntaxHighlighter
 {
@@ -136,11 +196,40 @@ public:
     QBrush background();
     void appendRule(HighlightingRule rule);
     void prependRule(HighlightingRule rule);
+    void set_lazy(bool on);
+    bool is_lazy() const;
+    void set_filling(bool on);
+    void set_visible_blocks(int first, int last);
 
 protected:
     void highlightBlock(const QString &text) Q_DECL_OVERRIDE;
 
+private slots:
+    void idle_chunk();
+    void contents_change(int position, int removed, int added);
+
 private:
+    typedef enum {
+	TC_none,
+	TC_section,
+	TC_keyword,
+	TC_conditional,
+	TC_operator,
+	TC_preproc,
+    }   TokenClass;
+
+    struct Lexicon;
+    static const Lexicon& lexicon();
+    const QTextCharFormat* class_format(TokenClass tc, bool first) const;
+    static int comment_end(const QString& text, int from);
+    int tokenize(const QString& text, int state, bool format);
+    bool formatting(int number) const;
+
+    //! Number of blocks above and below the visible ones to format first
+    static constexpr int visible_margin = 50;
+    //! Milliseconds to spend formatting blocks per idle time chunk
+    static constexpr int idle_chunk_msecs = 8;
+
     static constexpr QRgb color_background  = qRgb(0xf8, 0xfc, 0xf8);
     static constexpr QRgb color_preproc	    = qRgb(0x20, 0x20, 0x7f);
     static constexpr QRgb color_keyword	    = qRgb(0x00, 0x9f, 0x9f);
@@ -156,9 +245,12 @@ private:
 
     PropEdit::Options m_options;
     QVector<HighlightingRule> highlightingRules;
-
-    QRegExp commentStartExpression;
-    QRegExp commentEndExpression;
+    bool m_lazy;			//!< true while the lazy mode formats blocks
+    bool m_filling;			//!< true while the document is filled in chunks
+    int m_done;				//!< blocks before this number are formatted
+    int m_visible_first;		//!< first visible block, including the margin
+    int m_visible_last;			//!< last visible block, including the margin
+    QTimer m_idle_timer;		//!< timer for the idle time chunks
 
     QTextCharFormat singleLineCommentFormat;
     QTextCharFormat inLineCommentFormat;
@@ -0,0 +1,89 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 text lines model
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#include <QFontMetrics>
+#include <cstring>
+#include "textlinesmodel.h"
+
+TextLinesModel::TextLinesModel(const QByteArray& text, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_text(text)
+    , m_offsets()
+    , m_max_columns(0)
+    , m_size_hint()
+{
+    const char* data = m_text.constData();
+    const int size = m_text.size();
+    int offs = 0;
+    m_offsets += 0;
+    while (offs < size) {
+	const char* lf = static_cast<const char*>(memchr(data + offs, '\n', static_cast<size_t>(size - offs)));
+	const int end = lf ? static_cast<int>(lf - data) + 1 : size;
+	int columns = end - offs;
+	// count each tab as a full tab stop for the width estimate
+	for (const char* p = data + offs; (p = static_cast<const char*>(memchr(p, '\t', static_cast<size_t>(data + end - p)))); p++)
+	    columns += tab_size - 1;
+	m_max_columns = qMax(m_max_columns, columns);
+	m_offsets += end;
+	offs = end;
+    }
+}
+
+/**
+ * @brief Set the font the lines are shown in
+ *
+ * The width of the longest line is reported as the size hint of all
+ * rows, so that a view with uniform item sizes never has to measure them.
+ * @param font const reference to the (fixed pitch) QFont of the view
+ */
+void TextLinesModel::set_font(const QFont& font)
+{
+    const QFontMetrics fm(font);
+    m_size_hint = QSize(fm.horizontalAdvance(QChar('0')) * (m_max_columns + 1), fm.height());
+}
+
+int TextLinesModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+	return 0;
+    return m_offsets.size() - 1;
+}
+
+QVariant TextLinesModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+	return QVariant();
+    switch (role) {
+    case Qt::DisplayRole:
+	return line(index.row());
+    case Qt::SizeHintRole:
+	if (m_size_hint.isValid())
+	    return m_size_hint;
+	break;
+    }
+    return QVariant();
+}
+
+/**
+ * @brief Decode the text of line @p row
+ * @param row line number
+ * @return QString without the line end, tabs expanded to blanks
+ */
+QString TextLinesModel::line(int row) const
+{
+    const int offs = m_offsets[row];
+    int len = m_offsets[row + 1] - offs;
+    const char* src = m_text.constData() + offs;
+    while (len > 0 && (src[len - 1] == '\n' || src[len - 1] == '\r'))
+	len--;
+    QString text = QString::fromUtf8(src, len);
+    for (int tab = text.indexOf(QChar::Tabulation); tab >= 0; tab = text.indexOf(QChar::Tabulation, tab))
+	text.replace(tab, 1, QString(tab_size - tab % tab_size, QChar::Space));
+    return text;
+}
@@ -0,0 +1,43 @@
+/***************************************************************************************
+ *
+ * Qt5 Propeller 2 text lines model
+ *
+ * Copyright 🄯 2021 Jürgen Buchmüller <pullmoll@t-online.de>
+ *
+ * See the file LICENSE for the details of the BSD-3-Clause terms.
+ *
+ ***************************************************************************************/
+#pragma once
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QFont>
+#include <QVector>
+
+/**
+ * @brief The TextLinesModel class shows UTF-8 text, e.g. a listing, line by line
+ *
+ * The constructor only scans the text for line feeds and records the
+ * offset of each line. A line is decoded, and its tabs expanded, only
+ * when a view asks for it, so a view of a large listing opens instantly.
+ */
+class TextLinesModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit TextLinesModel(const QByteArray& text, QObject* parent = nullptr);
+
+    void set_font(const QFont& font);
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    //! Number of columns per tab stop
+    static constexpr int tab_size = 8;
+
+    QByteArray m_text;		//!< UTF-8 text
+    QVector<int> m_offsets;	//!< offset of each line, plus the end of the text
+    int m_max_columns;		//!< upper bound of the columns of the longest line
+    QSize m_size_hint;		//!< size of every row in the font of the view
+
+    QString line(int row) const;
+};